@@ -26,6 +26,7 @@
 #include "OniCProperties.h"
 #include "OniDriverTypes.h"
 #include <stdarg.h>
+#include <string.h>
 
 namespace oni { namespace driver {
 
@@ -60,6 +61,16 @@ public:
 	{
 		OniStreamServices::releaseFrame(streamServices, pFrame);
 	}
+
+	bool isExternalFrameSupported()
+	{
+		return OniStreamServices::acquireExternalFrame != NULL;
+	}
+
+	OniFrame* acquireExternalFrame(void* data, int dataSize, OniFrameFreeBufferCallback freeData, void* pCookie)
+	{
+		return OniStreamServices::acquireExternalFrame(streamServices, data, dataSize, freeData, pCookie);
+	}
 };
 
 class StreamBase
@@ -70,6 +81,14 @@ public:
 
 	virtual void setServices(StreamServices* pStreamServices) { m_pServices = pStreamServices; }
 
+	// Keeps a copy of the services, of the size the core has. Members it doesn't have are NULL.
+	StreamServices* copyServices(const OniStreamServices* pServices, size_t servicesSize)
+	{
+		memset(&m_servicesCopy, 0, sizeof(m_servicesCopy));
+		memcpy(&m_servicesCopy, pServices, (servicesSize < sizeof(OniStreamServices)) ? servicesSize : sizeof(OniStreamServices));
+		return &m_servicesCopy;
+	}
+
 	virtual OniStatus setProperty(int /*propertyId*/, const void* /*data*/, int /*dataSize*/) {return ONI_STATUS_NOT_IMPLEMENTED;}
 	virtual OniStatus getProperty(int /*propertyId*/, void* /*data*/, int* /*pDataSize*/) {return ONI_STATUS_NOT_IMPLEMENTED;}
 	virtual OniBool isPropertySupported(int /*propertyId*/) {return FALSE;}
@@ -88,6 +107,46 @@ public:
 
 	virtual OniStatus convertDepthToColorCoordinates(StreamBase* /*colorStream*/, int /*depthX*/, int /*depthY*/, OniDepthPixel /*depthZ*/, int* /*pColorX*/, int* /*pColorY*/) { return ONI_STATUS_NOT_SUPPORTED; }
 
+	// Batch versions of convertDepthToColorCoordinates(). Each result is an (x, y) pair in pColorXY, (-1, -1) if the
+	// pixel has no color counterpart. The defaults convert one point at a time; drivers can do better.
+	virtual OniStatus convertDepthPointsToColorCoordinates(StreamBase* colorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			OniStatus rc = convertDepthToColorCoordinates(colorStream, pDepthXY[i*2], pDepthXY[i*2+1], pDepthZ[i], &pColorXY[i*2], &pColorXY[i*2+1]);
+			if (rc == ONI_STATUS_NOT_SUPPORTED)
+			{
+				return rc;
+			}
+			else if (rc != ONI_STATUS_OK)
+			{
+				pColorXY[i*2] = pColorXY[i*2+1] = -1;
+			}
+		}
+		return ONI_STATUS_OK;
+	}
+
+	// pDepth points at depth pixel (originX, originY), stride is in bytes.
+	virtual OniStatus convertDepthMapToColorCoordinates(StreamBase* colorStream, const OniDepthPixel* pDepth, int stride, int originX, int originY, int width, int height, int* pColorXY)
+	{
+		for (int y = 0; y < height; ++y, pDepth = (const OniDepthPixel*)((const char*)pDepth + stride))
+		{
+			for (int x = 0; x < width; ++x, pColorXY += 2)
+			{
+				OniStatus rc = convertDepthToColorCoordinates(colorStream, originX + x, originY + y, pDepth[x], &pColorXY[0], &pColorXY[1]);
+				if (rc == ONI_STATUS_NOT_SUPPORTED)
+				{
+					return rc;
+				}
+				else if (rc != ONI_STATUS_OK)
+				{
+					pColorXY[0] = pColorXY[1] = -1;
+				}
+			}
+		}
+		return ONI_STATUS_OK;
+	}
+
 protected:
 	void raiseNewFrame(OniFrame* pFrame) { (*m_newFrameCallback)(this, pFrame, m_newFrameCallbackCookie); }
 	void raisePropertyChanged(int propertyId, const void* data, int dataSize) { (*m_propertyChangedCallback)(this, propertyId, data, dataSize, m_propertyChangedCookie); }
@@ -96,6 +155,7 @@ protected:
 
 private:
 	StreamServices* m_pServices;
+	StreamServices m_servicesCopy;
 	NewFrameCallback m_newFrameCallback;
 	void* m_newFrameCallbackCookie;
 	PropertyChangedCallback m_propertyChangedCallback;
@@ -303,7 +363,13 @@ ONI_C_API_EXPORT OniBool oniDriverDeviceIsImageRegistrationModeSupported(oni::dr
 /* As Stream */																												\
 ONI_C_API_EXPORT void oniDriverStreamSetServices(oni::driver::StreamBase* pStream, OniStreamServices* pServices)			\
 {																															\
-	pStream->setServices((oni::driver::StreamServices*)pServices);															\
+	pStream->setServices(pStream->copyServices(pServices, ONI_STREAM_SERVICES_UNSIZED_SIZE));								\
+}																															\
+																															\
+ONI_C_API_EXPORT void oniDriverStreamSetServicesSized(oni::driver::StreamBase* pStream, OniStreamServices* pServices,		\
+													int servicesSize)														\
+{																															\
+	pStream->setServices(pStream->copyServices(pServices, (size_t)servicesSize));											\
 }																															\
 																															\
 ONI_C_API_EXPORT OniStatus oniDriverStreamSetProperty(oni::driver::StreamBase* pStream, int propertyId,						\
@@ -365,6 +431,19 @@ ONI_C_API_EXPORT OniStatus oniDriverStreamConvertDepthToColorCoordinates(oni::dr
 	return pDepthStream->convertDepthToColorCoordinates(pColorStream, depthX, depthY, depthZ, pColorX, pColorY);			\
 }																															\
 																															\
+ONI_C_API_EXPORT OniStatus oniDriverStreamConvertDepthPointsToColorCoordinates(oni::driver::StreamBase* pDepthStream,		\
+	oni::driver::StreamBase* pColorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY)	\
+{																															\
+	return pDepthStream->convertDepthPointsToColorCoordinates(pColorStream, count, pDepthXY, pDepthZ, pColorXY);			\
+}																															\
+																															\
+ONI_C_API_EXPORT OniStatus oniDriverStreamConvertDepthMapToColorCoordinates(oni::driver::StreamBase* pDepthStream,			\
+	oni::driver::StreamBase* pColorStream, const OniDepthPixel* pDepth, int stride, int originX, int originY,				\
+	int width, int height, int* pColorXY)																					\
+{																															\
+	return pDepthStream->convertDepthMapToColorCoordinates(pColorStream, pDepth, stride, originX, originY, width, height, pColorXY); \
+}																															\
+																															\
 ONI_C_API_EXPORT void* oniDriverEnableFrameSync(oni::driver::StreamBase** pStreams, int streamCount)						\
 {																															\
 	return g_pDriver->enableFrameSync(pStreams, streamCount);																\
@@ -23,6 +23,7 @@
 
 #include <OniCTypes.h>
 #include <stdarg.h>
+#include <stddef.h>
 
 #define ONI_STREAM_PROPERTY_PRIVATE_BASE XN_MAX_UINT16
 
@@ -41,6 +42,8 @@ struct OniDriverServices
 	void (ONI_CALLBACK_TYPE* log)(void* driverServices, int severity, const char* file, int line, const char* mask, const char* message);
 };
 
+// Members are only ever appended. The core tells drivers the size of the struct it was built with through
+// oniDriverStreamSetServicesSized(). Cores that call oniDriverStreamSetServices() have the members up to releaseFrame.
 struct OniStreamServices
 {
 	void* streamServices;
@@ -48,7 +51,11 @@ struct OniStreamServices
 	OniFrame* (ONI_CALLBACK_TYPE* acquireFrame)(void* streamServices); // returns a frame with size corresponding to getRequiredFrameSize()
 	void (ONI_CALLBACK_TYPE* addFrameRef)(void* streamServices, OniFrame* pframe);
 	void (ONI_CALLBACK_TYPE* releaseFrame)(void* streamServices, OniFrame* pframe);
+	// returns a frame whose data is owned by the driver. freeData is called once the frame is no longer used.
+	OniFrame* (ONI_CALLBACK_TYPE* acquireExternalFrame)(void* streamServices, void* data, int dataSize, OniFrameFreeBufferCallback freeData, void* pCookie);
 };
 
+#define ONI_STREAM_SERVICES_UNSIZED_SIZE	offsetof(OniStreamServices, acquireExternalFrame)
+
 
 #endif // _ONI_DRIVER_TYPES_H_
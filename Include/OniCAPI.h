@@ -109,6 +109,19 @@ ONI_C_API void oniStreamStop(OniStreamHandle stream);
 /** Get the next frame from the stream. This function is blocking until there is a new frame from the stream. For timeout, use oniWaitForStreams() first */
 ONI_C_API OniStatus oniStreamReadFrame(OniStreamHandle stream, OniFrame** pFrame);
 
+/**
+ * Get all the frames currently available from a set of streams in a single call.
+ * Blocks until at least one of the streams has a new frame, or until the timeout expires.
+ * @param	[in]	pStreams	The streams to read from. Entries may be NULL.
+ * @param	[in]	numStreams	The number of streams in pStreams.
+ * @param	[out]	pFrames		An array of numStreams frames. Each entry is set to the new frame of the matching stream,
+ *								or NULL if it has none. Each returned frame should be released with oniFrameRelease().
+ * @param	[in]	timeout		Timeout in milliseconds, or ONI_TIMEOUT_FOREVER.
+ * @retval ONI_STATUS_OK Upon successful completion. At least one frame was returned.
+ * @retval ONI_STATUS_TIME_OUT If no stream had a new frame before the timeout expired.
+ */
+ONI_C_API OniStatus oniReadFramesBatch(OniStreamHandle* pStreams, int numStreams, OniFrame** pFrames, int timeout);
+
 /** Register a callback to when the stream has a new frame. */
 ONI_C_API OniStatus oniStreamRegisterNewFrameCallback(OniStreamHandle stream, OniNewFrameCallback handler, void* pCookie, OniCallbackHandle* pHandle);
 /** Unregister a previously registered callback to when the stream has a new frame. */
@@ -177,6 +190,27 @@ ONI_C_API OniStatus oniRecorderStart(OniRecorderHandle recorder);
  */
 ONI_C_API void oniRecorderStop(OniRecorderHandle recorder);
 
+/**
+ * Limits the memory held by frames that were received but not yet written to
+ * the file. The default limit is set by the [Recording] section of OpenNI.ini.
+ * @param[in] recorder The handle to the recorder.
+ * @param[in] maxQueuedBytes Max total size of the queued frames, in bytes. 0 means no limit.
+ * @param[in] policy What to do with new frames once the limit is reached.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the recorder handle or the policy are invalid.
+ */
+ONI_C_API OniStatus oniRecorderSetQueueLimit(OniRecorderHandle recorder, uint64_t maxQueuedBytes, OniRecorderQueuePolicy policy);
+
+/**
+ * Gets the counters of a recorder: its queue depth, and how many frames were
+ * recorded or dropped.
+ * @param[in] recorder The handle to the recorder.
+ * @param[out] pStats The counters.
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the recorder handle is invalid.
+ */
+ONI_C_API OniStatus oniRecorderGetStats(OniRecorderHandle recorder, OniRecorderStats* pStats);
+
 /**
  * Stops recording if needed, and destroys a recorder.
  * @param	[in,out]	recorder	The handle to the recorder, the handle will be
@@ -188,10 +222,50 @@ ONI_C_API OniStatus oniRecorderDestroy(OniRecorderHandle* pRecorder);
 
 ONI_C_API OniStatus oniCoordinateConverterDepthToWorld(OniStreamHandle depthStream, float depthX, float depthY, float depthZ, float* pWorldX, float* pWorldY, float* pWorldZ);
 
+/**
+ * Converts a whole depth frame, or a region of it, to World coordinates.
+ * @param	[in]	depthStream	The stream that produced the frame.
+ * @param	[in]	pFrame		A depth frame (DEPTH_1_MM or DEPTH_100_UM) read from depthStream.
+ * @param	[in]	pRegion		The part of the frame to convert, in frame pixels. NULL (or a disabled region) converts the whole frame.
+ * @param	[in]	step		Converts every step-th pixel of every step-th row. 1 converts all pixels.
+ * @param	[out]	pWorld		Receives X, Y and Z of each converted pixel, row by row. Must have room for
+ *								3 * ceil(width / step) * ceil(height / step) floats. Pixels with no depth become (0, 0, 0).
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_BAD_PARAMETER If the region is outside the frame, or the frame does not match the stream's video mode.
+ * @retval ONI_STATUS_NOT_SUPPORTED If the stream or the frame is not depth.
+ */
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToWorld(OniStreamHandle depthStream, const OniFrame* pFrame, const OniCropping* pRegion, int step, float* pWorld);
+
 ONI_C_API OniStatus oniCoordinateConverterWorldToDepth(OniStreamHandle depthStream, float worldX, float worldY, float worldZ, float* pDepthX, float* pDepthY, float* pDepthZ);
 
 ONI_C_API OniStatus oniCoordinateConverterDepthToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
 
+/**
+ * Finds the color pixels of many depth pixels at once.
+ * @param	[in]	depthStream	The depth stream.
+ * @param	[in]	colorStream	A color stream of the same device.
+ * @param	[in]	count		Number of points.
+ * @param	[in]	pDepthXY	X and Y of each depth pixel (2 * count ints).
+ * @param	[in]	pDepthZ		Depth of each pixel (count values).
+ * @param	[out]	pColorXY	Receives X and Y of the matching color pixels (2 * count ints). Pixels with
+ *								no depth, or that fall outside of the color image, get (-1, -1).
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_NOT_SUPPORTED If the streams are not depth and color of the same device.
+ */
+ONI_C_API OniStatus oniCoordinateConverterDepthPointsToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY);
+
+/**
+ * Finds the color pixel of every pixel of a depth frame.
+ * @param	[in]	depthStream	The stream that produced the frame.
+ * @param	[in]	colorStream	A color stream of the same device.
+ * @param	[in]	pFrame		A depth frame read from depthStream.
+ * @param	[out]	pColorXY	Receives X and Y of the matching color pixels, row by row (2 * width * height ints).
+ *								Pixels with no depth, or that fall outside of the color image, get (-1, -1).
+ * @retval ONI_STATUS_OK Upon successful completion.
+ * @retval ONI_STATUS_NOT_SUPPORTED If the streams are not depth and color of the same device.
+ */
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, const OniFrame* pFrame, int* pColorXY);
+
 /******************************************** Log APIs */
 
 /** 
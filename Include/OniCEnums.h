@@ -75,6 +75,17 @@ typedef enum
 	ONI_IMAGE_REGISTRATION_DEPTH_TO_COLOR	= 1,
 } OniImageRegistrationMode;
 
+/** What a recorder does with new frames when its queue of frames waiting to be written is full */
+typedef enum
+{
+	/** Wait until there is room in the queue. Slows down the recorded streams. */
+	ONI_RECORDER_QUEUE_BLOCK		= 0,
+	/** Don't record the new frame. */
+	ONI_RECORDER_QUEUE_DROP_NEWEST	= 1,
+	/** Drop the oldest frames waiting in the queue to make room for the new one. */
+	ONI_RECORDER_QUEUE_DROP_OLDEST	= 2,
+} OniRecorderQueuePolicy;
+
 enum
 {
 	ONI_TIMEOUT_NONE = 0,
@@ -34,6 +34,7 @@ enum
 	// Files
 	ONI_DEVICE_PROPERTY_PLAYBACK_SPEED		= 100, // float
 	ONI_DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED			= 101, // OniBool
+	ONI_DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED			= 102, // OniBool
 };
 
 // Stream properties
@@ -57,12 +58,16 @@ enum
 	ONI_STREAM_PROPERTY_AUTO_EXPOSURE			= 101, // OniBool
 	ONI_STREAM_PROPERTY_EXPOSURE				= 102, // int
 	ONI_STREAM_PROPERTY_GAIN					= 103, // int
+
+	// Frame buffers (handled by OpenNI itself, for streams using the default frame buffer allocator)
+	ONI_STREAM_PROPERTY_FRAME_BUFFER_POOL_DEPTH	= 200, // int: number of buffers preallocated on stream start
 };
 
 // Device commands (for Invoke)
 enum
 {
 	ONI_DEVICE_COMMAND_SEEK				= 1, // OniSeek
+	ONI_DEVICE_COMMAND_EXPORT_SEGMENTS	= 2, // OniExportSegments
 };
 
 #endif // _ONI_C_PROPERTIES_H_
@@ -190,4 +190,40 @@ typedef struct
 	OniStreamHandle stream;
 } OniSeek;
 
+/** Counters of a recorder, since it was created. */
+typedef struct
+{
+	/** Number of frames waiting to be written. */
+	int queuedFrames;
+	/** Size of the frames waiting to be written, in bytes. */
+	uint64_t queuedBytes;
+	/** Number of frames written to the file. */
+	uint64_t recordedFrames;
+	/** Number of frames dropped because the queue was full. */
+	uint64_t droppedFrames;
+	/** Number of bytes written to the file. */
+	uint64_t writtenBytes;
+} OniRecorderStats;
+
+/** A range of frames of a recording, to be exported to a recording of its own. */
+typedef struct
+{
+	/** The sensor whose frames delimit the segment. The frames of the other sensors are exported from the time of
+	    the first frame, up to the time of the frame following the last one. */
+	OniSensorType sensorType;
+	/** First and last frames of the segment (inclusive, counting from 1). */
+	int firstFrameIndex;
+	int lastFrameIndex;
+	/** The recording to create. */
+	const char* fileName;
+	/** Set when the segment is exported. */
+	OniStatus status;
+} OniRecordingSegment;
+
+typedef struct
+{
+	OniRecordingSegment* segments;
+	int numSegments;
+} OniExportSegments;
+
 #endif // _ONI_TYPES_H_
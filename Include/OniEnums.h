@@ -78,6 +78,17 @@ typedef enum
 	IMAGE_REGISTRATION_DEPTH_TO_COLOR	= 1,
 } ImageRegistrationMode;
 
+/** What a recorder does with new frames when its queue of frames waiting to be written is full */
+typedef enum
+{
+	/** Wait until there is room in the queue. Slows down the recorded streams. */
+	RECORDER_QUEUE_BLOCK		= 0,
+	/** Don't record the new frame. */
+	RECORDER_QUEUE_DROP_NEWEST	= 1,
+	/** Drop the oldest frames waiting in the queue to make room for the new one. */
+	RECORDER_QUEUE_DROP_OLDEST	= 2,
+} RecorderQueuePolicy;
+
 static const int TIMEOUT_NONE = 0;
 static const int TIMEOUT_FOREVER = -1;
 
@@ -37,6 +37,7 @@ enum
 	// Files
 	DEVICE_PROPERTY_PLAYBACK_SPEED			= 100, // float
 	DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED		= 101, // OniBool
+	DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED	= 102, // OniBool
 };
 
 // Stream properties
@@ -61,12 +62,15 @@ enum
 	STREAM_PROPERTY_EXPOSURE				= 102, // int
 	STREAM_PROPERTY_GAIN					= 103, // int
 
+	// Frame buffers (handled by OpenNI itself, for streams using the default frame buffer allocator)
+	STREAM_PROPERTY_FRAME_BUFFER_POOL_DEPTH	= 200, // int: number of buffers preallocated on stream start
 };
 
 // Device commands (for Invoke)
 enum
 {
 	DEVICE_COMMAND_SEEK				= 1, // OniSeek
+	DEVICE_COMMAND_EXPORT_SEGMENTS	= 2, // OniExportSegments
 };
 
 } // namespace openni
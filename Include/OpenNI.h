@@ -82,6 +82,36 @@ typedef struct
 	uint8_t y2;
 } YUV422DoublePixel;
 
+/** Counters of a @ref Recorder, since it was created. */
+typedef struct
+{
+	/** Number of frames waiting to be written. */
+	int queuedFrames;
+	/** Size of the frames waiting to be written, in bytes. */
+	uint64_t queuedBytes;
+	/** Number of frames written to the file. */
+	uint64_t recordedFrames;
+	/** Number of frames dropped because the queue was full. */
+	uint64_t droppedFrames;
+	/** Number of bytes written to the file. */
+	uint64_t writtenBytes;
+} RecorderStats;
+
+/** A range of frames of a recording, to be exported by @ref PlaybackControl::exportSegments(). */
+typedef struct
+{
+	/** The sensor whose frames delimit the segment. The frames of the other sensors are exported from the time of
+	    the first frame, up to the time of the frame following the last one. */
+	SensorType sensorType;
+	/** First and last frames of the segment (inclusive, counting from 1). */
+	int firstFrameIndex;
+	int lastFrameIndex;
+	/** The recording to create. */
+	const char* fileName;
+	/** Set when the segment is exported. */
+	Status status;
+} RecordingSegment;
+
 /** This special URI can be passed to @ref Device::open() when the application has no concern for a specific device. */
 #if ONI_PLATFORM != ONI_PLATFORM_WIN32
 #pragma GCC diagnostic ignored "-Wunused-variable"
@@ -609,6 +639,12 @@ public:
 		return m_pFrame;
 	}
 
+	/** @internal */
+	const OniFrame* _getFrame() const
+	{
+		return m_pFrame;
+	}
+
 private:
 	friend class VideoStream;
 	inline void setReference(OniFrame* pFrame)
@@ -816,6 +852,10 @@ public:
 			return STATUS_ERROR;
 		}
 
+		// Let go of the previous frame before waiting for the next one (a file device in lockstep mode only
+		// moves on once it was released).
+		pFrame->release();
+
 		OniFrame* pOniFrame;
 		Status rc = (Status)oniStreamReadFrame(m_stream, &pOniFrame);
 
@@ -823,6 +863,59 @@ public:
 		return rc;
 	}
 
+	/**
+	Read all the frames currently available from a group of video streams in a single call.  If none of the
+	streams has a new frame, the call blocks until at least one does, or until the timeout expires.
+	Streams that had no new frame get an invalid @ref VideoFrameRef (see @ref VideoFrameRef::isValid()).
+	This is cheaper than @ref OpenNI::waitForAnyStream() followed by a @ref readFrame() call for each stream
+	when reading many streams.
+
+	@param [in] pStreams An array of streams to read from. Entries may be NULL.
+	@param [in] streamCount The number of streams in @c pStreams.
+	@param [out] pFrames An array of @c streamCount @ref VideoFrameRef objects to hold the new frames.
+	@param [in] timeout [Optional] A timeout before returning if no stream has new data. Default value is @ref TIMEOUT_FOREVER.
+	@returns Status code to indicated success or failure of this function.
+	*/
+	static Status readFrames(VideoStream** pStreams, int streamCount, VideoFrameRef* pFrames, int timeout = TIMEOUT_FOREVER)
+	{
+		static const int ONI_STACK_STREAMS = 16;
+		OniStreamHandle stackStreams[ONI_STACK_STREAMS];
+		OniFrame* stackFrames[ONI_STACK_STREAMS];
+
+		if (streamCount <= 0)
+		{
+			return STATUS_BAD_PARAMETER;
+		}
+
+		OniStreamHandle* streams = stackStreams;
+		OniFrame** frames = stackFrames;
+		if (streamCount > ONI_STACK_STREAMS)
+		{
+			streams = new OniStreamHandle[streamCount];
+			frames = new OniFrame*[streamCount];
+		}
+
+		for (int i = 0; i < streamCount; ++i)
+		{
+			streams[i] = (pStreams[i] != NULL) ? pStreams[i]->_getHandle() : NULL;
+			pFrames[i].release();
+		}
+
+		Status rc = (Status)oniReadFramesBatch(streams, streamCount, frames, timeout);
+		for (int i = 0; i < streamCount; ++i)
+		{
+			pFrames[i].setReference(rc == STATUS_OK ? frames[i] : NULL);
+		}
+
+		if (streams != stackStreams)
+		{
+			delete []streams;
+			delete []frames;
+		}
+
+		return rc;
+	}
+
 	/**
 	Adds a new Listener to receive this VideoStream onNewFrame event.  See @ref VideoStream::NewFrameListener for
 	more information on implementing an event driven frame reading architecture. An instance of a listener can be added to only one source.
@@ -1762,6 +1855,50 @@ public:
 		return m_pDevice->setProperty<OniBool>(DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED, repeat ? TRUE : FALSE);
 	}
 
+	/**
+	* Gets the current lockstep setting of the file device.
+	*
+	* @returns true if lockstep is enabled, false if not enabled.
+	*/
+	bool getLockstepEnabled() const
+	{
+		if (!isValid())
+		{
+			return false;
+		}
+
+		OniBool lockstep;
+		Status rc = m_pDevice->getProperty<OniBool>(DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED, &lockstep);
+		if (rc != STATUS_OK)
+		{
+			return false;
+		}
+
+		return lockstep == TRUE;
+	}
+
+	/**
+	* Changes the lockstep mode of the device.  In lockstep mode, the recording is played back without regard
+	* to its timestamps: each stream gets its next frame as soon as all the frames it handed out before were
+	* released (by the application, and by any recorder the stream is attached to).  Playback runs as fast as
+	* the consumers allow, and no frame is dropped.  The playback speed is ignored while lockstep is enabled.
+	* Since the recording is read in order, the application must read every started stream, and release
+	* its frames before waiting for the next frame of any stream (@ref VideoStream::readFrame() releases
+	* the frame it is given before waiting).
+	*
+	* @param [in] lockstep New value for lockstep -- true to enable, false to disable
+	* @returns Status code indicating success or failure of this operations.
+	*/
+	Status setLockstepEnabled(bool lockstep)
+	{
+		if (!isValid())
+		{
+			return STATUS_NO_DEVICE;
+		}
+
+		return m_pDevice->setProperty<OniBool>(DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED, lockstep ? TRUE : FALSE);
+	}
+
 	/**
 	* Seeks within a VideoStream to a given FrameID.  Note that when this function is called on one 
 	* stream, all other streams will also be changed to the corresponding place in the recording.  The FrameIDs
@@ -1784,6 +1921,47 @@ public:
 		return m_pDevice->invoke(DEVICE_COMMAND_SEEK, seek);
 	}
 
+	/**
+	* Exports ranges of frames of the recording to recordings of their own, without decoding them. The frames
+	* are copied as they are, along with the settings the streams had when each range starts. Several segments
+	* are exported in parallel, and playback is not affected.
+	*
+	* @param [in,out] segments The segments to export. The status of each is set.
+	* @param [in] numSegments Number of segments.
+	* @returns Status code indicating success or failure of this operation (failure if any segment failed).
+	*/
+	Status exportSegments(RecordingSegment* segments, int numSegments)
+	{
+		if (!isValid())
+		{
+			return STATUS_NO_DEVICE;
+		}
+		OniExportSegments exportSegments;
+		exportSegments.segments = (OniRecordingSegment*)segments;
+		exportSegments.numSegments = numSegments;
+		return m_pDevice->invoke(DEVICE_COMMAND_EXPORT_SEGMENTS, exportSegments);
+	}
+
+	/**
+	* Exports a range of frames of the recording to a recording of its own. See @ref exportSegments().
+	*
+	* @param [in] sensorType The sensor whose frames delimit the range.
+	* @param [in] firstFrameIndex First frame of the range.
+	* @param [in] lastFrameIndex Last frame of the range (inclusive).
+	* @param [in] fileName The recording to create.
+	* @returns Status code indicating success or failure of this operation
+	*/
+	Status exportSegment(SensorType sensorType, int firstFrameIndex, int lastFrameIndex, const char* fileName)
+	{
+		RecordingSegment segment;
+		segment.sensorType = sensorType;
+		segment.firstFrameIndex = firstFrameIndex;
+		segment.lastFrameIndex = lastFrameIndex;
+		segment.fileName = fileName;
+		segment.status = STATUS_OK;
+		return exportSegments(&segment, 1);
+	}
+
 	/**
 	 * Provides the a count of frames that this recording contains for a given stream.  This is useful
 	 * both to determine the length of the recording, and to ensure that a valid Frame Index is set when using
@@ -2383,9 +2561,10 @@ Since Depth coordinates are a projective, the apparent size of objects in depth
 will increase as an object moves closer to the sensor.  The size of objects in the World coordinate system is independent of
 distance from the sensor.
 
-Note that converting from Depth to World coordinates is relatively expensive computationally.  It is generally not practical to convert
-the entire raw depth map to World coordinates.  A better approach is to have your computer vision algorithm work in Depth
-coordinates for as long as possible, and only converting a few specific points to World coordinates right before output.
+Note that converting from Depth to World coordinates is relatively expensive computationally.  A better approach is to have your
+computer vision algorithm work in Depth coordinates for as long as possible, and only converting a few specific points to World
+coordinates right before output.  When a point cloud of the entire depth map (or of a large part of it) is needed, use
+@ref convertDepthFrameToWorld(), which converts a whole frame at once.
 
 Note that when converting from Depth to World or vice versa, the Z value remains the same.
 */
@@ -2457,6 +2636,40 @@ public:
 		return (Status)oniCoordinateConverterDepthToWorld(depthStream._getHandle(), depthX, depthY, depthZ, pWorldX, pWorldY, pWorldZ);
 	}
 
+	/**
+	Converts a whole depth frame to the World coordinate system. Much faster than converting the pixels one by one.
+	@param [in] depthStream Reference to an openni::VideoStream that produced depthFrame
+	@param [in] depthFrame A depth frame read from depthStream
+	@param [out] pWorld Pointer to a buffer of 3 * width * height floats (or less, see step), receiving X, Y and Z of each pixel, row by row, measured in millimeters in World coordinates. Pixels with no depth become (0, 0, 0)
+	@param [in] step Converts only every step-th pixel of every step-th row, giving ceil(width / step) * ceil(height / step) points
+	*/
+	static Status convertDepthFrameToWorld(const VideoStream& depthStream, const VideoFrameRef& depthFrame, float* pWorld, int step = 1)
+	{
+		return (Status)oniCoordinateConverterDepthFrameToWorld(depthStream._getHandle(), depthFrame._getFrame(), NULL, step, pWorld);
+	}
+
+	/**
+	Converts a region of a depth frame to the World coordinate system.
+	@param [in] depthStream Reference to an openni::VideoStream that produced depthFrame
+	@param [in] depthFrame A depth frame read from depthStream
+	@param [in] originX X of the top-left pixel of the region, in frame pixels
+	@param [in] originY Y of the top-left pixel of the region, in frame pixels
+	@param [in] width Width of the region, in pixels
+	@param [in] height Height of the region, in pixels
+	@param [out] pWorld Pointer to a buffer of 3 * ceil(width / step) * ceil(height / step) floats, receiving X, Y and Z of each converted pixel, row by row, measured in millimeters in World coordinates
+	@param [in] step Converts only every step-th pixel of every step-th row of the region
+	*/
+	static Status convertDepthFrameToWorld(const VideoStream& depthStream, const VideoFrameRef& depthFrame, int originX, int originY, int width, int height, float* pWorld, int step = 1)
+	{
+		OniCropping region;
+		region.enabled = TRUE;
+		region.originX = originX;
+		region.originY = originY;
+		region.width = width;
+		region.height = height;
+		return (Status)oniCoordinateConverterDepthFrameToWorld(depthStream._getHandle(), depthFrame._getFrame(), &region, step, pWorld);
+	}
+
 	/**
 	For a given depth point, provides the coordinates of the corresponding color value.  Useful for superimposing the depth and color images.
 	This operation is the same as turning on registration, but is performed on a single pixel rather than the whole image.
@@ -2472,6 +2685,32 @@ public:
 	{
 		return (Status)oniCoordinateConverterDepthToColor(depthStream._getHandle(), colorStream._getHandle(), depthX, depthY, depthZ, pColorX, pColorY);
 	}
+
+	/**
+	For many depth points at once, provides the coordinates of the corresponding color values.
+	@param [in] depthStream Reference to a openni::VideoStream that produced the depth values
+	@param [in] colorStream Reference to a openni::VideoStream that we want to find the appropriate color pixels in
+	@param [in] count Number of points
+	@param [in] pDepthXY X and Y of each depth point, given in Depth coordinates and measured in pixels (2 * count values)
+	@param [in] pDepthZ Z(depth) value of each depth point, given in the @ref PixelFormat of depthStream (count values)
+	@param [out] pColorXY X and Y of the color pixel that overlaps each depth point (2 * count values), or -1 for points with no color pixel
+	*/
+	static Status convertDepthToColor(const VideoStream& depthStream, const VideoStream& colorStream, int count, const int* pDepthXY, const DepthPixel* pDepthZ, int* pColorXY)
+	{
+		return (Status)oniCoordinateConverterDepthPointsToColor(depthStream._getHandle(), colorStream._getHandle(), count, pDepthXY, pDepthZ, pColorXY);
+	}
+
+	/**
+	For each pixel of a depth frame, provides the coordinates of the corresponding color value.
+	@param [in] depthStream Reference to a openni::VideoStream that produced depthFrame
+	@param [in] colorStream Reference to a openni::VideoStream that we want to find the appropriate color pixels in
+	@param [in] depthFrame A depth frame read from depthStream
+	@param [out] pColorXY X and Y of the color pixel that overlaps each depth pixel, row by row (2 * width * height values), or -1 for pixels with no color pixel
+	*/
+	static Status convertDepthFrameToColor(const VideoStream& depthStream, const VideoStream& colorStream, const VideoFrameRef& depthFrame, int* pColorXY)
+	{
+		return (Status)oniCoordinateConverterDepthFrameToColor(depthStream._getHandle(), colorStream._getHandle(), depthFrame._getFrame(), pColorXY);
+	}
 };
 
 /**
@@ -2586,6 +2825,34 @@ public:
 		}
     }
 
+	/**
+	 * Limits the memory held by frames that were received but not yet written to the file.
+	 * The default limit is set by the [Recording] section of OpenNI.ini.
+	 *
+	 * @param [in] maxQueuedBytes	Max total size of the queued frames, in bytes. 0 means no limit.
+	 * @param [in] policy			What to do with new frames once the limit is reached.
+	 */
+	Status setQueueLimit(uint64_t maxQueuedBytes, RecorderQueuePolicy policy)
+	{
+		if (!isValid())
+		{
+			return STATUS_ERROR;
+		}
+		return (Status)oniRecorderSetQueueLimit(m_recorder, maxQueuedBytes, (OniRecorderQueuePolicy)policy);
+	}
+
+	/**
+	 * Gets the counters of the recorder: its queue depth, and how many frames were recorded or dropped.
+	 */
+	Status getStats(RecorderStats* pStats) const
+	{
+		if (!isValid())
+		{
+			return STATUS_ERROR;
+		}
+		return (Status)oniRecorderGetStats(m_recorder, (OniRecorderStats*)pStats);
+	}
+
 	/**
 	Destroys the recorder object.
 	*/
@@ -127,6 +127,18 @@ enum
 	XN_MODULE_PROPERTY_APC_ENABLED = 0x1080FF91, // "APCEnabled"
 	/** Boolean */
 	XN_MODULE_PROPERTY_FIRMWARE_TEC_DEBUG_PRINT = 0x1080FF92, // "TecDebugPrint"
+	/** String. Set before the device is opened (from the INI file) to capture its USB traffic to this file. */
+	XN_MODULE_PROPERTY_USB_CAPTURE_FILE = 0x1080FF93, // "UsbCaptureFile"
+	/** Real. The speed a device opened from a USB capture file is replayed at. 1.0 (default) is real time, 0 is as fast as possible. */
+	XN_MODULE_PROPERTY_USB_REPLAY_SPEED = 0x1080FF94, // "UsbReplaySpeed"
+	/** Boolean. Set before the device is opened (from the INI file) to process the data read from each USB end point on a thread of its own, instead of on the USB read thread. */
+	XN_MODULE_PROPERTY_USB_READ_PIPELINE = 0x1080FF95, // "UsbReadPipeline"
+	/** XnUsbReadPipelinesStatistics, get only */
+	XN_MODULE_PROPERTY_USB_READ_PIPELINE_STATISTICS = 0x1080FF96, // "UsbReadPipelineStatistics"
+	/** XnUsbTransfers, get only. How each USB end point is read, as sized for the mode of the stream using it. */
+	XN_MODULE_PROPERTY_USB_TRANSFERS = 0x1080FF97, // "UsbTransfers"
+	/** Boolean. When on, end points that complete transfers late or drop data get more transfers in flight. */
+	XN_MODULE_PROPERTY_USB_TRANSFERS_AUTO_TUNE = 0x1080FF98, // "UsbTransfersAutoTune"
 
 	/*******************************************************************/
 	/* Common stream properties                                        */
@@ -627,6 +639,45 @@ typedef struct XnBist
 	uint32_t nFailures;
 } XnBist;
 
+typedef struct XnUsbReadPipelineStatistics
+{
+	/** Size of the ring, in USB buffers. 0 if the end point isn't pipelined. */
+	uint32_t nCapacity;
+	/** USB buffers waiting to be processed. */
+	uint32_t nOccupancy;
+	uint32_t nPeakOccupancy;
+	uint32_t nQueued;
+	/** USB buffers dropped because the ring was full. */
+	uint32_t nOverruns;
+} XnUsbReadPipelineStatistics;
+
+typedef struct XnUsbReadPipelinesStatistics
+{
+	XnUsbReadPipelineStatistics depth;
+	XnUsbReadPipelineStatistics image;
+	XnUsbReadPipelineStatistics misc;
+} XnUsbReadPipelinesStatistics;
+
+typedef struct XnUsbEndPointTransfers
+{
+	/** The bandwidth of the stream the transfers were sized for, in bytes per second. 0 if unknown. */
+	uint32_t nBytesPerSecond;
+	uint32_t nTransferSize;
+	/** Number of transfers in flight. */
+	uint32_t nTransfers;
+	/** Transfers handled too slowly for the ones in flight to cover. */
+	uint32_t nLateCompletions;
+	/** Times data was dropped on the way, found by the stream losing its packet boundaries. */
+	uint32_t nLostSyncs;
+} XnUsbEndPointTransfers;
+
+typedef struct XnUsbTransfers
+{
+	XnUsbEndPointTransfers depth;
+	XnUsbEndPointTransfers image;
+	XnUsbEndPointTransfers misc;
+} XnUsbTransfers;
+
 #pragma pack (pop)
 
 #endif //_PS1080_H_
\ No newline at end of file
@@ -28,6 +28,9 @@ static const char* ONI_DEFAULT_DRIVERS_REPOSITORY = "OpenNI2" XN_FILE_DIR_SEP "D
 
 #define XN_MASK_ONI_CONTEXT "OniContext"
 
+// larger write buffers don't make writing any faster, and sizes are 32-bit
+#define ONI_RECORDER_MAX_WRITE_BUFFER_SIZE	(256 * 1024 * 1024)
+
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 OniBool Context::s_valid = FALSE;
@@ -35,11 +38,33 @@ OniBool Context::s_valid = FALSE;
 Context::Context() : m_errorLogger(xnl::ErrorLogger::GetInstance()), m_initializationCounter(0)
 {
 	xnOSMemSet(m_overrideDevice, 0, XN_FILE_MAX_PATH);
+
+	m_frameSyncSettings.mode = FRAME_SYNC_BY_FRAME_INDEX;
+	m_frameSyncSettings.toleranceUs = 16000;
+	m_frameSyncSettings.deadlineUs = 50000;
+	m_frameSyncSettings.ringSize = 4;
+	m_frameSyncSettings.useReceiveTime = FALSE;
+
+	m_recorderSettings.maxQueuedBytes = 0;
+	m_recorderSettings.queuePolicy = ONI_RECORDER_QUEUE_BLOCK;
+	m_recorderSettings.writeBufferSize = 1024 * 1024;
+	m_recorderSettings.writeBufferCount = 4;
+	XnUInt32 nProcessors = xnOSGetProcessorCount();
+	m_recorderSettings.compressionThreads = (nProcessors > 1) ? XN_MIN(nProcessors - 1, 4u) : 0;
+	m_recorderSettings.compress = TRUE;
+	m_recorderSettings.depthRowBlocks = FALSE;
+	m_recorderSettings.checkpointInterval = 0;
 }
 
 Context::~Context()
 {
 	s_valid = FALSE;
+
+	for (xnl::Hash<XN_THREAD_ID, StreamWaiter*>::Iterator it = m_waitingThreads.Begin(); it != m_waitingThreads.End(); ++it)
+	{
+		XN_DELETE(it->Value());
+	}
+	m_waitingThreads.Clear();
 }
 
 // Dummy function used only for taking its address for the sake of xnOSGetModulePathForProcAddress.
@@ -150,6 +175,99 @@ OniStatus Context::initialize()
 			repositoryOverridden = TRUE;
 		}
 
+		FrameBufferPoolSettings poolSettings = m_frameManager.getFrameBufferPoolSettings();
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "FrameBuffers", "PoolDepth", &nValue);
+		if (rc == XN_STATUS_OK && nValue >= 0)
+		{
+			poolSettings.depth = nValue;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "FrameBuffers", "HugePages", &nValue);
+		if (rc == XN_STATUS_OK)
+		{
+			poolSettings.useHugePages = (nValue == 1);
+		}
+
+		m_frameManager.setFrameBufferPoolSettings(poolSettings);
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "FrameSync", "Mode", &nValue);
+		if (rc == XN_STATUS_OK)
+		{
+			m_frameSyncSettings.mode = (nValue == 1) ? FRAME_SYNC_BY_TIMESTAMP : FRAME_SYNC_BY_FRAME_INDEX;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "FrameSync", "Tolerance", &nValue);
+		if (rc == XN_STATUS_OK && nValue >= 0)
+		{
+			m_frameSyncSettings.toleranceUs = nValue;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "FrameSync", "Deadline", &nValue);
+		if (rc == XN_STATUS_OK && nValue >= 0)
+		{
+			m_frameSyncSettings.deadlineUs = nValue;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "FrameSync", "RingSize", &nValue);
+		if (rc == XN_STATUS_OK && nValue > 0)
+		{
+			m_frameSyncSettings.ringSize = nValue;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "FrameSync", "UseReceiveTime", &nValue);
+		if (rc == XN_STATUS_OK)
+		{
+			m_frameSyncSettings.useReceiveTime = (nValue == 1);
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "QueueMaxMemory", &nValue);
+		if (rc == XN_STATUS_OK && nValue >= 0)
+		{
+			m_recorderSettings.maxQueuedBytes = (XnUInt64)nValue * 1024 * 1024;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "QueuePolicy", &nValue);
+		if (rc == XN_STATUS_OK && nValue >= ONI_RECORDER_QUEUE_BLOCK && nValue <= ONI_RECORDER_QUEUE_DROP_OLDEST)
+		{
+			m_recorderSettings.queuePolicy = (OniRecorderQueuePolicy)nValue;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "WriteBufferSize", &nValue);
+		if (rc == XN_STATUS_OK && nValue > 0)
+		{
+			m_recorderSettings.writeBufferSize = (XnUInt32)XN_MIN((XnUInt64)nValue * 1024, (XnUInt64)ONI_RECORDER_MAX_WRITE_BUFFER_SIZE);
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "WriteBuffers", &nValue);
+		if (rc == XN_STATUS_OK && nValue > 0)
+		{
+			m_recorderSettings.writeBufferCount = nValue;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "CompressionThreads", &nValue);
+		if (rc == XN_STATUS_OK && nValue >= 0)
+		{
+			m_recorderSettings.compressionThreads = nValue;
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "Compression", &nValue);
+		if (rc == XN_STATUS_OK)
+		{
+			m_recorderSettings.compress = (nValue == 1);
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "DepthRowBlocks", &nValue);
+		if (rc == XN_STATUS_OK)
+		{
+			m_recorderSettings.depthRowBlocks = (nValue == 1);
+		}
+
+		rc = xnOSReadIntFromINI(strOniConfigurationFile, "Recording", "CheckpointInterval", &nValue);
+		if (rc == XN_STATUS_OK && nValue >= 0)
+		{
+			m_recorderSettings.checkpointInterval = nValue;
+		}
 
 
 		xnLogVerbose(XN_MASK_ONI_CONTEXT, "Configuration has been read from '%s'", strOniConfigurationFile);
@@ -513,7 +631,6 @@ OniStatus Context::createStream(OniDeviceHandle device, OniSensorType sensorType
 		return ONI_STATUS_ERROR;
 	}
 
-	pMyStream->setNewFrameCallback(newFrameCallback, this);
 
 	// Create stream frame holder and connect it to the stream.
 	StreamFrameHolder* pFrameHolder = XN_NEW(StreamFrameHolder, m_frameManager, pMyStream);
@@ -639,119 +756,122 @@ OniStatus Context::readFrame(OniStreamHandle stream, OniFrame** pFrame)
 	return pStream->pStream->readFrame(pFrame);
 }
 
-void Context::frameRelease(OniFrame* pFrame)
-{
-	m_frameManager.release(pFrame);
-}
-
-void Context::frameAddRef(OniFrame* pFrame)
-{
-	m_frameManager.addRef(pFrame);
-}
-
-OniStatus Context::waitForStreams(OniStreamHandle* pStreams, int streamCount, int* pStreamIndex, int timeout)
+OniStatus Context::readFramesBatch(OniStreamHandle* pStreams, int streamCount, OniFrame** pFrames, int timeout)
 {
-	static const int MAX_WAITED_STREAMS = 50;
-	Device* deviceList[MAX_WAITED_STREAMS];
-	VideoStream* streamsList[MAX_WAITED_STREAMS];
-
-	unsigned long long oldestTimestamp = XN_MAX_UINT64;
-	int oldestIndex = -1;
-
-	if (streamCount > MAX_WAITED_STREAMS)
+	if (pStreams == NULL || pFrames == NULL || streamCount <= 0)
 	{
-		m_errorLogger.Append("Cannot wait on more than %d streams", MAX_WAITED_STREAMS);
-		return ONI_STATUS_NOT_SUPPORTED;
+		m_errorLogger.Append("readFramesBatch: bad parameter");
+		return ONI_STATUS_BAD_PARAMETER;
 	}
 
-	int numDevices = 0;
-
-	for (int i = 0; i < streamCount; ++i)
+	XnUInt64 startTime = 0;
+	if (timeout != ONI_TIMEOUT_FOREVER)
 	{
-		if (pStreams[i] == NULL)
-		{
-			continue;
-		}
-
-		streamsList[i] =  ((_OniStream*)pStreams[i])->pStream;
+		xnOSGetTimeStamp(&startTime);
+	}
 
-		Device* pDevice = &streamsList[i]->getDevice();
+	int remainingTimeout = timeout;
 
-		// Check if device already exists.
-		bool found = false;
-		for (int j = 0; j < numDevices; ++j)
+	for (;;)
+	{
+		for (int i = 0; i < streamCount; ++i)
 		{
-			if (deviceList[j] == pDevice)
-			{
-				found = true;
-				break;
-			}
+			pFrames[i] = NULL;
 		}
 
-		// Add new device to list.
-		if (!found)
+		// Make sure at least one frame is available.
+		int streamIndex;
+		OniStatus rc = waitForStreams(pStreams, streamCount, &streamIndex, remainingTimeout);
+		if (rc != ONI_STATUS_OK)
 		{
-			deviceList[numDevices] = pDevice;
-			++numDevices;
+			return rc;
 		}
-	}
 
-	XN_EVENT_HANDLE hEvent = getThreadEvent();
-
-	XnUInt64 passedTime;
-	XnOSTimer workTimer;
-	XnUInt32 timeToWait = timeout;
-	xnOSStartTimer(&workTimer);
-
-	do
-	{
+		// Take all the available frames. Streams in a frame sync group share a frame holder, so lock each
+		// holder only once, when reaching the first of its streams.
+		int frameCount = 0;
 		for (int i = 0; i < streamCount; ++i)
 		{
 			if (pStreams[i] == NULL)
+			{
 				continue;
+			}
 
-			VideoStream* pStream = ((_OniStream*)pStreams[i])->pStream;
-			pStream->lockFrame();
-			OniFrame* pFrame = pStream->peekFrame();
-			if (pFrame != NULL && pFrame->timestamp < oldestTimestamp)
+			FrameHolder* pFrameHolder = pStreams[i]->pStream->getFrameHolder();
+			XnBool handled = FALSE;
+			for (int j = 0; j < i && !handled; ++j)
 			{
-				oldestTimestamp = pFrame->timestamp;
-				oldestIndex = i;
+				handled = (pStreams[j] != NULL && pStreams[j]->pStream->getFrameHolder() == pFrameHolder);
+			}
+			if (handled)
+			{
+				continue;
 			}
-			pStream->unlockFrame();
-		}
 
-		if (oldestIndex != -1)
-		{
-			*pStreamIndex = oldestIndex;
-			break;
+			pFrameHolder->lock();
+			for (int j = i; j < streamCount; ++j)
+			{
+				if (pStreams[j] != NULL && pFrames[j] == NULL && pStreams[j]->pStream->getFrameHolder() == pFrameHolder)
+				{
+					pFrames[j] = pFrameHolder->takeFrame(pStreams[j]->pStream);
+					if (pFrames[j] != NULL)
+					{
+						// the frame is gone, so readFrame() shouldn't wake up for it
+						pStreams[j]->pStream->resetNewFrameEvent();
+						++frameCount;
+					}
+				}
+			}
+			pFrameHolder->unlock();
 		}
 
-		// 'Poke' the driver to attempt to receive more frames.
-		for (int j = 0; j < numDevices; ++j)
+		if (frameCount > 0)
 		{
-			deviceList[j]->tryManualTrigger();
+			return ONI_STATUS_OK;
 		}
 
-		if(timeout != ONI_TIMEOUT_FOREVER)
+		// Another thread took the frames first. Wait again, for whatever is left of the timeout.
+		if (timeout != ONI_TIMEOUT_FOREVER)
 		{
-			xnOSQueryTimer(workTimer, &passedTime);
-			if((int)passedTime < timeout)
-				timeToWait = timeout - (int)passedTime;
-			else
-				timeToWait = 0;
+			XnUInt64 now;
+			xnOSGetTimeStamp(&now);
+			if (now - startTime >= (XnUInt64)timeout)
+			{
+				m_errorLogger.Append("readFramesBatch: timeout reached");
+				return ONI_STATUS_TIME_OUT;
+			}
+
+			remainingTimeout = timeout - (int)(now - startTime);
 		}
-	} while (XN_STATUS_OK == xnOSWaitEvent(hEvent, timeToWait));
-	
-	xnOSStopTimer(&workTimer);
+	}
+}
+
+void Context::frameRelease(OniFrame* pFrame)
+{
+	m_frameManager.release(pFrame);
+}
 
-	if (oldestIndex != -1)
+void Context::frameAddRef(OniFrame* pFrame)
+{
+	m_frameManager.addRef(pFrame);
+}
+
+OniStatus Context::waitForStreams(OniStreamHandle* pStreams, int streamCount, int* pStreamIndex, int timeout)
+{
+	StreamWaiter* pWaiter = getThreadWaiter();
+	if (pWaiter == NULL)
 	{
-		return ONI_STATUS_OK;
+		m_errorLogger.Append("waitForStreams: couldn't allocate waiter");
+		return ONI_STATUS_ERROR;
 	}
 
-	m_errorLogger.Append("waitForStreams: timeout reached");
-	return ONI_STATUS_TIME_OUT;
+	OniStatus rc = pWaiter->wait(pStreams, streamCount, pStreamIndex, timeout);
+	if (rc == ONI_STATUS_TIME_OUT)
+	{
+		m_errorLogger.Append("waitForStreams: timeout reached");
+	}
+
+	return rc;
 }
 
 OniStatus Context::enableFrameSync(OniStreamHandle* pStreams, int numStreams, OniFrameSyncHandle* pFrameSyncHandle)
@@ -764,6 +884,7 @@ OniStatus Context::enableFrameSync(OniStreamHandle* pStreams, int numStreams, On
 
 	xnl::Array<VideoStream*> pStreamList(numStreams);
 	DeviceDriver* pDeviceDriver = NULL;
+	XnBool crossDriver = FALSE;
 
 	// Set the size of the arrays, so they can be filled.
 	pStreamList.SetSize(numStreams);
@@ -781,9 +902,13 @@ OniStatus Context::enableFrameSync(OniStreamHandle* pStreams, int numStreams, On
 			// Check whether device is different than previous devices.
 			if (pDeviceDriver != pStreams[i]->pStream->getDevice().getDeviceDriver())
 			{
-				// Frame sync groups using streams from different drivers is not supported.
-				m_errorLogger.Append("EnableFrameSync: can't sync streams from different drivers");
-				return ONI_STATUS_NOT_SUPPORTED;
+				// Streams from different drivers can only be matched by timestamps, with no help from the drivers.
+				if (m_frameSyncSettings.mode != FRAME_SYNC_BY_TIMESTAMP)
+				{
+					m_errorLogger.Append("EnableFrameSync: can't sync streams from different drivers");
+					return ONI_STATUS_NOT_SUPPORTED;
+				}
+				crossDriver = TRUE;
 			}
 		}
 
@@ -798,25 +923,38 @@ OniStatus Context::enableFrameSync(OniStreamHandle* pStreams, int numStreams, On
 		pStreamList[i] = pStreams[i]->pStream;
 	}
 
-	return enableFrameSyncEx(pStreamList.GetData(), numStreams, pDeviceDriver, pFrameSyncHandle);
+	return enableFrameSyncEx(pStreamList.GetData(), numStreams, crossDriver ? NULL : pDeviceDriver, pFrameSyncHandle);
 }
 
 OniStatus Context::enableFrameSyncEx(VideoStream** pStreams, int numStreams, DeviceDriver* pDeviceDriver, OniFrameSyncHandle* pFrameSyncHandle)
 {
-	// Make sure the device driver is valid.
-	if (pDeviceDriver == NULL)
+	// Make sure the device driver is valid. Timestamp matching can do without one (streams of several drivers).
+	if (pDeviceDriver == NULL && m_frameSyncSettings.mode != FRAME_SYNC_BY_TIMESTAMP)
 	{
 		return ONI_STATUS_ERROR;
 	}
 
 	// Create the new frame sync group (it will link all the streams).
 	SyncedStreamsFrameHolder* pSyncedStreamsFrameHolder = XN_NEW(SyncedStreamsFrameHolder, 
-																	m_frameManager, pStreams, numStreams);
+																	m_frameManager, pStreams, numStreams, m_frameSyncSettings);
 	XN_VALIDATE_PTR(pSyncedStreamsFrameHolder, ONI_STATUS_ERROR);
 
 	// Configure frame-sync group in driver.
-	void* driverHandle = pDeviceDriver->enableFrameSync(pStreams, numStreams);
-	XN_VALIDATE_PTR(driverHandle, ONI_STATUS_ERROR);
+	// Timestamp matching doesn't need the driver to support it.
+	void* driverHandle = NULL;
+	if (pDeviceDriver != NULL)
+	{
+		driverHandle = pDeviceDriver->enableFrameSync(pStreams, numStreams);
+		if (driverHandle == NULL)
+		{
+			if (m_frameSyncSettings.mode != FRAME_SYNC_BY_TIMESTAMP)
+			{
+				XN_DELETE(pSyncedStreamsFrameHolder);
+				return ONI_STATUS_ERROR;
+			}
+			pDeviceDriver = NULL;
+		}
+	}
 
 	// Return the frame sync handle.
 	*pFrameSyncHandle = XN_NEW(_OniFrameSync);
@@ -855,7 +993,10 @@ void Context::disableFrameSync(OniFrameSyncHandle frameSyncHandle)
 	}
 
 	// Disable the frame sync in the driver.
-	frameSyncHandle->pDeviceDriver->disableFrameSync(frameSyncHandle->pFrameSyncHandle);
+	if (frameSyncHandle->pDeviceDriver != NULL)
+	{
+		frameSyncHandle->pDeviceDriver->disableFrameSync(frameSyncHandle->pFrameSyncHandle);
+	}
 
 	// Disable and clear the synced stream frame holder.
 	frameSyncHandle->pSyncedStreamsFrameHolder->setEnabled(FALSE);
@@ -934,7 +1075,7 @@ OniStatus Context::recorderOpen(const char* fileName, OniRecorderHandle* pRecord
         return ONI_STATUS_ERROR;
     }
     // Create the recorder itself.
-    if (NULL == ((*pRecorder)->pRecorder = XN_NEW(Recorder, m_frameManager, m_errorLogger, *pRecorder)))
+    if (NULL == ((*pRecorder)->pRecorder = XN_NEW(Recorder, m_frameManager, m_errorLogger, m_recorderSettings, *pRecorder)))
     {
         XN_DELETE(*pRecorder);
         return ONI_STATUS_ERROR;
@@ -1025,39 +1166,26 @@ void Context::addToLogger(const XnChar* cpFormat, ...)
 	va_end(args);
 }
 
-void Context::onNewFrame()
-{
-	m_cs.Lock();
-	for (xnl::Hash<XN_THREAD_ID, XN_EVENT_HANDLE>::Iterator it = m_waitingThreads.Begin(); it != m_waitingThreads.End(); ++it)
-	{
-		xnOSSetEvent(it->Value());
-	}
-	m_cs.Unlock();
-}
-
-void XN_CALLBACK_TYPE Context::newFrameCallback(void* pCookie)
-{
-	Context* pThis = (Context*)pCookie;
-	pThis->onNewFrame();
-}
-
-XN_EVENT_HANDLE Context::getThreadEvent()
+StreamWaiter* Context::getThreadWaiter()
 {
 	XN_THREAD_ID tid;
-	XN_EVENT_HANDLE hEvent = NULL;
+	StreamWaiter* pWaiter = NULL;
 	xnOSGetCurrentThreadID(&tid);
 
 	m_cs.Lock();
 	
-	if (XN_STATUS_OK != m_waitingThreads.Get(tid, hEvent))
+	if (XN_STATUS_OK != m_waitingThreads.Get(tid, pWaiter))
 	{
-		xnOSCreateEvent(&hEvent, FALSE);
-		m_waitingThreads.Set(tid, hEvent);
+		pWaiter = XN_NEW(StreamWaiter);
+		if (pWaiter != NULL)
+		{
+			m_waitingThreads.Set(tid, pWaiter);
+		}
 	}
 
 	m_cs.Unlock();
 
-	return hEvent;
+	return pWaiter;
 }
 
 ONI_NAMESPACE_IMPLEMENTATION_END
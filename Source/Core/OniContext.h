@@ -24,6 +24,7 @@
 #include "OniDeviceDriver.h"
 #include "OniRecorder.h"
 #include "OniFrameManager.h"
+#include "OniStreamWaiter.h"
 
 #include "XnList.h"
 #include "XnHash.h"
@@ -82,6 +83,7 @@ public:
 	const OniSensorInfo* getSensorInfo(OniStreamHandle stream);
 
 	OniStatus readFrame(OniStreamHandle stream, OniFrame** pFrame);
+	OniStatus readFramesBatch(OniStreamHandle* pStreams, int streamCount, OniFrame** pFrames, int timeout);
 
 	void frameRelease(OniFrame* pFrame);
 	void frameAddRef(OniFrame* pFrame);
@@ -113,11 +115,11 @@ private:
 	Context& operator=(const Context&other);
 
 	XnStatus loadLibraries(const char* directoryName);
-	void onNewFrame();
-	XN_EVENT_HANDLE getThreadEvent();
-	static void XN_CALLBACK_TYPE newFrameCallback(void* pCookie);
+	StreamWaiter* getThreadWaiter();
 
 	FrameManager m_frameManager;
+	FrameSyncSettings m_frameSyncSettings;
+	RecorderSettings m_recorderSettings;
 
 	xnl::ErrorLogger& m_errorLogger;
 
@@ -130,7 +132,7 @@ private:
 	xnl::List<oni::implementation::VideoStream*> m_streams;
     xnl::List<oni::implementation::Recorder*> m_recorders;
 
-	xnl::Hash<XN_THREAD_ID, XN_EVENT_HANDLE> m_waitingThreads;
+	xnl::Hash<XN_THREAD_ID, StreamWaiter*> m_waitingThreads;
 
 	xnl::CriticalSection m_cs;
 
@@ -47,7 +47,8 @@ const XnChar* AsString(XnUInt32 nodeType)
 RecordAssembler::RecordAssembler()
         : m_pBuffer(NULL),
           m_bufferSize_bytes(0),
-          m_pEmitPtr(NULL)
+          m_pEmitPtr(NULL),
+          m_externalPayload(FALSE)
 {
 
 }
@@ -81,14 +82,14 @@ void RecordAssembler::initialize()
     } 
 }
 
-OniStatus RecordAssembler::serialize(XN_FILE_HANDLE file)
+OniStatus RecordAssembler::serialize(RecordWriter& writer)
 {
     // NOTE(oleksii): strange, but fieldsSize includes the size of header as
     // well...
     XnUInt32 serializedSize_bytes = 
         m_header->fieldsSize +
-        m_header->payloadSize;
-    XnStatus status = xnOSWriteFile(file, m_pBuffer, serializedSize_bytes);
+        (m_externalPayload ? 0 : m_header->payloadSize);
+    XnStatus status = writer.write(m_pBuffer, serializedSize_bytes);
     return XN_STATUS_OK == status ? ONI_STATUS_OK : ONI_STATUS_ERROR;
 }
 
@@ -107,6 +108,7 @@ void RecordAssembler::emitCommonHeader(XnUInt32 recordType, XnUInt32 nodeId, XnU
     m_header->fieldsSize   = sizeof(*m_header);
     m_header->payloadSize  = XN_UINT32_C(0);
     m_header->undoRecordPos = undoRecordPos;
+    m_externalPayload = FALSE;
     // Reset emit pointer.
     m_pEmitPtr = m_pBuffer + sizeof(*m_header);
 }
@@ -296,6 +298,77 @@ OniStatus RecordAssembler::emit_RECORD_SEEK_TABLE(XnUInt32 nodeId, XnUInt32 numF
     return ONI_STATUS_OK;
 }
 
+OniStatus RecordAssembler::emit_RECORD_CHECKPOINT_DIRECTORY(XnUInt64 lastCheckpointPos)
+{
+    MUST_BE_INITIALIZED(ONI_STATUS_ERROR)
+
+    emitCommonHeader(RECORD_SEEK_TABLE, /* nodeId (the recording) = */ XN_UINT32_C(0), /*undoRecordPos*/ 0);
+
+    XnSizeT fieldsSize = m_header->fieldsSize;
+    emit(lastCheckpointPos, fieldsSize);
+    m_header->fieldsSize = (XnUInt32)fieldsSize;
+
+    return ONI_STATUS_OK;
+}
+
+OniStatus RecordAssembler::emit_RECORD_SEEK_TABLE_CHUNK(
+        XnUInt32 nodeId,
+        XnUInt64 undoRecordPos,
+        XnUInt32 firstFrame,
+        const DataIndexEntryList& dataIndexEntryList)
+{
+    MUST_BE_INITIALIZED(ONI_STATUS_ERROR)
+
+    emitCommonHeader(RECORD_SEEK_TABLE, nodeId, undoRecordPos);
+
+    XnSizeT fieldsSize = m_header->fieldsSize;
+    emit(firstFrame, fieldsSize);
+    m_header->fieldsSize = (XnUInt32)fieldsSize;
+
+    XnSizeT nPayloadSize = dataIndexEntryList.Size() * sizeof(DataIndexEntry);
+    XnSizeT roomLeft = m_bufferSize_bytes - size_t(m_pEmitPtr - m_pBuffer);
+    if (roomLeft < nPayloadSize)
+    {
+        return ONI_STATUS_ERROR;
+    }
+
+    for (DataIndexEntryList::ConstIterator it = dataIndexEntryList.Begin(); it != dataIndexEntryList.End(); ++it)
+    {
+        emitData(&(*it), sizeof(DataIndexEntry));
+    }
+
+    m_header->payloadSize = (XnUInt32)nPayloadSize;
+
+    return ONI_STATUS_OK;
+}
+
+OniStatus RecordAssembler::emit_RECORD_CHECKPOINT(
+        XnUInt64 undoRecordPos,
+        XnUInt32 configurationId,
+        const CheckpointNodeEntry* pNodes,
+        XnUInt32 nodeCount)
+{
+    MUST_BE_INITIALIZED(ONI_STATUS_ERROR)
+
+    emitCommonHeader(RECORD_SEEK_TABLE, /* nodeId (the recording) = */ XN_UINT32_C(0), undoRecordPos);
+
+    XnSizeT fieldsSize = m_header->fieldsSize;
+    emit(configurationId, fieldsSize);
+    m_header->fieldsSize = (XnUInt32)fieldsSize;
+
+    XnSizeT nPayloadSize = nodeCount * sizeof(CheckpointNodeEntry);
+    XnSizeT roomLeft = m_bufferSize_bytes - size_t(m_pEmitPtr - m_pBuffer);
+    if (roomLeft < nPayloadSize)
+    {
+        return ONI_STATUS_ERROR;
+    }
+
+    emitData(pNodes, nPayloadSize);
+    m_header->payloadSize = (XnUInt32)nPayloadSize;
+
+    return ONI_STATUS_OK;
+}
+
 OniStatus RecordAssembler::emit_RECORD_END()
 {
     MUST_BE_INITIALIZED(ONI_STATUS_ERROR)
@@ -369,6 +442,30 @@ OniStatus RecordAssembler::emit_RECORD_NEW_DATA(
     return ONI_STATUS_OK;
 }
 
+OniStatus RecordAssembler::emit_RECORD_NEW_DATA_HEADER(
+        XnUInt32    nodeId,
+       	XnUInt64    undoRecordPos,
+        XnUInt64    timeStamp,
+        XnUInt32    frameId,
+        XnSizeT     dataSize_bytes)
+{
+    MUST_BE_INITIALIZED(ONI_STATUS_ERROR)
+
+    // Same fields as RECORD_NEW_DATA.
+    emitCommonHeader(RECORD_NEW_DATA, nodeId, undoRecordPos);
+
+	XnSizeT fieldsSize = m_header->fieldsSize;
+    emit(timeStamp, fieldsSize);
+    emit(frameId,   fieldsSize);
+	m_header->fieldsSize = (XnUInt32)fieldsSize;
+
+    // The payload isn't limited by the size of the buffer, as it never gets there.
+    m_header->payloadSize = (XnUInt32)dataSize_bytes;
+    m_externalPayload = TRUE;
+
+    return ONI_STATUS_OK;
+}
+
 OniStatus RecordAssembler::emit_RECORD_GENERAL_PROPERTY(
         XnUInt32    nodeId,
        	XnUInt64    undoRecordPos,
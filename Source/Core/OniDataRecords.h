@@ -26,6 +26,7 @@
 
 #include "OniCommon.h"
 #include "OniCTypes.h"
+#include "OniRecordWriter.h"
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 #if (ONI_PLATFORM != ONI_PLATFORM_ARC)
@@ -36,6 +37,7 @@ ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 #define ONI_CODEC_UNCOMPRESSED      ONI_CODEC_ID('N', 'O', 'N', 'E')
 #define ONI_CODEC_16Z_EMB_TABLES    ONI_CODEC_ID('1', '6', 'z', 'T')
+#define ONI_CODEC_16Z_ROWS          ONI_CODEC_ID('1', '6', 'z', 'R')
 #define ONI_CODEC_JPEG              ONI_CODEC_ID('J', 'P', 'E', 'G')
 
 static const XnSizeT IDENTITY_SIZE = 4;
@@ -83,6 +85,14 @@ typedef struct DataIndexEntry
 
 typedef xnl::List<DataIndexEntry> DataIndexEntryList;
 
+/// An entry for a node in a checkpoint: its frames so far, and where the last of its seek table chunks is.
+typedef struct CheckpointNodeEntry
+{
+	XnUInt32 nNodeID;
+	XnUInt32 nFrames;
+	XnUInt64 nLastChunkPos;
+} CheckpointNodeEntry;
+
 /// Enumerates known record types.
 enum RecordType
 {
@@ -146,7 +156,7 @@ public:
     void initialize();
 
     ///
-    OniStatus serialize(XN_FILE_HANDLE file);
+    OniStatus serialize(RecordWriter& writer);
 
     ///
     OniStatus emit_RECORD_NODE_ADDED_1_0_0_5(
@@ -178,6 +188,32 @@ public:
 	    XnUInt32 numFrames, 
 	    DataIndexEntryList dataIndexEntryList);
 
+    /// Checkpoints of a recording that is still being written all use seek
+    /// table records, which players that don't know them skip:
+    /// - The checkpoint directory (of node 0) follows the file header. Its
+    ///   fields hold the position of the last checkpoint (0 if none).
+    /// - A seek table chunk holds the entries of the frames a node recorded
+    ///   since its previous chunk (the undo position of the record). Its
+    ///   fields hold the number of its first frame.
+    /// - A checkpoint (of node 0) holds a CheckpointNodeEntry for each node.
+    ///   Its undo position is the previous checkpoint, and its fields hold the
+    ///   configuration ID of the recording at the time.
+    OniStatus emit_RECORD_CHECKPOINT_DIRECTORY(XnUInt64 lastCheckpointPos);
+
+    ///
+    OniStatus emit_RECORD_SEEK_TABLE_CHUNK(
+            XnUInt32 nodeId,
+            XnUInt64 undoRecordPos,
+            XnUInt32 firstFrame,
+            const DataIndexEntryList& dataIndexEntryList);
+
+    ///
+    OniStatus emit_RECORD_CHECKPOINT(
+            XnUInt64 undoRecordPos,
+            XnUInt32 configurationId,
+            const CheckpointNodeEntry* pNodes,
+            XnUInt32 nodeCount);
+
     ///
     OniStatus emit_RECORD_END();
 
@@ -196,6 +232,15 @@ public:
             const void* data, 
             XnSizeT     dataSize_bytes);
 
+    /// Same as RECORD_NEW_DATA, but the payload is not copied: the caller
+    /// writes it right after the serialized record.
+    OniStatus emit_RECORD_NEW_DATA_HEADER(
+            XnUInt32    nodeId,
+            XnUInt64    undoRecordPos,
+            XnUInt64    timeStamp,
+            XnUInt32    frameId, 
+            XnSizeT     dataSize_bytes);
+
     ///
     OniStatus emit_RECORD_GENERAL_PROPERTY(
             XnUInt32    nodeId,
@@ -237,6 +282,8 @@ private:
     XnSizeT m_bufferSize_bytes;
     // Pointer into the buffer for emit operations.
     XnUInt8* m_pEmitPtr;
+    // Whether the payload of the current record is left out of the buffer.
+    XnBool m_externalPayload;
 };
 
 #if (ONI_PLATFORM != ONI_PLATFORM_ARC)
@@ -202,6 +202,8 @@ void Device::notifyAllProperties()
 }
 OniStatus Device::invoke(int commandId, void* data, int dataSize)
 {
+	// declared here, as it must outlive the block that fills it
+	Device::Seek seek;
 	if (commandId == ONI_DEVICE_COMMAND_SEEK)
 	{
 		if (dataSize != sizeof(OniSeek))
@@ -210,7 +212,6 @@ OniStatus Device::invoke(int commandId, void* data, int dataSize)
 		}
 
 		// Change seek's stream handle.
-		Device::Seek seek;
 		OniSeek* pSeek = (OniSeek*)data;
 		seek.frameId = pSeek->frameIndex;
 		seek.pStream = ((_OniStream*)pSeek->stream)->pStream->getHandle();
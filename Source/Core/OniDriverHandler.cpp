@@ -33,6 +33,14 @@
 	}																							\
 }
 
+#define OniGetOptionalProcAddress(function)														\
+{																								\
+	if (xnOSGetProcAddress(m_libHandle, XN_STRINGIFY(function), (XnFarProc*)&funcs.function) != XN_STATUS_OK)	\
+	{																							\
+		funcs.function = NULL;																	\
+	}																							\
+}
+
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 DriverHandler::DriverHandler(const char* library, xnl::ErrorLogger& errorLogger)
@@ -70,6 +78,7 @@ DriverHandler::DriverHandler(const char* library, xnl::ErrorLogger& errorLogger)
 	OniGetProcAddress(oniDriverDeviceTryManualTrigger);
 
 	OniGetProcAddress(oniDriverStreamSetServices);
+	OniGetOptionalProcAddress(oniDriverStreamSetServicesSized);
 	OniGetProcAddress(oniDriverStreamSetProperty);
 	OniGetProcAddress(oniDriverStreamGetProperty);
 	OniGetProcAddress(oniDriverStreamIsPropertySupported);
@@ -82,6 +91,8 @@ DriverHandler::DriverHandler(const char* library, xnl::ErrorLogger& errorLogger)
 	OniGetProcAddress(oniDriverStreamGetRequiredFrameSize);
 	OniGetProcAddress(oniDriverStreamSetNewFrameCallback);
 	OniGetProcAddress(oniDriverStreamConvertDepthToColorCoordinates);
+	OniGetOptionalProcAddress(oniDriverStreamConvertDepthPointsToColorCoordinates);
+	OniGetOptionalProcAddress(oniDriverStreamConvertDepthMapToColorCoordinates);
 
 	OniGetProcAddress(oniDriverEnableFrameSync);
 	OniGetProcAddress(oniDriverDisableFrameSync);
@@ -89,6 +100,57 @@ DriverHandler::DriverHandler(const char* library, xnl::ErrorLogger& errorLogger)
 	m_valid = true;
 }
 
+OniStatus DriverHandler::convertDepthPointsToColor(void* depthStreamHandle, void* colorStreamHandle, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY) const
+{
+	if (funcs.oniDriverStreamConvertDepthPointsToColorCoordinates != NULL)
+	{
+		return (*funcs.oniDriverStreamConvertDepthPointsToColorCoordinates)(depthStreamHandle, colorStreamHandle, count, pDepthXY, pDepthZ, pColorXY);
+	}
+
+	// older driver - one point at a time
+	for (int i = 0; i < count; ++i)
+	{
+		OniStatus rc = convertDepthPointToColor(depthStreamHandle, colorStreamHandle, pDepthXY[i*2], pDepthXY[i*2+1], pDepthZ[i], &pColorXY[i*2], &pColorXY[i*2+1]);
+		if (rc == ONI_STATUS_NOT_SUPPORTED)
+		{
+			return rc;
+		}
+		else if (rc != ONI_STATUS_OK)
+		{
+			pColorXY[i*2] = pColorXY[i*2+1] = -1;
+		}
+	}
+
+	return ONI_STATUS_OK;
+}
+
+OniStatus DriverHandler::convertDepthMapToColor(void* depthStreamHandle, void* colorStreamHandle, const OniDepthPixel* pDepth, int stride, int originX, int originY, int width, int height, int* pColorXY) const
+{
+	if (funcs.oniDriverStreamConvertDepthMapToColorCoordinates != NULL)
+	{
+		return (*funcs.oniDriverStreamConvertDepthMapToColorCoordinates)(depthStreamHandle, colorStreamHandle, pDepth, stride, originX, originY, width, height, pColorXY);
+	}
+
+	// older driver - one point at a time
+	for (int y = 0; y < height; ++y, pDepth = (const OniDepthPixel*)((const XnUInt8*)pDepth + stride))
+	{
+		for (int x = 0; x < width; ++x, pColorXY += 2)
+		{
+			OniStatus rc = convertDepthPointToColor(depthStreamHandle, colorStreamHandle, originX + x, originY + y, pDepth[x], &pColorXY[0], &pColorXY[1]);
+			if (rc == ONI_STATUS_NOT_SUPPORTED)
+			{
+				return rc;
+			}
+			else if (rc != ONI_STATUS_OK)
+			{
+				pColorXY[0] = pColorXY[1] = -1;
+			}
+		}
+	}
+
+	return ONI_STATUS_OK;
+}
+
 DriverHandler::~DriverHandler()
 {
 	if (m_valid)
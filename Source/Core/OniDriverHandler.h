@@ -70,6 +70,8 @@ struct Funcs
 
 	// As Stream
 	void (ONI_C_DECL* oniDriverStreamSetServices)(void* streamHandle, OniStreamServices* pServices);
+	// optional - drivers built before it was added only know the members of OniStreamServices up to releaseFrame
+	void (ONI_C_DECL* oniDriverStreamSetServicesSized)(void* streamHandle, OniStreamServices* pServices, int servicesSize);
 	OniStatus (ONI_C_DECL* oniDriverStreamSetProperty)(void* streamHandle, int propertyId, const void* data, int dataSize);
 	OniStatus (ONI_C_DECL* oniDriverStreamGetProperty)(void* streamHandle, int propertyId, void* data, int* pDataSize);
 	OniBool (ONI_C_DECL* oniDriverStreamIsPropertySupported)(void* streamHandle, int propertyId);
@@ -85,6 +87,9 @@ struct Funcs
 
 	void (ONI_C_DECL* oniDriverStreamSetNewFrameCallback)(void* streamHandle, OniDriverNewFrame handler, void* pCookie);
 	OniStatus (ONI_C_DECL* oniDriverStreamConvertDepthToColorCoordinates)(void* depthStreamHandle, void* colorStreamHandle, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
+	// optional - drivers built before these were added don't have them
+	OniStatus (ONI_C_DECL* oniDriverStreamConvertDepthPointsToColorCoordinates)(void* depthStreamHandle, void* colorStreamHandle, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY);
+	OniStatus (ONI_C_DECL* oniDriverStreamConvertDepthMapToColorCoordinates)(void* depthStreamHandle, void* colorStreamHandle, const OniDepthPixel* pDepth, int stride, int originX, int originY, int width, int height, int* pColorXY);
 
 	void* (ONI_C_DECL* oniDriverEnableFrameSync)(void** pStreamHandles, int streamCount);
 	void (ONI_C_DECL* oniDriverDisableFrameSync)(void* frameSyncGroup);
@@ -182,7 +187,14 @@ public:
 
 	void streamSetServices(void* streamHandle, OniStreamServices* pServices) const
 	{
-		(*funcs.oniDriverStreamSetServices)(streamHandle, pServices);
+		if (funcs.oniDriverStreamSetServicesSized != NULL)
+		{
+			(*funcs.oniDriverStreamSetServicesSized)(streamHandle, pServices, (int)sizeof(OniStreamServices));
+		}
+		else
+		{
+			(*funcs.oniDriverStreamSetServices)(streamHandle, pServices);
+		}
 	}
 	OniStatus streamSetProperty(void* streamHandle, int propertyId, const void* data, int dataSize) const
 	{
@@ -237,6 +249,9 @@ public:
 		return (*funcs.oniDriverStreamConvertDepthToColorCoordinates)(depthStreamHandle, colorStreamHandle, depthX, depthY, DepthZ, pColorX, pColorY);
 	}
 
+	OniStatus convertDepthPointsToColor(void* depthStreamHandle, void* colorStreamHandle, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY) const;
+	OniStatus convertDepthMapToColor(void* depthStreamHandle, void* colorStreamHandle, const OniDepthPixel* pDepth, int stride, int originX, int originY, int width, int height, int* pColorXY) const;
+
 	void* enableFrameSync(void** streamHandles, int streamCount) const
 	{
 		return (*funcs.oniDriverEnableFrameSync)(streamHandles, streamCount);
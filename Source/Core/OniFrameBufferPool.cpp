@@ -0,0 +1,286 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniFrameBufferPool.h"
+
+#define ONI_FRAME_BUFFER_MIN_SIZE_CLASS		4096
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+FrameBufferPool::FrameBufferPool() :
+	m_refCount(1),
+	m_generation(0),
+	m_availableCount(0),
+	m_pFirstAvailable(NULL),
+	m_bufferSize(0),
+	m_sizeClass(0),
+	m_depth(0),
+	m_useHugePages(FALSE)
+{
+}
+
+FrameBufferPool::~FrameBufferPool()
+{
+	XN_ASSERT(m_pFirstAvailable == NULL);
+}
+
+void FrameBufferPool::addRef()
+{
+	xnOSAtomicIncrement(&m_refCount);
+}
+
+void FrameBufferPool::release()
+{
+	if (xnOSAtomicDecrement(&m_refCount) == 0)
+	{
+		XN_DELETE(this);
+	}
+}
+
+void FrameBufferPool::shutdown()
+{
+	xnOSAtomicIncrement(&m_generation);
+	trim();
+	release();
+}
+
+int FrameBufferPool::getSizeClass(int size)
+{
+	if (size <= ONI_FRAME_BUFFER_MIN_SIZE_CLASS)
+	{
+		return ONI_FRAME_BUFFER_MIN_SIZE_CLASS;
+	}
+
+	// 4 size classes for each power of two, so no more than 25% of a buffer is wasted
+	int highestPowerOfTwo = ONI_FRAME_BUFFER_MIN_SIZE_CLASS;
+	while (highestPowerOfTwo <= size / 2)
+	{
+		highestPowerOfTwo <<= 1;
+	}
+
+	int step = highestPowerOfTwo / 4;
+	return (size + step - 1) / step * step;
+}
+
+void FrameBufferPool::setBufferSize(int size)
+{
+	{
+		xnl::AutoCSLocker lock(m_allocCS);
+		m_bufferSize = size;
+
+		int sizeClass = getSizeClass(size);
+		if (sizeClass == m_sizeClass)
+		{
+			return;
+		}
+
+		// all existing buffers are of the wrong size. Free them (in-flight ones will be freed when released).
+		m_sizeClass = sizeClass;
+		xnOSAtomicIncrement(&m_generation);
+	}
+
+	trim();
+}
+
+void FrameBufferPool::preallocate()
+{
+	xnl::AutoCSLocker lock(m_allocCS);
+	while (m_availableCount < m_depth)
+	{
+		BufferHeader* pHeader = createBuffer();
+		if (pHeader == NULL)
+		{
+			break;
+		}
+
+		pushAvailable(pHeader);
+	}
+}
+
+void* FrameBufferPool::allocBuffer(int size)
+{
+	if (size > m_sizeClass)
+	{
+		setBufferSize(size);
+	}
+
+	xnl::AutoCSLocker lock(m_allocCS);
+
+	BufferHeader* pHeader = popAvailable();
+	while (pHeader != NULL && pHeader->generation != m_generation)
+	{
+		// a stale buffer that was returned while the pool was being invalidated
+		destroyBuffer(pHeader);
+		pHeader = popAvailable();
+	}
+
+	if (pHeader == NULL)
+	{
+		pHeader = createBuffer();
+		if (pHeader == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	return getData(pHeader);
+}
+
+void FrameBufferPool::releaseBuffer(void* pBuffer)
+{
+	BufferHeader* pHeader = getHeader(pBuffer);
+	XnInt32 generation = pHeader->generation;
+	if (generation != m_generation)
+	{
+		// size class changed (or pool was shut down) while this buffer was in use
+		destroyBuffer(pHeader);
+		return;
+	}
+
+	// once in the list, the buffer (and its reference to the pool) can be freed by a concurrent trim()
+	addRef();
+
+	pushAvailable(pHeader);
+
+	if (generation != m_generation)
+	{
+		// pool was invalidated while we were pushing. Make sure the buffer does not stay in the list.
+		trim();
+	}
+
+	release();
+}
+
+FrameBufferPool::BufferHeader* FrameBufferPool::createBuffer()
+{
+	XnSizeT allocSize = BUFFER_HEADER_SIZE + m_sizeClass;
+	XnBool hugePages = FALSE;
+	void* pMemory = NULL;
+
+	if (m_useHugePages)
+	{
+		pMemory = xnOSMallocHugePages(allocSize);
+		hugePages = (pMemory != NULL);
+	}
+
+	if (pMemory == NULL)
+	{
+		pMemory = xnOSMallocAligned(allocSize, BUFFER_HEADER_SIZE);
+		if (pMemory == NULL)
+		{
+			return NULL;
+		}
+	}
+
+	BufferHeader* pHeader = (BufferHeader*)pMemory;
+	pHeader->pNextAvailable = NULL;
+	pHeader->generation = m_generation;
+	pHeader->allocSize = allocSize;
+	pHeader->hugePages = hugePages;
+
+	// each buffer keeps the pool alive
+	addRef();
+
+	return pHeader;
+}
+
+void FrameBufferPool::destroyBuffer(BufferHeader* pHeader)
+{
+	if (pHeader->hugePages)
+	{
+		xnOSFreeHugePages(pHeader, pHeader->allocSize);
+	}
+	else
+	{
+		xnOSFreeAligned(pHeader);
+	}
+
+	release();
+}
+
+void FrameBufferPool::pushAvailable(BufferHeader* pHeader)
+{
+	BufferHeader* pHead = m_pFirstAvailable;
+	for (;;)
+	{
+		pHeader->pNextAvailable = pHead;
+		BufferHeader* pPrev = (BufferHeader*)xnOSAtomicCompareExchangePointer((void* volatile*)&m_pFirstAvailable, pHeader, pHead);
+		if (pPrev == pHead)
+		{
+			break;
+		}
+		pHead = pPrev;
+	}
+
+	xnOSAtomicIncrement(&m_availableCount);
+}
+
+FrameBufferPool::BufferHeader* FrameBufferPool::popAvailable()
+{
+	// NOTE: m_allocCS must be locked. Only pushes can race with us, so if head did not change, its next pointer is still valid.
+	BufferHeader* pHeader = m_pFirstAvailable;
+	while (pHeader != NULL)
+	{
+		BufferHeader* pPrev = (BufferHeader*)xnOSAtomicCompareExchangePointer((void* volatile*)&m_pFirstAvailable, pHeader->pNextAvailable, pHeader);
+		if (pPrev == pHeader)
+		{
+			xnOSAtomicDecrement(&m_availableCount);
+			break;
+		}
+		pHeader = pPrev;
+	}
+
+	return pHeader;
+}
+
+void FrameBufferPool::trim()
+{
+	BufferHeader* pStale = NULL;
+
+	{
+		xnl::AutoCSLocker lock(m_allocCS);
+
+		BufferHeader* pValid = NULL;
+		BufferHeader* pHeader;
+		while ((pHeader = popAvailable()) != NULL)
+		{
+			BufferHeader*& pList = (pHeader->generation == m_generation) ? pValid : pStale;
+			pHeader->pNextAvailable = pList;
+			pList = pHeader;
+		}
+
+		while (pValid != NULL)
+		{
+			pHeader = pValid;
+			pValid = pValid->pNextAvailable;
+			pushAvailable(pHeader);
+		}
+	}
+
+	// free outside the lock, as this might release the last reference to the pool
+	while (pStale != NULL)
+	{
+		BufferHeader* pHeader = pStale;
+		pStale = pStale->pNextAvailable;
+		destroyBuffer(pHeader);
+	}
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
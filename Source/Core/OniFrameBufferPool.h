@@ -0,0 +1,109 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_FRAME_BUFFER_POOL_H_
+#define _ONI_FRAME_BUFFER_POOL_H_
+
+#include "OniCommon.h"
+#include <XnOS.h>
+#include <XnOSCpp.h>
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+/**
+* A pool of frame buffers of a single size class, used by a sensor when the application did not supply its own
+* allocator.
+*
+* Buffers are returned to the pool without taking any lock (from any thread). Allocations are serialized among
+* themselves only, so the producing thread never waits on consumers releasing frames.
+*
+* The pool is reference counted: every buffer it handed out keeps it alive, so frames may outlive the sensor.
+*/
+class FrameBufferPool
+{
+public:
+	FrameBufferPool();
+
+	void addRef();
+	void release();
+
+	/** Invalidates all buffers (in-flight ones will be freed when released) and releases the owner reference. */
+	void shutdown();
+
+	/** Sets the required buffer size. Buffers are kept as long as the size does not leave the current size class. */
+	void setBufferSize(int size);
+
+	/** Sets the number of buffers preallocated by preallocate(). */
+	void setDepth(int depth) { m_depth = depth; }
+	int getDepth() const { return m_depth; }
+
+	void setUseHugePages(XnBool useHugePages) { m_useHugePages = useHugePages; }
+
+	/** Makes sure at least depth buffers are available, so no allocation happens while streaming. */
+	void preallocate();
+
+	void* allocBuffer(int size);
+	void releaseBuffer(void* pBuffer);
+
+	static int getSizeClass(int size);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(FrameBufferPool);
+
+	~FrameBufferPool();
+
+	struct BufferHeader
+	{
+		BufferHeader* pNextAvailable;
+		XnInt32 generation;
+		XnSizeT allocSize;
+		XnBool hugePages;
+	};
+
+	// data follows the header, aligned to a cache line
+	enum { BUFFER_HEADER_SIZE = 64 };
+
+	static BufferHeader* getHeader(void* pBuffer) { return (BufferHeader*)((XnUInt8*)pBuffer - BUFFER_HEADER_SIZE); }
+	static void* getData(BufferHeader* pHeader) { return (XnUInt8*)pHeader + BUFFER_HEADER_SIZE; }
+
+	BufferHeader* createBuffer();
+	void destroyBuffer(BufferHeader* pHeader);
+
+	void pushAvailable(BufferHeader* pHeader);
+	BufferHeader* popAvailable();
+	void trim();
+
+	volatile XnInt32 m_refCount;
+	volatile XnInt32 m_generation;
+	volatile XnInt32 m_availableCount;
+	BufferHeader* volatile m_pFirstAvailable;
+
+	// serializes pops (this rules out the ABA problem on the available list) and configuration changes
+	xnl::CriticalSection m_allocCS;
+
+	int m_bufferSize;
+	int m_sizeClass;
+	int m_depth;
+	XnBool m_useHugePages;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_FRAME_BUFFER_POOL_H_
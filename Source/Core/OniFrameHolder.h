@@ -43,6 +43,10 @@ public:
 	// Get the next frame belonging to a stream.
 	virtual OniStatus readFrame(VideoStream* pStream, OniFrame** pFrame) = 0;
 
+	// Take the next frame belonging to a stream, or NULL if none is available. Never blocks.
+	// Should be called with the holder locked (see lock()).
+	virtual OniFrame* takeFrame(VideoStream* pStream) = 0;
+
 	// Process a newly received frame.
 	virtual OniStatus processNewFrame(VideoStream* pStream, OniFrame* pFrame) = 0;
 	
@@ -5,15 +5,72 @@ ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 FrameManager::FrameManager()
 {
+	for (int i = 0; i < FREE_LIST_COUNT; ++i)
+	{
+		m_freeLists[i].pFirstAvailable = NULL;
+	}
+
+	m_frameBufferPoolSettings.depth = 0;
+	m_frameBufferPoolSettings.useHugePages = FALSE;
 }
 
 FrameManager::~FrameManager()
 {
+	for (int i = 0; i < FREE_LIST_COUNT; ++i)
+	{
+		xnl::AutoCSLocker lock(m_freeLists[i].popLock);
+		for (xnl::List<OniFrameInternal*>::Iterator it = m_freeLists[i].all.Begin(); it != m_freeLists[i].all.End(); ++it)
+		{
+			XN_DELETE(*it);
+		}
+		m_freeLists[i].all.Clear();
+		m_freeLists[i].pFirstAvailable = NULL;
+	}
+}
+
+FrameManager::FreeList& FrameManager::getFreeListForCurrentThread()
+{
+	XN_THREAD_ID threadID = 0;
+	xnOSGetCurrentThreadID(&threadID);
+
+	// thread IDs are often aligned addresses, so mix higher bits in
+	XnUInt64 nHash = (XnUInt64)threadID;
+	nHash ^= (nHash >> 7) ^ (nHash >> 13) ^ (nHash >> 21);
+	return m_freeLists[nHash % FREE_LIST_COUNT];
 }
 
 OniFrameInternal* FrameManager::acquireFrame()
 {
-	OniFrameInternal* pFrame = m_frames.Acquire();
+	FreeList& freeList = getFreeListForCurrentThread();
+	OniFrameInternal* pFrame = NULL;
+
+	{
+		xnl::AutoCSLocker lock(freeList.popLock);
+
+		// only pushes can race with us here, so if head did not change, its next pointer is still valid
+		pFrame = freeList.pFirstAvailable;
+		while (pFrame != NULL)
+		{
+			OniFrameInternal* pPrev = (OniFrameInternal*)xnOSAtomicCompareExchangePointer((void* volatile*)&freeList.pFirstAvailable, pFrame->pNextAvailable, pFrame);
+			if (pPrev == pFrame)
+			{
+				break;
+			}
+			pFrame = pPrev;
+		}
+
+		if (pFrame == NULL)
+		{
+			// we need to allocate new object
+			pFrame = XN_NEW(OniFrameInternal);
+			if (pFrame == NULL)
+			{
+				return NULL;
+			}
+			pFrame->freeListIndex = (int)(&freeList - m_freeLists);
+			freeList.all.AddLast(pFrame);
+		}
+	}
 
 	// reset all fields
 	pFrame->dataSize = 0;
@@ -36,6 +93,7 @@ OniFrameInternal* FrameManager::acquireFrame()
 	pFrame->refCount = 1; // this is the only reference
 	pFrame->freeBufferFunc = NULL;
 	pFrame->freeBufferFuncCookie = NULL;
+	pFrame->pNextAvailable = NULL;
 
 	return pFrame;
 }
@@ -43,27 +101,40 @@ OniFrameInternal* FrameManager::acquireFrame()
 void FrameManager::addRef(OniFrame* pFrame)
 {
 	OniFrameInternal* pInternal = (OniFrameInternal*)pFrame;
-	m_frames.Lock();
-	++pInternal->refCount;
-	m_frames.Unlock();
+	xnOSAtomicIncrement(&pInternal->refCount);
 }
 
 void FrameManager::release(OniFrame* pFrame)
 {
 	OniFrameInternal* pInternal = (OniFrameInternal*)pFrame;
-	m_frames.Lock();
-	if (--pInternal->refCount == 0)
+	if (xnOSAtomicDecrement(&pInternal->refCount) == 0)
 	{
 		// notify frame is back to pool
-        if (pInternal->backToPoolFunc != NULL)
-        {
-            pInternal->backToPoolFunc(pInternal, pInternal->backToPoolFuncCookie);
-        }
-        
+		if (pInternal->backToPoolFunc != NULL)
+		{
+			pInternal->backToPoolFunc(pInternal, pInternal->backToPoolFuncCookie);
+		}
+
 		// and return frame to pool
-		m_frames.Release(pInternal);
+		pushAvailable(pInternal);
+	}
+}
+
+void FrameManager::pushAvailable(OniFrameInternal* pFrame)
+{
+	FreeList& freeList = m_freeLists[pFrame->freeListIndex];
+
+	OniFrameInternal* pHead = freeList.pFirstAvailable;
+	for (;;)
+	{
+		pFrame->pNextAvailable = pHead;
+		OniFrameInternal* pPrev = (OniFrameInternal*)xnOSAtomicCompareExchangePointer((void* volatile*)&freeList.pFirstAvailable, pFrame, pHead);
+		if (pPrev == pHead)
+		{
+			break;
+		}
+		pHead = pPrev;
 	}
-	m_frames.Unlock();
 }
 
 ONI_NAMESPACE_IMPLEMENTATION_END
@@ -4,7 +4,8 @@
 #include <OniCTypes.h>
 #include "OniCommon.h"
 #include <XnOS.h>
-#include <XnPool.h>
+#include <XnOSCpp.h>
+#include <XnList.h>
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
@@ -14,11 +15,22 @@ typedef void (ONI_CALLBACK_TYPE* FreeBufferFuncPtr)(void* data, void* pCookie);
 
 struct OniFrameInternal : public OniFrame
 {
-	int refCount;
+	volatile XnInt32 refCount;
 	BackToPoolFuncPtr backToPoolFunc; // callback function to be called when frame reached zero refs and returned to pool
 	void* backToPoolFuncCookie;
 	FreeBufferFuncPtr freeBufferFunc; // callback function for freeing the frame buffer
 	void* freeBufferFuncCookie;
+
+	// used by the frame manager
+	OniFrameInternal* pNextAvailable;
+	int freeListIndex;
+};
+
+// default configuration for the frame buffer pools of all sensors
+struct FrameBufferPoolSettings
+{
+	int depth; // number of buffers to preallocate when a stream starts
+	XnBool useHugePages;
 };
 
 class FrameManager
@@ -31,8 +43,29 @@ public:
 	void addRef(OniFrame* pFrame);
 	void release(OniFrame* pFrame);
 
+	void setFrameBufferPoolSettings(const FrameBufferPoolSettings& settings) { m_frameBufferPoolSettings = settings; }
+	const FrameBufferPoolSettings& getFrameBufferPoolSettings() const { return m_frameBufferPoolSettings; }
+
 private:
-	xnl::Pool<OniFrameInternal> m_frames;
+	XN_DISABLE_COPY_AND_ASSIGN(FrameManager);
+
+	enum { FREE_LIST_COUNT = 8 };
+
+	// Frames are pushed back to their free list without any lock. Popping is serialized per list by popLock,
+	// which makes the pop safe from the ABA problem. Acquiring threads are spread across the lists, so
+	// frame producers of different devices rarely share a list.
+	struct FreeList
+	{
+		OniFrameInternal* volatile pFirstAvailable;
+		xnl::CriticalSection popLock;
+		xnl::List<OniFrameInternal*> all;
+	};
+
+	FreeList& getFreeListForCurrentThread();
+	void pushAvailable(OniFrameInternal* pFrame);
+
+	FreeList m_freeLists[FREE_LIST_COUNT];
+	FrameBufferPoolSettings m_frameBufferPoolSettings;
 };
 
 ONI_NAMESPACE_IMPLEMENTATION_END
@@ -0,0 +1,441 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniRecordWriter.h"
+
+// Buffers are page aligned, so the OS can hand them to the disk without bouncing them.
+#define ONI_RECORD_WRITER_BUFFER_ALIGNMENT		4096
+#define ONI_RECORD_WRITER_MIN_BUFFER_COUNT		2
+#define ONI_RECORD_WRITER_WAIT_INTERVAL_MS		100
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+RecordWriter::RecordWriter() :
+	m_file(XN_INVALID_FILE_HANDLE),
+	m_thread(NULL),
+	m_bufferSize(0),
+	m_payloadReleaseHandler(NULL),
+	m_payloadReleaseCookie(NULL),
+	m_position(0),
+	m_busy(FALSE),
+	m_stop(FALSE),
+	m_filePosition(0),
+	m_bytesWritten(0),
+	m_status(XN_STATUS_OK)
+{
+	m_current.pData = NULL;
+	m_current.sync = FALSE;
+	m_current.offset = 0;
+	m_current.size = 0;
+	m_current.pPayload = NULL;
+	m_current.payloadSize = 0;
+	m_current.pPayloadCookie = NULL;
+}
+
+RecordWriter::~RecordWriter()
+{
+	close();
+}
+
+XnStatus RecordWriter::open(const XnChar* fileName, XnUInt32 bufferSize, XnUInt32 bufferCount)
+{
+	XnStatus nRetVal = xnOSOpenFile(fileName, XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, &m_file);
+	XN_IS_STATUS_OK(nRetVal);
+
+	// round the buffers up to whole pages
+	m_bufferSize = XN_MAX(bufferSize, ONI_RECORD_WRITER_BUFFER_ALIGNMENT);
+	m_bufferSize = (m_bufferSize + ONI_RECORD_WRITER_BUFFER_ALIGNMENT - 1) & ~(ONI_RECORD_WRITER_BUFFER_ALIGNMENT - 1);
+	bufferCount = XN_MAX(bufferCount, ONI_RECORD_WRITER_MIN_BUFFER_COUNT);
+
+	for (XnUInt32 i = 0; i < bufferCount; ++i)
+	{
+		XnUInt8* pBuffer = (XnUInt8*)xnOSMallocAligned(m_bufferSize, ONI_RECORD_WRITER_BUFFER_ALIGNMENT);
+		if (pBuffer == NULL)
+		{
+			close();
+			return XN_STATUS_ALLOC_FAILED;
+		}
+		m_buffers.AddLast(pBuffer);
+		m_free.AddLast(pBuffer);
+	}
+
+	nRetVal = m_pendingEvent.Create(FALSE);
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = m_freeEvent.Create(FALSE);
+	}
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = xnOSCreateThread(threadMain, this, &m_thread);
+	}
+	if (nRetVal != XN_STATUS_OK)
+	{
+		close();
+		return nRetVal;
+	}
+
+	return XN_STATUS_OK;
+}
+
+XnStatus RecordWriter::close()
+{
+	if (!isOpen())
+	{
+		return XN_STATUS_OK;
+	}
+
+	if (m_thread != NULL)
+	{
+		submitCurrent();
+		waitForIdle();
+
+		{
+			xnl::AutoCSLocker lock(m_lock);
+			m_stop = TRUE;
+		}
+		m_pendingEvent.Set();
+		xnOSWaitForThreadExit(m_thread, XN_WAIT_INFINITE);
+		xnOSCloseThread(&m_thread);
+		m_thread = NULL;
+	}
+
+	xnOSCloseFile(&m_file);
+	m_file = XN_INVALID_FILE_HANDLE;
+
+	for (XnUInt32 i = 0; i < m_buffers.GetSize(); ++i)
+	{
+		xnOSFreeAligned(m_buffers[i]);
+	}
+	m_buffers.Clear();
+	m_free.Clear();
+	m_current.pData = NULL;
+
+	return m_status;
+}
+
+XnStatus RecordWriter::write(const void* pData, XnSizeT size)
+{
+	const XnUInt8* pSource = (const XnUInt8*)pData;
+
+	while (size > 0)
+	{
+		if (m_status != XN_STATUS_OK)
+		{
+			return m_status;
+		}
+
+		if (m_current.pData == NULL)
+		{
+			XnStatus nRetVal = acquireBuffer();
+			XN_IS_STATUS_OK(nRetVal);
+		}
+
+		// large records simply span several buffers
+		XnSizeT cursor = (XnSizeT)(m_position - m_current.offset);
+		XnSizeT chunk = XN_MIN(size, m_bufferSize - cursor);
+		xnOSMemCopy(m_current.pData + cursor, pSource, chunk);
+
+		pSource += chunk;
+		size -= chunk;
+		m_position += chunk;
+		cursor += chunk;
+		if (cursor > m_current.size)
+		{
+			m_current.size = cursor;
+		}
+
+		if (cursor == m_bufferSize)
+		{
+			submitCurrent();
+		}
+	}
+
+	return m_status;
+}
+
+void RecordWriter::setPayloadReleaseHandler(PayloadReleaseHandler handler, void* pCookie)
+{
+	m_payloadReleaseHandler = handler;
+	m_payloadReleaseCookie = pCookie;
+}
+
+XnStatus RecordWriter::writePayload(const void* pData, XnSizeT size, void* pPayloadCookie)
+{
+	if (m_status == XN_STATUS_OK && m_current.pData == NULL)
+	{
+		acquireBuffer();
+	}
+
+	// The payload can only be chained to the end of the current buffer. Anywhere else (after seeking back into
+	// the buffer), fall back to copying it.
+	if (m_status != XN_STATUS_OK ||
+		m_current.pData == NULL ||
+		m_position != m_current.offset + m_current.size)
+	{
+		XnStatus nRetVal = (m_status == XN_STATUS_OK) ? write(pData, size) : m_status;
+		releasePayload(pPayloadCookie);
+		return nRetVal;
+	}
+
+	m_current.pPayload = pData;
+	m_current.payloadSize = size;
+	m_current.pPayloadCookie = pPayloadCookie;
+	submit(m_current);
+
+	m_current.pData = NULL;
+	m_current.pPayload = NULL;
+	m_current.payloadSize = 0;
+	m_current.pPayloadCookie = NULL;
+	m_position += size;
+
+	return m_status;
+}
+
+void RecordWriter::releasePayload(void* pPayloadCookie)
+{
+	if (m_payloadReleaseHandler != NULL)
+	{
+		m_payloadReleaseHandler(m_payloadReleaseCookie, pPayloadCookie);
+	}
+}
+
+XnStatus RecordWriter::seek(XnUInt64 position)
+{
+	// moving inside the data of the current buffer (e.g. undoing a record) needs no I/O at all
+	if (m_current.pData != NULL &&
+		position >= m_current.offset &&
+		position <= m_current.offset + m_current.size &&
+		position < m_current.offset + m_bufferSize)
+	{
+		m_position = position;
+		return m_status;
+	}
+
+	submitCurrent();
+	m_position = position;
+	return m_status;
+}
+
+XnStatus RecordWriter::truncate(XnUInt64 size)
+{
+	submitCurrent();
+
+	Block block;
+	block.pData = NULL;
+	block.sync = FALSE;
+	block.offset = size;
+	block.size = 0;
+	block.pPayload = NULL;
+	block.payloadSize = 0;
+	block.pPayloadCookie = NULL;
+	submit(block);
+
+	return m_status;
+}
+
+XnStatus RecordWriter::sync()
+{
+	submitCurrent();
+
+	Block block;
+	block.pData = NULL;
+	block.sync = TRUE;
+	block.offset = 0;
+	block.size = 0;
+	block.pPayload = NULL;
+	block.payloadSize = 0;
+	block.pPayloadCookie = NULL;
+	submit(block);
+
+	return m_status;
+}
+
+XnStatus RecordWriter::acquireBuffer()
+{
+	xnl::AutoCSLocker lock(m_lock);
+	while (m_free.IsEmpty())
+	{
+		if (m_status != XN_STATUS_OK)
+		{
+			return m_status;
+		}
+
+		// all buffers are queued for writing - the disk is slower than the recording
+		lock.Unlock();
+		m_freeEvent.Wait(ONI_RECORD_WRITER_WAIT_INTERVAL_MS);
+		lock.Lock();
+	}
+
+	m_current.pData = *m_free.Begin();
+	m_current.offset = m_position;
+	m_current.size = 0;
+	m_free.Remove(m_free.Begin());
+
+	return XN_STATUS_OK;
+}
+
+void RecordWriter::submitCurrent()
+{
+	if (m_current.pData == NULL)
+	{
+		return;
+	}
+
+	if (m_current.size == 0)
+	{
+		xnl::AutoCSLocker lock(m_lock);
+		m_free.AddLast(m_current.pData);
+	}
+	else
+	{
+		submit(m_current);
+	}
+
+	m_current.pData = NULL;
+}
+
+void RecordWriter::submit(const Block& block)
+{
+	{
+		xnl::AutoCSLocker lock(m_lock);
+		m_pending.AddLast(block);
+	}
+	m_pendingEvent.Set();
+}
+
+XnStatus RecordWriter::waitForIdle()
+{
+	xnl::AutoCSLocker lock(m_lock);
+	while (!m_pending.IsEmpty() || m_busy)
+	{
+		lock.Unlock();
+		m_freeEvent.Wait(ONI_RECORD_WRITER_WAIT_INTERVAL_MS);
+		lock.Lock();
+	}
+
+	return m_status;
+}
+
+XN_THREAD_PROC RecordWriter::threadMain(XN_THREAD_PARAM pThreadParam)
+{
+	RecordWriter* pThis = (RecordWriter*)pThreadParam;
+
+	for (;;)
+	{
+		Block block;
+		XnBool hasBlock = FALSE;
+		XnBool stop = FALSE;
+
+		{
+			xnl::AutoCSLocker lock(pThis->m_lock);
+			if (!pThis->m_pending.IsEmpty())
+			{
+				block = *pThis->m_pending.Begin();
+				pThis->m_pending.Remove(pThis->m_pending.Begin());
+				pThis->m_busy = TRUE;
+				hasBlock = TRUE;
+			}
+			stop = pThis->m_stop;
+		}
+
+		if (hasBlock)
+		{
+			pThis->processBlock(block);
+			if (block.pPayload != NULL)
+			{
+				pThis->releasePayload(block.pPayloadCookie);
+			}
+
+			{
+				xnl::AutoCSLocker lock(pThis->m_lock);
+				if (block.pData != NULL)
+				{
+					pThis->m_free.AddLast(block.pData);
+				}
+				pThis->m_busy = FALSE;
+			}
+			pThis->m_freeEvent.Set();
+		}
+		else if (stop)
+		{
+			break;
+		}
+		else
+		{
+			pThis->m_pendingEvent.Wait(XN_WAIT_INFINITE);
+		}
+	}
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void RecordWriter::processBlock(const Block& block)
+{
+	if (m_status != XN_STATUS_OK)
+	{
+		return;
+	}
+
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	if (block.sync)
+	{
+		nRetVal = xnOSFlushFile(m_file);
+	}
+	else if (block.pData == NULL)
+	{
+		nRetVal = xnOSTruncateFile64(m_file, block.offset);
+	}
+	else
+	{
+		if (block.offset != m_filePosition)
+		{
+			nRetVal = xnOSSeekFile64(m_file, XN_OS_SEEK_SET, block.offset);
+		}
+		if (nRetVal == XN_STATUS_OK)
+		{
+			if (block.pPayload == NULL)
+			{
+				nRetVal = xnOSWriteFile(m_file, block.pData, (XnUInt32)block.size);
+			}
+			else
+			{
+				// the buffer ends with the header of the payload - write both in one go
+				XnOSFileSegment segments[2] = {
+					{ block.pData, (XnUInt32)block.size },
+					{ block.pPayload, (XnUInt32)block.payloadSize }
+				};
+				nRetVal = xnOSWriteFileGather(m_file, segments, 2);
+			}
+		}
+		if (nRetVal == XN_STATUS_OK)
+		{
+			m_filePosition = block.offset + block.size + block.payloadSize;
+			m_bytesWritten += block.size + block.payloadSize;
+		}
+	}
+
+	if (nRetVal != XN_STATUS_OK)
+	{
+		m_status = nRetVal;
+	}
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
@@ -0,0 +1,139 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_RECORD_WRITER_H_
+#define _ONI_RECORD_WRITER_H_
+
+#include "OniCommon.h"
+#include <XnOS.h>
+#include <XnOSCpp.h>
+#include <XnList.h>
+#include <XnArray.h>
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+/**
+* Writes the records of a recording to its file through a small set of large buffers, which a dedicated thread
+* flushes to disk. Records are coalesced into the current buffer, so the file sees a few large sequential writes
+* instead of one or two small ones per record, and the recorder thread does not wait on the disk unless all
+* buffers are in flight.
+*
+* The writer keeps the semantics of a plain file handle: the recorder may tell, seek back to patch an earlier
+* record, and truncate. A seek inside the current buffer only moves the cursor; any other seek hands the current
+* buffer to the I/O thread and starts a new one at the target offset. Buffers are written in the order they were
+* handed over, so a patch always lands after the data it overwrites.
+*
+* Large payloads (e.g. raw frames) can be handed over by reference with writePayload(). The I/O thread writes them
+* from the caller's memory together with the buffer that precedes them, in a single gather write, and then passes
+* them back to the payload release handler.
+*
+* All methods but getBytesWritten() must be called from a single thread. I/O errors are sticky: once a write
+* failed, every following call fails as well.
+*/
+class RecordWriter
+{
+public:
+	// Called once a payload is no longer needed - normally on the I/O thread.
+	typedef void (XN_CALLBACK_TYPE* PayloadReleaseHandler)(void* pCookie, void* pPayloadCookie);
+
+	RecordWriter();
+	~RecordWriter();
+
+	// Creates (or truncates) the file, and starts the I/O thread.
+	XnStatus open(const XnChar* fileName, XnUInt32 bufferSize, XnUInt32 bufferCount);
+
+	// Flushes all pending data and closes the file.
+	XnStatus close();
+
+	XnBool isOpen() const { return m_file != XN_INVALID_FILE_HANDLE; }
+
+	XnStatus write(const void* pData, XnSizeT size);
+
+	void setPayloadReleaseHandler(PayloadReleaseHandler handler, void* pCookie);
+
+	// Writes the given memory without copying it. The memory must stay valid until the release handler is called
+	// with pPayloadCookie, which always happens, even if writing fails.
+	XnStatus writePayload(const void* pData, XnSizeT size, void* pPayloadCookie);
+
+	XnStatus seek(XnUInt64 position);
+	XnUInt64 tell() const { return m_position; }
+
+	// Cuts the file at the given offset, once everything written so far reached the disk.
+	XnStatus truncate(XnUInt64 size);
+
+	// Makes everything written so far durable (fsync) before anything written later reaches the file. Does not wait
+	// for the disk.
+	XnStatus sync();
+
+	// Number of bytes the I/O thread has written to the file so far.
+	XnUInt64 getBytesWritten() const { return m_bytesWritten; }
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(RecordWriter);
+
+	struct Block
+	{
+		XnUInt8* pData; // NULL for a truncation, or a sync
+		XnBool sync;
+		XnUInt64 offset;
+		XnSizeT size;
+		const void* pPayload; // written right after the buffer data, NULL if none
+		XnSizeT payloadSize;
+		void* pPayloadCookie;
+	};
+
+	static XN_THREAD_PROC threadMain(XN_THREAD_PARAM pThreadParam);
+	void processBlock(const Block& block);
+
+	XnStatus acquireBuffer();
+	void submitCurrent();
+	void submit(const Block& block);
+	void releasePayload(void* pPayloadCookie);
+	XnStatus waitForIdle();
+
+	XN_FILE_HANDLE m_file;
+	XN_THREAD_HANDLE m_thread;
+	XnUInt32 m_bufferSize;
+	xnl::Array<XnUInt8*> m_buffers;
+	PayloadReleaseHandler m_payloadReleaseHandler;
+	void* m_payloadReleaseCookie;
+
+	// owned by the calling thread
+	Block m_current; // pData is NULL when there is no current buffer
+	XnUInt64 m_position;
+
+	// shared with the I/O thread, under m_lock
+	xnl::CriticalSection m_lock;
+	xnl::List<Block> m_pending;
+	xnl::List<XnUInt8*> m_free;
+	XnBool m_busy;
+	XnBool m_stop;
+	xnl::OSEvent m_pendingEvent;
+	xnl::OSEvent m_freeEvent;
+
+	// owned by the I/O thread
+	XnUInt64 m_filePosition;
+	volatile XnUInt64 m_bytesWritten;
+	volatile XnStatus m_status;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif //_ONI_RECORD_WRITER_H_
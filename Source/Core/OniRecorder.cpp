@@ -21,9 +21,11 @@
 #include "OniRecorder.h"
 
 #include "XnLockGuard.h"
+#include "XnArray.h"
 
 // These come from OniFile/Formats:
 #include "Xn16zEmbTablesCodec.h"
+#include "Xn16zRowsCodec.h"
 #include "XnJpegCodec.h"
 #include "XnUncompressedCodec.h"
 
@@ -77,6 +79,9 @@ const XnSizeT propertyTableItemsCount = sizeof(propertyTable) / sizeof(propertyT
 
 } // namespace
 
+// Period at which a stream blocked on a full queue re-checks whether it should stop waiting.
+#define ONI_RECORDER_QUEUE_WAIT_INTERVAL_MS 100
+
 /**
  * Is used by Recorder to make it possible to undo failed records.
  *
@@ -135,8 +140,11 @@ public:
     {
         m_needRollback = true;
 
-        XnStatus status = xnOSTellFile64(m_pRecorder->m_file, &m_offset);
-        if (status != XN_STATUS_OK)
+        if (m_pRecorder != NULL && m_pRecorder->m_writer.isOpen())
+        {
+            m_offset = m_pRecorder->m_writer.tell();
+        }
+        else
         {
             m_pRecorder = NULL;
         }
@@ -149,7 +157,7 @@ public:
     {
         if (m_pRecorder != NULL)
         {
-            xnOSSeekFile64(m_pRecorder->m_file, XN_OS_SEEK_SET, m_offset);
+            m_pRecorder->m_writer.seek(m_offset);
         }
     }
 
@@ -168,7 +176,7 @@ public:
     {
         if (m_pRecorder != NULL)
         {
-            xnOSSeekFile64(m_pRecorder->m_file, XN_OS_SEEK_SET, pos);
+            m_pRecorder->m_writer.seek(pos);
         }
     }
 
@@ -178,17 +186,154 @@ private:
     XnBool    m_needRollback;
 };
 
-Recorder::Recorder(FrameManager& frameManager, xnl::ErrorLogger& errorLogger, OniRecorderHandle handle)
+/**
+ * Compresses frames for a Recorder on a thread of its own. Each worker keeps its own codec for every stream,
+ * since codecs keep per-frame state.
+ */
+class Recorder::CompressionWorker
+{
+public:
+    CompressionWorker(Recorder* pRecorder)
+        : m_pRecorder(pRecorder), m_thread(NULL), m_stop(FALSE)
+    {
+    }
+
+    ~CompressionWorker()
+    {
+        if (m_thread != NULL)
+        {
+            {
+                xnl::AutoCSLocker lock(m_lock);
+                m_stop = TRUE;
+            }
+            m_event.Set();
+            xnOSWaitForThreadExit(m_thread, XN_WAIT_INFINITE);
+            xnOSCloseThread(&m_thread);
+        }
+
+        for (Codecs::Iterator i = m_codecs.Begin(); i != m_codecs.End(); ++i)
+        {
+            XN_DELETE(i->Value());
+        }
+    }
+
+    XnStatus Start()
+    {
+        XnStatus nRetVal = m_event.Create(FALSE);
+        XN_IS_STATUS_OK(nRetVal);
+        return xnOSCreateThread(threadMain, this, &m_thread);
+    }
+
+    void Submit(CompressionJob* pJob)
+    {
+        {
+            xnl::AutoCSLocker lock(m_lock);
+            m_jobs.AddLast(pJob);
+        }
+        m_event.Set();
+    }
+
+    /**
+     * Deletes the codec of a detached stream. Must only be called when the worker has no jobs of this stream.
+     */
+    void RemoveCodec(XnUInt32 nodeId)
+    {
+        xnl::AutoCSLocker lock(m_lock);
+        Codecs::Iterator i = m_codecs.Find(nodeId);
+        if (i != m_codecs.End())
+        {
+            XN_DELETE(i->Value());
+            m_codecs.Remove(i);
+        }
+    }
+
+private:
+    typedef xnl::Hash<XnUInt32, XnCodecBase*> Codecs;
+
+    static XN_THREAD_PROC threadMain(XN_THREAD_PARAM pThreadParam)
+    {
+        CompressionWorker* pThis = reinterpret_cast<CompressionWorker*>(pThreadParam);
+        pThis->Run();
+        XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+    }
+
+    void Run()
+    {
+        for (;;)
+        {
+            CompressionJob* pJob = NULL;
+            XnCodecBase* pCodec = NULL;
+            {
+                xnl::AutoCSLocker lock(m_lock);
+                if (!m_jobs.IsEmpty())
+                {
+                    pJob = *m_jobs.Begin();
+                    m_jobs.Remove(m_jobs.Begin());
+
+                    Codecs::Iterator i = m_codecs.Find(pJob->nodeId);
+                    if (i != m_codecs.End())
+                    {
+                        pCodec = i->Value();
+                    }
+                    else
+                    {
+                        pCodec = createCodec(pJob->codec);
+                        m_codecs.Set(pJob->nodeId, pCodec);
+                    }
+                }
+                else if (m_stop)
+                {
+                    break;
+                }
+            }
+
+            if (pJob == NULL)
+            {
+                m_event.Wait(XN_WAIT_INFINITE);
+                continue;
+            }
+
+            if (pCodec != NULL)
+            {
+                compressFrame(pCodec, pJob);
+            }
+            else
+            {
+                pJob->status = XN_STATUS_ERROR;
+            }
+            m_pRecorder->onJobDone(pJob);
+        }
+    }
+
+    Recorder* m_pRecorder;
+    XN_THREAD_HANDLE m_thread;
+    xnl::CriticalSection m_lock;
+    xnl::OSEvent m_event;
+    xnl::List<CompressionJob*> m_jobs;
+    XnBool m_stop;
+    Codecs m_codecs;    //< Only touched while holding m_lock.
+};
+
+Recorder::Recorder(FrameManager& frameManager, xnl::ErrorLogger& errorLogger, const RecorderSettings& settings, OniRecorderHandle handle)
         : m_frameManager(frameManager),
           m_errorLogger(errorLogger), 
           m_handle(handle),
           m_maxId(0),
           m_configurationId(0),
 		  m_propertyPriority(ms_priorityNormal),
-          m_file(XN_INVALID_FILE_HANDLE),
+          m_settings(settings),
+          m_queuedFrames(0),
+          m_queuedBytes(0),
+          m_recordedFrames(0),
+          m_droppedFrames(0),
+          m_pendingDetaches(0),
+          m_nextCompressionWorker(0),
           m_running(FALSE),
           m_started(FALSE),
-          m_wasStarted(FALSE)
+          m_wasStarted(FALSE),
+          m_checkpointDirectoryPosition(0),
+          m_lastCheckpointPosition(0),
+          m_lastCheckpointTime(0)
 {
 }
 
@@ -199,6 +344,26 @@ Recorder::~Recorder()
     send(Message::MESSAGE_TERMINATE);
     xnOSWaitForThreadExit(m_thread, XN_WAIT_INFINITE);
 	xnOSCloseThread(&m_thread);
+    // returns the frames still held by the writer
+    m_writer.close();
+
+    for (XnUInt32 i = 0; i < m_compressionWorkers.GetSize(); ++i)
+    {
+        XN_DELETE(m_compressionWorkers[i]);
+    }
+    // only left if the recorder thread did not get to terminate
+    for (xnl::List<CompressionJob*>::Iterator i = m_pendingJobs.Begin(); i != m_pendingJobs.End(); ++i)
+    {
+        m_frameManager.release((*i)->pFrame);
+        m_freeJobs.AddLast(*i);
+    }
+    m_pendingJobs.Clear();
+    for (xnl::List<CompressionJob*>::Iterator i = m_freeJobs.Begin(); i != m_freeJobs.End(); ++i)
+    {
+        XN_DELETE_ARR((*i)->pBuffer);
+        XN_DELETE(*i);
+    }
+
     if (NULL != m_handle)
     {
         m_handle->pRecorder = NULL;
@@ -222,6 +387,34 @@ OniStatus Recorder::initialize(const char* fileName)
     xnOSCloseFile(&fileHandle);
 
     m_assembler.initialize();   
+
+    status = m_queueEvent.Create(FALSE);
+    if (XN_STATUS_OK == status)
+    {
+        status = m_queueSpaceEvent.Create(FALSE);
+    }
+    if (XN_STATUS_OK == status)
+    {
+        status = m_jobDoneEvent.Create(FALSE);
+    }
+    if (XN_STATUS_OK != status)
+    {
+        return ONI_STATUS_ERROR;
+    }
+
+    m_writer.setPayloadReleaseHandler(onPayloadWritten, this);
+
+    // If the workers can't be started, frames are simply compressed on the recorder thread.
+    for (XnUInt32 i = 0; i < m_settings.compressionThreads; ++i)
+    {
+        CompressionWorker* pWorker = XN_NEW(CompressionWorker, this);
+        if (pWorker == NULL || XN_STATUS_OK != pWorker->Start())
+        {
+            XN_DELETE(pWorker);
+            break;
+        }
+        m_compressionWorkers.AddLast(pWorker);
+    }
     
     status = xnOSCreateThread(threadMain, this, &m_thread);
     if (XN_STATUS_OK != status)
@@ -254,6 +447,9 @@ OniStatus Recorder::attachStream(VideoStream& stream, OniBool allowLossyCompress
             m_streams[pStream].lastInputTimestamp        = 0;
             m_streams[pStream].lastNewDataRecordPosition = 0;
             m_streams[pStream].dataIndex.Clear();
+            m_streams[pStream].uncheckpointedIndex.Clear();
+            m_streams[pStream].checkpointedFrames        = 0;
+            m_streams[pStream].lastIndexChunkPosition    = 0;
             send(Message::MESSAGE_ATTACH, pStream);
             return ONI_STATUS_OK;
         }
@@ -263,26 +459,57 @@ OniStatus Recorder::attachStream(VideoStream& stream, OniBool allowLossyCompress
 
 OniStatus Recorder::detachStream(VideoStream& stream)
 {
-    xnl::LockGuard<AttachedStreams> guard(m_streams);
     VideoStream* pStream = &stream;
-    if (m_streams.End() != m_streams.Find(pStream))
     {
-        stream.removeRecorder(*this);
-        send(Message::MESSAGE_DETACH, pStream);
-        return ONI_STATUS_OK;
+        xnl::LockGuard<AttachedStreams> guard(m_streams);
+        if (m_streams.End() == m_streams.Find(pStream))
+        {
+            return ONI_STATUS_BAD_PARAMETER;
+        }
+    }
+
+    // Unhook from the stream without holding m_streams: a stream thread inside record() holds the stream's
+    // recorders lock while it waits for m_streams, or for room in the queue (which the recorder thread can
+    // only make while m_streams is free). Streams waiting for room are let through meanwhile.
+    {
+        xnl::LockGuard<MessageQueue> queueGuard(m_queue);
+        ++m_pendingDetaches;
+    }
+    m_queueSpaceEvent.Set();
+
+    stream.removeRecorder(*this);
+
+    {
+        xnl::LockGuard<MessageQueue> queueGuard(m_queue);
+        --m_pendingDetaches;
+    }
+
+    xnl::LockGuard<AttachedStreams> guard(m_streams);
+    if (m_streams.End() == m_streams.Find(pStream))
+    {
+        return ONI_STATUS_BAD_PARAMETER;
     }
-    return ONI_STATUS_BAD_PARAMETER;
+    send(Message::MESSAGE_DETACH, pStream);
+    return ONI_STATUS_OK;
 }
 
 OniStatus Recorder::detachAllStreams()
 {
-    xnl::LockGuard<AttachedStreams> guard(m_streams);
-    for (AttachedStreams::Iterator 
-                i = m_streams.Begin(),
-                e = m_streams.End();
-         i != e; ++i)
+    xnl::Array<VideoStream*> streams;
+    {
+        xnl::LockGuard<AttachedStreams> guard(m_streams);
+        for (AttachedStreams::Iterator 
+                    i = m_streams.Begin(),
+                    e = m_streams.End();
+             i != e; ++i)
+        {
+            streams.AddLast(i->Key());
+        }
+    }
+
+    for (XnUInt32 i = 0; i < streams.GetSize(); ++i)
     {
-        detachStream(*i->Key());
+        detachStream(*streams[i]);
     }
     return ONI_STATUS_OK;
 }
@@ -297,6 +524,8 @@ OniStatus Recorder::start()
 void Recorder::stop()
 {
     m_started = false;
+    // release streams waiting for room in the queue
+    m_queueSpaceEvent.Set();
 }
 
 OniStatus Recorder::record(VideoStream& stream, OniFrame& aFrame)
@@ -305,18 +534,121 @@ OniStatus Recorder::record(VideoStream& stream, OniFrame& aFrame)
     {
         return ONI_STATUS_ERROR;
     }
+
+    // Make room before taking m_streams, which the recorder thread needs in order to write queued frames.
+    if (!reserveQueueSpace(aFrame.dataSize))
+    {
+        return ONI_STATUS_OK;
+    }
+
     xnl::LockGuard< AttachedStreams > guard(m_streams);
     VideoStream* pStream = &stream;
     if (m_streams.Find(pStream) == m_streams.End())
     {
+        releaseQueueSpace(aFrame.dataSize);
         return ONI_STATUS_BAD_PARAMETER;
     }
     OniFrame* pFrame = &aFrame;
     m_frameManager.addRef(pFrame);
-    send(Message::MESSAGE_RECORD, pStream, pFrame);
+    send(Message::MESSAGE_RECORD, pStream, pFrame, 0u, aFrame.dataSize);
+    return ONI_STATUS_OK;
+}
+
+XnBool Recorder::reserveQueueSpace(XnSizeT frameSize)
+{
+    xnl::LockGuard<MessageQueue> guard(m_queue);
+
+    // A frame is always let in when nothing else is queued, so a limit smaller than a frame can't stall recording.
+    while (m_settings.maxQueuedBytes != 0 &&
+           m_queuedFrames != 0 &&
+           m_queuedBytes + frameSize > m_settings.maxQueuedBytes)
+    {
+        if (m_settings.queuePolicy == ONI_RECORDER_QUEUE_DROP_NEWEST)
+        {
+            ++m_droppedFrames;
+            return FALSE;
+        }
+        else if (m_settings.queuePolicy == ONI_RECORDER_QUEUE_DROP_OLDEST)
+        {
+            Message oldest;
+            if (XN_STATUS_OK != m_queue.RemoveFirst(ms_priorityNormal, isRecordMessage, oldest))
+            {
+                // only the frame being written is left
+                break;
+            }
+            --m_queuedFrames;
+            m_queuedBytes -= oldest.dataSize;
+            ++m_droppedFrames;
+            m_frameManager.release(oldest.pFrame);
+        }
+        else
+        {
+            if (!m_started || !m_running || m_pendingDetaches != 0)
+            {
+                break;
+            }
+
+            m_queue.Unlock();
+            m_queueSpaceEvent.Wait(ONI_RECORDER_QUEUE_WAIT_INTERVAL_MS);
+            m_queue.Lock();
+        }
+    }
+
+    ++m_queuedFrames;
+    m_queuedBytes += frameSize;
+
+    if (m_settings.queuePolicy == ONI_RECORDER_QUEUE_BLOCK)
+    {
+        // other streams may be waiting as well
+        m_queueSpaceEvent.Set();
+    }
+
+    return TRUE;
+}
+
+void Recorder::releaseQueueSpace(XnSizeT frameSize)
+{
+    {
+        xnl::LockGuard<MessageQueue> guard(m_queue);
+        --m_queuedFrames;
+        m_queuedBytes -= frameSize;
+    }
+    m_queueSpaceEvent.Set();
+}
+
+XnBool Recorder::isRecordMessage(const Message& msg)
+{
+    return msg.type == Message::MESSAGE_RECORD;
+}
+
+OniStatus Recorder::setQueueLimit(XnUInt64 maxQueuedBytes, OniRecorderQueuePolicy policy)
+{
+    if (policy != ONI_RECORDER_QUEUE_BLOCK &&
+        policy != ONI_RECORDER_QUEUE_DROP_NEWEST &&
+        policy != ONI_RECORDER_QUEUE_DROP_OLDEST)
+    {
+        return ONI_STATUS_BAD_PARAMETER;
+    }
+
+    {
+        xnl::LockGuard<MessageQueue> guard(m_queue);
+        m_settings.maxQueuedBytes = maxQueuedBytes;
+        m_settings.queuePolicy = policy;
+    }
+    m_queueSpaceEvent.Set();
     return ONI_STATUS_OK;
 }
 
+void Recorder::getStats(OniRecorderStats* pStats)
+{
+    xnl::LockGuard<MessageQueue> guard(m_queue);
+    pStats->queuedFrames = (int)m_queuedFrames;
+    pStats->queuedBytes = m_queuedBytes;
+    pStats->recordedFrames = m_recordedFrames;
+    pStats->droppedFrames = m_droppedFrames;
+    pStats->writtenBytes = m_writer.getBytesWritten();
+}
+
 OniStatus Recorder::recordStreamProperty(
             VideoStream&     stream,
             int         propertyId,
@@ -361,6 +693,26 @@ void Recorder::messagePump()
 		nRetVal = m_queue.Pop(msg);
 	}
 
+    if (XN_STATUS_IS_EMPTY == nRetVal)
+    {
+        // Nothing new to do - write out frames the workers are still busy with.
+        if (!m_pendingJobs.IsEmpty())
+        {
+            writeNextJob();
+        }
+        else
+        {
+            m_queueEvent.Wait(XN_WAIT_INFINITE);
+        }
+        return;
+    }
+
+    // Any other record must follow all frames dispatched before it.
+    if (XN_STATUS_OK == nRetVal && Message::MESSAGE_RECORD != msg.type)
+    {
+        flushJobs();
+    }
+
     if (XN_STATUS_OK == nRetVal)
     {
         switch (msg.type)
@@ -393,6 +745,10 @@ void Recorder::messagePump()
                     if (i != m_streams.End())
                     {
                         onDetach(i->Value().nodeId);
+                        for (XnUInt32 j = 0; j < m_compressionWorkers.GetSize(); ++j)
+                        {
+                            m_compressionWorkers[j]->RemoveCodec(i->Value().nodeId);
+                        }
                         XN_DELETE(m_streams[msg.pStream].pCodec);
                         m_streams.Remove(msg.pStream);
                     }
@@ -413,21 +769,39 @@ void Recorder::messagePump()
                 break;
             case Message::MESSAGE_RECORD:
                 {
-                    xnl::LockGuard<AttachedStreams> streamsGuard(m_streams);
-                    AttachedStreams::Iterator i = m_streams.Find(msg.pStream);
-                    if (i != m_streams.End())
+                    XnUInt32 nodeId     = 0;
+                    XnCodecBase* pCodec = NULL;
+                    CodecParams codecParams;
+                    XnUInt32 frameId    = 0;
+                    XnUInt64 timestamp  = 0;
                     {
-                        XnCodecBase* pCodec = m_streams[msg.pStream].pCodec;
-                        XnUInt32 frameId    = ++m_streams[msg.pStream].frameId;
-                        XnUInt64 timestamp  = 0;
-                        if (frameId > 1)
+                        xnl::LockGuard<AttachedStreams> streamsGuard(m_streams);
+                        AttachedStreams::Iterator i = m_streams.Find(msg.pStream);
+                        if (i != m_streams.End())
                         {
-                            timestamp = m_streams[msg.pStream].lastOutputTimestamp + (msg.pFrame->timestamp - m_streams[msg.pStream].lastInputTimestamp);
+                            AttachedStreamInfo& info = i->Value();
+                            nodeId      = info.nodeId;
+                            pCodec      = info.pCodec;
+                            codecParams = info.codecParams;
+                            frameId     = ++info.frameId;
+                            if (frameId > 1)
+                            {
+                                timestamp = info.lastOutputTimestamp + (msg.pFrame->timestamp - info.lastInputTimestamp);
+                            }
+                            info.lastInputTimestamp = msg.pFrame->timestamp;
+                            info.lastOutputTimestamp = timestamp;
                         }
-                        m_streams[msg.pStream].lastInputTimestamp = msg.pFrame->timestamp;
-                        m_streams[msg.pStream].lastOutputTimestamp = timestamp;
-                        onRecord(i->Value().nodeId, pCodec, msg.pFrame, frameId, timestamp);
+                    }
+
+                    if (nodeId != 0)
+                    {
+                        // the job now owns the frame and its queue space
+                        dispatchRecord(nodeId, pCodec, codecParams, msg.pFrame, msg.dataSize, frameId, timestamp);
+                    }
+                    else
+                    {
                         m_frameManager.release(msg.pFrame);
+                        releaseQueueSpace(msg.dataSize);
                     }
                 }
                 break;
@@ -453,6 +827,201 @@ void Recorder::messagePump()
     }
 }
 
+XnCodecBase* Recorder::createCodec(const CodecParams& params)
+{
+    XnCodecBase* pCodec = NULL;
+    switch (params.codecId)
+    {
+    case ONI_CODEC_16Z_EMB_TABLES:
+        pCodec = XN_NEW(Xn16zEmbTablesCodec, params.maxDepth);
+        break;
+    case ONI_CODEC_16Z_ROWS:
+        pCodec = XN_NEW(Xn16zRowsCodec, params.maxDepth, params.resolutionX, params.resolutionY);
+        break;
+    case ONI_CODEC_JPEG:
+        pCodec = XN_NEW(
+                XnJpegCodec, 
+                /* bRGB = */ TRUE, 
+                params.resolutionX,
+                params.resolutionY);
+        break;
+    default:
+        pCodec = XN_NEW(XnUncompressedCodec);
+        break;
+    }
+
+    if (pCodec != NULL && XN_STATUS_OK != pCodec->Init())
+    {
+        XN_DELETE(pCodec);
+        pCodec = NULL;
+    }
+    return pCodec;
+}
+
+void Recorder::compressFrame(XnCodecBase* pCodec, CompressionJob* pJob)
+{
+    const OniFrame* pFrame = pJob->pFrame;
+
+    // the output buffer of a job is reused for all frames going through it, so it only grows once
+    XnUInt32 requiredSize = pFrame->dataSize * 2 + pCodec->GetOverheadSize();
+    if (pJob->bufferSize < requiredSize)
+    {
+        XN_DELETE_ARR(pJob->pBuffer);
+        pJob->pBuffer = XN_NEW_ARR(XnUInt8, requiredSize);
+        pJob->bufferSize = (pJob->pBuffer != NULL) ? requiredSize : 0;
+        if (pJob->pBuffer == NULL)
+        {
+            pJob->status = XN_STATUS_ALLOC_FAILED;
+            return;
+        }
+    }
+
+    pJob->compressedSize = pJob->bufferSize;
+    pJob->status = pCodec->Compress(reinterpret_cast<const XnUChar*>(pFrame->data), 
+            pFrame->dataSize, pJob->pBuffer, &pJob->compressedSize);
+}
+
+void Recorder::dispatchRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const CodecParams& codecParams, OniFrame* pFrame, XnSizeT queuedSize, XnUInt32 frameId, XnUInt64 timestamp)
+{
+    // Keep every worker busy, but don't let finished frames pile up behind a slow one.
+    XnUInt32 maxPendingJobs = XN_MAX(1u, 2 * m_compressionWorkers.GetSize());
+    while (m_pendingJobs.Size() >= maxPendingJobs)
+    {
+        writeNextJob();
+    }
+
+    CompressionJob* pJob = NULL;
+    if (!m_freeJobs.IsEmpty())
+    {
+        pJob = *m_freeJobs.Begin();
+        m_freeJobs.Remove(m_freeJobs.Begin());
+    }
+    else
+    {
+        pJob = XN_NEW(CompressionJob);
+        if (pJob == NULL)
+        {
+            m_frameManager.release(pFrame);
+            releaseQueueSpace(queuedSize);
+            return;
+        }
+        pJob->pBuffer = NULL;
+        pJob->bufferSize = 0;
+    }
+
+    pJob->nodeId         = nodeId;
+    pJob->codec          = codecParams;
+    pJob->compress       = (pCodec != NULL);
+    pJob->pFrame         = pFrame;
+    pJob->queuedSize     = queuedSize;
+    pJob->frameId        = frameId;
+    pJob->timestamp      = timestamp;
+    pJob->compressedSize = 0;
+    pJob->status         = XN_STATUS_OK;
+    pJob->done           = FALSE;
+    m_pendingJobs.AddLast(pJob);
+
+    if (pCodec == NULL)
+    {
+        // written as is
+        pJob->done = TRUE;
+    }
+    else if (m_compressionWorkers.IsEmpty())
+    {
+        compressFrame(pCodec, pJob);
+        pJob->done = TRUE;
+    }
+    else
+    {
+        m_compressionWorkers[m_nextCompressionWorker]->Submit(pJob);
+        m_nextCompressionWorker = (m_nextCompressionWorker + 1) % m_compressionWorkers.GetSize();
+    }
+
+    writeCompletedJobs();
+}
+
+void Recorder::onJobDone(CompressionJob* pJob)
+{
+    {
+        xnl::AutoCSLocker lock(m_jobsLock);
+        pJob->done = TRUE;
+    }
+    m_jobDoneEvent.Set();
+}
+
+void XN_CALLBACK_TYPE Recorder::onPayloadWritten(void* pCookie, void* pPayloadCookie)
+{
+    Recorder* pThis = (Recorder*)pCookie;
+    OniFrame* pFrame = (OniFrame*)pPayloadCookie;
+
+    // the frame was queued with its data size (see record())
+    XnSizeT frameSize = pFrame->dataSize;
+    pThis->m_frameManager.release(pFrame);
+    pThis->releaseQueueSpace(frameSize);
+}
+
+void Recorder::writeCompletedJobs()
+{
+    while (!m_pendingJobs.IsEmpty())
+    {
+        CompressionJob* pJob = *m_pendingJobs.Begin();
+        {
+            xnl::AutoCSLocker lock(m_jobsLock);
+            if (!pJob->done)
+            {
+                return;
+            }
+        }
+        writeNextJob();
+    }
+}
+
+void Recorder::writeNextJob()
+{
+    if (m_pendingJobs.IsEmpty())
+    {
+        return;
+    }
+
+    CompressionJob* pJob = *m_pendingJobs.Begin();
+    {
+        xnl::AutoCSLocker lock(m_jobsLock);
+        while (!pJob->done)
+        {
+            lock.Unlock();
+            m_jobDoneEvent.Wait(XN_WAIT_INFINITE);
+            lock.Lock();
+        }
+    }
+    m_pendingJobs.Remove(m_pendingJobs.Begin());
+
+    if (XN_STATUS_OK == pJob->status)
+    {
+        onRecord(*pJob);
+        checkpointIfDue();
+
+        xnl::LockGuard<MessageQueue> queueGuard(m_queue);
+        ++m_recordedFrames;
+    }
+
+    // uncompressed frames are held by the writer until they reach the file
+    if (pJob->pFrame != NULL)
+    {
+        m_frameManager.release(pJob->pFrame);
+        releaseQueueSpace(pJob->queuedSize);
+        pJob->pFrame = NULL;
+    }
+    m_freeJobs.AddLast(pJob);
+}
+
+void Recorder::flushJobs()
+{
+    while (!m_pendingJobs.IsEmpty())
+    {
+        writeNextJob();
+    }
+}
+
 void Recorder::send(
             Message::Type type, 
             VideoStream*     pStream, 
@@ -470,16 +1039,19 @@ void Recorder::send(
         propertyId,
         dataSize
     };
-    xnl::LockGuard<MessageQueue> guard(m_queue);
-    m_queue.Push(msg, priority);
+    {
+        xnl::LockGuard<MessageQueue> guard(m_queue);
+        m_queue.Push(msg, priority);
+    }
+    m_queueEvent.Set();
 }
 
 void Recorder::onInitialize()
 {
-    XnStatus status = xnOSOpenFile(
-        /* file name  = */ m_fileName.Data(), 
-        /* open flags = */ XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, 
-        /* out handle = */ &m_file);
+    XnStatus status = m_writer.open(
+        /* file name    = */ m_fileName.Data(), 
+        /* buffer size  = */ m_settings.writeBufferSize,
+        /* buffer count = */ m_settings.writeBufferCount);
 
     if (XN_STATUS_OK == status)
     {
@@ -491,7 +1063,20 @@ void Recorder::onInitialize()
             /* maxNodeId    = */ m_maxId,
         };
         m_fileHeader = fileHeader;
-        xnOSWriteFile(m_file, &m_fileHeader, sizeof(m_fileHeader));
+        m_writer.write(&m_fileHeader, sizeof(m_fileHeader));
+
+        if (m_settings.checkpointInterval > 0)
+        {
+            // No checkpoint yet. Each one will point this record to itself.
+            m_checkpointDirectoryPosition = m_writer.tell();
+            if (ONI_STATUS_OK != m_assembler.emit_RECORD_CHECKPOINT_DIRECTORY(XN_UINT64_C(0)) ||
+                ONI_STATUS_OK != m_assembler.serialize(m_writer))
+            {
+                m_writer.seek(m_checkpointDirectoryPosition);
+                m_checkpointDirectoryPosition = 0;
+            }
+            xnOSGetTimeStamp(&m_lastCheckpointTime);
+        }
     }
 }
 
@@ -512,7 +1097,7 @@ void Recorder::onInitialize()
 #define EMIT(expr)                                              \
     if (ONI_STATUS_OK == (m_assembler.emit_##expr))             \
     {                                                           \
-        if (ONI_STATUS_OK != m_assembler.serialize(m_file))     \
+        if (ONI_STATUS_OK != m_assembler.serialize(m_writer))   \
         {                                                       \
             return;                                             \
         }                                                       \
@@ -555,10 +1140,9 @@ void Recorder::onTerminate()
 {
     // Truncate the file to it's last offset, so that undone records
     // will not be serialized.
-    XnUInt64 truncationOffset = XN_UINT64_C(0);
-    if (XN_STATUS_OK == xnOSTellFile64(m_file, &truncationOffset))
+    if (m_writer.isOpen())
     {
-        xnOSTruncateFile64(m_file, truncationOffset);
+        m_writer.truncate(m_writer.tell());
     }
 
     Memento undoPoint(this);
@@ -568,11 +1152,83 @@ void Recorder::onTerminate()
     // The file header needs being patched, because its maxNodeId field has become
     // irrelevant by now.
     m_fileHeader.maxNodeId = m_maxId;
-    xnOSSeekFile64(m_file, XN_OS_SEEK_SET, XN_UINT64_C(0));
-    xnOSWriteFile(m_file, &m_fileHeader, sizeof(m_fileHeader));
+    m_writer.seek(XN_UINT64_C(0));
+    m_writer.write(&m_fileHeader, sizeof(m_fileHeader));
+
+    m_writer.close();
+}
+
+void Recorder::checkpointIfDue()
+{
+    if (0 == m_checkpointDirectoryPosition)
+    {
+        return;
+    }
+
+    XnUInt64 now = 0;
+    xnOSGetTimeStamp(&now);
+    if (now - m_lastCheckpointTime < XnUInt64(m_settings.checkpointInterval) * 1000)
+    {
+        return;
+    }
+    m_lastCheckpointTime = now;
 
-    xnOSCloseFile(&m_file);
-    m_file = XN_INVALID_FILE_HANDLE;
+    writeCheckpoint();
+}
+
+void Recorder::writeCheckpoint()
+{
+    // Everything the checkpoint covers must reach the disk before the header points to it, and a file that was
+    // cut short in the middle of a checkpoint is still read from the previous one.
+    xnl::Array<CheckpointNodeEntry> nodes;
+    {
+        xnl::LockGuard<AttachedStreams> guard(m_streams);
+        for (AttachedStreams::Iterator i = m_streams.Begin(), e = m_streams.End(); i != e; ++i)
+        {
+            AttachedStreamInfo& info = i->Value();
+            if (!info.uncheckpointedIndex.IsEmpty())
+            {
+                Memento undoPoint(this);
+                EMIT(RECORD_SEEK_TABLE_CHUNK(
+                        info.nodeId,
+                        info.lastIndexChunkPosition,
+                        /* firstFrame = */ info.checkpointedFrames + 1,
+                        info.uncheckpointedIndex
+                    ))
+                undoPoint.Release();
+                info.lastIndexChunkPosition = undoPoint.GetPosition();
+                info.checkpointedFrames += info.uncheckpointedIndex.Size();
+                info.uncheckpointedIndex.Clear();
+            }
+
+            if (0 != info.lastIndexChunkPosition)
+            {
+                CheckpointNodeEntry entry = { info.nodeId, info.checkpointedFrames, info.lastIndexChunkPosition };
+                nodes.AddLast(entry);
+            }
+        }
+    }
+
+    Memento undoPoint(this);
+    EMIT(RECORD_CHECKPOINT(
+            m_lastCheckpointPosition,
+            m_configurationId,
+            nodes.GetData(),
+            nodes.GetSize()
+        ))
+    undoPoint.Release();
+    m_lastCheckpointPosition = undoPoint.GetPosition();
+    m_writer.sync();
+
+    // Point the file to the checkpoint. The header knows of all the nodes added so far.
+    undoPoint.Reuse();
+    m_fileHeader.maxNodeId = m_maxId;
+    m_writer.seek(XN_UINT64_C(0));
+    m_writer.write(&m_fileHeader, sizeof(m_fileHeader));
+    undoPoint.SetPosition(m_checkpointDirectoryPosition);
+    EMIT(RECORD_CHECKPOINT_DIRECTORY(m_lastCheckpointPosition))
+    undoPoint.Undo();
+    m_writer.sync();
 }
 
 typedef enum XnPixelFormat
@@ -664,41 +1320,42 @@ void Recorder::onAttach(XnUInt32 nodeId, VideoStream* pStream)
             pStream->getProperty(
                     ONI_STREAM_PROPERTY_MAX_VALUE, &maxDepth, &size);
 
-            m_streams[pStream].pCodec = XN_NEW(
-                    Xn16zEmbTablesCodec, static_cast<XnUInt16>(maxDepth));
-
-            codecId = ONI_CODEC_16Z_EMB_TABLES;
+            if (m_settings.compress)
+            {
+                codecId = m_settings.depthRowBlocks ? ONI_CODEC_16Z_ROWS : ONI_CODEC_16Z_EMB_TABLES;
+            }
         }
         break;
     case ONI_PIXEL_FORMAT_RGB888:
         {
-            if (m_streams[pStream].allowLossyCompression)
+            if (m_settings.compress && m_streams[pStream].allowLossyCompression)
             {
-                m_streams[pStream].pCodec = XN_NEW(
-                        XnJpegCodec, 
-                        /* bRGB = */ TRUE, 
-                        curVideoMode.resolutionX,
-                        curVideoMode.resolutionY);
-
                 codecId = ONI_CODEC_JPEG;
             }
-            else
-            {
-                m_streams[pStream].pCodec = XN_NEW(XnUncompressedCodec);
-            }
         }
         break;
     default:
-        m_streams[pStream].pCodec = XN_NEW(XnUncompressedCodec);
         break;
     }
 
+    CodecParams& codecParams = m_streams[pStream].codecParams;
+    codecParams.codecId     = codecId;
+    codecParams.maxDepth    = static_cast<XnUInt16>(maxDepth);
+    codecParams.resolutionX = curVideoMode.resolutionX;
+    codecParams.resolutionY = curVideoMode.resolutionY;
+
+    // Compression workers create codecs of their own from the same parameters.
+    // Uncompressed frames need no codec at all - they are written as they are.
+    if (ONI_CODEC_UNCOMPRESSED != codecId)
+    {
+        m_streams[pStream].pCodec = createCodec(codecParams);
+    }
+
     // If anything went wrong - fall back to uncompressed format. 
-    if (XN_STATUS_OK != m_streams[pStream].pCodec->Init())
+    if (NULL == m_streams[pStream].pCodec)
     {
-        XN_DELETE(m_streams[pStream].pCodec);
-        m_streams[pStream].pCodec = NULL;
         codecId = ONI_CODEC_UNCOMPRESSED;
+        codecParams.codecId = codecId;
     }
     
     Memento undoPoint(this);
@@ -989,48 +1646,46 @@ void Recorder::onStart(XnUInt32 nodeId)
     undoPoint.Release();
 }
 
-void Recorder::onRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const OniFrame* pFrame, XnUInt32 frameId, XnUInt64 timestamp)
+void Recorder::onRecord(CompressionJob& job)
 {
-    if (0 == nodeId || NULL == pFrame)
+    if (0 == job.nodeId || NULL == job.pFrame)
     {
         return;
     }
 
+    XnUInt32 nodeId = job.nodeId;
     FIND_ATTACHED_STREAM_INFO(nodeId)
     if (!pInfo) return;
 
     Memento undoPoint(this);
 
-    if (NULL != pCodec)
+    if (job.compress)
     {
-        XnUInt32 bufferSize_bytes32 = pFrame->dataSize * 2 + pCodec->GetOverheadSize();
-        XnUInt8* buffer             = XN_NEW_ARR(XnUInt8, bufferSize_bytes32);
-
-        XnStatus status = pCodec->Compress(reinterpret_cast<const XnUChar*>(pFrame->data), 
-                pFrame->dataSize, buffer, &bufferSize_bytes32);
-                XnSizeT  bufferSize_bytes = bufferSize_bytes32;
-        if (XN_STATUS_OK == status)
-        {
-            EMIT(RECORD_NEW_DATA(
-                    nodeId,
-                    pInfo->lastNewDataRecordPosition,
-                    timestamp,
-                    frameId,
-                    buffer,
-                    bufferSize_bytes))
-        }
-        XN_DELETE_ARR(buffer);
+        EMIT(RECORD_NEW_DATA(
+                job.nodeId,
+                pInfo->lastNewDataRecordPosition,
+                job.timestamp,
+                job.frameId,
+                job.pBuffer,
+                job.compressedSize))
     }
     else
     {
-        EMIT(RECORD_NEW_DATA(
-                nodeId,
+        // Hand the frame itself to the writer, which writes its data right after the header, and releases it
+        // once it's on disk.
+        EMIT(RECORD_NEW_DATA_HEADER(
+                job.nodeId,
                 pInfo->lastNewDataRecordPosition,
-                pFrame->timestamp,
-                pFrame->frameIndex,
-                pFrame->data,
-                pFrame->dataSize
+                job.timestamp,
+                job.frameId,
+                job.pFrame->dataSize
             ))
+        OniFrame* pFrame = job.pFrame;
+        job.pFrame = NULL;
+        if (XN_STATUS_OK != m_writer.writePayload(pFrame->data, pFrame->dataSize, pFrame))
+        {
+            return;
+        }
     }
     undoPoint.Release();
     // save this record's position as the last one
@@ -1038,11 +1693,15 @@ void Recorder::onRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const OniFrame* pF
     
     // write to seek table
     DataIndexEntry dataIndexEntry;
-    dataIndexEntry.nTimestamp = timestamp;
+    dataIndexEntry.nTimestamp = job.timestamp;
     dataIndexEntry.nConfigurationID = m_configurationId;
     dataIndexEntry.nSeekPos = undoPoint.GetPosition();
 
     pInfo->dataIndex.AddLast(dataIndexEntry);
+    if (0 != m_checkpointDirectoryPosition)
+    {
+        pInfo->uncheckpointedIndex.AddLast(dataIndexEntry);
+    }
 }
 
 void Recorder::onRecordProperty(
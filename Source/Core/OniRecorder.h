@@ -25,9 +25,12 @@
 #include "XnLockable.h"
 #include "XnString.h"
 #include "XnPriorityQueue.h"
+#include "XnOSCpp.h"
+#include "XnArray.h"
 
 // These come from OniFile/Formats
 #include "Xn16zEmbTablesCodec.h"
+#include "Xn16zRowsCodec.h"
 #include "XnJpegCodec.h"
 #include "XnUncompressedCodec.h"
 
@@ -41,6 +44,19 @@ ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 class VideoStream;
 
+// configuration of recorders (see the [Recording] section of OpenNI.ini)
+struct RecorderSettings
+{
+    XnUInt64 maxQueuedBytes; // memory held by frames waiting to be written (0 - unlimited)
+    OniRecorderQueuePolicy queuePolicy; // what to do with new frames when the queue is full
+    XnUInt32 writeBufferSize; // size of each of the buffers records are coalesced into, in bytes
+    XnUInt32 writeBufferCount; // number of write buffers
+    XnUInt32 compressionThreads; // threads compressing frames (0 - compress on the recorder thread)
+    XnBool compress;             // FALSE - all streams are recorded uncompressed, straight from the frames
+    XnBool depthRowBlocks;       // TRUE - depth is compressed in blocks of rows that decode independently (16zR)
+    XnUInt32 checkpointInterval; // seconds between checkpoints of the seek tables and the header (0 - none)
+};
+
 /**
  * The private implementation of a recorder.
  */
@@ -52,7 +68,7 @@ public:
      * @note The newly constructed recorder becomes the owner of the handle.
      * @note The handle might be NULL.
      */
-    Recorder(FrameManager& frameManager, xnl::ErrorLogger& errorLogger, OniRecorderHandle handle = NULL);
+    Recorder(FrameManager& frameManager, xnl::ErrorLogger& errorLogger, const RecorderSettings& settings, OniRecorderHandle handle = NULL);
 
     /**
      * Destroys the recorder and stops recording if needed.
@@ -106,6 +122,17 @@ public:
             int         propertyId,
             const void* pData, 
             int         dataSize);
+
+    /**
+     * Limits the memory held by queued frames (0 - unlimited), and sets what
+     * happens to new frames once the limit is reached.
+     */
+    OniStatus setQueueLimit(XnUInt64 maxQueuedBytes, OniRecorderQueuePolicy policy);
+
+    /**
+     * Gets the queue depth and the frame counters of the recorder.
+     */
+    void getStats(OniRecorderStats* pStats);
     
 private:
     XN_DISABLE_COPY_AND_ASSIGN(Recorder)
@@ -144,6 +171,38 @@ private:
            class Memento;
     friend class Memento;
 
+    // What is needed to create the codec of a stream.
+    struct CodecParams
+    {
+        XnUInt32 codecId;
+        XnUInt16 maxDepth;      // 16z codecs
+        XnUInt32 resolutionX;   // JPEG and 16z rows codecs
+        XnUInt32 resolutionY;
+    };
+
+    // A frame on its way to the file. Jobs are recycled along with their output buffers.
+    struct CompressionJob
+    {
+        XnUInt32    nodeId;
+        CodecParams codec;
+        XnBool      compress;       // FALSE when the frame is written as is
+        OniFrame*   pFrame;
+        XnSizeT     queuedSize;
+        XnUInt32    frameId;
+        XnUInt64    timestamp;
+        XnUInt8*    pBuffer;
+        XnUInt32    bufferSize;
+        XnUInt32    compressedSize;
+        XnStatus    status;
+        XnBool      done;           // under m_jobsLock
+    };
+
+           class CompressionWorker;
+    friend class CompressionWorker;
+
+    static XnCodecBase* createCodec(const CodecParams& params);
+    static void compressFrame(XnCodecBase* pCodec, CompressionJob* pJob);
+
     // The main function of Recorder's thread.
     static XN_THREAD_PROC threadMain(XN_THREAD_PARAM pThreadParam);
 
@@ -151,6 +210,23 @@ private:
     // action associated with that message.
     void messagePump();
 
+    // Makes room for a new frame in the queue according to the queue policy. Returns FALSE if the frame is dropped.
+    XnBool reserveQueueSpace(XnSizeT frameSize);
+    void releaseQueueSpace(XnSizeT frameSize);
+    static XnBool isRecordMessage(const Message& msg);
+
+    // Frames are compressed out of order by the workers, but written in the order they were dispatched.
+    void dispatchRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const CodecParams& codecParams, OniFrame* pFrame, XnSizeT queuedSize, XnUInt32 frameId, XnUInt64 timestamp);
+    void onJobDone(CompressionJob* pJob);
+    static void XN_CALLBACK_TYPE onPayloadWritten(void* pCookie, void* pPayloadCookie);
+    void writeCompletedJobs();
+    void writeNextJob();
+    void flushJobs();
+
+    // Writes the seek table chunks of all streams, and points the header to them, once the interval passed.
+    void checkpointIfDue();
+    void writeCheckpoint();
+
     // Sends a message to the threadMain.
     void send(
             Message::Type type, 
@@ -166,7 +242,7 @@ private:
     void onAttach(XnUInt32 nodeId, VideoStream* pStream);
     void onDetach(XnUInt32 nodeId);
     void onStart (XnUInt32 nodeId);
-    void onRecord(XnUInt32 nodeId, XnCodecBase* pCodec, const OniFrame* pFrame, XnUInt32 frameId, XnUInt64 timestamp);
+    void onRecord(CompressionJob& job);
     void onRecordProperty(
             XnUInt32    nodeId, 
             XnUInt32    propertyId,
@@ -197,6 +273,7 @@ private:
         XnUInt64       nodeAddedRecordPosition;
         XnUInt32       nodeType; 
         XnUInt32       codecId;
+        CodecParams    codecParams;
 
         // needed for keeping track of undoRecordPos field
         XnUInt64       lastNewDataRecordPosition;
@@ -205,6 +282,11 @@ private:
 
         // needed for generating the SeekTable in the end
         DataIndexEntryList dataIndex;
+
+        // entries not written in a seek table chunk yet (checkpoints only)
+        DataIndexEntryList uncheckpointedIndex;
+        XnUInt32       checkpointedFrames;
+        XnUInt64       lastIndexChunkPosition;
     };
 
     // A map of stream -> stream information.
@@ -229,6 +311,24 @@ private:
 	static const int ms_priorityLow = 2;
 	static const int ms_priorityNormal = 1;
 	static const int ms_priorityHigh = 0;
+    xnl::OSEvent m_queueEvent;  //< Set whenever a message is sent.
+
+    // Queue accounting, under the lock of m_queue. Frames are accounted from the moment they are
+    // queued until they are written.
+    RecorderSettings m_settings;
+    XnUInt32 m_queuedFrames;
+    XnUInt64 m_queuedBytes;
+    XnUInt64 m_recordedFrames;
+    XnUInt64 m_droppedFrames;
+    XnUInt32 m_pendingDetaches;
+    xnl::OSEvent m_queueSpaceEvent;  //< Set whenever a queued frame was written.
+
+    xnl::Array<CompressionWorker*> m_compressionWorkers;
+    XnUInt32 m_nextCompressionWorker;
+    xnl::List<CompressionJob*> m_pendingJobs;  //< Dispatched frames, in file order.
+    xnl::List<CompressionJob*> m_freeJobs;
+    xnl::CriticalSection m_jobsLock;
+    xnl::OSEvent m_jobDoneEvent;
 
     // The Recorder uses RecordAssembler to assemble records correctly and to
     // serialize them to a file.
@@ -237,11 +337,16 @@ private:
     XN_THREAD_HANDLE m_thread;
     FileHeaderData   m_fileHeader;  //< Will be patched during termination.
     xnl::String      m_fileName;
-    XN_FILE_HANDLE   m_file;
+    RecordWriter     m_writer;
     XnBool           m_running;     //< TRUE whenever the threadMain is running.
     XnBool           m_started;     //< TRUE whenever the recorder has started.
     XnBool           m_wasStarted;  //< TRUE if the recorder has been started once.
 
+    // Checkpoints (see RecordAssembler::emit_RECORD_CHECKPOINT_DIRECTORY()).
+    XnUInt64         m_checkpointDirectoryPosition; //< 0 if checkpoints are off.
+    XnUInt64         m_lastCheckpointPosition;
+    XnUInt64         m_lastCheckpointTime;          //< In milliseconds.
+
 // Get rid of macros:
 #undef ONI_DISABLE_COPY_AND_ASSIGN
 };
@@ -12,6 +12,11 @@ Sensor::Sensor(xnl::ErrorLogger& errorLogger, FrameManager& frameManager, const
 	m_streamHandle(NULL),
 	m_requiredFrameSize(0)
 {
+	const FrameBufferPoolSettings& poolSettings = m_frameManager.getFrameBufferPoolSettings();
+	m_pFrameBufferPool = XN_NEW(FrameBufferPool);
+	m_pFrameBufferPool->setDepth(poolSettings.depth);
+	m_pFrameBufferPool->setUseHugePages(poolSettings.useHugePages);
+
 	resetFrameAllocator();
 
 	OniStreamServices::streamServices = this;
@@ -19,11 +24,13 @@ Sensor::Sensor(xnl::ErrorLogger& errorLogger, FrameManager& frameManager, const
 	OniStreamServices::acquireFrame = acquireFrameCallback;
 	OniStreamServices::addFrameRef = addFrameRefCallback;
 	OniStreamServices::releaseFrame = releaseFrameCallback;
+	OniStreamServices::acquireExternalFrame = acquireExternalFrameCallback;
 }
 
 Sensor::~Sensor()
 {
-	releaseAllFrames();
+	// frames that are still held by the application will free their buffers when released
+	m_pFrameBufferPool->shutdown();
 }
 
 void Sensor::setDriverStream(void* streamHandle)
@@ -63,20 +70,32 @@ OniStatus Sensor::setFrameBufferAllocator(OniFrameAllocBufferCallback alloc, Oni
 
 void Sensor::setRequiredFrameSize(int requiredFrameSize)
 {
-	if (m_requiredFrameSize != requiredFrameSize)
+	m_requiredFrameSize = requiredFrameSize;
+
+	if (m_allocFrameBufferCallback == allocFrameBufferFromPoolCallback)
 	{
-		// release all previous frames. They can't be used anymore
-		releaseAllFrames();
+		// buffers of a different size class are freed by the pool, and new ones are preallocated,
+		// so streaming does not start with allocations
+		m_pFrameBufferPool->setBufferSize(requiredFrameSize);
+		m_pFrameBufferPool->preallocate();
 	}
+}
 
-	m_requiredFrameSize = requiredFrameSize;
+void Sensor::setFrameBufferPoolDepth(int depth)
+{
+	m_pFrameBufferPool->setDepth(depth);
+}
+
+int Sensor::getFrameBufferPoolDepth() const
+{
+	return m_pFrameBufferPool->getDepth();
 }
 
 void Sensor::resetFrameAllocator()
 {
 	m_allocFrameBufferCallback = allocFrameBufferFromPoolCallback;
 	m_freeFrameBufferCallback = releaseFrameBufferToPoolCallback;
-	m_frameBufferAllocatorCookie = this;
+	m_frameBufferAllocatorCookie = m_pFrameBufferPool;
 }
 
 OniFrame* Sensor::acquireFrame()
@@ -96,86 +115,45 @@ OniFrame* Sensor::acquireFrame()
 
 	pResult->dataSize = m_requiredFrameSize;
 	pResult->backToPoolFunc = frameBackToPoolCallback;
-	pResult->backToPoolFuncCookie = this;
+	pResult->backToPoolFuncCookie = NULL;
 	pResult->freeBufferFunc = m_freeFrameBufferCallback;
 	pResult->freeBufferFuncCookie = m_frameBufferAllocatorCookie;
 
-	xnl::AutoCSLocker lock(m_framesCS);
-	m_currentStreamFrames.AddLast(pResult);
-
 	return pResult;
 }
 
-void* Sensor::allocFrameBufferFromPool(int size)
+OniFrame* Sensor::acquireExternalFrame(void* data, int dataSize, OniFrameFreeBufferCallback freeData, void* pCookie)
 {
-	XN_ASSERT(size == m_requiredFrameSize);
-	void* pResult = NULL;
-	xnl::AutoCSLocker lock(m_framesCS);
-	if (m_availableFrameBuffers.IsEmpty())
-	{
-		// create a new one
-		pResult = xnOSMallocAligned(size, XN_DEFAULT_MEM_ALIGN);
-		m_allFrameBuffers.AddLast(pResult);
-	}
-	else
+	OniFrameInternal* pResult = m_frameManager.acquireFrame();
+	if (pResult == NULL)
 	{
-		xnl::List<void*>::Iterator it = m_availableFrameBuffers.Begin();
-		pResult = *it;
-		m_availableFrameBuffers.Remove(it);
+		return NULL;
 	}
-	return pResult;
-}
 
-void Sensor::releaseFrameBufferToPool(void* pBuffer)
-{
-	xnl::AutoCSLocker lock(m_framesCS);
-	m_availableFrameBuffers.AddLast(pBuffer);
+	// the data goes back to the driver (rather than to the pool) when the last reference is released
+	pResult->data = data;
+	pResult->dataSize = dataSize;
+	pResult->backToPoolFunc = frameBackToPoolCallback;
+	pResult->backToPoolFuncCookie = NULL;
+	pResult->freeBufferFunc = freeData;
+	pResult->freeBufferFuncCookie = pCookie;
+
+	return pResult;
 }
 
 void* ONI_CALLBACK_TYPE Sensor::allocFrameBufferFromPoolCallback(int size, void* pCookie)
 {
-	Sensor* pThis = (Sensor*)pCookie;
-	return pThis->allocFrameBufferFromPool(size);
+	FrameBufferPool* pPool = (FrameBufferPool*)pCookie;
+	return pPool->allocBuffer(size);
 }
 
 void ONI_CALLBACK_TYPE Sensor::releaseFrameBufferToPoolCallback(void* pBuffer, void* pCookie)
 {
-	Sensor* pThis = (Sensor*)pCookie;
-	pThis->releaseFrameBufferToPool(pBuffer);
-}
-
-void ONI_CALLBACK_TYPE Sensor::freeFrameBufferMemoryCallback(void* pBuffer, void* /*pCookie*/)
-{
-	xnOSFreeAligned(pBuffer);
+	FrameBufferPool* pPool = (FrameBufferPool*)pCookie;
+	pPool->releaseBuffer(pBuffer);
 }
 
-void Sensor::releaseAllFrames()
-{
-	xnl::AutoCSLocker lock(m_framesCS);
-	// change release method of current frames
-	for (xnl::List<OniFrameInternal*>::Iterator it = m_currentStreamFrames.Begin(); it != m_currentStreamFrames.End(); ++it)
-	{
-		// don't return frame buffer to pool, instead just free it
-		if ((*it)->freeBufferFunc == releaseFrameBufferToPoolCallback)
-		{
-			(*it)->freeBufferFunc = freeFrameBufferMemoryCallback;
-		}
-
-		// mark that this frame does not belong to this stream anymore
-		(*it)->backToPoolFuncCookie = NULL;
-	}
-
-	m_currentStreamFrames.Clear();
-
-	// delete all available frames
-	for (xnl::List<void*>::Iterator it = m_availableFrameBuffers.Begin(); it != m_availableFrameBuffers.End(); ++it)
-	{
-		xnOSFreeAligned(*it);
-	}
-	m_availableFrameBuffers.Clear();
-}
-
-void ONI_CALLBACK_TYPE Sensor::frameBackToPoolCallback(OniFrameInternal* pFrame, void* pCookie)
+void ONI_CALLBACK_TYPE Sensor::frameBackToPoolCallback(OniFrameInternal* pFrame, void* /*pCookie*/)
 {
 	// release the data
 	if (pFrame->data != NULL)
@@ -184,13 +162,6 @@ void ONI_CALLBACK_TYPE Sensor::frameBackToPoolCallback(OniFrameInternal* pFrame,
 		pFrame->freeBufferFunc(pFrame->data, pFrame->freeBufferFuncCookie);
 		pFrame->data = NULL;
 	}
-
-	if (pCookie != NULL)
-	{
-		Sensor* pThis = (Sensor*)pCookie;
-		xnl::AutoCSLocker lock(pThis->m_framesCS);
-		pThis->m_currentStreamFrames.Remove(pFrame);
-	}
 }
 
 int Sensor::getDefaultRequiredFrameSize()
@@ -231,6 +202,12 @@ OniFrame* ONI_CALLBACK_TYPE Sensor::acquireFrameCallback(void* streamServices)
 	return pThis->acquireFrame();
 }
 
+OniFrame* ONI_CALLBACK_TYPE Sensor::acquireExternalFrameCallback(void* streamServices, void* data, int dataSize, OniFrameFreeBufferCallback freeData, void* pCookie)
+{
+	Sensor* pThis = (Sensor*)streamServices;
+	return pThis->acquireExternalFrame(data, dataSize, freeData, pCookie);
+}
+
 void ONI_CALLBACK_TYPE Sensor::addFrameRefCallback(void* streamServices, OniFrame* pFrame)
 {
 	Sensor* pThis = (Sensor*)streamServices;
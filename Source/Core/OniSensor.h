@@ -3,6 +3,7 @@
 
 #include "OniCommon.h"
 #include "OniFrameManager.h"
+#include "OniFrameBufferPool.h"
 #include "OniDriverHandler.h"
 #include <Driver/OniDriverTypes.h>
 #include <XnOSCpp.h>
@@ -23,6 +24,9 @@ public:
 	OniStatus setFrameBufferAllocator(OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
 	void setRequiredFrameSize(int requiredFrameSize);
 
+	void setFrameBufferPoolDepth(int depth);
+	int getFrameBufferPoolDepth() const;
+
 	xnl::Event1Arg<OniFrame*>::Interface& newFrameEvent() { return m_newFrameEvent; }
 	void* streamHandle() const { return m_streamHandle; }
 
@@ -36,22 +40,19 @@ private:
 	// stream services implementation
 	int getDefaultRequiredFrameSize();
 	OniFrame* acquireFrame();
+	OniFrame* acquireExternalFrame(void* data, int dataSize, OniFrameFreeBufferCallback freeData, void* pCookie);
 
 	static int ONI_CALLBACK_TYPE getDefaultRequiredFrameSizeCallback(void* streamServices);
 	static OniFrame* ONI_CALLBACK_TYPE acquireFrameCallback(void* streamServices);
+	static OniFrame* ONI_CALLBACK_TYPE acquireExternalFrameCallback(void* streamServices, void* data, int dataSize, OniFrameFreeBufferCallback freeData, void* pCookie);
 	static void ONI_CALLBACK_TYPE releaseFrameCallback(void* streamServices, OniFrame* pFrame);
 	static void ONI_CALLBACK_TYPE addFrameRefCallback(void* streamServices, OniFrame* pFrame);
 
 	void resetFrameAllocator();
 
 	// frame buffer management
-	void* allocFrameBufferFromPool(int size);
-	void releaseFrameBufferToPool(void* pBuffer);
-	void releaseAllFrames();
-
 	static void* ONI_CALLBACK_TYPE allocFrameBufferFromPoolCallback(int size, void* pCookie);
 	static void ONI_CALLBACK_TYPE releaseFrameBufferToPoolCallback(void* pBuffer, void* pCookie);
-	static void ONI_CALLBACK_TYPE freeFrameBufferMemoryCallback(void* pBuffer, void* pCookie);
 	static void ONI_CALLBACK_TYPE frameBackToPoolCallback(OniFrameInternal* pFrame, void* pCookie);
 
 	static void ONI_CALLBACK_TYPE newFrameCallback(void* streamHandle, OniFrame* pFrame, void* pCookie);
@@ -65,11 +66,8 @@ private:
 
 	int m_requiredFrameSize;
 
-	// following members are for the frame buffer pool that is used by default
-	xnl::CriticalSection m_framesCS;
-	xnl::List<void*> m_allFrameBuffers;
-	xnl::List<void*> m_availableFrameBuffers;
-	xnl::List<OniFrameInternal*> m_currentStreamFrames;
+	// the frame buffer pool that is used by default. It is reference counted, as frames may outlive the sensor.
+	FrameBufferPool* m_pFrameBufferPool;
 
 	// following members point to current allocation functions
 	OniFrameAllocBufferCallback m_allocFrameBufferCallback;
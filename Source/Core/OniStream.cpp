@@ -23,10 +23,20 @@
 #include "OniProperties.h"
 #include "Driver/OniDriverTypes.h"
 #include "OniRecorder.h"
+#include "OniStreamWaiter.h"
 #include "XnLockGuard.h"
 
 #include <math.h>
 
+#if (XN_PLATFORM == XN_PLATFORM_WIN32) || defined(__SSE2__)
+	#define XN_WORLD_CONVERT_SSE2
+	#include <emmintrin.h>
+#endif
+
+// Frames with fewer points than this are converted on the calling thread only
+#define XN_WORLD_CONVERT_MIN_PARALLEL_POINTS	(64*1024)
+#define XN_WORLD_CONVERT_MAX_THREADS			4
+
 #define STREAM_DESTROY_THREAD_TIMEOUT			2000
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
@@ -40,7 +50,8 @@ VideoStream::VideoStream(Sensor* pSensor, const OniSensorInfo* pSensorInfo, Devi
 	m_frameManager(frameManager),
 	m_pSensor(pSensor),
 	m_hNewFrameEvent(NULL),
-	m_started(FALSE)
+	m_started(FALSE),
+	m_worldConvertWorkersStarted(FALSE)
 {
 	xnOSCreateEvent(&m_newFrameInternalEvent, false);
 	xnOSCreateEvent(&m_newFrameInternalEventForFrameHolder, false);
@@ -73,6 +84,22 @@ VideoStream::~VideoStream()
 
 	m_device.clearStream(this);
 
+	// Detach the waiters, then tell them outside our lock (a waiter may be unregistering from us right now, and
+	// needs it to do so). Waiters that already removed us just ignore it.
+	xnl::List<StreamWaiter*> waiters;
+	{
+		xnl::AutoCSLocker lock(m_waitersCS);
+		for (xnl::List<StreamWaiter*>::Iterator it = m_waiters.Begin(); it != m_waiters.End(); ++it)
+		{
+			waiters.AddLast(*it);
+		}
+		m_waiters.Clear();
+	}
+	for (xnl::List<StreamWaiter*>::Iterator it = waiters.Begin(); it != waiters.End(); ++it)
+	{
+		(*it)->notifyStreamDestroyed(this);
+	}
+
     // Detach all recorders from this stream.
     xnl::LockGuard< Recorders > guard(m_recorders);
     while (m_recorders.Begin() != m_recorders.End())
@@ -120,6 +147,11 @@ OniStatus VideoStream::start()
 	{
 		m_pFrameHolder->clear();
 
+		// Take frames before the driver starts streaming - it may push the first ones right away (a file device
+		// in lockstep mode would otherwise play on, as no one holds them).
+		m_started = TRUE;
+		m_pFrameHolder->setStreamEnabled(this, m_started);
+
 		xnl::AutoCSLocker lock(m_pSensor->m_refCountCS);
 		if (m_pSensor->m_startedStreamCount == 0)
 		{
@@ -129,6 +161,8 @@ OniStatus VideoStream::start()
 			OniStatus rc = m_driverHandler.streamStart(m_pSensor->streamHandle());
 			if (rc != ONI_STATUS_OK)
 			{
+				m_started = FALSE;
+				m_pFrameHolder->setStreamEnabled(this, m_started);
 				return rc;
 			}
 
@@ -136,9 +170,6 @@ OniStatus VideoStream::start()
 		}
 
 		++m_pSensor->m_startedStreamCount;
-
-		m_pFrameHolder->setStreamEnabled(this, m_started);
-		m_started = TRUE;
 	}
 
 	return ONI_STATUS_OK;
@@ -200,6 +231,19 @@ OniStatus VideoStream::setProperty(int propertyId, const void* data, int dataSiz
 		return ONI_STATUS_OUT_OF_FLOW;
 	}
 
+	if (propertyId == ONI_STREAM_PROPERTY_FRAME_BUFFER_POOL_DEPTH)
+	{
+		if (dataSize != sizeof(int) || *(const int*)data < 0)
+		{
+			m_errorLogger.Append("Stream setProperty(%d): invalid frame buffer pool depth\n", propertyId);
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		// takes effect on next stream start
+		m_pSensor->setFrameBufferPoolDepth(*(const int*)data);
+		return ONI_STATUS_OK;
+	}
+
 	OniStatus rc = m_driverHandler.streamSetProperty(m_pSensor->streamHandle(), propertyId, data, dataSize);
 	if (rc != ONI_STATUS_OK)
 	{
@@ -216,6 +260,18 @@ OniStatus VideoStream::setProperty(int propertyId, const void* data, int dataSiz
 }
 OniStatus VideoStream::getProperty(int propertyId, void* data, int* pDataSize)
 {
+	if (propertyId == ONI_STREAM_PROPERTY_FRAME_BUFFER_POOL_DEPTH)
+	{
+		if (*pDataSize != sizeof(int))
+		{
+			m_errorLogger.Append("Stream getProperty(%d): bad data size\n", propertyId);
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		*(int*)data = m_pSensor->getFrameBufferPoolDepth();
+		return ONI_STATUS_OK;
+	}
+
 	OniStatus rc = m_driverHandler.streamGetProperty(m_pSensor->streamHandle(), propertyId, data, pDataSize);
 	if (rc != ONI_STATUS_OK)
 	{
@@ -225,6 +281,11 @@ OniStatus VideoStream::getProperty(int propertyId, void* data, int* pDataSize)
 }
 OniBool VideoStream::isPropertySupported(int propertyId)
 {
+	if (propertyId == ONI_STREAM_PROPERTY_FRAME_BUFFER_POOL_DEPTH)
+	{
+		return TRUE;
+	}
+
 	return m_driverHandler.streamIsPropertySupported(m_pSensor->streamHandle(), propertyId);
 }
 void VideoStream::notifyAllProperties()
@@ -343,12 +404,34 @@ void VideoStream::raiseNewFrameEvent()
 {
 	xnOSSetEvent(m_newFrameInternalEvent);
 	xnOSSetEvent(m_newFrameInternalEventForFrameHolder);
-	m_newFrameCallback(m_newFrameCookie);
+
+	xnl::AutoCSLocker lock(m_waitersCS);
+	for (xnl::List<StreamWaiter*>::Iterator it = m_waiters.Begin(); it != m_waiters.End(); ++it)
+	{
+		(*it)->notifyNewFrame(this);
+	}
+}
+
+void VideoStream::addWaiter(StreamWaiter* pWaiter)
+{
+	xnl::AutoCSLocker lock(m_waitersCS);
+	m_waiters.AddLast(pWaiter);
+}
+
+void VideoStream::removeWaiter(StreamWaiter* pWaiter)
+{
+	xnl::AutoCSLocker lock(m_waitersCS);
+	m_waiters.Remove(pWaiter);
 }
 
-XnStatus VideoStream::waitForNewFrameEvent()
+XnStatus VideoStream::waitForNewFrameEvent(XnUInt32 nMilliseconds)
 {
-	return xnOSWaitEvent(m_newFrameInternalEventForFrameHolder, XN_WAIT_INFINITE);
+	return xnOSWaitEvent(m_newFrameInternalEventForFrameHolder, nMilliseconds);
+}
+
+void VideoStream::resetNewFrameEvent()
+{
+	xnOSResetEvent(m_newFrameInternalEventForFrameHolder);
 }
 
 Device& VideoStream::getDevice()
@@ -444,6 +527,193 @@ void VideoStream::refreshWorldConversionCache()
 	m_worldConvertCache.halfResY = m_worldConvertCache.resolutionY / 2;
 	m_worldConvertCache.coeffX = m_worldConvertCache.resolutionX / m_worldConvertCache.xzFactor;
 	m_worldConvertCache.coeffY = m_worldConvertCache.resolutionY / m_worldConvertCache.yzFactor;
+
+	xnl::AutoCSLocker lock(m_worldConvertCS);
+	if (m_worldColumnFactors.SetSize(XN_MAX(videoMode.resolutionX, 0)) != XN_STATUS_OK ||
+		m_worldRowFactors.SetSize(XN_MAX(videoMode.resolutionY, 0)) != XN_STATUS_OK)
+	{
+		m_worldColumnFactors.Clear();
+		m_worldRowFactors.Clear();
+		return;
+	}
+
+	// same math as convertDepthToWorldCoordinates(), with the Z-independent part done once per column/row
+	for (int x = 0; x < videoMode.resolutionX; ++x)
+	{
+		m_worldColumnFactors[x] = ((float)x / m_worldConvertCache.resolutionX - .5f) * m_worldConvertCache.xzFactor;
+	}
+	for (int y = 0; y < videoMode.resolutionY; ++y)
+	{
+		m_worldRowFactors[y] = (.5f - (float)y / m_worldConvertCache.resolutionY) * m_worldConvertCache.yzFactor;
+	}
+}
+
+namespace
+{
+
+struct DepthFrameToWorldJob
+{
+	const OniDepthPixel* pDepth;	// first converted pixel
+	int depthStride;				// in pixels
+	const float* pColumnFactors;	// factor of first converted column
+	const float* pRowFactors;		// factor of first converted row
+	int width;						// output points per row
+	int height;						// output rows
+	int step;
+	float* pWorld;
+	int rowsPerTask;
+};
+
+void convertDepthRowToWorld(const OniDepthPixel* pDepth, const float* pColumnFactors, float rowFactor, int width, int step, float* pWorld)
+{
+	int x = 0;
+
+#ifdef XN_WORLD_CONVERT_SSE2
+	if (step == 1)
+	{
+		const __m128 rowFactor4 = _mm_set1_ps(rowFactor);
+		const __m128i zero = _mm_setzero_si128();
+
+		for (; x + 4 <= width; x += 4, pWorld += 12)
+		{
+			__m128i depth16 = _mm_loadl_epi64((const __m128i*)(pDepth + x));
+			__m128 z = _mm_cvtepi32_ps(_mm_unpacklo_epi16(depth16, zero));
+			__m128 wx = _mm_mul_ps(_mm_loadu_ps(pColumnFactors + x), z);
+			__m128 wy = _mm_mul_ps(rowFactor4, z);
+
+			// interleave (x0..x3, y0..y3, z0..z3) into x0 y0 z0 x1 | y1 z1 x2 y2 | z2 x3 y3 z3
+			__m128 xyLow = _mm_unpacklo_ps(wx, wy);
+			__m128 xyHigh = _mm_unpackhi_ps(wx, wy);
+			__m128 z0x1 = _mm_shuffle_ps(z, wx, _MM_SHUFFLE(1, 1, 0, 0));
+			__m128 y1z1 = _mm_shuffle_ps(wy, z, _MM_SHUFFLE(1, 1, 1, 1));
+			__m128 z2x3 = _mm_shuffle_ps(z, wx, _MM_SHUFFLE(3, 3, 2, 2));
+			__m128 y3z3 = _mm_shuffle_ps(wy, z, _MM_SHUFFLE(3, 3, 3, 3));
+
+			_mm_storeu_ps(pWorld, _mm_shuffle_ps(xyLow, z0x1, _MM_SHUFFLE(2, 0, 1, 0)));
+			_mm_storeu_ps(pWorld + 4, _mm_shuffle_ps(y1z1, xyHigh, _MM_SHUFFLE(1, 0, 2, 0)));
+			_mm_storeu_ps(pWorld + 8, _mm_shuffle_ps(z2x3, y3z3, _MM_SHUFFLE(2, 0, 2, 0)));
+		}
+	}
+#endif
+
+	for (; x < width; ++x, pWorld += 3)
+	{
+		float z = (float)pDepth[x * step];
+		pWorld[0] = pColumnFactors[x * step] * z;
+		pWorld[1] = rowFactor * z;
+		pWorld[2] = z;
+	}
+}
+
+}
+
+void XN_CALLBACK_TYPE VideoStream::convertDepthFrameToWorldTask(XnUInt32 nTask, void* pCookie)
+{
+	const DepthFrameToWorldJob& job = *(const DepthFrameToWorldJob*)pCookie;
+
+	int firstRow = nTask * job.rowsPerTask;
+	int lastRow = XN_MIN(firstRow + job.rowsPerTask, job.height);
+
+	for (int y = firstRow; y < lastRow; ++y)
+	{
+		convertDepthRowToWorld(job.pDepth + y * job.step * job.depthStride, job.pColumnFactors, job.pRowFactors[y * job.step],
+			job.width, job.step, job.pWorld + y * job.width * 3);
+	}
+}
+
+OniStatus VideoStream::convertDepthFrameToWorldCoordinates(const OniFrame* pFrame, const OniCropping* pRegion, int step, float* pWorld)
+{
+	if (m_pSensorInfo->sensorType != ONI_SENSOR_DEPTH)
+	{
+		m_errorLogger.Append("convertDepthFrameToWorldCoordinates: Stream is not from DEPTH\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (pFrame == NULL || pWorld == NULL || step < 1)
+	{
+		m_errorLogger.Append("convertDepthFrameToWorldCoordinates: Bad parameter\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	if (pFrame->videoMode.pixelFormat != ONI_PIXEL_FORMAT_DEPTH_1_MM && pFrame->videoMode.pixelFormat != ONI_PIXEL_FORMAT_DEPTH_100_UM)
+	{
+		m_errorLogger.Append("convertDepthFrameToWorldCoordinates: Frame is not a depth map\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	// region, in frame pixels
+	int originX = 0;
+	int originY = 0;
+	int width = pFrame->width;
+	int height = pFrame->height;
+	if (pRegion != NULL && pRegion->enabled)
+	{
+		originX = pRegion->originX;
+		originY = pRegion->originY;
+		width = pRegion->width;
+		height = pRegion->height;
+	}
+
+	if (originX < 0 || originY < 0 || width < 0 || height < 0 ||
+		originX + width > pFrame->width || originY + height > pFrame->height)
+	{
+		m_errorLogger.Append("convertDepthFrameToWorldCoordinates: Region is outside of the frame\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	// frame pixels are relative to the cropping origin, world conversion is relative to the full resolution
+	int depthX = originX + (pFrame->croppingEnabled ? pFrame->cropOriginX : 0);
+	int depthY = originY + (pFrame->croppingEnabled ? pFrame->cropOriginY : 0);
+
+	xnl::AutoCSLocker lock(m_worldConvertCS);
+
+	if (depthX + width > (int)m_worldColumnFactors.GetSize() || depthY + height > (int)m_worldRowFactors.GetSize())
+	{
+		m_errorLogger.Append("convertDepthFrameToWorldCoordinates: Frame does not match the stream's video mode\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	DepthFrameToWorldJob job;
+	job.depthStride = pFrame->stride / sizeof(OniDepthPixel);
+	job.pDepth = (const OniDepthPixel*)pFrame->data + originY * job.depthStride + originX;
+	job.pColumnFactors = m_worldColumnFactors.GetData() + depthX;
+	job.pRowFactors = m_worldRowFactors.GetData() + depthY;
+	job.width = (width + step - 1) / step;
+	job.height = (height + step - 1) / step;
+	job.step = step;
+	job.pWorld = pWorld;
+	job.rowsPerTask = job.height;
+
+	if (job.width * job.height >= XN_WORLD_CONVERT_MIN_PARALLEL_POINTS)
+	{
+		if (!m_worldConvertWorkersStarted)
+		{
+			// if starting the workers fails, the pool runs everything on this thread
+			m_worldConvertWorkers.Init(XN_MIN(xnOSGetProcessorCount(), (XnUInt32)XN_WORLD_CONVERT_MAX_THREADS));
+			m_worldConvertWorkersStarted = TRUE;
+		}
+
+		// a few tasks per thread, so a slow thread does not hold up the whole frame
+		XnUInt32 nTasks = m_worldConvertWorkers.GetThreadCount() * 4;
+		job.rowsPerTask = (job.height + nTasks - 1) / nTasks;
+	}
+
+	if (job.rowsPerTask == 0)
+	{
+		return ONI_STATUS_OK;
+	}
+
+	XnUInt32 nTasks = (job.height + job.rowsPerTask - 1) / job.rowsPerTask;
+	if (nTasks == 1)
+	{
+		convertDepthFrameToWorldTask(0, &job);
+	}
+	else
+	{
+		m_worldConvertWorkers.Run(nTasks, convertDepthFrameToWorldTask, &job);
+	}
+
+	return ONI_STATUS_OK;
 }
 
 OniStatus VideoStream::convertDepthToColorCoordinates(VideoStream* colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY)
@@ -462,6 +732,63 @@ OniStatus VideoStream::convertDepthToColorCoordinates(VideoStream* colorStream,
 	return m_driverHandler.convertDepthPointToColor(m_pSensor->streamHandle(), colorStream->m_pSensor->streamHandle(), depthX, depthY, depthZ, pColorX, pColorY);
 }
 
+OniStatus VideoStream::convertDepthPointsToColorCoordinates(VideoStream* colorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY)
+{
+	if (m_pSensorInfo->sensorType != ONI_SENSOR_DEPTH || colorStream->m_pSensorInfo->sensorType != ONI_SENSOR_COLOR)
+	{
+		m_errorLogger.Append("convertDepthPointsToColorCoordinates: Streams are from the wrong sensors (should be DEPTH and COLOR)\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (&m_device != &colorStream->m_device)
+	{
+		m_errorLogger.Append("convertDepthPointsToColorCoordinates: Streams are not from the same device\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (count < 0 || (count > 0 && (pDepthXY == NULL || pDepthZ == NULL || pColorXY == NULL)))
+	{
+		m_errorLogger.Append("convertDepthPointsToColorCoordinates: Bad parameter\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	return m_driverHandler.convertDepthPointsToColor(m_pSensor->streamHandle(), colorStream->m_pSensor->streamHandle(), count, pDepthXY, pDepthZ, pColorXY);
+}
+
+OniStatus VideoStream::convertDepthFrameToColorCoordinates(VideoStream* colorStream, const OniFrame* pFrame, int* pColorXY)
+{
+	if (m_pSensorInfo->sensorType != ONI_SENSOR_DEPTH || colorStream->m_pSensorInfo->sensorType != ONI_SENSOR_COLOR)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: Streams are from the wrong sensors (should be DEPTH and COLOR)\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (&m_device != &colorStream->m_device)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: Streams are not from the same device\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	if (pFrame == NULL || pColorXY == NULL)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: Bad parameter\n");
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	if (pFrame->sensorType != ONI_SENSOR_DEPTH)
+	{
+		m_errorLogger.Append("convertDepthFrameToColorCoordinates: Frame is not a depth map\n");
+		return ONI_STATUS_NOT_SUPPORTED;
+	}
+
+	// frame pixels are relative to the cropping origin
+	int originX = pFrame->croppingEnabled ? pFrame->cropOriginX : 0;
+	int originY = pFrame->croppingEnabled ? pFrame->cropOriginY : 0;
+
+	return m_driverHandler.convertDepthMapToColor(m_pSensor->streamHandle(), colorStream->m_pSensor->streamHandle(),
+		(const OniDepthPixel*)pFrame->data, pFrame->stride, originX, originY, pFrame->width, pFrame->height, pColorXY);
+}
+
 int VideoStream::getRequiredFrameSize()
 {
 	return m_driverHandler.streamGetRequiredFrameSize(m_pSensor->streamHandle());
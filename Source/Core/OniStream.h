@@ -30,12 +30,15 @@
 #include "XnErrorLogger.h"
 #include "XnHash.h"
 #include "XnLockable.h"
+#include "XnArray.h"
+#include "XnWorkerPool.h"
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
 class Device;
 class FrameHolder;
 class Recorder;
+class StreamWaiter;
 
 class VideoStream
 {
@@ -43,10 +46,6 @@ public:
 	VideoStream(Sensor* pSensor, const OniSensorInfo* pSensorInfo, Device& device, const DriverHandler& driverHandler, FrameManager& frameManager, xnl::ErrorLogger& errorLogger);
 	virtual ~VideoStream();
 
-	typedef void (XN_CALLBACK_TYPE* NewFrameFuncPtr)(void* pCookie);
-
-	void setNewFrameCallback(NewFrameFuncPtr callback, void* pCookie) { m_newFrameCallback = callback; m_newFrameCookie = pCookie; }
-
 	OniStatus start();
 	void stop();
 	OniBool isStarted();
@@ -77,7 +76,11 @@ public:
 	FrameHolder* getFrameHolder();
 
 	void raiseNewFrameEvent();
-	XnStatus waitForNewFrameEvent();
+	XnStatus waitForNewFrameEvent(XnUInt32 nMilliseconds = XN_WAIT_INFINITE);
+	void resetNewFrameEvent();
+
+	void addWaiter(StreamWaiter* pWaiter);
+	void removeWaiter(StreamWaiter* pWaiter);
 
     OniStatus addRecorder(Recorder& aRecorder);
     OniStatus removeRecorder(Recorder& aRecorder);
@@ -85,8 +88,11 @@ public:
 	OniStatus setFrameBufferAllocator(OniFrameAllocBufferCallback alloc, OniFrameFreeBufferCallback free, void* pCookie);
 
 	OniStatus convertDepthToWorldCoordinates(float depthX, float depthY, float depthZ, float* pWorldX, float* pWorldY, float* pWorldZ);
+	OniStatus convertDepthFrameToWorldCoordinates(const OniFrame* pFrame, const OniCropping* pRegion, int step, float* pWorld);
 	OniStatus convertWorldToDepthCoordinates(float worldX, float worldY, float worldZ, float* pDepthX, float* pDepthY, float* pDepthZ);
 	OniStatus convertDepthToColorCoordinates(VideoStream* colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
+	OniStatus convertDepthPointsToColorCoordinates(VideoStream* colorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY);
+	OniStatus convertDepthFrameToColorCoordinates(VideoStream* colorStream, const OniFrame* pFrame, int* pColorXY);
 
 	int getRequiredFrameSize();
 
@@ -115,8 +121,11 @@ private:
 
 	void refreshWorldConversionCache();
 
-	NewFrameFuncPtr m_newFrameCallback;
-	void* m_newFrameCookie;
+	static void XN_CALLBACK_TYPE convertDepthFrameToWorldTask(XnUInt32 nTask, void* pCookie);
+
+	// threads waiting on this stream (see StreamWaiter)
+	xnl::CriticalSection m_waitersCS;
+	xnl::List<StreamWaiter*> m_waiters;
 
 	Device& m_device;
 	const DriverHandler& m_driverHandler;
@@ -143,6 +152,14 @@ private:
 		int halfResX;
 		int halfResY;
 	} m_worldConvertCache;
+
+	// Per-column normalized X and per-row normalized Y, already multiplied by the FOV factors,
+	// so a whole frame can be converted with one multiplication per coordinate.
+	xnl::Array<float> m_worldColumnFactors;
+	xnl::Array<float> m_worldRowFactors;
+	xnl::CriticalSection m_worldConvertCS;
+	xnl::WorkerPool m_worldConvertWorkers;
+	XnBool m_worldConvertWorkersStarted;
 };
 
 ONI_NAMESPACE_IMPLEMENTATION_END
@@ -41,23 +41,42 @@ OniStatus StreamFrameHolder::readFrame(VideoStream* pStream, OniFrame** pFrame)
 		return ONI_STATUS_BAD_PARAMETER;
 	}
 
-	// Make sure frame holder is enabled.
-	if (!m_enabled)
+	for (;;)
 	{
-		*pFrame = NULL;
-		return ONI_STATUS_ERROR;
+		// Make sure frame holder is enabled.
+		if (!m_enabled)
+		{
+			*pFrame = NULL;
+			return ONI_STATUS_ERROR;
+		}
+
+		// If frame already exists, wait() will return immidiately.
+		m_pStream->waitForNewFrameEvent();
+
+		// Return the last frame and set it to NULL.
+		lock();
+		*pFrame = takeFrame(pStream);
+		unlock();
+
+		// The event may outlive the frame it was raised for (if it was taken some other way), so wait again.
+		if (*pFrame != NULL)
+		{
+			return ONI_STATUS_OK;
+		}
 	}
+}
 
-	// If frame already exists, wait() will return immidiately.
-	m_pStream->waitForNewFrameEvent();
+OniFrame* StreamFrameHolder::takeFrame(VideoStream* pStream)
+{
+	// Verify called with relevant stream, and that frame holder is enabled.
+	if (pStream != m_pStream || !m_enabled)
+	{
+		return NULL;
+	}
 
-	// Return the last frame and set it to NULL.
-	lock();
-	*pFrame = m_pLastFrame;
+	OniFrame* pFrame = m_pLastFrame;
 	m_pLastFrame = NULL;
-	unlock();
-
-	return ONI_STATUS_OK;
+	return pFrame;
 }
 
 OniStatus StreamFrameHolder::processNewFrame(VideoStream* pStream, OniFrame* pFrame)
@@ -41,6 +41,9 @@ public:
 	// Get the next frame belonging to a stream.
 	virtual OniStatus readFrame(VideoStream* pStream, OniFrame** pFrame);
 
+	// Take the next frame belonging to a stream, or NULL if none is available.
+	virtual OniFrame* takeFrame(VideoStream* pStream);
+
 	// Process a newly received frame.
 	virtual OniStatus processNewFrame(VideoStream* pStream, OniFrame* pFrame);
 	
@@ -0,0 +1,315 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "OniStreamWaiter.h"
+#include "OniContext.h"
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+StreamWaiter::StreamWaiter() : m_hEvent(NULL), m_waitedValid(FALSE)
+{
+	xnOSCreateEvent(&m_hEvent, FALSE);
+}
+
+StreamWaiter::~StreamWaiter()
+{
+	unregisterAllStreams();
+	xnOSCloseEvent(&m_hEvent);
+}
+
+OniStatus StreamWaiter::wait(OniStreamHandle* pStreams, int streamCount, int* pStreamIndex, int timeout)
+{
+	VideoStream* pSingleStream = NULL;
+	Device* pSingleDevice = NULL;
+	Device** pDevices = NULL;
+	int deviceCount = 0;
+
+	if (streamCount == 1)
+	{
+		// Waiting on a single stream (readFrame() does that). Don't replace the waited set for that, as it is
+		// usually followed by another wait on the full set.
+		if (pStreams[0] == NULL)
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		pSingleStream = pStreams[0]->pStream;
+		registerStream(pSingleStream, -1);
+		pSingleDevice = &pSingleStream->getDevice();
+		pDevices = &pSingleDevice;
+		deviceCount = 1;
+	}
+	else
+	{
+		refreshWaitedStreams(pStreams, streamCount);
+		pDevices = m_waitedDevices.GetData();
+		deviceCount = m_waitedDevices.GetSize();
+	}
+
+	int oldestIndex = -1;
+
+	XnUInt64 passedTime;
+	XnOSTimer workTimer;
+	XnUInt32 timeToWait = timeout;
+	xnOSStartTimer(&workTimer);
+
+	do
+	{
+		if (pSingleStream != NULL)
+		{
+			XnUInt64 timestamp;
+			if (hasFrame(pSingleStream, &timestamp))
+			{
+				oldestIndex = 0;
+			}
+		}
+		else
+		{
+			oldestIndex = findOldestReadyStream();
+		}
+
+		if (oldestIndex != -1)
+		{
+			*pStreamIndex = oldestIndex;
+			break;
+		}
+
+		// 'Poke' the driver to attempt to receive more frames.
+		triggerDevices(pDevices, deviceCount);
+
+		if (timeout != ONI_TIMEOUT_FOREVER)
+		{
+			xnOSQueryTimer(workTimer, &passedTime);
+			if ((int)passedTime < timeout)
+				timeToWait = timeout - (int)passedTime;
+			else
+				timeToWait = 0;
+		}
+	} while (XN_STATUS_OK == xnOSWaitEvent(m_hEvent, timeToWait));
+
+	xnOSStopTimer(&workTimer);
+
+	return (oldestIndex != -1) ? ONI_STATUS_OK : ONI_STATUS_TIME_OUT;
+}
+
+void StreamWaiter::notifyNewFrame(VideoStream* pStream)
+{
+	m_cs.Lock();
+	StreamEntry* pEntry = NULL;
+	if (m_streams.Get(pStream, pEntry) == XN_STATUS_OK && !pEntry->queued)
+	{
+		pEntry->queued = TRUE;
+		m_ready.AddLast(pStream);
+	}
+	m_cs.Unlock();
+
+	xnOSSetEvent(m_hEvent);
+}
+
+void StreamWaiter::notifyStreamDestroyed(VideoStream* pStream)
+{
+	// if we're unregistering from this stream right now, let us finish before it goes away
+	xnl::AutoCSLocker unregisterLock(m_unregisterCS);
+	xnl::AutoCSLocker lock(m_cs);
+	if (m_streams.Remove(pStream) == XN_STATUS_OK)
+	{
+		m_ready.Remove(pStream);
+		m_waitedValid = FALSE;
+	}
+}
+
+void StreamWaiter::refreshWaitedStreams(OniStreamHandle* pStreams, int streamCount)
+{
+	if (m_waitedValid && 
+		(int)m_waitedHandles.GetSize() == streamCount && 
+		xnOSMemCmp(m_waitedHandles.GetData(), pStreams, streamCount * sizeof(OniStreamHandle)) == 0)
+	{
+		// same set as last time. We're already registered.
+		return;
+	}
+
+	unregisterAllStreams();
+
+	m_waitedHandles.SetData(pStreams, streamCount);
+	m_waitedDevices.Clear();
+
+	for (int i = 0; i < streamCount; ++i)
+	{
+		if (pStreams[i] == NULL)
+		{
+			continue;
+		}
+
+		VideoStream* pStream = pStreams[i]->pStream;
+		registerStream(pStream, i);
+
+		// Add the device, if not already in the list.
+		Device* pDevice = &pStream->getDevice();
+		bool found = false;
+		for (XnUInt32 j = 0; j < m_waitedDevices.GetSize(); ++j)
+		{
+			if (m_waitedDevices[j] == pDevice)
+			{
+				found = true;
+				break;
+			}
+		}
+
+		if (!found)
+		{
+			m_waitedDevices.AddLast(pDevice);
+		}
+	}
+
+	m_waitedValid = TRUE;
+}
+
+void StreamWaiter::registerStream(VideoStream* pStream, int index)
+{
+	{
+		xnl::AutoCSLocker lock(m_cs);
+		StreamEntry* pEntry = NULL;
+		if (m_streams.Get(pStream, pEntry) == XN_STATUS_OK)
+		{
+			// already registered
+			if (index != -1)
+			{
+				pEntry->index = index;
+			}
+			return;
+		}
+
+		// stream might already have a frame, so have it checked on first wait
+		StreamEntry entry;
+		entry.index = index;
+		entry.queued = TRUE;
+		m_streams.Set(pStream, entry);
+		m_ready.AddLast(pStream);
+	}
+
+	pStream->addWaiter(this);
+}
+
+void StreamWaiter::unregisterAllStreams()
+{
+	// streams being destroyed wait on this lock (see notifyStreamDestroyed()), so the ones copied below stay alive
+	xnl::AutoCSLocker unregisterLock(m_unregisterCS);
+
+	xnl::Array<VideoStream*> streams;
+
+	{
+		xnl::AutoCSLocker lock(m_cs);
+		for (StreamEntries::Iterator it = m_streams.Begin(); it != m_streams.End(); ++it)
+		{
+			streams.AddLast(it->Key());
+		}
+		m_streams.Clear();
+		m_ready.Clear();
+		m_waitedValid = FALSE;
+	}
+
+	// NOTE: don't call streams while holding our lock. Streams call us while holding theirs.
+	for (XnUInt32 i = 0; i < streams.GetSize(); ++i)
+	{
+		streams[i]->removeWaiter(this);
+	}
+}
+
+void StreamWaiter::queueStream(VideoStream* pStream)
+{
+	xnl::AutoCSLocker lock(m_cs);
+	StreamEntry* pEntry = NULL;
+	if (m_streams.Get(pStream, pEntry) == XN_STATUS_OK && !pEntry->queued)
+	{
+		pEntry->queued = TRUE;
+		m_ready.AddLast(pStream);
+	}
+}
+
+int StreamWaiter::findOldestReadyStream()
+{
+	// Take the whole ready list. Streams that still have a frame are queued again, so a frame that arrives while
+	// we check can't be missed.
+	m_candidates.Clear();
+	{
+		xnl::AutoCSLocker lock(m_cs);
+		for (xnl::List<VideoStream*>::Iterator it = m_ready.Begin(); it != m_ready.End(); ++it)
+		{
+			StreamEntry* pEntry = NULL;
+			if (m_streams.Get(*it, pEntry) == XN_STATUS_OK)
+			{
+				pEntry->queued = FALSE;
+				if (pEntry->index != -1)
+				{
+					ReadyStream candidate;
+					candidate.pStream = *it;
+					candidate.index = pEntry->index;
+					m_candidates.AddLast(candidate);
+				}
+			}
+		}
+		m_ready.Clear();
+	}
+
+	XnUInt64 oldestTimestamp = XN_MAX_UINT64;
+	int oldestIndex = -1;
+
+	for (XnUInt32 i = 0; i < m_candidates.GetSize(); ++i)
+	{
+		XnUInt64 timestamp;
+		if (!hasFrame(m_candidates[i].pStream, &timestamp))
+		{
+			continue;
+		}
+
+		queueStream(m_candidates[i].pStream);
+
+		if (timestamp < oldestTimestamp || (timestamp == oldestTimestamp && m_candidates[i].index < oldestIndex))
+		{
+			oldestTimestamp = timestamp;
+			oldestIndex = m_candidates[i].index;
+		}
+	}
+
+	return oldestIndex;
+}
+
+XnBool StreamWaiter::hasFrame(VideoStream* pStream, XnUInt64* pTimestamp)
+{
+	pStream->lockFrame();
+	OniFrame* pFrame = pStream->peekFrame();
+	if (pFrame != NULL)
+	{
+		*pTimestamp = pFrame->timestamp;
+	}
+	pStream->unlockFrame();
+
+	return (pFrame != NULL);
+}
+
+void StreamWaiter::triggerDevices(Device** pDevices, int deviceCount)
+{
+	for (int i = 0; i < deviceCount; ++i)
+	{
+		pDevices[i]->tryManualTrigger();
+	}
+}
+
+ONI_NAMESPACE_IMPLEMENTATION_END
@@ -0,0 +1,116 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _ONI_IMPL_STREAM_WAITER_H_
+#define _ONI_IMPL_STREAM_WAITER_H_
+
+#include "OniCommon.h"
+#include "OniCTypes.h"
+#include <XnOSCpp.h>
+#include <XnArray.h>
+#include <XnList.h>
+#include <XnHash.h>
+
+ONI_NAMESPACE_IMPLEMENTATION_BEGIN
+
+class VideoStream;
+class Device;
+
+/**
+* Waits on a set of streams on behalf of a single thread.
+*
+* The waiter registers itself with the streams it waits on, and streams report to it when a new frame arrives.
+* Only streams that reported a frame are examined on wakeup, so a wait costs O(ready streams). Registration is
+* kept between calls, and is only redone when the thread waits on a different set of streams.
+*/
+class StreamWaiter
+{
+public:
+	StreamWaiter();
+	~StreamWaiter();
+
+	OniStatus wait(OniStreamHandle* pStreams, int streamCount, int* pStreamIndex, int timeout);
+
+	// Called by streams.
+	void notifyNewFrame(VideoStream* pStream);
+	void notifyStreamDestroyed(VideoStream* pStream);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(StreamWaiter);
+
+	struct StreamEntry
+	{
+		int index; // index in the waited set, or -1 if not a member of it
+		XnBool queued; // TRUE if stream is in the ready list
+	};
+
+	class StreamKeyManager
+	{
+	public:
+		static xnl::HashCode Hash(VideoStream* const& key)
+		{
+			// objects are allocated aligned, so skip the low bits
+			XnSizeT value = (XnSizeT)key;
+			return (xnl::HashCode)((value >> 4) ^ (value >> 12));
+		}
+		static XnInt32 Compare(VideoStream* const& key1, VideoStream* const& key2)
+		{
+			return (key1 == key2) ? 0 : (key1 < key2 ? -1 : 1);
+		}
+	};
+
+	typedef xnl::Hash<VideoStream*, StreamEntry, StreamKeyManager> StreamEntries;
+
+	void refreshWaitedStreams(OniStreamHandle* pStreams, int streamCount);
+	void registerStream(VideoStream* pStream, int index);
+	void unregisterAllStreams();
+	void queueStream(VideoStream* pStream);
+
+	int findOldestReadyStream();
+	XnBool hasFrame(VideoStream* pStream, XnUInt64* pTimestamp);
+	void triggerDevices(Device** pDevices, int deviceCount);
+
+	XN_EVENT_HANDLE m_hEvent;
+
+	// protects m_streams and m_ready, which are accessed by streams
+	xnl::CriticalSection m_cs;
+	StreamEntries m_streams;
+	xnl::List<VideoStream*> m_ready;
+
+	// held while unregistering from streams. Streams take it when destroyed, without holding their own lock.
+	xnl::CriticalSection m_unregisterCS;
+
+	// the set of streams waited on by the last multi-stream wait
+	xnl::Array<OniStreamHandle> m_waitedHandles;
+	xnl::Array<Device*> m_waitedDevices;
+	XnBool m_waitedValid;
+
+	struct ReadyStream
+	{
+		VideoStream* pStream;
+		int index;
+	};
+
+	xnl::Array<ReadyStream> m_candidates;
+};
+
+ONI_NAMESPACE_IMPLEMENTATION_END
+
+#endif // _ONI_IMPL_STREAM_WAITER_H_
@@ -24,11 +24,19 @@
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 	
 // Constructor.
-SyncedStreamsFrameHolder::SyncedStreamsFrameHolder(FrameManager& frameManager, VideoStream** ppStreams, int numStreams) : 
-	FrameHolder(frameManager), m_FrameSyncedStreams(numStreams)
+SyncedStreamsFrameHolder::SyncedStreamsFrameHolder(FrameManager& frameManager, VideoStream** ppStreams, int numStreams, const FrameSyncSettings& settings) : 
+	FrameHolder(frameManager), m_FrameSyncedStreams(numStreams), m_settings(settings), m_lastSetSize(0)
 {
+	if (m_settings.ringSize < 1)
+	{
+		m_settings.ringSize = 1;
+	}
+
 	m_FrameSyncedStreams.SetSize(numStreams);
 	m_FrameSyncedStreams.Zero();
+	m_ring.SetSize(numStreams * m_settings.ringSize);
+	m_ring.Zero();
+	m_chosen.SetSize(numStreams);
 
 	lock();
 
@@ -50,51 +58,91 @@ SyncedStreamsFrameHolder::~SyncedStreamsFrameHolder()
 
 // Get the next frame belonging to a stream.
 OniStatus SyncedStreamsFrameHolder::readFrame(VideoStream* pStream, OniFrame** pFrame)
+{
+	// A partial set becomes due even if no frame arrives (the streams may have stopped), so don't wait past the deadline.
+	XnUInt32 waitTimeout = XN_WAIT_INFINITE;
+	if (m_settings.mode == FRAME_SYNC_BY_TIMESTAMP && m_settings.deadlineUs != 0)
+	{
+		waitTimeout = (XnUInt32)XN_MIN((m_settings.deadlineUs + 999) / 1000, (XnUInt64)XN_WAIT_INFINITE - 1);
+	}
+
+	for (;;)
+	{
+		// Make sure frame holder is enabled (it may have been disabled while waiting).
+		if (!m_enabled)
+		{
+			*pFrame = NULL;
+			return ONI_STATUS_ERROR;
+		}
+
+		lock();
+		*pFrame = takeFrame(pStream);
+		unlock();
+
+		if (*pFrame != NULL)
+		{
+			return ONI_STATUS_OK;
+		}
+
+		// No frames exist, wait for a new frame event and try again.
+		pStream->waitForNewFrameEvent(waitTimeout);
+	}
+}
+
+// Take the next frame belonging to a stream, or NULL if none is available.
+OniFrame* SyncedStreamsFrameHolder::takeFrame(VideoStream* pStream)
 {
 	// Make sure frame holder is enabled.
 	if (!m_enabled)
 	{
-		*pFrame = NULL;
-		return ONI_STATUS_ERROR;
+		return NULL;
 	}
 
-	lock();
+	if (m_settings.mode == FRAME_SYNC_BY_TIMESTAMP)
+	{
+		return takeSyncedFrame(pStream);
+	}
+
+	// Make sure the stream has a frame to return.
+	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
+	XnBool frameExists = FALSE;
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (m_FrameSyncedStreams[i].pStream == pStream)
+		{
+			frameExists = (m_FrameSyncedStreams[i].pSyncedFrame != NULL) ||
+							(m_FrameSyncedStreams[i].pLastFrame != NULL);
+			break;
+		}
+	}
+	if (!frameExists)
+	{
+		return NULL;
+	}
 
 	// Parse all the streams.
+	OniFrame* pFrame = NULL;
 	int frameId = (m_FrameSyncedStreams[0].pLastFrame != NULL) ? 
 					m_FrameSyncedStreams[0].pLastFrame->frameIndex : -1;
 	int minSyncedFrameId = -1;
 	XnUInt32 validFrameCount = 0;
 	OniBool syncedFramesExist = FALSE;
-	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
 	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
 	{
 		// Is this the stream frame was received on?
 		if (m_FrameSyncedStreams[i].pStream == pStream)
 		{
-			// If no frames exist, wait for a new frame event.
-			if ((m_FrameSyncedStreams[i].pSyncedFrame == NULL) &&
-				(m_FrameSyncedStreams[i].pLastFrame == NULL))
-			{
-				unlock();
-				pStream->waitForNewFrameEvent();
-					
-				// Algorithm needs to be restarted, so call function again 
-				// NOTE: this is not a real recursion as next call will surely succeed (new frame event received).
-				return readFrame(pStream, pFrame);
-			}
-
 			// Check if synced frame exists.
 			if (m_FrameSyncedStreams[i].pSyncedFrame != NULL)
 			{
 				// Copy frame and clear synced frame.
-				*pFrame = m_FrameSyncedStreams[i].pSyncedFrame;
+				pFrame = m_FrameSyncedStreams[i].pSyncedFrame;
 				m_FrameSyncedStreams[i].pSyncedFrame = NULL;
 			}
 			else // if (m_FameSyncedStreams[i].pLastFrame != NULL)
 			{
 				// Copy frame and clear last frame.
-				*pFrame = m_FrameSyncedStreams[i].pLastFrame;
+				pFrame = m_FrameSyncedStreams[i].pLastFrame;
 				m_FrameSyncedStreams[i].pLastFrame = NULL;
 
 				// Increment valid frame count, to make sure that after invalidation last frames may still be copied to synced.
@@ -120,7 +168,7 @@ OniStatus SyncedStreamsFrameHolder::readFrame(VideoStream* pStream, OniFrame** p
 	}
 
 	// Check if there is are synced frames which have lower ID from the the frame being returned.
-	if ((minSyncedFrameId != -1) && ((*pFrame)->frameIndex != minSyncedFrameId))
+	if ((minSyncedFrameId != -1) && (pFrame->frameIndex != minSyncedFrameId))
 	{
 		// Invalidate the synced frames.
 		for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
@@ -154,9 +202,7 @@ OniStatus SyncedStreamsFrameHolder::readFrame(VideoStream* pStream, OniFrame** p
 		}
 	}
 
-	unlock();
-
-	return ONI_STATUS_OK;
+	return pFrame;
 }
 
 // Process a newly received frame.
@@ -168,6 +214,11 @@ OniStatus SyncedStreamsFrameHolder::processNewFrame(VideoStream* pStream, OniFra
 		return ONI_STATUS_OK;
 	}
 
+	if (m_settings.mode == FRAME_SYNC_BY_TIMESTAMP)
+	{
+		return processNewFrameByTimestamp(pStream, pFrame);
+	}
+
 	lock();
 
 	// Parse all the streams.
@@ -254,6 +305,11 @@ OniFrame* SyncedStreamsFrameHolder::peekFrame(VideoStream* pStream)
 
 	lock();
 
+	if (m_settings.mode == FRAME_SYNC_BY_TIMESTAMP)
+	{
+		latchDueSets();
+	}
+
 	// Parse all the streams.
 	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
 	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
@@ -290,7 +346,9 @@ void SyncedStreamsFrameHolder::clear()
 			m_frameManager.release(m_FrameSyncedStreams[i].pSyncedFrame);
 			m_FrameSyncedStreams[i].pSyncedFrame = NULL;
 		}
+		clearRing(i);
 	}
+	m_lastSetSize = 0;
 
 	unlock();
 }
@@ -324,6 +382,7 @@ void SyncedStreamsFrameHolder::setStreamEnabled(VideoStream* pStream, OniBool en
 					m_frameManager.release(m_FrameSyncedStreams[i].pSyncedFrame);
 					m_FrameSyncedStreams[i].pSyncedFrame = NULL;
 				}
+				clearRing(i);
 			}
 		}
 
@@ -363,4 +422,327 @@ int SyncedStreamsFrameHolder::getNumStreams()
 	return m_FrameSyncedStreams.GetSize();
 }
 
+// Process a newly received frame, when matching frames by timestamp.
+OniStatus SyncedStreamsFrameHolder::processNewFrameByTimestamp(VideoStream* pStream, OniFrame* pFrame)
+{
+	XnUInt64 now;
+	xnOSGetHighResTimeStamp(&now);
+
+	lock();
+
+	// Keep the frame with the recent frames of its stream.
+	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (m_FrameSyncedStreams[i].pStream == pStream)
+		{
+			if (m_FrameSyncedStreams[i].enabled)
+			{
+				pushRingFrame(i, pFrame, now);
+			}
+			break;
+		}
+	}
+
+	// Latch sets for as long as frames can be matched (a slow reader skips to the newest set).
+	while (latchTimestampSet(now))
+		;
+
+	unlock();
+
+	return ONI_STATUS_OK;
+}
+
+// Take the latched frame of a stream (timestamp mode).
+OniFrame* SyncedStreamsFrameHolder::takeSyncedFrame(VideoStream* pStream)
+{
+	latchDueSets();
+
+	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (m_FrameSyncedStreams[i].pStream == pStream)
+		{
+			OniFrame* pFrame = m_FrameSyncedStreams[i].pSyncedFrame;
+			m_FrameSyncedStreams[i].pSyncedFrame = NULL;
+			return pFrame;
+		}
+	}
+
+	return NULL;
+}
+
+SyncedStreamsFrameHolder::RingEntry& SyncedStreamsFrameHolder::ringEntry(XnUInt32 streamIndex, int i)
+{
+	return m_ring[streamIndex * m_settings.ringSize + (m_FrameSyncedStreams[streamIndex].ringFirst + i) % m_settings.ringSize];
+}
+
+void SyncedStreamsFrameHolder::pushRingFrame(XnUInt32 streamIndex, OniFrame* pFrame, XnUInt64 receiveTime)
+{
+	FameSyncedStream& stream = m_FrameSyncedStreams[streamIndex];
+
+	// Ring is full - the oldest frame is dropped.
+	if (stream.ringCount == m_settings.ringSize)
+	{
+		m_frameManager.release(popRingFrame(streamIndex));
+	}
+
+	RingEntry& entry = ringEntry(streamIndex, stream.ringCount);
+	entry.pFrame = pFrame;
+	entry.key = m_settings.useReceiveTime ? receiveTime : pFrame->timestamp;
+	entry.receiveTime = receiveTime;
+	++stream.ringCount;
+
+	m_frameManager.addRef(pFrame);
+}
+
+// Remove the oldest frame of a stream. The caller gets its reference.
+OniFrame* SyncedStreamsFrameHolder::popRingFrame(XnUInt32 streamIndex)
+{
+	FameSyncedStream& stream = m_FrameSyncedStreams[streamIndex];
+	OniFrame* pFrame = ringEntry(streamIndex, 0).pFrame;
+	stream.ringFirst = (stream.ringFirst + 1) % m_settings.ringSize;
+	--stream.ringCount;
+	return pFrame;
+}
+
+// Drop the frames of a stream which are not newer than maxKey. Returns TRUE if any frame was dropped.
+XnBool SyncedStreamsFrameHolder::dropRingFrames(XnUInt32 streamIndex, XnUInt64 maxKey)
+{
+	XnBool dropped = FALSE;
+
+	while (m_FrameSyncedStreams[streamIndex].ringCount > 0 && ringEntry(streamIndex, 0).key <= maxKey)
+	{
+		m_frameManager.release(popRingFrame(streamIndex));
+		dropped = TRUE;
+	}
+
+	return dropped;
+}
+
+void SyncedStreamsFrameHolder::clearRing(XnUInt32 streamIndex)
+{
+	dropRingFrames(streamIndex, XN_MAX_UINT64);
+	m_FrameSyncedStreams[streamIndex].ringFirst = 0;
+}
+
+// Find the frame of a stream nearest to key, within tolerance. Returns its position in the ring, or -1.
+int SyncedStreamsFrameHolder::findNearestRingFrame(XnUInt32 streamIndex, XnUInt64 key, XnUInt64 tolerance)
+{
+	int nearest = -1;
+	XnUInt64 nearestDiff = 0;
+
+	for (int i = 0; i < m_FrameSyncedStreams[streamIndex].ringCount; ++i)
+	{
+		XnUInt64 entryKey = ringEntry(streamIndex, i).key;
+		XnUInt64 diff = (entryKey > key) ? (entryKey - key) : (key - entryKey);
+		if (diff <= tolerance && (nearest == -1 || diff < nearestDiff))
+		{
+			nearest = i;
+			nearestDiff = diff;
+		}
+	}
+
+	return nearest;
+}
+
+// A new set may replace the latched one only if none of its frames was read yet (so readers never get a mix of
+// two sets), or if all of them were.
+XnBool SyncedStreamsFrameHolder::canLatch()
+{
+	XnUInt32 syncedFramesCount = 0;
+	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (m_FrameSyncedStreams[i].pSyncedFrame != NULL)
+		{
+			++syncedFramesCount;
+		}
+	}
+
+	return (syncedFramesCount == 0) || (syncedFramesCount == m_lastSetSize);
+}
+
+// Try to latch a set of frames. Returns TRUE if anything changed (a set was latched, or frames were dropped).
+XnBool SyncedStreamsFrameHolder::latchTimestampSet(XnUInt64 now)
+{
+	if (!canLatch())
+	{
+		return FALSE;
+	}
+
+	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
+
+	// Look for a full set. Newer frames of the stream that is most behind can't exist yet, so its newest frame
+	// is the reference the others are matched to.
+	XnUInt64 reference = XN_MAX_UINT64;
+	XnUInt32 numEnabled = 0;
+	XnBool allHaveFrames = TRUE;
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (!m_FrameSyncedStreams[i].enabled)
+		{
+			continue;
+		}
+
+		++numEnabled;
+		if (m_FrameSyncedStreams[i].ringCount == 0)
+		{
+			allHaveFrames = FALSE;
+			continue;
+		}
+
+		XnUInt64 newest = ringEntry(i, m_FrameSyncedStreams[i].ringCount - 1).key;
+		reference = XN_MIN(reference, newest);
+	}
+
+	if (numEnabled == 0)
+	{
+		return FALSE;
+	}
+
+	if (allHaveFrames)
+	{
+		XnBool matched = TRUE;
+		for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+		{
+			m_chosen[i] = m_FrameSyncedStreams[i].enabled ? findNearestRingFrame(i, reference, m_settings.toleranceUs) : -1;
+			if (m_FrameSyncedStreams[i].enabled && m_chosen[i] == -1)
+			{
+				matched = FALSE;
+			}
+		}
+
+		if (matched)
+		{
+			latch(m_chosen.GetData());
+			return TRUE;
+		}
+
+		// Frames too old to match the reference will never be part of a set.
+		if (reference > m_settings.toleranceUs)
+		{
+			XnBool dropped = FALSE;
+			for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+			{
+				if (dropRingFrames(i, reference - m_settings.toleranceUs - 1))
+				{
+					dropped = TRUE;
+				}
+			}
+
+			if (dropped)
+			{
+				return TRUE;
+			}
+		}
+	}
+
+	// No full set. Release a partial one around the oldest frame, if it waited for too long.
+	if (m_settings.deadlineUs == 0)
+	{
+		return FALSE;
+	}
+
+	int anchor = -1;
+	XnUInt64 oldestReceiveTime = XN_MAX_UINT64;
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (m_FrameSyncedStreams[i].enabled && m_FrameSyncedStreams[i].ringCount > 0 &&
+			ringEntry(i, 0).receiveTime < oldestReceiveTime)
+		{
+			anchor = i;
+			oldestReceiveTime = ringEntry(i, 0).receiveTime;
+		}
+	}
+
+	if (anchor == -1 || now - oldestReceiveTime < m_settings.deadlineUs)
+	{
+		return FALSE;
+	}
+
+	XnUInt64 anchorKey = ringEntry(anchor, 0).key;
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if ((int)i == anchor)
+		{
+			m_chosen[i] = 0;
+		}
+		else
+		{
+			m_chosen[i] = m_FrameSyncedStreams[i].enabled ? findNearestRingFrame(i, anchorKey, m_settings.toleranceUs) : -1;
+		}
+	}
+
+	latch(m_chosen.GetData());
+
+	// Streams missing from the set only have frames too old to be matched up to the anchor.
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (m_chosen[i] == -1)
+		{
+			dropRingFrames(i, anchorKey);
+		}
+	}
+
+	return TRUE;
+}
+
+// Release the partial sets whose deadline passed since the last frame arrived (timestamp mode).
+void SyncedStreamsFrameHolder::latchDueSets()
+{
+	if (m_settings.deadlineUs == 0)
+	{
+		return;
+	}
+
+	XnUInt64 now;
+	xnOSGetHighResTimeStamp(&now);
+
+	while (latchTimestampSet(now))
+		;
+}
+
+// Latch the chosen frame of each stream (-1 for none), dropping the older frames.
+void SyncedStreamsFrameHolder::latch(const int* pChosen)
+{
+	XnUInt32 numFrameSyncStreams = m_FrameSyncedStreams.GetSize();
+
+	// Release any set that wasn't read.
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (m_FrameSyncedStreams[i].pSyncedFrame != NULL)
+		{
+			m_frameManager.release(m_FrameSyncedStreams[i].pSyncedFrame);
+			m_FrameSyncedStreams[i].pSyncedFrame = NULL;
+		}
+	}
+
+	m_lastSetSize = 0;
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (pChosen[i] == -1)
+		{
+			continue;
+		}
+
+		// Older frames are dropped. The ring's reference moves to the synced frame.
+		for (int j = 0; j < pChosen[i]; ++j)
+		{
+			m_frameManager.release(popRingFrame(i));
+		}
+		m_FrameSyncedStreams[i].pSyncedFrame = popRingFrame(i);
+		++m_lastSetSize;
+	}
+
+	// Send the raise event to the streams in the set.
+	for (XnUInt32 i = 0; i < numFrameSyncStreams; ++i)
+	{
+		if (pChosen[i] != -1)
+		{
+			m_FrameSyncedStreams[i].pStream->raiseNewFrameEvent();
+		}
+	}
+}
+
 ONI_NAMESPACE_IMPLEMENTATION_END
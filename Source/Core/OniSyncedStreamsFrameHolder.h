@@ -28,12 +28,30 @@
 
 ONI_NAMESPACE_IMPLEMENTATION_BEGIN
 
+typedef enum
+{
+	// Latch a set only when all the streams have a frame with the same frame index.
+	FRAME_SYNC_BY_FRAME_INDEX = 0,
+	// Latch a set of frames whose timestamps are within a tolerance window of each other.
+	FRAME_SYNC_BY_TIMESTAMP = 1,
+} FrameSyncMode;
+
+// configuration of frame sync groups
+struct FrameSyncSettings
+{
+	FrameSyncMode mode;
+	XnUInt64 toleranceUs; // max timestamp difference between frames of a set (timestamp mode only)
+	XnUInt64 deadlineUs; // time to wait for a full set before a partial one is released (0 - never)
+	int ringSize; // number of recent frames kept per stream (timestamp mode only)
+	XnBool useReceiveTime; // match by host receive time instead of device timestamps (for streams of different devices)
+};
+
 class SyncedStreamsFrameHolder : public FrameHolder
 {
 public:
 
 	// Constructor.
-	SyncedStreamsFrameHolder(FrameManager& frameManager, VideoStream** ppStreams, int numStreams);
+	SyncedStreamsFrameHolder(FrameManager& frameManager, VideoStream** ppStreams, int numStreams, const FrameSyncSettings& settings);
 
 	// Destructor.
 	virtual ~SyncedStreamsFrameHolder();
@@ -41,6 +59,9 @@ public:
 	// Get the next frame belonging to a stream.
 	virtual OniStatus readFrame(VideoStream* pStream, OniFrame** pFrame);
 
+	// Take the next frame belonging to a stream, or NULL if none is available.
+	virtual OniFrame* takeFrame(VideoStream* pStream);
+
 	// Process a newly received frame.
 	virtual OniStatus processNewFrame(VideoStream* pStream, OniFrame* pFrame);
 
@@ -59,7 +80,30 @@ public:
 	// Return number of streams which are members of the stream group.
 	virtual int getNumStreams();
 
+	// Get the settings the group was created with.
+	const FrameSyncSettings& getSettings() const { return m_settings; }
+
 private:
+	typedef struct
+	{
+		OniFrame* pFrame;
+		XnUInt64 key; // the time frames are matched by
+		XnUInt64 receiveTime;
+	} RingEntry;
+
+	// Timestamp mode
+	OniStatus processNewFrameByTimestamp(VideoStream* pStream, OniFrame* pFrame);
+	OniFrame* takeSyncedFrame(VideoStream* pStream);
+	void pushRingFrame(XnUInt32 streamIndex, OniFrame* pFrame, XnUInt64 receiveTime);
+	RingEntry& ringEntry(XnUInt32 streamIndex, int i);
+	OniFrame* popRingFrame(XnUInt32 streamIndex);
+	XnBool dropRingFrames(XnUInt32 streamIndex, XnUInt64 maxKey);
+	void clearRing(XnUInt32 streamIndex);
+	int findNearestRingFrame(XnUInt32 streamIndex, XnUInt64 key, XnUInt64 tolerance);
+	XnBool latchTimestampSet(XnUInt64 now);
+	void latchDueSets();
+	XnBool canLatch();
+	void latch(const int* pChosen);
 
 	typedef struct 
 	{
@@ -75,8 +119,17 @@ private:
 		// 'Latched' frame.
 		OniFrame* pSyncedFrame;
 
+		// Recent frames not synced yet (timestamp mode). Stored in m_ring.
+		int ringFirst;
+		int ringCount;
+
 	} FameSyncedStream;
 	xnl::Array<FameSyncedStream> m_FrameSyncedStreams;
+
+	FrameSyncSettings m_settings;
+	xnl::Array<RingEntry> m_ring;
+	xnl::Array<int> m_chosen;
+	XnUInt32 m_lastSetSize;
 };
 
 ONI_NAMESPACE_IMPLEMENTATION_END
@@ -269,6 +269,12 @@ ONI_C_API OniStatus oniStreamReadFrame(OniStreamHandle stream, OniFrame** pFrame
 	return g_Context.readFrame(stream, pFrame);
 }
 
+ONI_C_API OniStatus oniReadFramesBatch(OniStreamHandle* pStreams, int numStreams, OniFrame** pFrames, int timeout)
+{
+	g_Context.clearErrorLogger();
+	return g_Context.readFramesBatch(pStreams, numStreams, pFrames, timeout);
+}
+
 struct OniNewFrameCookie
 {
 	OniStreamHandle streamHandle;
@@ -424,6 +430,29 @@ ONI_C_API void oniRecorderStop(OniRecorderHandle recorder)
     recorder->pRecorder->stop();
 }
 
+ONI_C_API OniStatus oniRecorderSetQueueLimit(OniRecorderHandle recorder, uint64_t maxQueuedBytes, OniRecorderQueuePolicy policy)
+{
+	g_Context.clearErrorLogger();
+    // Validate parameters.
+    if (NULL == recorder || NULL == recorder->pRecorder)
+    {
+        return ONI_STATUS_BAD_PARAMETER;
+    }
+    return recorder->pRecorder->setQueueLimit(maxQueuedBytes, policy);
+}
+
+ONI_C_API OniStatus oniRecorderGetStats(OniRecorderHandle recorder, OniRecorderStats* pStats)
+{
+	g_Context.clearErrorLogger();
+    // Validate parameters.
+    if (NULL == recorder || NULL == recorder->pRecorder || NULL == pStats)
+    {
+        return ONI_STATUS_BAD_PARAMETER;
+    }
+    recorder->pRecorder->getStats(pStats);
+    return ONI_STATUS_OK;
+}
+
 ONI_C_API OniStatus oniRecorderDestroy(OniRecorderHandle* pRecorder)
 {
 	g_Context.clearErrorLogger();
@@ -502,6 +531,12 @@ ONI_C_API OniStatus oniCoordinateConverterDepthToWorld(OniStreamHandle depthStre
 	return depthStream->pStream->convertDepthToWorldCoordinates(depthX, depthY, depthZ, pWorldX, pWorldY, pWorldZ);
 }
 
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToWorld(OniStreamHandle depthStream, const OniFrame* pFrame, const OniCropping* pRegion, int step, float* pWorld)
+{
+	g_Context.clearErrorLogger();
+	return depthStream->pStream->convertDepthFrameToWorldCoordinates(pFrame, pRegion, step, pWorld);
+}
+
 ONI_C_API OniStatus oniCoordinateConverterWorldToDepth(OniStreamHandle depthStream, float worldX, float worldY, float worldZ, float* pDepthX, float* pDepthY, float* pDepthZ)
 {
 	g_Context.clearErrorLogger();
@@ -514,4 +549,16 @@ ONI_C_API OniStatus oniCoordinateConverterDepthToColor(OniStreamHandle depthStre
 	return depthStream->pStream->convertDepthToColorCoordinates(colorStream->pStream, depthX, depthY, depthZ, pColorX, pColorY);
 }
 
+ONI_C_API OniStatus oniCoordinateConverterDepthPointsToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY)
+{
+	g_Context.clearErrorLogger();
+	return depthStream->pStream->convertDepthPointsToColorCoordinates(colorStream->pStream, count, pDepthXY, pDepthZ, pColorXY);
+}
+
+ONI_C_API OniStatus oniCoordinateConverterDepthFrameToColor(OniStreamHandle depthStream, OniStreamHandle colorStream, const OniFrame* pFrame, int* pColorXY)
+{
+	g_Context.clearErrorLogger();
+	return depthStream->pStream->convertDepthFrameToColorCoordinates(colorStream->pStream, pFrame, pColorXY);
+}
+
 XN_API_EXPORT_INIT()
\ No newline at end of file
@@ -38,6 +38,22 @@ XN_C_API XnStatus DepthUtilsTranslatePixel(DepthUtilsHandle handle, unsigned int
 	}
 	return handle->pDepthUtils->TranslateSinglePixel(x, y, z, *pX, *pY);
 }
+XN_C_API XnStatus DepthUtilsTranslatePixels(DepthUtilsHandle handle, int count, const int* pDepthXY, const unsigned short* pDepthZ, int* pImageXY)
+{
+	if (handle == NULL || handle->pDepthUtils == NULL || count < 0)
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+	return handle->pDepthUtils->TranslatePixels(count, pDepthXY, pDepthZ, pImageXY);
+}
+XN_C_API XnStatus DepthUtilsTranslateDepthMapPixels(DepthUtilsHandle handle, const unsigned short* depthMap, int stride, int originX, int originY, int width, int height, int* pImageXY)
+{
+	if (handle == NULL || handle->pDepthUtils == NULL || stride < 0 || originX < 0 || originY < 0 || width < 0 || height < 0)
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+	return handle->pDepthUtils->TranslateDepthMapPixels(depthMap, stride, originX, originY, width, height, pImageXY);
+}
 XN_C_API XnStatus DepthUtilsTranslateDepthMap(DepthUtilsHandle handle, unsigned short* depth)
 {
 	if (handle == NULL || handle->pDepthUtils == NULL)
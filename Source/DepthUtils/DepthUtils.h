@@ -89,6 +89,10 @@ extern "C"
 
 	int DepthUtilsTranslatePixel(DepthUtilsHandle handle, unsigned int x, unsigned int y, unsigned short z, unsigned int* pX, unsigned int* pY);
 	int DepthUtilsTranslateDepthMap(DepthUtilsHandle handle, unsigned short* depthMap);
+	// Batch versions of DepthUtilsTranslatePixel(). Each result is an (x, y) pair, or (-1, -1) if the pixel has no color counterpart.
+	// For depth maps, stride is in pixels and (originX, originY) are the depth coordinates of depthMap[0].
+	int DepthUtilsTranslatePixels(DepthUtilsHandle handle, int count, const int* pDepthXY, const unsigned short* pDepthZ, int* pImageXY);
+	int DepthUtilsTranslateDepthMapPixels(DepthUtilsHandle handle, const unsigned short* depthMap, int stride, int originX, int originY, int width, int height, int* pImageXY);
 
 	int DepthUtilsSetDepthConfiguration(DepthUtilsHandle handle, int xres, int yres, OniPixelFormat format, int isMirrored);
 	int DepthUtilsSetColorResolution(DepthUtilsHandle handle, int xres, int yres);
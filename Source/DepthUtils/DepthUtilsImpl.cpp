@@ -22,8 +22,12 @@ static void incrementalFitting50(XnInt64 dPrev, XnInt64 ddPrev, XnInt64 dddPrev,
 
 
 DepthUtilsImpl::DepthUtilsImpl() : m_pDepthToShiftTable_QQVGA(NULL), m_pDepthToShiftTable_QVGA(NULL), m_pDepthToShiftTable_VGA(NULL),
-									m_pRegistrationTable_QQVGA(NULL), m_pRegistrationTable_QVGA(NULL), m_pRegistrationTable_VGA(NULL), m_bD2SAlloc(false), m_bInitialized(FALSE)
+									m_pRegistrationTable_QQVGA(NULL), m_pRegistrationTable_QVGA(NULL), m_pRegistrationTable_VGA(NULL), m_pRegTable(NULL), m_bD2SAlloc(false), m_bInitialized(FALSE),
+									m_nBands(0), m_pBandsBuffer(NULL), m_nBandsBufferSize(0), m_pApplyFrame(NULL),
+									m_pImageXTable(NULL), m_nImageXTableSize(0), m_pImageYTable(NULL), m_nImageYTableSize(0), m_nImageYTableAllocated(0), m_nRegXScaleReciprocal(0), m_bImageTablesValid(false)
 {
+	m_depthResolution.x = m_depthResolution.y = 0;
+	m_colorResolution.x = m_colorResolution.y = 0;
 }
 DepthUtilsImpl::~DepthUtilsImpl()
 {
@@ -48,6 +52,9 @@ XnStatus DepthUtilsImpl::Initialize(DepthUtilsSensorCalibrationInfo* pBlob)
 
 	xnOSMemCopy(&m_blob, pBlob, sizeof(DepthUtilsSensorCalibrationInfo));
 
+	// a pool that failed to start simply runs registration on the calling thread
+	m_workers.Init(XN_MIN(xnOSGetProcessorCount(), (XnUInt32)REGISTRATION_BANDS));
+
 	//		m_pDepthToShiftTable = pDepthToShiftTable;
 
 	// allocate table
@@ -109,80 +116,257 @@ XnStatus DepthUtilsImpl::Free()
 		m_bD2SAlloc = FALSE;
 	}
 
+	if (m_pBandsBuffer != NULL)
+	{
+		xnOSFreeAligned(m_pBandsBuffer);
+		m_pBandsBuffer = NULL;
+		m_nBandsBufferSize = 0;
+	}
+	m_nBands = 0;
+	m_pRegTable = NULL;
+
+	if (m_pImageXTable != NULL)
+	{
+		xnOSFreeAligned(m_pImageXTable);
+		m_pImageXTable = NULL;
+	}
+	if (m_pImageYTable != NULL)
+	{
+		xnOSFreeAligned(m_pImageYTable);
+		m_pImageYTable = NULL;
+		m_nImageYTableAllocated = 0;
+	}
+	m_bImageTablesValid = false;
+
 	return (XN_STATUS_OK);
 }
 
-XnStatus DepthUtilsImpl::Apply(unsigned short* pOutput)
+/*
+	Registration scatters each depth pixel to its place in the color image, keeping the closest one
+	when several land on the same place. The frame is split into bands of input lines. Each band
+	scatters into its own buffer, which covers all the output lines its pixels may land on (known from the
+	registration table). Bands are processed in parallel, and then merged, again keeping the closest depth
+	where bands overlap. With a single band, results are the same as scattering directly to the output.
+*/
+
+// Writes a registered pixel (and the ones above and to its left), if it is closer than what's already there
+static inline void RegisterPixel(unsigned short* pOutput, XnUInt32 nArrPos, XnUInt32 nNewX, XnUInt32 nNewY, XnUInt32 nDepthXRes, unsigned short nValue)
 {
-	unsigned short* pTempBuffer;
-	pTempBuffer = (unsigned short*)xnOSCallocAligned(m_depthResolution.x*m_depthResolution.y, sizeof(unsigned short), XN_DEFAULT_MEM_ALIGN);
+	// zero (no depth) wraps around to the largest value, so this is a single comparison
+	if ((unsigned short)(pOutput[nArrPos] - 1) >= nValue)
+	{
+		if ( nNewX > 0 && nNewY > 0 )
+		{
+			pOutput[nArrPos-nDepthXRes] = nValue;
+			pOutput[nArrPos-nDepthXRes-1] = nValue;
+			pOutput[nArrPos-1] = nValue;
+		}
+		else if( nNewY > 0 )
+		{
+			pOutput[nArrPos-nDepthXRes] = nValue;
+		}
+		else if( nNewX > 0 )
+		{
+			pOutput[nArrPos-1] = nValue;
+		}
 
-	unsigned short* pInput = pTempBuffer;
-	memcpy(pInput, pOutput, m_depthResolution.x*m_depthResolution.y*2);
+		pOutput[nArrPos] = nValue;
+	}
+}
 
+void DepthUtilsImpl::ApplyBand(XnUInt32 nBand)
+{
+	RegistrationBand& band = m_aBands[nBand];
+	if (band.nFirstOutputLine > band.nLastOutputLine)
+	{
+		// nothing in this band can be registered
+		return;
+	}
 
-	XnInt16* pRegTable = (XnInt16*)m_pRegTable;
-	XnInt16* pRGBRegDepthToShiftTable = (XnInt16*)m_pDepth2ShiftTable; 
-	unsigned short nValue = 0;
-	unsigned short nOutValue = 0;
-	XnUInt32 nNewX = 0;
-	XnUInt32 nNewY = 0;
-	XnUInt32 nArrPos = 0;
 	XnUInt32 nDepthXRes = m_depthResolution.x;
-	XnUInt32 nDepthYRes = m_depthResolution.y;
-
-	memset(pOutput, 0, nDepthXRes*nDepthYRes*sizeof(unsigned short));
-
 	XnBool bMirror = m_isMirrored;
-
 	XnUInt32 nLinesShift = m_pPadInfo->nCroppingLines - m_pPadInfo->nStartLines;
+	XnInt16* pRGBRegDepthToShiftTable = (XnInt16*)m_pDepth2ShiftTable;
+	XnInt32 nXScale = m_blob.params1080.rgbRegXValScale;
+	XnUInt32 nLastOutputLine = (XnUInt32)band.nLastOutputLine;
 
-	for (XnUInt32 y = 0; y < nDepthYRes; ++y)
+	// positions in the band buffer are frame positions minus this
+	XnInt32 nOutputBase = band.nFirstOutputLine * (XnInt32)nDepthXRes;
+	unsigned short* pOutput = band.pOutput;
+
+	xnOSMemSet(pOutput, 0, (band.nLastOutputLine - band.nFirstOutputLine + 1) * nDepthXRes * sizeof(unsigned short));
+
+	for (XnUInt32 y = band.nFirstLine; y < band.nLastLine; ++y)
 	{
-		pRegTable = (XnInt16*)&m_pRegTable[ bMirror ? ((y+1) * nDepthXRes - 1) * 2 : y * nDepthXRes * 2 ];
+		const unsigned short* pInput = m_pApplyFrame + y * nDepthXRes;
+		const XnInt16* pRegTable = (const XnInt16*)&m_pRegTable[ bMirror ? ((y+1) * nDepthXRes - 1) * 2 : y * nDepthXRes * 2 ];
+
 		for (XnUInt32 x = 0; x < nDepthXRes; ++x)
 		{
-			nValue = *pInput;
+			unsigned short nValue = pInput[x];
 
 			if (nValue != 0)
 			{
-				nNewX = (XnUInt32)(*pRegTable + pRGBRegDepthToShiftTable[nValue]) / m_blob.params1080.rgbRegXValScale;
-				nNewY = *(pRegTable+1);
+				XnUInt32 nNewX = (XnUInt32)(*pRegTable + pRGBRegDepthToShiftTable[nValue]) / nXScale;
+				XnUInt32 nNewY = *(pRegTable+1);
 
-				if (nNewX < nDepthXRes && nNewY > nLinesShift)
+				if (nNewX < nDepthXRes && nNewY > nLinesShift && nNewY - nLinesShift <= nLastOutputLine)
 				{
 					nNewY -= nLinesShift;
-					nArrPos = bMirror ? (nNewY+1)*nDepthXRes - nNewX - 1 : (nNewY*nDepthXRes) + nNewX;
+					XnUInt32 nArrPos = bMirror ? (nNewY+1)*nDepthXRes - nNewX - 1 : (nNewY*nDepthXRes) + nNewX;
+
+					RegisterPixel(pOutput, nArrPos - nOutputBase, nNewX, nNewY, nDepthXRes, nValue);
+				}
+			}
+
+			bMirror ? pRegTable-=2 : pRegTable+=2;
+		}
+	}
+}
 
-					nOutValue = pOutput[nArrPos];
+void DepthUtilsImpl::MergeBands(XnUInt32 nFirstLine, XnUInt32 nLastLine)
+{
+	XnUInt32 nDepthXRes = m_depthResolution.x;
 
-					if ((nOutValue == 0) || (nOutValue > nValue))
+	for (XnUInt32 y = nFirstLine; y < nLastLine; ++y)
+	{
+		unsigned short* pOutput = m_pApplyFrame + y * nDepthXRes;
+		XnBool bWritten = FALSE;
+
+		for (XnUInt32 nBand = 0; nBand < m_nBands; ++nBand)
+		{
+			const RegistrationBand& band = m_aBands[nBand];
+			if ((XnInt32)y < band.nFirstOutputLine || (XnInt32)y > band.nLastOutputLine)
+			{
+				continue;
+			}
+
+			const unsigned short* pBandLine = band.pOutput + (y - band.nFirstOutputLine) * nDepthXRes;
+			if (!bWritten)
+			{
+				xnOSMemCopy(pOutput, pBandLine, nDepthXRes * sizeof(unsigned short));
+				bWritten = TRUE;
+			}
+			else
+			{
+				for (XnUInt32 x = 0; x < nDepthXRes; ++x)
+				{
+					// keep the closer one (zero is no depth, and wraps around to the largest value)
+					if ((unsigned short)(pBandLine[x] - 1) < (unsigned short)(pOutput[x] - 1))
 					{
-						if ( nNewX > 0 && nNewY > 0 )
-						{
-							pOutput[nArrPos-nDepthXRes] = nValue;
-							pOutput[nArrPos-nDepthXRes-1] = nValue;
-							pOutput[nArrPos-1] = nValue;
-						}
-						else if( nNewY > 0 )
-						{
-							pOutput[nArrPos-nDepthXRes] = nValue;
-						}
-						else if( nNewX > 0 )
-						{
-							pOutput[nArrPos-1] = nValue;
-						}
-
-						pOutput[nArrPos] = nValue;
+						pOutput[x] = pBandLine[x];
 					}
 				}
 			}
+		}
 
-			pInput++;
-			bMirror ? pRegTable-=2 : pRegTable+=2;
+		if (!bWritten)
+		{
+			xnOSMemSet(pOutput, 0, nDepthXRes * sizeof(unsigned short));
 		}
 	}
-	xnOSFreeAligned(pTempBuffer);
+}
+
+void XN_CALLBACK_TYPE DepthUtilsImpl::ApplyBandTask(XnUInt32 nTask, void* pCookie)
+{
+	DepthUtilsImpl* pThis = (DepthUtilsImpl*)pCookie;
+	pThis->ApplyBand(nTask);
+}
+
+void XN_CALLBACK_TYPE DepthUtilsImpl::MergeBandsTask(XnUInt32 nTask, void* pCookie)
+{
+	DepthUtilsImpl* pThis = (DepthUtilsImpl*)pCookie;
+	XnUInt32 nDepthYRes = pThis->m_depthResolution.y;
+	pThis->MergeBands(nTask * nDepthYRes / pThis->m_nBands, (nTask + 1) * nDepthYRes / pThis->m_nBands);
+}
+
+XnStatus DepthUtilsImpl::Apply(unsigned short* pOutput)
+{
+	if (m_nBands == 0)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	// bands only write to their own buffers, so they can all read the input from the output frame
+	m_pApplyFrame = pOutput;
+
+	m_workers.Run(m_nBands, ApplyBandTask, this);
+	m_workers.Run(m_nBands, MergeBandsTask, this);
+
+	m_pApplyFrame = NULL;
+
+	return XN_STATUS_OK;
+}
+
+XnStatus DepthUtilsImpl::PrepareRegistrationBands()
+{
+	m_nBands = 0;
+
+	if (m_pRegTable == NULL)
+	{
+		return XN_STATUS_OK;
+	}
+
+	XnUInt32 nDepthXRes = m_depthResolution.x;
+	XnUInt32 nDepthYRes = m_depthResolution.y;
+	XnUInt32 nLinesShift = m_pPadInfo->nCroppingLines - m_pPadInfo->nStartLines;
+	XnUInt32 nBands = REGISTRATION_BANDS;
+	XnUInt32 nBufferSize = 0;
+
+	for (XnUInt32 nBand = 0; nBand < nBands; ++nBand)
+	{
+		RegistrationBand& band = m_aBands[nBand];
+		band.nFirstLine = nBand * nDepthYRes / nBands;
+		band.nLastLine = (nBand + 1) * nDepthYRes / nBands;
+
+		// the output lines registered pixels of the band can land on only depend on the registration table
+		XnInt32 nMinLine = (XnInt32)nDepthYRes;
+		XnInt32 nMaxLine = -1;
+		const XnInt16* pRegTable = (const XnInt16*)&m_pRegTable[band.nFirstLine * nDepthXRes * 2];
+		for (XnUInt32 i = 0; i < (band.nLastLine - band.nFirstLine) * nDepthXRes; ++i, pRegTable += 2)
+		{
+			XnUInt32 nNewY = *(pRegTable+1);
+			if (nNewY > nLinesShift && nNewY - nLinesShift < nDepthYRes)
+			{
+				nMinLine = XN_MIN(nMinLine, (XnInt32)(nNewY - nLinesShift));
+				nMaxLine = XN_MAX(nMaxLine, (XnInt32)(nNewY - nLinesShift));
+			}
+		}
+
+		// pixels also write to their neighbors above, which is up to two lines up (last pixel of the line before it, in mirror mode)
+		band.nFirstOutputLine = nMinLine - 2;
+		band.nLastOutputLine = nMaxLine;
+		if (band.nFirstOutputLine <= band.nLastOutputLine)
+		{
+			nBufferSize += (band.nLastOutputLine - band.nFirstOutputLine + 1) * nDepthXRes;
+		}
+	}
+
+	if (nBufferSize > m_nBandsBufferSize)
+	{
+		if (m_pBandsBuffer != NULL)
+		{
+			xnOSFreeAligned(m_pBandsBuffer);
+			m_nBandsBufferSize = 0;
+		}
+
+		m_pBandsBuffer = (unsigned short*)xnOSMallocAligned(nBufferSize * sizeof(unsigned short), XN_DEFAULT_MEM_ALIGN);
+		XN_VALIDATE_ALLOC_PTR(m_pBandsBuffer);
+		m_nBandsBufferSize = nBufferSize;
+	}
+
+	unsigned short* pBuffer = m_pBandsBuffer;
+	for (XnUInt32 nBand = 0; nBand < nBands; ++nBand)
+	{
+		RegistrationBand& band = m_aBands[nBand];
+		band.pOutput = pBuffer;
+		if (band.nFirstOutputLine <= band.nLastOutputLine)
+		{
+			pBuffer += (band.nLastOutputLine - band.nFirstOutputLine + 1) * nDepthXRes;
+		}
+	}
+
+	m_nBands = nBands;
 
 	return XN_STATUS_OK;
 }
@@ -190,6 +374,7 @@ XnStatus DepthUtilsImpl::Apply(unsigned short* pOutput)
 XnStatus DepthUtilsImpl::SetDepthConfiguration(int xres, int yres, OniPixelFormat /*format*/, bool isMirrored)
 {
 	m_isMirrored = isMirrored;
+	m_bImageTablesValid = false;
 
 	if (xres == 160 && yres == 120)
 	{
@@ -219,11 +404,16 @@ XnStatus DepthUtilsImpl::SetDepthConfiguration(int xres, int yres, OniPixelForma
 	m_depthResolution.x = xres;
 	m_depthResolution.y = yres;
 
-	return XN_STATUS_OK;
+	return PrepareRegistrationBands();
 }
 
 XnStatus DepthUtilsImpl::SetColorResolution(int xres, int yres)
 {
+	if (m_colorResolution.x != xres || m_colorResolution.y != yres)
+	{
+		m_bImageTablesValid = false;
+	}
+
 	m_colorResolution.x = xres;
 	m_colorResolution.y = yres;
 
@@ -294,6 +484,182 @@ XnStatus DepthUtilsImpl::TranslateSinglePixel(XnUInt32 x, XnUInt32 y, unsigned s
 	return XN_STATUS_OK;
 }
 
+/*
+	TranslateSinglePixel() finds the registered X and Y of a pixel in the registration table, and then scales
+	them to the color resolution. The second part only depends on the registered X and Y, so the batch
+	functions do it with two lookups into tables built here, using the very same math.
+*/
+XnStatus DepthUtilsImpl::PrepareImageCoordinateTables()
+{
+	if (m_bImageTablesValid)
+	{
+		return XN_STATUS_OK;
+	}
+
+	if (m_pRegTable == NULL || m_colorResolution.x <= 0 || m_colorResolution.y <= 0)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	XnUInt32 nDepthXRes = m_depthResolution.x;
+	XnUInt32 nDepthYRes = m_depthResolution.y;
+	XnBool bMirror = m_isMirrored;
+	XnUInt32 nLinesShift = m_pPadInfo->nCroppingLines - m_pPadInfo->nStartLines;
+
+	// registered Y values are whatever the table holds, so size the Y table by its largest one
+	XnUInt32 nMaxNewY = 0;
+	const XnInt16* pRegTable = (const XnInt16*)m_pRegTable;
+	for (XnUInt32 i = 0; i < nDepthXRes * nDepthYRes; ++i, pRegTable += 2)
+	{
+		nMaxNewY = XN_MAX(nMaxNewY, (XnUInt32)XN_MAX(*(pRegTable+1), 0));
+	}
+
+	if (m_pImageXTable == NULL)
+	{
+		// largest depth resolution, and the end marker
+		XN_VALIDATE_ALIGNED_CALLOC(m_pImageXTable, XnInt32, 640 + 1, XN_DEFAULT_MEM_ALIGN);
+	}
+
+	if (nMaxNewY + 2 > m_nImageYTableAllocated)
+	{
+		if (m_pImageYTable != NULL)
+		{
+			xnOSFreeAligned(m_pImageYTable);
+			m_nImageYTableAllocated = 0;
+		}
+		XN_VALIDATE_ALIGNED_CALLOC(m_pImageYTable, XnInt32, nMaxNewY + 2, XN_DEFAULT_MEM_ALIGN);
+		m_nImageYTableAllocated = nMaxNewY + 2;
+	}
+
+	XnDouble fullXRes = m_colorResolution.x;
+	XnDouble fullYRes;
+	XnBool bCrop = FALSE;
+
+	if ((9 * m_colorResolution.x / m_colorResolution.y) == 16)
+	{
+		fullYRes = m_colorResolution.x * 4 / 5;
+		bCrop = TRUE;
+	}
+	else
+	{
+		fullYRes = m_colorResolution.y;
+		bCrop = FALSE;
+	}
+
+	// dividing by the scale is the slowest part of the translation. As the dividend is always less than 2^16,
+	// multiplying by ceil(2^32 / scale) and taking the upper 32 bits gives exactly the same result.
+	XnUInt32 nXScale = m_blob.params1080.rgbRegXValScale;
+	if (nXScale == 0 || nXScale >= (1 << 16))
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+	m_nRegXScaleReciprocal = (XnUInt64)XN_MAX_UINT32 / nXScale + 1;
+
+	m_nImageXTableSize = nDepthXRes;
+	for (XnUInt32 nNewX = 0; nNewX < nDepthXRes; ++nNewX)
+	{
+		XnUInt32 imageX = bMirror ? (nDepthXRes - nNewX - 1) : nNewX;
+		m_pImageXTable[nNewX] = (XnInt32)(XnUInt32)(fullXRes / m_depthResolution.x * imageX);
+	}
+	// anything past the end of the tables is out of the image
+	m_pImageXTable[nDepthXRes] = -1;
+
+	m_nImageYTableSize = nMaxNewY + 1;
+	for (XnUInt32 nNewY = 0; nNewY <= nMaxNewY; ++nNewY)
+	{
+		if (nNewY < nLinesShift)
+		{
+			m_pImageYTable[nNewY] = -1;
+			continue;
+		}
+
+		XnUInt32 imageY = (XnUInt32)(fullYRes / m_depthResolution.y * (nNewY - nLinesShift));
+		if (bCrop)
+		{
+			// crop from center
+			imageY -= (XnUInt32)(fullYRes - m_colorResolution.y)/2;
+		}
+
+		m_pImageYTable[nNewY] = (imageY < (XnUInt32)m_colorResolution.y) ? (XnInt32)imageY : -1;
+	}
+	m_pImageYTable[nMaxNewY + 1] = -1;
+
+	m_bImageTablesValid = true;
+
+	return XN_STATUS_OK;
+}
+
+inline void DepthUtilsImpl::TranslatePixelFromTables(XnUInt32 nRegIndex, unsigned short z, XnInt32* pImageXY)
+{
+	const XnInt16* pRegTable = (const XnInt16*)&m_pRegTable[nRegIndex];
+	XnInt32 nShiftedX = *pRegTable + ((const XnInt16*)m_pDepth2ShiftTable)[z];
+	// negative values are out of range anyway (TranslateSinglePixel() gets huge unsigned values from them)
+	XnUInt32 nNewX = (nShiftedX < 0) ? m_nImageXTableSize : (XnUInt32)(((XnUInt64)nShiftedX * m_nRegXScaleReciprocal) >> 32);
+	XnUInt32 nNewY = (XnUInt16)*(pRegTable+1);
+
+	// no branches here - which pixels have depth and fall in the image is hard to predict
+	XnInt32 imageX = m_pImageXTable[XN_MIN(nNewX, m_nImageXTableSize)];
+	XnInt32 imageY = m_pImageYTable[XN_MIN(nNewY, m_nImageYTableSize)];
+	XnInt32 nInvalid = -(XnInt32)((z == 0) | (imageX < 0) | (imageY < 0));
+
+	pImageXY[0] = imageX | nInvalid;
+	pImageXY[1] = imageY | nInvalid;
+}
+
+XnStatus DepthUtilsImpl::TranslatePixels(XnUInt32 nCount, const XnInt32* pDepthXY, const unsigned short* pDepthZ, XnInt32* pImageXY)
+{
+	XnStatus nRetVal = PrepareImageCoordinateTables();
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnUInt32 nDepthXRes = m_depthResolution.x;
+	XnUInt32 nDepthYRes = m_depthResolution.y;
+	XnBool bMirror = m_isMirrored;
+
+	for (XnUInt32 i = 0; i < nCount; ++i, pDepthXY += 2, pImageXY += 2)
+	{
+		XnUInt32 x = pDepthXY[0];
+		XnUInt32 y = pDepthXY[1];
+		if (x >= nDepthXRes || y >= nDepthYRes)
+		{
+			pImageXY[0] = -1;
+			pImageXY[1] = -1;
+			continue;
+		}
+
+		XnUInt32 nIndex = bMirror ? ((y+1)*nDepthXRes - x - 1) * 2 : (y*nDepthXRes + x) * 2;
+		TranslatePixelFromTables(nIndex, pDepthZ[i], pImageXY);
+	}
+
+	return XN_STATUS_OK;
+}
+
+XnStatus DepthUtilsImpl::TranslateDepthMapPixels(const unsigned short* pDepth, XnUInt32 nStride, XnUInt32 nOriginX, XnUInt32 nOriginY, XnUInt32 nWidth, XnUInt32 nHeight, XnInt32* pImageXY)
+{
+	XnStatus nRetVal = PrepareImageCoordinateTables();
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnUInt32 nDepthXRes = m_depthResolution.x;
+	if (nOriginX + nWidth > nDepthXRes || nOriginY + nHeight > (XnUInt32)m_depthResolution.y)
+	{
+		return XN_STATUS_BAD_PARAM;
+	}
+
+	XnBool bMirror = m_isMirrored;
+
+	for (XnUInt32 y = nOriginY; y < nOriginY + nHeight; ++y, pDepth += nStride)
+	{
+		XnUInt32 nIndex = bMirror ? ((y+1)*nDepthXRes - nOriginX - 1) * 2 : (y*nDepthXRes + nOriginX) * 2;
+		XnInt32 nIndexStep = bMirror ? -2 : 2;
+
+		for (XnUInt32 x = 0; x < nWidth; ++x, nIndex += nIndexStep, pImageXY += 2)
+		{
+			TranslatePixelFromTables(nIndex, pDepth[x], pImageXY);
+		}
+	}
+
+	return XN_STATUS_OK;
+}
+
 void DepthUtilsImpl::BuildDepthToShiftTable(XnUInt16* pRGBRegDepthToShiftTable, int xres)
 {
 	XnUInt32 nXScale = m_blob.params1080.cmosVGAOutputXRes / xres;
@@ -2,10 +2,15 @@
 #define _DEPTH_UTILS_IMPL_H_
 
 #include <XnLib.h>
+#include <XnWorkerPool.h>
 #include "DepthUtils.h"
 
 #define MAX_Z 65535
 
+// registration is always split into this number of row bands (so its output doesn't depend on the host), shared by
+// whatever threads there are
+#define REGISTRATION_BANDS 4
+
 class DepthUtilsImpl
 {
 public:
@@ -22,7 +27,33 @@ public:
 	XnStatus SetColorResolution(int xres, int yres);
 
 	XnStatus TranslateSinglePixel(XnUInt32 x, XnUInt32 y, unsigned short z, XnUInt32& imageX, XnUInt32& imageY);
+
+	// Batch versions of TranslateSinglePixel(). Each output is an (x, y) pair, or (-1, -1) for pixels
+	// with no depth, or that fall outside of the color image.
+	XnStatus TranslatePixels(XnUInt32 nCount, const XnInt32* pDepthXY, const unsigned short* pDepthZ, XnInt32* pImageXY);
+	XnStatus TranslateDepthMapPixels(const unsigned short* pDepth, XnUInt32 nStride, XnUInt32 nOriginX, XnUInt32 nOriginY, XnUInt32 nWidth, XnUInt32 nHeight, XnInt32* pImageXY);
 private:
+	struct RegistrationBand
+	{
+		// input lines [nFirstLine, nLastLine)
+		XnUInt32 nFirstLine;
+		XnUInt32 nLastLine;
+		// output lines the band may write to, [nFirstOutputLine, nLastOutputLine] (empty if first > last)
+		XnInt32 nFirstOutputLine;
+		XnInt32 nLastOutputLine;
+		// band-local output, covering the output lines above
+		unsigned short* pOutput;
+	};
+
+	XnStatus PrepareRegistrationBands();
+	void ApplyBand(XnUInt32 nBand);
+	void MergeBands(XnUInt32 nFirstLine, XnUInt32 nLastLine);
+	static void XN_CALLBACK_TYPE ApplyBandTask(XnUInt32 nTask, void* pCookie);
+	static void XN_CALLBACK_TYPE MergeBandsTask(XnUInt32 nTask, void* pCookie);
+
+	XnStatus PrepareImageCoordinateTables();
+	inline void TranslatePixelFromTables(XnUInt32 nRegIndex, unsigned short z, XnInt32* pImageXY);
+
 	void BuildDepthToShiftTable(XnUInt16* pRGBRegDepthToShiftTable, int xres);
 	XnStatus BuildRegistrationTable(XnUInt16* pRegTable, RegistrationInfo* pRegInfo, XnUInt16** pDepthToShiftTable, int xres, int yres);
 
@@ -66,6 +97,24 @@ private:
 	bool m_bD2SAlloc;
 	bool m_bInitialized;
 	bool m_isMirrored;
+
+	xnl::WorkerPool m_workers;
+	RegistrationBand m_aBands[REGISTRATION_BANDS];
+	XnUInt32 m_nBands;
+	unsigned short* m_pBandsBuffer;
+	XnUInt32 m_nBandsBufferSize;
+	unsigned short* m_pApplyFrame;
+
+	// color image coordinates of each registered X and Y (as found in the registration table), -1 if outside
+	// of the color image. Built on first use after the depth configuration or color resolution changes.
+	XnInt32* m_pImageXTable;
+	XnUInt32 m_nImageXTableSize;
+	XnInt32* m_pImageYTable;
+	XnUInt32 m_nImageYTableSize;
+	XnUInt32 m_nImageYTableAllocated;
+	XnUInt64 m_nRegXScaleReciprocal;
+	bool m_bImageTablesValid;
+
 	struct
 	{
 		int x, y;
@@ -829,6 +829,16 @@ NodeDataBeginRecord::NodeDataBeginRecord(const Record& record) : Record(record)
 	xnOSMemSet(&m_seekInfo, 0, sizeof(m_seekInfo));
 }
 
+void NodeDataBeginRecord::SetNumFrames(XnUInt32 nNumFrames)
+{
+	m_seekInfo.m_nFrames = nNumFrames;
+}
+
+void NodeDataBeginRecord::SetMaxTimeStamp(XnUInt64 nMaxTimeStamp)
+{
+	m_seekInfo.m_nMaxTimeStamp = nMaxTimeStamp;
+}
+
 XnUInt32 NodeDataBeginRecord::GetNumFrames() const
 {
 	return m_seekInfo.m_nFrames;
@@ -1030,6 +1040,197 @@ XnStatus DataIndexRecordHeader::AsString(XnChar* strDest, XnUInt32 nSize, XnUInt
 	return XN_STATUS_OK;
 }
 
+/*****************************/
+/* CheckpointDirectoryRecord */
+/*****************************/
+CheckpointDirectoryRecord::CheckpointDirectoryRecord(XnUInt8* pData, XnUInt32 nMaxSize, XnBool bUseOld32Header) :
+	Record(pData, nMaxSize, bUseOld32Header),
+	m_nLastCheckpointPos(0)
+{
+}
+
+CheckpointDirectoryRecord::CheckpointDirectoryRecord(const Record& record) :
+	Record(record),
+	m_nLastCheckpointPos(0)
+{
+}
+
+void CheckpointDirectoryRecord::SetLastCheckpointPos(XnUInt64 nPos)
+{
+	m_nLastCheckpointPos = nPos;
+}
+
+XnUInt64 CheckpointDirectoryRecord::GetLastCheckpointPos() const
+{
+	return m_nLastCheckpointPos;
+}
+
+XnStatus CheckpointDirectoryRecord::Encode()
+{
+	XnStatus nRetVal = StartWrite(RECORD_SEEK_TABLE);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = Write(&m_nLastCheckpointPos, sizeof(m_nLastCheckpointPos));
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = FinishWrite();
+	XN_IS_STATUS_OK(nRetVal);
+	return XN_STATUS_OK;
+}
+
+XnStatus CheckpointDirectoryRecord::Decode()
+{
+	XnStatus nRetVal = StartRead();
+	XN_IS_STATUS_OK(nRetVal);
+	if (GetSize() != HEADER_SIZE + sizeof(m_nLastCheckpointPos))
+	{
+		XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Not a checkpoint directory record");
+	}
+	nRetVal = Read(&m_nLastCheckpointPos, sizeof(m_nLastCheckpointPos));
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = FinishRead();
+	XN_IS_STATUS_OK(nRetVal);
+	return XN_STATUS_OK;
+}
+
+XnStatus CheckpointDirectoryRecord::AsString(XnChar* strDest, XnUInt32 nSize, XnUInt32& nCharsWritten)
+{
+	XnUInt32 nTempCharsWritten = 0;
+	nCharsWritten = 0;
+	XnStatus nRetVal = Record::AsString(strDest, nSize, nTempCharsWritten);
+	XN_IS_STATUS_OK(nRetVal);
+	nCharsWritten += nTempCharsWritten;
+	nRetVal = xnOSStrFormat(strDest + nCharsWritten, nSize - nCharsWritten, &nTempCharsWritten, 
+		" lastCheckpoint=%llu", m_nLastCheckpointPos);
+	XN_IS_STATUS_OK(nRetVal);
+	nCharsWritten += nTempCharsWritten;
+	return XN_STATUS_OK;
+}
+
+/******************************/
+/* SeekTableChunkRecordHeader */
+/******************************/
+SeekTableChunkRecordHeader::SeekTableChunkRecordHeader(XnUInt8* pData, XnUInt32 nMaxSize, XnBool bUseOld32Header) :
+	Record(pData, nMaxSize, bUseOld32Header),
+	m_nFirstFrame(0)
+{
+}
+
+SeekTableChunkRecordHeader::SeekTableChunkRecordHeader(const Record& record) :
+	Record(record),
+	m_nFirstFrame(0)
+{
+}
+
+void SeekTableChunkRecordHeader::SetFirstFrame(XnUInt32 nFirstFrame)
+{
+	m_nFirstFrame = nFirstFrame;
+}
+
+XnUInt32 SeekTableChunkRecordHeader::GetFirstFrame() const
+{
+	return m_nFirstFrame;
+}
+
+XnStatus SeekTableChunkRecordHeader::Encode()
+{
+	XnStatus nRetVal = StartWrite(RECORD_SEEK_TABLE);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = Write(&m_nFirstFrame, sizeof(m_nFirstFrame));
+	XN_IS_STATUS_OK(nRetVal);
+	//No call to FinishWrite() - this record is not done yet
+	return XN_STATUS_OK;
+}
+
+XnStatus SeekTableChunkRecordHeader::Decode()
+{
+	XnStatus nRetVal = StartRead();
+	XN_IS_STATUS_OK(nRetVal);
+	if (GetSize() != HEADER_SIZE + sizeof(m_nFirstFrame))
+	{
+		XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Not a seek table chunk record");
+	}
+	nRetVal = Read(&m_nFirstFrame, sizeof(m_nFirstFrame));
+	XN_IS_STATUS_OK(nRetVal);
+	//No call to FinishRead() - this record is not done yet
+	return XN_STATUS_OK;
+}
+
+XnStatus SeekTableChunkRecordHeader::AsString(XnChar* strDest, XnUInt32 nSize, XnUInt32& nCharsWritten)
+{
+	XnUInt32 nTempCharsWritten = 0;
+	nCharsWritten = 0;
+	XnStatus nRetVal = Record::AsString(strDest, nSize, nTempCharsWritten);
+	XN_IS_STATUS_OK(nRetVal);
+	nCharsWritten += nTempCharsWritten;
+	nRetVal = xnOSStrFormat(strDest + nCharsWritten, nSize - nCharsWritten, &nTempCharsWritten, 
+		" firstFrame=%u", m_nFirstFrame);
+	XN_IS_STATUS_OK(nRetVal);
+	nCharsWritten += nTempCharsWritten;
+	return XN_STATUS_OK;
+}
+
+/**************************/
+/* CheckpointRecordHeader */
+/**************************/
+CheckpointRecordHeader::CheckpointRecordHeader(XnUInt8* pData, XnUInt32 nMaxSize, XnBool bUseOld32Header) :
+	Record(pData, nMaxSize, bUseOld32Header),
+	m_nConfigurationID(0)
+{
+}
+
+CheckpointRecordHeader::CheckpointRecordHeader(const Record& record) :
+	Record(record),
+	m_nConfigurationID(0)
+{
+}
+
+void CheckpointRecordHeader::SetConfigurationID(XnUInt32 nConfigurationID)
+{
+	m_nConfigurationID = nConfigurationID;
+}
+
+XnUInt32 CheckpointRecordHeader::GetConfigurationID() const
+{
+	return m_nConfigurationID;
+}
+
+XnStatus CheckpointRecordHeader::Encode()
+{
+	XnStatus nRetVal = StartWrite(RECORD_SEEK_TABLE);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = Write(&m_nConfigurationID, sizeof(m_nConfigurationID));
+	XN_IS_STATUS_OK(nRetVal);
+	//No call to FinishWrite() - this record is not done yet
+	return XN_STATUS_OK;
+}
+
+XnStatus CheckpointRecordHeader::Decode()
+{
+	XnStatus nRetVal = StartRead();
+	XN_IS_STATUS_OK(nRetVal);
+	if (GetSize() != HEADER_SIZE + sizeof(m_nConfigurationID))
+	{
+		XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Not a checkpoint record");
+	}
+	nRetVal = Read(&m_nConfigurationID, sizeof(m_nConfigurationID));
+	XN_IS_STATUS_OK(nRetVal);
+	//No call to FinishRead() - this record is not done yet
+	return XN_STATUS_OK;
+}
+
+XnStatus CheckpointRecordHeader::AsString(XnChar* strDest, XnUInt32 nSize, XnUInt32& nCharsWritten)
+{
+	XnUInt32 nTempCharsWritten = 0;
+	nCharsWritten = 0;
+	XnStatus nRetVal = Record::AsString(strDest, nSize, nTempCharsWritten);
+	XN_IS_STATUS_OK(nRetVal);
+	nCharsWritten += nTempCharsWritten;
+	nRetVal = xnOSStrFormat(strDest + nCharsWritten, nSize - nCharsWritten, &nTempCharsWritten, 
+		" configurationID=%u", m_nConfigurationID);
+	XN_IS_STATUS_OK(nRetVal);
+	nCharsWritten += nTempCharsWritten;
+	return XN_STATUS_OK;
+}
+
 /*************/
 /* EndRecord */
 /*************/
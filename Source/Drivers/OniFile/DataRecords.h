@@ -295,6 +295,9 @@ public:
 	NodeDataBeginRecord(XnUInt8* pData, XnUInt32 nMaxSize, XnBool bUseOld32Header);
 	NodeDataBeginRecord(const Record& record);
 
+	void SetNumFrames(XnUInt32 nNumFrames);
+	void SetMaxTimeStamp(XnUInt64 nMaxTimeStamp);
+
 	XnUInt32 GetNumFrames() const;
 	XnUInt64 GetMaxTimeStamp() const;
 
@@ -375,6 +378,71 @@ public:
 	XnStatus AsString(XnChar* strDest, XnUInt32 nSize, XnUInt32& nCharsWritten);
 };
 
+/* Checkpoints of a recording that was still being written, so that it can be indexed without reading all of it.
+   These are all seek table records, which older players skip:
+   - The checkpoint directory (of node 0) follows the recording header, and points to the last checkpoint.
+   - A seek table chunk holds the entries of a node's frames since its previous chunk (its undo record).
+   - A checkpoint (of node 0) points to the last chunk of each node. Its undo record is the previous checkpoint.*/
+typedef struct CheckpointNodeEntry
+{
+	XnUInt32 nNodeID;
+	XnUInt32 nFrames;
+	XnUInt64 nLastChunkPos;
+} CheckpointNodeEntry;
+
+class CheckpointDirectoryRecord : public Record
+{
+public:
+	CheckpointDirectoryRecord(XnUInt8* pData, XnUInt32 nMaxSize, XnBool bUseOld32Header);
+	CheckpointDirectoryRecord(const Record& record);
+
+	void SetLastCheckpointPos(XnUInt64 nPos);
+	XnUInt64 GetLastCheckpointPos() const;
+
+	XnStatus Encode();
+	XnStatus Decode();
+	XnStatus AsString(XnChar* strDest, XnUInt32 nSize, XnUInt32& nCharsWritten);
+
+private:
+	XnUInt64 m_nLastCheckpointPos;
+};
+
+/*Followed by a DataIndexEntry for each frame, from the first one.*/
+class SeekTableChunkRecordHeader : public Record
+{
+public:
+	SeekTableChunkRecordHeader(XnUInt8* pData, XnUInt32 nMaxSize, XnBool bUseOld32Header);
+	SeekTableChunkRecordHeader(const Record& record);
+
+	void SetFirstFrame(XnUInt32 nFirstFrame);
+	XnUInt32 GetFirstFrame() const;
+
+	XnStatus Encode();
+	XnStatus Decode();
+	XnStatus AsString(XnChar* strDest, XnUInt32 nSize, XnUInt32& nCharsWritten);
+
+private:
+	XnUInt32 m_nFirstFrame;
+};
+
+/*Followed by a CheckpointNodeEntry for each node that has a seek table chunk.*/
+class CheckpointRecordHeader : public Record
+{
+public:
+	CheckpointRecordHeader(XnUInt8* pData, XnUInt32 nMaxSize, XnBool bUseOld32Header);
+	CheckpointRecordHeader(const Record& record);
+
+	void SetConfigurationID(XnUInt32 nConfigurationID);
+	XnUInt32 GetConfigurationID() const;
+
+	XnStatus Encode();
+	XnStatus Decode();
+	XnStatus AsString(XnChar* strDest, XnUInt32 nSize, XnUInt32& nCharsWritten);
+
+private:
+	XnUInt32 m_nConfigurationID;
+};
+
 class EndRecord : public Record
 {
 public:
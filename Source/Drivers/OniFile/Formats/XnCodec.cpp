@@ -34,6 +34,8 @@ XnCompressionFormats XnCodec::GetCompressionFormatFromCodecID(XnCodecID codecID)
 		return XN_COMPRESSION_16Z;
 	case XN_CODEC_16Z_EMB_TABLES:
 		return XN_COMPRESSION_16Z_EMB_TABLE;
+	case XN_CODEC_16Z_ROWS:
+		return XN_COMPRESSION_16Z_ROWS;
 	case XN_CODEC_8Z:
 		return XN_COMPRESSION_COLOR_8Z;
 	case XN_CODEC_JPEG:
@@ -51,6 +53,8 @@ XnCodecID XnCodec::GetCodecIDFromCompressionFormat(XnCompressionFormats format)
 		return XN_CODEC_16Z;
 	case XN_COMPRESSION_16Z_EMB_TABLE:
 		return XN_CODEC_16Z_EMB_TABLES;
+	case XN_COMPRESSION_16Z_ROWS:
+		return XN_CODEC_16Z_ROWS;
 	case XN_COMPRESSION_JPEG:
 		return XN_CODEC_JPEG;
 	case XN_COMPRESSION_NONE:
@@ -29,6 +29,7 @@
 #define XN_CODEC_JPEG				XN_CODEC_ID('J','P','E','G')
 #define XN_CODEC_16Z				XN_CODEC_ID('1','6','z','P')
 #define XN_CODEC_16Z_EMB_TABLES		XN_CODEC_ID('1','6','z','T')
+#define XN_CODEC_16Z_ROWS			XN_CODEC_ID('1','6','z','R')
 #define XN_CODEC_8Z					XN_CODEC_ID('I','m','8','z')
 
 #endif // __NICODECIDS_H__
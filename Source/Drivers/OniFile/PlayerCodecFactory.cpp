@@ -25,6 +25,7 @@
 #include "Formats/XnUncompressedCodec.h"
 #include "Formats/Xn16zCodec.h"
 #include "Formats/Xn16zEmbTablesCodec.h"
+#include "Formats/Xn16zRowsCodec.h"
 #include "Formats/Xn8zCodec.h"
 #include "Formats/XnJpegCodec.h"
 #include "OniCProperties.h"
@@ -66,6 +67,27 @@ XnStatus PlayerCodecFactory::Create(XnCodecID nCodecID, PlayerSource* pSource, X
 			XN_VALIDATE_NEW_AND_INIT(pCodec, Xn16zEmbTablesCodec, (OniDepthPixel)nMaxDepth);
 			break;
 		}
+		case XN_CODEC_16Z_ROWS:
+		{
+			int nMaxDepth;
+			int dataSize = sizeof(nMaxDepth);
+			rc = pSource->GetProperty(ONI_STREAM_PROPERTY_MAX_VALUE, &nMaxDepth, &dataSize);
+			if (rc != ONI_STATUS_OK)
+			{
+				return XN_STATUS_ERROR;
+			}
+
+			OniVideoMode videoMode;
+			dataSize = sizeof(videoMode);
+			rc = pSource->GetProperty(ONI_STREAM_PROPERTY_VIDEO_MODE, &videoMode, &dataSize);
+			if (rc != ONI_STATUS_OK)
+			{
+				return XN_STATUS_ERROR;
+			}
+
+			XN_VALIDATE_NEW_AND_INIT(pCodec, Xn16zRowsCodec, (OniDepthPixel)nMaxDepth, videoMode.resolutionX, videoMode.resolutionY);
+			break;
+		}
 		case XN_CODEC_8Z:
 		{
 			XN_VALIDATE_NEW_AND_INIT(pCodec, Xn8zCodec);
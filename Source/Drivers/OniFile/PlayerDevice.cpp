@@ -30,6 +30,7 @@
 #include "XnMemory.h"
 #include "Formats/XnCodec.h"
 #include "PlayerCodecFactory.h"
+#include "PlayerSegmentExporter.h"
 #include "PS1080.h"
 
 namespace oni_file {
@@ -42,6 +43,8 @@ namespace driver = oni::driver;
 #define XN_PLAYBACK_SPEED_SANITY_SLEEP				2000
 #define XN_PLAYBACK_SPEED_FASTEST					0.0
 #define XN_PLAYBACK_SPEED_MANUAL					(-1.0)
+#define DEVICE_MAX_DECODE_THREADS					4
+#define DEVICE_MAX_EXPORT_THREADS					4
 
 #ifndef ARRAYSIZE
 #define ARRAYSIZE(a)								(sizeof(a)/sizeof((a)[0]))
@@ -90,10 +93,30 @@ static PS1080Property PS1080PropertyList[] =
 	*/
 };
 
+// Checks if two paths name the same existing file.
+static XnBool IsSameFile(const XnChar* strFilePath1, const XnChar* strFilePath2)
+{
+	XnBool bExists = FALSE;
+	if (xnOSDoesFileExist(strFilePath1, &bExists) != XN_STATUS_OK || !bExists)
+	{
+		return FALSE;
+	}
+
+	XnChar strFullPath1[XN_FILE_MAX_PATH];
+	XnChar strFullPath2[XN_FILE_MAX_PATH];
+	if (xnOSGetFullPathName(strFilePath1, strFullPath1, sizeof(strFullPath1)) != XN_STATUS_OK ||
+		xnOSGetFullPathName(strFilePath2, strFullPath2, sizeof(strFullPath2)) != XN_STATUS_OK)
+	{
+		return (strcmp(strFilePath1, strFilePath2) == 0);
+	}
+
+	return (strcmp(strFullPath1, strFullPath2) == 0);
+}
+
 PlayerDevice::PlayerDevice(const xnl::String& filePath) : 
-	m_filePath(filePath), m_fileHandle(0), m_threadHandle(NULL), m_running(FALSE), m_isSeeking(FALSE),
+	m_filePath(filePath), m_fileHandle(0), m_pMapping(NULL), m_nMappingPosition(0), m_threadHandle(NULL), m_running(FALSE), m_isSeeking(FALSE), m_isSeekInProgress(FALSE), m_seekStatus(XN_STATUS_OK),
 	m_dPlaybackSpeed(1.0), m_nStartTimestamp(0), m_nStartTime(0), m_bHasTimeReference(FALSE), 
-	m_bRepeat(TRUE), m_player(filePath.Data()), m_driverEOFCallback(NULL), m_driverCookie(NULL)
+	m_bRepeat(TRUE), m_bLockstep(FALSE), m_player(filePath.Data()), m_driverEOFCallback(NULL), m_driverCookie(NULL)
 {
 	// Create the events.
 	m_readyForDataInternalEvent.Create(FALSE);
@@ -128,6 +151,7 @@ OniStatus PlayerDevice::Initialize()
 		FileClose,
 		FileSeek64,
 		FileTell64,
+		FileMap,
 	};
 	static PlayerNode::CodecFactory codecFactory = 
 	{
@@ -156,6 +180,14 @@ OniStatus PlayerDevice::Initialize()
 		return ONI_STATUS_ERROR;
 	}
 
+	// Decode compressed frames on the other processors, ahead of playback.
+	XnUInt32 nProcessors = xnOSGetProcessorCount();
+	rc = m_player.SetDecodeThreads((nProcessors > 1) ? XN_MIN(nProcessors - 1, (XnUInt32)DEVICE_MAX_DECODE_THREADS) : 0);
+	if (rc != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
 	// Register to end of file reached event.
 	XnCallbackHandle handle;
 	rc = m_player.RegisterToEndOfFileReached(OnEndOfFileReached, this, handle);
@@ -164,6 +196,13 @@ OniStatus PlayerDevice::Initialize()
 		return ONI_STATUS_ERROR;
 	}
 
+	// Cache the seek index of recordings without seek tables next to the file.
+	rc = m_player.SetSeekIndexCacheFile(m_filePath.Data());
+	if (rc != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
 	// Set the input interface.
 	rc = m_player.SetInputStream(this, &inputInterface);
 	if (rc != XN_STATUS_OK)
@@ -187,6 +226,7 @@ void PlayerDevice::close()
 	m_running = false;
 	m_readyForDataInternalEvent.Set();
 	m_manualTriggerInternalEvent.Set();
+	WakeFrameCreditWaiters();
 	XnStatus rc = xnOSWaitForThreadExit(m_threadHandle, DEVICE_DESTROY_THREAD_TIMEOUT);
 	if (rc != XN_STATUS_OK)
 	{
@@ -281,6 +321,7 @@ driver::StreamBase* PlayerDevice::createStream(OniSensorType sensorType)
 		XN_DELETE(pStream);
 		return NULL;
 	}
+	pStream->SetLockstep(m_bLockstep);
 
 	// Register to ready for data event.
 	// NOTE: handle is discarded, as device will always exist longer than stream, therefore device can never unregister.
@@ -356,6 +397,17 @@ OniStatus PlayerDevice::getProperty(int propertyId, void* data, int* pDataSize)
 		// Return the repeat value.
 		*((OniBool*)data) = m_bRepeat;
 	}
+	else if (propertyId == ONI_DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED)
+	{
+		// Validate parameter size.
+		if (*pDataSize != sizeof(OniBool))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		// Return the lockstep value.
+		*((OniBool*)data) = m_bLockstep;
+	}
 	else
 	{
 		// Get the property.
@@ -399,6 +451,27 @@ OniStatus PlayerDevice::setProperty(int propertyId, const void* data, int dataSi
 		m_bRepeat = *((OniBool*)data);
 		m_player.SetRepeat(m_bRepeat);
 	}
+	else if (propertyId == ONI_DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED)
+	{
+		// Validate parameter size.
+		if (dataSize != sizeof(OniBool))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		// Update the lockstep mode of the device and its streams.
+		Lock();
+		m_bLockstep = *((OniBool*)data);
+		for (StreamList::Iterator iter = m_streams.Begin(); iter != m_streams.End(); ++iter)
+		{
+			(*iter)->SetLockstep(m_bLockstep);
+		}
+		Unlock();
+
+		// Reset the timing reference, and release the player thread if it waits for frame credits.
+		m_bHasTimeReference = FALSE;
+		WakeFrameCreditWaiters();
+	}
 	else
 	{
 		// Set the property.
@@ -414,6 +487,7 @@ OniBool PlayerDevice::isPropertySupported(int propertyId)
 {
 	return propertyId == ONI_DEVICE_PROPERTY_PLAYBACK_SPEED ||
 			propertyId == ONI_DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED ||
+			propertyId == ONI_DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED ||
 			m_properties.Exists(propertyId);
 }
 
@@ -442,9 +516,24 @@ OniStatus PlayerDevice::invoke(int commandId, void* data, int dataSize)
 		// Set the ready for data and manual trigger events, to make sure player thread wakes up.
 		m_readyForDataInternalEvent.Set();
 		m_manualTriggerInternalEvent.Set();
+		WakeFrameCreditWaiters();
 
 		// Wait for seek to complete.
 		m_SeekCompleteInternalEvent.Wait(XN_WAIT_INFINITE);
+		if (m_seekStatus != XN_STATUS_OK)
+		{
+			return ONI_STATUS_ERROR;
+		}
+	}
+	else if (commandId == ONI_DEVICE_COMMAND_EXPORT_SEGMENTS)
+	{
+		if (dataSize != sizeof(OniExportSegments))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		OniExportSegments* pExport = (OniExportSegments*)data;
+		return ExportSegments(pExport->segments, pExport->numSegments);
 	}
 	else
 	{
@@ -456,7 +545,83 @@ OniStatus PlayerDevice::invoke(int commandId, void* data, int dataSize)
 
 OniBool PlayerDevice::isCommandSupported(int commandId)
 {
-	return commandId == ONI_DEVICE_COMMAND_SEEK;
+	return commandId == ONI_DEVICE_COMMAND_SEEK ||
+			commandId == ONI_DEVICE_COMMAND_EXPORT_SEGMENTS;
+}
+
+OniStatus PlayerDevice::ExportSegments(OniRecordingSegment* aSegments, int nSegments)
+{
+	if (aSegments == NULL || nSegments <= 0)
+	{
+		return ONI_STATUS_BAD_PARAMETER;
+	}
+
+	xnl::Array<PlayerSegmentExporter::Segment> segments;
+	if (segments.SetSize(nSegments) != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
+	for (int i = 0; i < nSegments; ++i)
+	{
+		PlayerSource* pSource = NULL;
+		for (SourceList::Iterator iter = m_sources.Begin(); iter != m_sources.End(); ++iter)
+		{
+			if ((*iter)->GetInfo()->sensorType == aSegments[i].sensorType)
+			{
+				pSource = *iter;
+				break;
+			}
+		}
+		if (pSource == NULL || aSegments[i].fileName == NULL || aSegments[i].firstFrameIndex <= 0 || aSegments[i].lastFrameIndex <= 0)
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		// exporting would truncate the recording both the exporter and playback have mapped
+		if (IsSameFile(aSegments[i].fileName, m_filePath.Data()))
+		{
+			return ONI_STATUS_BAD_PARAMETER;
+		}
+
+		segments[i].strNodeName = pSource->GetNodeName();
+		segments[i].nFirstFrame = aSegments[i].firstFrameIndex;
+		segments[i].nLastFrame = aSegments[i].lastFrameIndex;
+		segments[i].strFileName = aSegments[i].fileName;
+		segments[i].nStatus = XN_STATUS_OK;
+	}
+
+	// The exporter reads the file on its own, so playback goes on meanwhile.
+	PlayerSegmentExporter exporter;
+	XnStatus nRetVal = exporter.Open(m_filePath.Data());
+	if (nRetVal != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+	exporter.Export(segments.GetData(), nSegments, DEVICE_MAX_EXPORT_THREADS);
+
+	OniStatus rc = ONI_STATUS_OK;
+	for (int i = 0; i < nSegments; ++i)
+	{
+		switch (segments[i].nStatus)
+		{
+		case XN_STATUS_OK:
+			aSegments[i].status = ONI_STATUS_OK;
+			break;
+		case XN_STATUS_BAD_PARAM:
+		case XN_STATUS_BAD_NODE_NAME:
+			aSegments[i].status = ONI_STATUS_BAD_PARAMETER;
+			break;
+		default:
+			aSegments[i].status = ONI_STATUS_ERROR;
+		}
+		if (rc == ONI_STATUS_OK)
+		{
+			rc = aSegments[i].status;
+		}
+	}
+
+	return rc;
 }
 
 PlayerSource* PlayerDevice::FindSource(const XnChar* strNodeName)
@@ -525,6 +690,66 @@ void PlayerDevice::SleepToTimestamp(XnUInt64 nTimeStamp)
 	}
 }
 
+XnBool PlayerDevice::WaitForFrameCredits(PlayerSource* pSource)
+{
+	// Frames read while seeking are the result of the seek - they replace whatever the application holds.
+	if (m_isSeeking)
+	{
+		return TRUE;
+	}
+
+	// Take the credits of the streams on the source. They are referenced, so they survive a stream destroyed
+	// while waiting.
+	Lock();
+	for (StreamList::Iterator iter = m_streams.Begin(); iter != m_streams.End(); ++iter)
+	{
+		PlayerStream* pStream = *iter;
+		if (pStream->GetSource() == pSource)
+		{
+			PlayerFrameCredits* pCredits = pStream->GetFrameCredits();
+			pCredits->AddRef();
+			m_waitCredits.AddLast(pCredits);
+		}
+	}
+	Unlock();
+
+	// Wait for each stream to get all its frames back.
+	XnBool bDeliver = TRUE;
+	for (XnUInt32 i = 0; bDeliver && i < m_waitCredits.GetSize(); ++i)
+	{
+		while (m_waitCredits[i]->HasFramesInFlight())
+		{
+			if (m_isSeeking || !m_running || !m_bLockstep)
+			{
+				// A seek drops the frame, while leaving lockstep mode delivers it right away.
+				bDeliver = !m_isSeeking && m_running;
+				break;
+			}
+			m_waitCredits[i]->Wait();
+		}
+	}
+
+	Lock();
+	for (XnUInt32 i = 0; i < m_waitCredits.GetSize(); ++i)
+	{
+		m_waitCredits[i]->Release();
+	}
+	m_waitCredits.Clear();
+	Unlock();
+
+	return bDeliver;
+}
+
+void PlayerDevice::WakeFrameCreditWaiters()
+{
+	Lock();
+	for (XnUInt32 i = 0; i < m_waitCredits.GetSize(); ++i)
+	{
+		m_waitCredits[i]->Wake();
+	}
+	Unlock();
+}
+
 void PlayerDevice::MainLoop()
 {
 	m_running = true;
@@ -543,7 +768,8 @@ void PlayerDevice::MainLoop()
 		}
 		if (waitForStreamStart)
 		{
-			xnOSSleep(10);
+			// Streams raise the ready for data event when started.
+			m_readyForDataInternalEvent.Wait(XN_WAIT_INFINITE);
 			continue;
 		}
 
@@ -555,29 +781,27 @@ void PlayerDevice::MainLoop()
 
 			// Seek the frame ID for first source (seek to (frame ID-1) so next read frame is frameId).
 			PlayerSource* pSource = m_seek.pStream->GetSource();
-			XnStatus xnrc = m_player.SeekToFrame(pSource->GetNodeName(), m_seek.frameId, XN_PLAYER_SEEK_SET);
-			if (xnrc != XN_STATUS_OK)
-			{
-				// Failure to seek.
-				m_isSeeking = FALSE;
-				continue;
-			}
+			m_isSeekInProgress = TRUE;
+			m_seekStatus = m_player.SeekToFrame(pSource->GetNodeName(), m_seek.frameId, XN_PLAYER_SEEK_SET);
+			m_isSeekInProgress = FALSE;
 
 			// Return playback speed to normal.
 			m_dPlaybackSpeed = playbackSpeed;
 
-			// Reset the wait events.
-			m_readyForDataInternalEvent.Reset();
-			m_manualTriggerInternalEvent.Reset();
-
-			// Reset the time reference.
-			m_bHasTimeReference = FALSE;
+			if (m_seekStatus == XN_STATUS_OK)
+			{
+				// Reset the wait events.
+				m_readyForDataInternalEvent.Reset();
+				m_manualTriggerInternalEvent.Reset();
 
-			// Raise the seek complete event.
-			m_SeekCompleteInternalEvent.Set();
+				// Reset the time reference.
+				m_bHasTimeReference = FALSE;
+			}
 
-			// Mark the seeking flag as false.
+			// Mark the seeking flag as false before raising the seek complete event (also raised on failure), as the
+			// application may seek again as soon as it is raised.
 			m_isSeeking = FALSE;
+			m_SeekCompleteInternalEvent.Set();
 		}
 		else
 		{
@@ -999,8 +1223,8 @@ XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeNewData(void* pCookie, const XnCha
 			{
 				if (ready)
 				{
-					// Check if waiting for manual trigger (playback speed is zero).
-					if (pThis->m_dPlaybackSpeed == XN_PLAYBACK_SPEED_MANUAL)
+					// Check if waiting for manual trigger (playback speed is zero). A requested seek does not wait.
+					if (!pThis->m_bLockstep && !pThis->m_isSeeking && pThis->m_dPlaybackSpeed == XN_PLAYBACK_SPEED_MANUAL)
 					{
 						// Wait for manual trigger.
 						XnStatus rc = pThis->m_manualTriggerInternalEvent.Wait(DEVICE_MANUAL_TRIGGER_STANITY_SLEEP);
@@ -1022,12 +1246,35 @@ XnStatus XN_CALLBACK_TYPE PlayerDevice::OnNodeNewData(void* pCookie, const XnCha
 			}
 		}
 
-		// Sleep until next timestamp has expired.
-		pThis->SleepToTimestamp(nTimeStamp);
+		// Frames read ahead of a requested seek are replaced by its result.
+		if (pThis->m_isSeeking && !pThis->m_isSeekInProgress)
+		{
+			return XN_STATUS_OK;
+		}
 
-		// Continue processing in the source.
+		if (pThis->m_bLockstep)
+		{
+			// Wait for the consumers to release the previous frames, instead of for the timestamp.
+			if (!pThis->WaitForFrameCredits(pSource))
+			{
+				return XN_STATUS_OK;
+			}
+		}
+		else
+		{
+			// Sleep until next timestamp has expired.
+			pThis->SleepToTimestamp(nTimeStamp);
+		}
+
+		// Continue processing in the source. Data that wasn't decoded still points into the mapped file, and can
+		// be handed out as is.
 		void* data = const_cast<void*>(pData);
-		pSource->ProcessNewData(nTimeStamp, nFrame, data, nSize);
+		PlayerFileMapping* pMapping = NULL;
+		if (pThis->m_pMapping != NULL && pThis->m_pMapping->Contains(pData, nSize))
+		{
+			pMapping = pThis->m_pMapping;
+		}
+		pSource->ProcessNewData(nTimeStamp, nFrame, data, nSize, pMapping);
 	}
 
 	return XN_STATUS_OK;
@@ -1073,12 +1320,31 @@ XnStatus PlayerDevice::AddPrivateProperty(PlayerSource* pSource, const XnChar* s
 XnStatus XN_CALLBACK_TYPE PlayerDevice::FileOpen(void* pCookie)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+
+	// Prefer mapping the file, so records are read without any system calls, and frames that need no decoding
+	// are handed out without copying them. Fall back to plain reads if that fails (e.g. on a 32-bit build).
+	if (PlayerFileMapping::Open(pThis->m_filePath.Data(), &pThis->m_pMapping) == XN_STATUS_OK)
+	{
+		pThis->m_nMappingPosition = 0;
+		return XN_STATUS_OK;
+	}
+	pThis->m_pMapping = NULL;
+
 	return xnOSOpenFile(pThis->m_filePath.Data(), XN_OS_FILE_READ, &pThis->m_fileHandle);
 }
 
 XnStatus XN_CALLBACK_TYPE PlayerDevice::FileRead(void* pCookie, void* pBuffer, XnUInt32 nSize, XnUInt32* pnBytesRead)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+	if (pThis->m_pMapping != NULL)
+	{
+		const void* pData = NULL;
+		XnStatus rc = FileMap(pCookie, nSize, &pData, pnBytesRead);
+		XN_IS_STATUS_OK(rc);
+		xnOSMemCopy(pBuffer, pData, *pnBytesRead);
+		return XN_STATUS_OK;
+	}
+
 	XnUInt32 bufferSize = nSize;
 	XnStatus rc = xnOSReadFile(pThis->m_fileHandle, pBuffer, &bufferSize);
 	*pnBytesRead = bufferSize;
@@ -1098,6 +1364,14 @@ XnUInt32 XN_CALLBACK_TYPE PlayerDevice::FileTell(void* pCookie)
 void XN_CALLBACK_TYPE PlayerDevice::FileClose(void* pCookie)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+	if (pThis->m_pMapping != NULL)
+	{
+		// frames still pointing into the file keep it mapped until they are released
+		pThis->m_pMapping->Release();
+		pThis->m_pMapping = NULL;
+		return;
+	}
+
 	xnOSCloseFile(&pThis->m_fileHandle);
 	pThis->m_fileHandle = 0;
 }
@@ -1105,12 +1379,37 @@ void XN_CALLBACK_TYPE PlayerDevice::FileClose(void* pCookie)
 XnStatus XN_CALLBACK_TYPE PlayerDevice::FileSeek64(void* pCookie, XnOSSeekType seekType, const XnInt64 nOffset)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+	if (pThis->m_pMapping != NULL)
+	{
+		XnInt64 nOrigin = 0;
+		switch (seekType)
+		{
+		case XN_OS_SEEK_SET: nOrigin = 0; break;
+		case XN_OS_SEEK_CUR: nOrigin = (XnInt64)pThis->m_nMappingPosition; break;
+		case XN_OS_SEEK_END: nOrigin = (XnInt64)pThis->m_pMapping->GetSize(); break;
+		default: return XN_STATUS_OS_FILE_SEEK_FAILED;
+		}
+
+		// like a file, the position may be past the end - reads will just return nothing
+		if (nOrigin + nOffset < 0)
+		{
+			return XN_STATUS_OS_FILE_SEEK_FAILED;
+		}
+		pThis->m_nMappingPosition = (XnUInt64)(nOrigin + nOffset);
+		return XN_STATUS_OK;
+	}
+
 	return xnOSSeekFile64(pThis->m_fileHandle, seekType, nOffset);
 }
 
 XnUInt64 XN_CALLBACK_TYPE PlayerDevice::FileTell64(void* pCookie)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+	if (pThis->m_pMapping != NULL)
+	{
+		return pThis->m_nMappingPosition;
+	}
+
 	XnUInt64 pos = 0xffffffff;
 	XnStatus rc = xnOSTellFile64(pThis->m_fileHandle, &pos);
 	if (rc == XN_STATUS_OK)
@@ -1120,6 +1419,25 @@ XnUInt64 XN_CALLBACK_TYPE PlayerDevice::FileTell64(void* pCookie)
 	return 0xffffffff;
 }
 
+XnStatus XN_CALLBACK_TYPE PlayerDevice::FileMap(void* pCookie, XnUInt32 nSize, const void** ppData, XnUInt32* pnBytesMapped)
+{
+	PlayerDevice* pThis = (PlayerDevice*)pCookie;
+	if (pThis->m_pMapping == NULL)
+	{
+		return XN_STATUS_NOT_IMPLEMENTED;
+	}
+
+	XnUInt64 nFileSize = pThis->m_pMapping->GetSize();
+	XnUInt64 nAvailable = (pThis->m_nMappingPosition < nFileSize) ? nFileSize - pThis->m_nMappingPosition : 0;
+	XnUInt32 nMapped = (XnUInt32)XN_MIN((XnUInt64)nSize, nAvailable);
+
+	*ppData = pThis->m_pMapping->GetData() + XN_MIN(pThis->m_nMappingPosition, nFileSize);
+	*pnBytesMapped = nMapped;
+	pThis->m_nMappingPosition += nMapped;
+
+	return XN_STATUS_OK;
+}
+
 XnStatus XN_CALLBACK_TYPE PlayerDevice::CodecCreate(void* pCookie, const char* strNodeName, XnCodecID nCodecID, XnCodec** ppCodec)
 {
 	PlayerDevice* pThis = (PlayerDevice*)pCookie;
@@ -28,10 +28,12 @@
 #include "Driver/OniDriverAPI.h"
 #include "XnString.h"
 #include "XnList.h"
+#include "XnArray.h"
 #include "XnOSCpp.h"
 #include "PlayerNode.h"
 #include "PlayerProperties.h"
 #include "PlayerStream.h"
+#include "PlayerFileMapping.h"
 
 namespace oni_file {
 
@@ -92,6 +94,13 @@ protected:
 	// Wake up when timestamp is valid.
 	void SleepToTimestamp(XnUInt64 nTimeStamp);
 
+	// Wait until the streams of the source released all the frames they handed out (lockstep mode). Returns FALSE
+	// if the wait was cut short by a seek or by closing the device, in which case the frame should be dropped.
+	XnBool WaitForFrameCredits(PlayerSource* pSource);
+
+	// Wake up the player thread if it waits for frame credits.
+	void WakeFrameCreditWaiters();
+
 private:
 	void close();
 
@@ -101,6 +110,9 @@ private:
 		PlayerStream* pStream;
 	} Seek;
 
+	// Exports ranges of frames of the recording to new recordings (ONI_DEVICE_COMMAND_EXPORT_SEGMENTS).
+	OniStatus ExportSegments(OniRecordingSegment* aSegments, int nSegments);
+
 	void MainLoop();
 	static XN_THREAD_PROC ThreadProc(XN_THREAD_PARAM pThreadParam);
 
@@ -125,6 +137,7 @@ private:
 	static void     XN_CALLBACK_TYPE FileClose(void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE FileSeek64(void* pCookie, XnOSSeekType seekType, const XnInt64 nOffset);
 	static XnUInt64 XN_CALLBACK_TYPE FileTell64(void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE FileMap(void* pCookie, XnUInt32 nSize, const void** ppData, XnUInt32* pnBytesMapped);
 
 	static XnStatus XN_CALLBACK_TYPE CodecCreate(void* pCookie, const char* strNodeName, XnCodecID nCodecId, XnCodec** ppCodec);
 	static void     XN_CALLBACK_TYPE CodecDestroy(void* pCookie, XnCodec* pCodec);
@@ -138,6 +151,10 @@ private:
 	// Handle to the opened file.
 	XN_FILE_HANDLE m_fileHandle;
 
+	// The file mapped to memory (NULL if it could not be mapped, and is read through m_fileHandle instead).
+	PlayerFileMapping* m_pMapping;
+	XnUInt64 m_nMappingPosition;
+
 	// Thread handle.
 	XN_THREAD_HANDLE m_threadHandle;
 
@@ -147,6 +164,8 @@ private:
 	// Seek frame.
 	Seek m_seek;
 	OniBool m_isSeeking;
+	OniBool m_isSeekInProgress;
+	XnStatus m_seekStatus;
 
 	// Speed of playback.
 	XnDouble m_dPlaybackSpeed;
@@ -159,6 +178,12 @@ private:
 	// Repeat recording in loop.
 	OniBool m_bRepeat;
 
+	// Play in lockstep with the consumers, instead of according to the timestamps.
+	OniBool m_bLockstep;
+
+	// Frame credits the player thread waits for (under m_cs).
+	xnl::Array<PlayerFrameCredits*> m_waitCredits;
+
 	// Player object.
 	PlayerNode m_player;
 
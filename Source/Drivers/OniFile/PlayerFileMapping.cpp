@@ -0,0 +1,70 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "PlayerFileMapping.h"
+
+namespace oni_file {
+
+PlayerFileMapping::PlayerFileMapping(XnUInt8* pData, XnUInt64 nSize) :
+	m_pData(pData), m_nSize(nSize), m_nRefCount(1)
+{
+}
+
+PlayerFileMapping::~PlayerFileMapping()
+{
+	xnOSUnmapFile(m_pData, m_nSize);
+}
+
+XnStatus PlayerFileMapping::Open(const XnChar* strFileName, PlayerFileMapping** ppMapping)
+{
+	void* pData = NULL;
+	XnUInt64 nSize = 0;
+	XnStatus nRetVal = xnOSMapFile(strFileName, &pData, &nSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	*ppMapping = XN_NEW(PlayerFileMapping, (XnUInt8*)pData, nSize);
+	if (*ppMapping == NULL)
+	{
+		xnOSUnmapFile(pData, nSize);
+		return XN_STATUS_ALLOC_FAILED;
+	}
+
+	return XN_STATUS_OK;
+}
+
+void PlayerFileMapping::AddRef()
+{
+	xnOSAtomicIncrement(&m_nRefCount);
+}
+
+void PlayerFileMapping::Release()
+{
+	if (xnOSAtomicDecrement(&m_nRefCount) == 0)
+	{
+		XN_DELETE(this);
+	}
+}
+
+void ONI_CALLBACK_TYPE PlayerFileMapping::ReleaseFrameData(void* /*pData*/, void* pCookie)
+{
+	((PlayerFileMapping*)pCookie)->Release();
+}
+
+} // namespace oni_file
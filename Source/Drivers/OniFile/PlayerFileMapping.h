@@ -0,0 +1,68 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __PLAYER_FILE_MAPPING_H__
+#define __PLAYER_FILE_MAPPING_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "OniCTypes.h"
+#include "XnOS.h"
+
+namespace oni_file {
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/// A recording mapped into memory. The mapping is reference counted: the device holds one reference, and so does
+/// every frame handed out with data pointing into it, so frames stay valid after the device was closed.
+class PlayerFileMapping
+{
+public:
+	static XnStatus Open(const XnChar* strFileName, PlayerFileMapping** ppMapping);
+
+	void AddRef();
+	void Release();
+
+	const XnUInt8* GetData() const { return m_pData; }
+	XnUInt64 GetSize() const { return m_nSize; }
+
+	XnBool Contains(const void* pData, XnUInt32 nSize) const
+	{
+		const XnUInt8* p = (const XnUInt8*)pData;
+		return p >= m_pData && p + nSize <= m_pData + m_nSize;
+	}
+
+	// Releases the reference a frame held (matches OniFrameFreeBufferCallback, with the mapping as the cookie).
+	static void ONI_CALLBACK_TYPE ReleaseFrameData(void* pData, void* pCookie);
+
+private:
+	PlayerFileMapping(XnUInt8* pData, XnUInt64 nSize);
+	~PlayerFileMapping();
+
+	XnUInt8* m_pData;
+	XnUInt64 m_nSize;
+	volatile XnInt32 m_nRefCount;
+};
+
+} // namespace oni_file
+
+#endif // __PLAYER_FILE_MAPPING_H__
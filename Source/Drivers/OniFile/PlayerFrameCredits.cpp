@@ -0,0 +1,124 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "PlayerFrameCredits.h"
+
+namespace oni_file {
+
+typedef struct
+{
+	PlayerFrameCredits* pCredits;
+	PlayerFileMapping* pMapping;
+} PlayerFrameCookie;
+
+PlayerFrameCredits::PlayerFrameCredits() :
+	m_nRefCount(1), m_nFramesInFlight(0)
+{
+}
+
+PlayerFrameCredits::~PlayerFrameCredits()
+{
+}
+
+XnStatus PlayerFrameCredits::Create(PlayerFrameCredits** ppCredits)
+{
+	PlayerFrameCredits* pCredits = XN_NEW(PlayerFrameCredits);
+	XN_VALIDATE_ALLOC_PTR(pCredits);
+
+	XnStatus nRetVal = pCredits->m_releasedEvent.Create(FALSE);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		XN_DELETE(pCredits);
+		return nRetVal;
+	}
+
+	*ppCredits = pCredits;
+	return XN_STATUS_OK;
+}
+
+void PlayerFrameCredits::AddRef()
+{
+	xnOSAtomicIncrement(&m_nRefCount);
+}
+
+void PlayerFrameCredits::Release()
+{
+	if (xnOSAtomicDecrement(&m_nRefCount) == 0)
+	{
+		XN_DELETE(this);
+	}
+}
+
+void* PlayerFrameCredits::AllocateFrameData(XnUInt32 nSize)
+{
+	return xnOSMallocAligned(nSize, XN_DEFAULT_MEM_ALIGN);
+}
+
+void* PlayerFrameCredits::AcquireCredit(PlayerFileMapping* pMapping)
+{
+	PlayerFrameCookie* pCookie = XN_NEW(PlayerFrameCookie);
+	if (pCookie == NULL)
+	{
+		return NULL;
+	}
+
+	AddRef();
+	xnOSAtomicIncrement(&m_nFramesInFlight);
+	if (pMapping != NULL)
+	{
+		pMapping->AddRef();
+	}
+
+	pCookie->pCredits = this;
+	pCookie->pMapping = pMapping;
+	return pCookie;
+}
+
+void ONI_CALLBACK_TYPE PlayerFrameCredits::ReleaseFrameData(void* pData, void* pCookie)
+{
+	PlayerFrameCookie* pFrameCookie = (PlayerFrameCookie*)pCookie;
+	PlayerFrameCredits* pCredits = pFrameCookie->pCredits;
+
+	if (pFrameCookie->pMapping != NULL)
+	{
+		pFrameCookie->pMapping->Release();
+	}
+	else
+	{
+		xnOSFreeAligned(pData);
+	}
+	XN_DELETE(pFrameCookie);
+
+	xnOSAtomicDecrement(&pCredits->m_nFramesInFlight);
+	pCredits->m_releasedEvent.Set();
+	pCredits->Release();
+}
+
+void PlayerFrameCredits::Wait()
+{
+	m_releasedEvent.Wait(XN_WAIT_INFINITE);
+}
+
+void PlayerFrameCredits::Wake()
+{
+	m_releasedEvent.Set();
+}
+
+} // namespace oni_file
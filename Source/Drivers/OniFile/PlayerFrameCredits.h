@@ -0,0 +1,75 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __PLAYER_FRAME_CREDITS_H__
+#define __PLAYER_FRAME_CREDITS_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "OniCTypes.h"
+#include "XnOSCpp.h"
+#include "PlayerFileMapping.h"
+
+namespace oni_file {
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/// Counts the frames a stream handed out that were not freed yet, for lockstep playback: the player only moves on
+/// once every consumer (the application, a recorder, the frame holders in the core) released the previous frame.
+/// Each frame in flight holds a reference, so the object outlives the stream if the application keeps frames.
+class PlayerFrameCredits
+{
+public:
+	static XnStatus Create(PlayerFrameCredits** ppCredits);
+
+	void AddRef();
+	void Release();
+
+	/// Allocates a buffer for frame data that is not in the mapped file.
+	static void* AllocateFrameData(XnUInt32 nSize);
+
+	/// Takes a credit for a frame about to be handed out, and returns the cookie to pass to acquireExternalFrame()
+	/// along with ReleaseFrameData. pMapping is the mapping the frame data points into (a reference is taken),
+	/// or NULL if the data was allocated with AllocateFrameData().
+	void* AcquireCredit(PlayerFileMapping* pMapping);
+
+	/// Frees the frame data and returns its credit (matches OniFrameFreeBufferCallback).
+	static void ONI_CALLBACK_TYPE ReleaseFrameData(void* pData, void* pCookie);
+
+	XnBool HasFramesInFlight() const { return m_nFramesInFlight != 0; }
+
+	/// Waits until a frame was released, or Wake() was called.
+	void Wait();
+	void Wake();
+
+private:
+	PlayerFrameCredits();
+	~PlayerFrameCredits();
+
+	volatile XnInt32 m_nRefCount;
+	volatile XnInt32 m_nFramesInFlight;
+	xnl::OSEvent m_releasedEvent;
+};
+
+} // namespace oni_file
+
+#endif // __PLAYER_FRAME_CREDITS_H__
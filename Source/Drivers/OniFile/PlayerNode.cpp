@@ -73,6 +73,122 @@ const XnUInt64 PlayerNode::RECORD_MAX_SIZE =
 const XnVersion PlayerNode::OLDEST_SUPPORTED_FILE_FORMAT_VERSION = {1, 0, 0, 4};
 const XnVersion PlayerNode::FIRST_FILESIZE64BIT_FILE_FORMAT_VERSION = {1, 0, 1, 0};
 
+/**
+ * Decodes frames for a PlayerNode on a thread of its own. Each worker has its own codec for every node, since
+ * codecs keep per-frame state. Codecs are created and destroyed by the player thread, and only while the worker
+ * has no jobs of that node.
+ */
+class PlayerNode::DecodeWorker
+{
+public:
+	DecodeWorker(PlayerNode* pNode) : m_pNode(pNode), m_thread(NULL), m_bStop(FALSE)
+	{
+	}
+
+	~DecodeWorker()
+	{
+		if (m_thread != NULL)
+		{
+			{
+				xnl::AutoCSLocker lock(m_lock);
+				m_bStop = TRUE;
+			}
+			m_event.Set();
+			xnOSWaitForThreadExit(m_thread, XN_WAIT_INFINITE);
+			xnOSCloseThread(&m_thread);
+		}
+
+		for (Codecs::Iterator i = m_codecs.Begin(); i != m_codecs.End(); ++i)
+		{
+			m_pNode->m_pNodeCodecFactory->Destroy(m_pNode->m_pNodeCodecFactoryCookie, i->Value());
+		}
+	}
+
+	XnStatus Start()
+	{
+		XnStatus nRetVal = m_event.Create(FALSE);
+		XN_IS_STATUS_OK(nRetVal);
+		return xnOSCreateThread(ThreadMain, this, &m_thread);
+	}
+
+	void Submit(DecodeJob* pJob)
+	{
+		{
+			xnl::AutoCSLocker lock(m_lock);
+			m_jobs.AddLast(pJob);
+		}
+		m_event.Set();
+	}
+
+	XnCodec* GetCodec(XnUInt32 nNodeID)
+	{
+		Codecs::Iterator i = m_codecs.Find(nNodeID);
+		return (i != m_codecs.End()) ? i->Value() : NULL;
+	}
+
+	XnStatus SetCodec(XnUInt32 nNodeID, XnCodec* pCodec)
+	{
+		return m_codecs.Set(nNodeID, pCodec);
+	}
+
+	void RemoveCodec(XnUInt32 nNodeID)
+	{
+		Codecs::Iterator i = m_codecs.Find(nNodeID);
+		if (i != m_codecs.End())
+		{
+			m_pNode->m_pNodeCodecFactory->Destroy(m_pNode->m_pNodeCodecFactoryCookie, i->Value());
+			m_codecs.Remove(i);
+		}
+	}
+
+private:
+	typedef xnl::Hash<XnUInt32, XnCodec*> Codecs;
+
+	static XN_THREAD_PROC ThreadMain(XN_THREAD_PARAM pThreadParam)
+	{
+		DecodeWorker* pThis = reinterpret_cast<DecodeWorker*>(pThreadParam);
+		pThis->Run();
+		XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+	}
+
+	void Run()
+	{
+		for (;;)
+		{
+			DecodeJob* pJob = NULL;
+			{
+				xnl::AutoCSLocker lock(m_lock);
+				if (!m_jobs.IsEmpty())
+				{
+					pJob = *m_jobs.Begin();
+					m_jobs.Remove(m_jobs.Begin());
+				}
+				else if (m_bStop)
+				{
+					break;
+				}
+			}
+
+			if (pJob == NULL)
+			{
+				m_event.Wait(XN_WAIT_INFINITE);
+				continue;
+			}
+
+			DecodeFrame(pJob);
+			m_pNode->OnDecodeJobDone(pJob);
+		}
+	}
+
+	PlayerNode* m_pNode;
+	XN_THREAD_HANDLE m_thread;
+	xnl::CriticalSection m_lock;
+	xnl::OSEvent m_event;
+	xnl::List<DecodeJob*> m_jobs;
+	XnBool m_bStop;
+	Codecs m_codecs; // only touched by the player thread
+};
+
 PlayerNode::PlayerNode(const XnChar* strName) :
 	m_bOpen(FALSE),
 	m_bIs32bitFileFormat(FALSE),
@@ -82,6 +198,8 @@ PlayerNode::PlayerNode(const XnChar* strName) :
 	m_pInputStream(NULL),
 	m_pNotificationsCookie(NULL),
 	m_pNodeNotifications(NULL),
+	m_pNodeCodecFactoryCookie(NULL),
+	m_pNodeCodecFactory(NULL),
 	m_bRepeat(TRUE),
 	m_bDataBegun(FALSE),
 	m_bEOF(FALSE),
@@ -89,8 +207,11 @@ PlayerNode::PlayerNode(const XnChar* strName) :
 	m_nGlobalMaxTimeStamp(0),
 	m_pNodeInfoMap(NULL),
 	m_nMaxNodes(0),
-	m_aSeekTempArray(NULL)
+	m_aSeekTempArray(NULL),
+	m_bSeekIndexReady(FALSE),
+	m_nNextDecodeWorker(0)
 {
+	m_strSeekIndexRecordingFile[0] = '\0';
 	xnOSMemSet(&m_fileVersion, 0, sizeof(m_fileVersion));
 	xnOSStrCopy(m_strName, strName, sizeof(m_strName));
 	xnOSMemSet(&m_lastOutputMode, 0, sizeof(XnMapOutputMode));
@@ -107,11 +228,24 @@ XnStatus PlayerNode::Init()
 	XN_VALIDATE_ALLOC_PTR(m_pRecordBuffer);
 	m_pUncompressedData = XN_NEW_ARR(XnUInt8, DATA_MAX_SIZE);
 	XN_VALIDATE_ALLOC_PTR(m_pUncompressedData);
+	XnStatus nRetVal = m_decodeDoneEvent.Create(FALSE);
+	XN_IS_STATUS_OK(nRetVal);
 	return XN_STATUS_OK;
 }
 
 XnStatus PlayerNode::Destroy()
 {
+	// frames read ahead are not delivered anymore
+	DiscardDecodeJobs();
+	StopDecodeWorkers();
+	for (xnl::List<DecodeJob*>::Iterator i = m_freeDecodeJobs.Begin(); i != m_freeDecodeJobs.End(); ++i)
+	{
+		XN_DELETE_ARR((*i)->pInputBuffer);
+		XN_DELETE_ARR((*i)->pOutputBuffer);
+		XN_DELETE(*i);
+	}
+	m_freeDecodeJobs.Clear();
+
 	CloseStream();
 	//Don't verify return value - proceed anyway
 
@@ -132,6 +266,8 @@ XnStatus PlayerNode::Destroy()
 		m_aSeekTempArray = NULL;
 	}
 
+	m_seekIndex.Clear();
+
 	XN_DELETE_ARR(m_pRecordBuffer);
 	m_pRecordBuffer = NULL;
 	XN_DELETE_ARR(m_pUncompressedData);
@@ -167,6 +303,43 @@ XnStatus PlayerNode::SetNodeCodecFactory(void* pPlayerNodeCodecFactoryCookie,
 	return XN_STATUS_OK;
 }
 
+XnStatus PlayerNode::SetSeekIndexCacheFile(const XnChar* strRecordingFile)
+{
+	XN_VALIDATE_INPUT_PTR(strRecordingFile);
+	return xnOSStrCopy(m_strSeekIndexRecordingFile, strRecordingFile, sizeof(m_strSeekIndexRecordingFile));
+}
+
+XnStatus PlayerNode::SetDecodeThreads(XnUInt32 nThreads)
+{
+	DiscardDecodeJobs();
+	StopDecodeWorkers();
+
+	// If the workers can't be started, frames are simply decoded on the player thread.
+	for (XnUInt32 i = 0; i < nThreads; ++i)
+	{
+		DecodeWorker* pWorker = XN_NEW(DecodeWorker, this);
+		if (pWorker == NULL || pWorker->Start() != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_OPEN_NI, "Failed to start decode thread - using %u threads", i);
+			XN_DELETE(pWorker);
+			break;
+		}
+		m_decodeWorkers.AddLast(pWorker);
+	}
+
+	return XN_STATUS_OK;
+}
+
+void PlayerNode::StopDecodeWorkers()
+{
+	for (XnUInt32 i = 0; i < m_decodeWorkers.GetSize(); ++i)
+	{
+		XN_DELETE(m_decodeWorkers[i]);
+	}
+	m_decodeWorkers.Clear();
+	m_nNextDecodeWorker = 0;
+}
+
 XnStatus PlayerNode::SetRepeat(XnBool bRepeat)
 {
 	m_bRepeat = bRepeat;
@@ -200,6 +373,13 @@ XnStatus PlayerNode::SeekToFrame(const XnChar* strNodeName, XnInt32 nFrameOffset
 		XN_LOG_ERROR_RETURN(XN_STATUS_BAD_NODE_NAME, XN_MASK_OPEN_NI, "Bad node name '%s'", strNodeName);
 	}
 
+	// frames that were read ahead are replaced by the result of the seek
+	DiscardDecodeJobs();
+
+	// recordings that were never closed only know their real number of frames once indexed
+	nRetVal = EnsureSeekIndex();
+	XN_IS_STATUS_OK(nRetVal);
+
 	PlayerNodeInfo* pPlayerNodeInfo = &m_pNodeInfoMap[nNodeID];
 
 	XnInt64 nOriginFrame = 0;
@@ -230,6 +410,10 @@ XnStatus PlayerNode::SeekToFrame(const XnChar* strNodeName, XnInt32 nFrameOffset
 	nRetVal = SeekToFrameAbsolute(nNodeID, nDestFrame);
 	XN_IS_STATUS_OK(nRetVal);
 
+	// the seek is complete once its frames were delivered
+	nRetVal = FlushDecodeJobs();
+	XN_IS_STATUS_OK(nRetVal);
+
 	return XN_STATUS_OK;
 }
 
@@ -293,7 +477,7 @@ DataIndexEntry* PlayerNode::FindTimestampInDataIndex(XnUInt32 nNodeID, XnUInt64
 		}
 		else // equals
 		{
-			break;
+			return &pPlayerNodeInfo->pDataIndex[mid];
 		}
 	}
 
@@ -339,6 +523,364 @@ DataIndexEntry** PlayerNode::GetSeekLocationsFromDataIndex(XnUInt32 nNodeID, XnU
 	return m_aSeekTempArray;
 }
 
+XnStatus PlayerNode::SeekToTimeStampFromDataIndex(XnUInt64 nDestTimeStamp, XnBool& bSeeked)
+{
+	bSeeked = FALSE;
+	XnUInt64 nDestPos = 0;
+
+	// go to the first frame (of any node) at or after the destination timestamp
+	for (XnUInt32 i = 0; i < m_nMaxNodes; ++i)
+	{
+		PlayerNodeInfo* pPlayerNodeInfo = &m_pNodeInfoMap[i];
+		if (!pPlayerNodeInfo->bValid || !pPlayerNodeInfo->bIsGenerator)
+		{
+			continue;
+		}
+
+		if (pPlayerNodeInfo->pDataIndex == NULL || pPlayerNodeInfo->nCurFrame == 0)
+		{
+			return XN_STATUS_OK;
+		}
+
+		XnUInt32 first = 1;
+		XnUInt32 last = pPlayerNodeInfo->nFrames + 1;
+		while (first < last)
+		{
+			XnUInt32 mid = first + (last - first) / 2;
+			if (pPlayerNodeInfo->pDataIndex[mid].nTimestamp < nDestTimeStamp)
+			{
+				first = mid + 1;
+			}
+			else
+			{
+				last = mid;
+			}
+		}
+
+		if (first > pPlayerNodeInfo->nFrames)
+		{
+			// this node has no more frames
+			continue;
+		}
+
+		DataIndexEntry* pDestFrame = &pPlayerNodeInfo->pDataIndex[first];
+		if (pDestFrame->nConfigurationID != pPlayerNodeInfo->pDataIndex[pPlayerNodeInfo->nCurFrame].nConfigurationID)
+		{
+			xnLogVerbose(XN_MASK_OPEN_NI, "Seeking to timestamp %llu: Slow seek being used (configuration was changed between source and destination frames)", nDestTimeStamp);
+			return XN_STATUS_OK;
+		}
+
+		if (nDestPos == 0 || pDestFrame->nSeekPos < nDestPos)
+		{
+			nDestPos = pDestFrame->nSeekPos;
+		}
+	}
+
+	if (nDestPos == 0)
+	{
+		return XN_STATUS_OK;
+	}
+
+	XnStatus nRetVal = SeekStream(XN_OS_SEEK_SET, nDestPos);
+	XN_IS_STATUS_OK(nRetVal);
+
+	bSeeked = TRUE;
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerNode::EnsureSeekIndex()
+{
+	if (m_bSeekIndexReady)
+	{
+		return XN_STATUS_OK;
+	}
+
+	XnBool bNeeded = FALSE;
+	for (XnUInt32 i = 0; i < m_nMaxNodes; ++i)
+	{
+		if (m_pNodeInfoMap[i].bValid && m_pNodeInfoMap[i].bIsGenerator && m_pNodeInfoMap[i].pDataIndex == NULL)
+		{
+			bNeeded = TRUE;
+		}
+	}
+
+	if (!bNeeded)
+	{
+		return XN_STATUS_OK;
+	}
+
+	// only try once - if the file can't be indexed, seeks just stay slow
+	m_bSeekIndexReady = TRUE;
+
+	XnStatus nRetVal = BuildSeekIndex();
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogWarning(XN_MASK_OPEN_NI, "Failed to index recording: %s", xnGetStatusString(nRetVal));
+		return XN_STATUS_OK;
+	}
+
+	nRetVal = m_seekIndex.Save();
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogVerbose(XN_MASK_OPEN_NI, "Seek index was not cached: %s", xnGetStatusString(nRetVal));
+	}
+
+	for (XnUInt32 i = 0; i < m_nMaxNodes; ++i)
+	{
+		if (m_pNodeInfoMap[i].bValid)
+		{
+			AttachSeekIndex(i);
+		}
+	}
+
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerNode::BuildSeekIndex()
+{
+	XnStatus nRetVal = m_seekIndex.Init((m_strSeekIndexRecordingFile[0] != '\0') ? m_strSeekIndexRecordingFile : NULL, m_nMaxNodes);
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnUInt64 nStartPos = TellStream();
+	nRetVal = SeekStream(XN_OS_SEEK_END, 0);
+	XN_IS_STATUS_OK(nRetVal);
+	XnUInt64 nFileSize = TellStream();
+
+	// Frames up to the last checkpoint are already indexed in the file, so only the rest of it is walked.
+	XnUInt64 nScanPos = sizeof(RecordingHeader);
+	XnUInt32 nConfigurationID = 0;
+	nRetVal = LoadCheckpoints(nFileSize, nScanPos, nConfigurationID);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogWarning(XN_MASK_OPEN_NI, "Failed to read checkpoints of recording (%s), indexing all of it", xnGetStatusString(nRetVal));
+		nRetVal = m_seekIndex.Init((m_strSeekIndexRecordingFile[0] != '\0') ? m_strSeekIndexRecordingFile : NULL, m_nMaxNodes);
+		XN_IS_STATUS_OK(nRetVal);
+		nScanPos = sizeof(RecordingHeader);
+		nConfigurationID = 0;
+	}
+
+	nRetVal = SeekStream(XN_OS_SEEK_SET, nScanPos);
+	XN_IS_STATUS_OK(nRetVal);
+
+	// Walk the record headers only. Anything but data may change the state of the nodes, so it starts a new
+	// configuration (the recorder only does this for properties, which is enough to keep the fast seek correct).
+	Record record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	XnBool bEnd = FALSE;
+	while (!bEnd && nRetVal == XN_STATUS_OK)
+	{
+		XnUInt64 nRecordPos = TellStream();
+		if (nRecordPos + record.HEADER_SIZE > nFileSize ||
+			ReadRecord(record) != XN_STATUS_OK ||
+			nRecordPos + record.GetSize() + record.GetPayloadSize() > nFileSize)
+		{
+			// a recording that was never closed just ends, possibly in the middle of a record
+			break;
+		}
+
+		switch (record.GetType())
+		{
+			case RECORD_NEW_DATA:
+			{
+				NewDataRecordHeader newDataRecord(record);
+				nRetVal = newDataRecord.Decode();
+				if (nRetVal == XN_STATUS_OK)
+				{
+					DataIndexEntry entry;
+					entry.nTimestamp = newDataRecord.GetTimeStamp();
+					entry.nConfigurationID = nConfigurationID;
+					entry.nSeekPos = nRecordPos;
+					nRetVal = m_seekIndex.AddFrame(newDataRecord.GetNodeID(), newDataRecord.GetFrameNumber(), entry);
+				}
+				break;
+			}
+			case RECORD_SEEK_TABLE:
+				break;
+			case RECORD_END:
+				bEnd = TRUE;
+				break;
+			default:
+				++nConfigurationID;
+				break;
+		}
+
+		if (!bEnd && nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = SkipRecordPayload(record);
+		}
+	}
+
+	XnStatus nSeekRetVal = SeekStream(XN_OS_SEEK_SET, nStartPos);
+	XN_IS_STATUS_OK(nRetVal);
+	XN_IS_STATUS_OK(nSeekRetVal);
+
+	m_seekIndex.Complete();
+
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerNode::LoadCheckpoints(XnUInt64 nFileSize, XnUInt64& nScanPos, XnUInt32& nConfigurationID)
+{
+	// only recordings in the current format may have checkpoints
+	if (m_bIs32bitFileFormat)
+	{
+		return XN_STATUS_OK;
+	}
+
+	Record record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	if (sizeof(RecordingHeader) + record.HEADER_SIZE > nFileSize)
+	{
+		return XN_STATUS_OK;
+	}
+
+	XnStatus nRetVal = SeekStream(XN_OS_SEEK_SET, sizeof(RecordingHeader));
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = ReadRecordHeader(record);
+	XN_IS_STATUS_OK(nRetVal);
+	if (record.GetType() != RECORD_SEEK_TABLE || record.GetNodeID() != 0)
+	{
+		// recorded without checkpoints
+		return XN_STATUS_OK;
+	}
+
+	CheckpointDirectoryRecord directory(record);
+	nRetVal = ReadRecordFields(directory);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = directory.Decode();
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnUInt64 nCheckpointPos = directory.GetLastCheckpointPos();
+	if (nCheckpointPos == 0)
+	{
+		// cut short before its first checkpoint
+		return XN_STATUS_OK;
+	}
+	if (nCheckpointPos + record.HEADER_SIZE > nFileSize)
+	{
+		XN_LOG_WARNING_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Checkpoint is past the end of the recording");
+	}
+
+	nRetVal = SeekStream(XN_OS_SEEK_SET, nCheckpointPos);
+	XN_IS_STATUS_OK(nRetVal);
+	CheckpointRecordHeader checkpoint(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	nRetVal = ReadRecord(checkpoint);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = checkpoint.Decode();
+	XN_IS_STATUS_OK(nRetVal);
+	if (checkpoint.GetType() != RECORD_SEEK_TABLE || checkpoint.GetNodeID() != 0 ||
+		checkpoint.GetPayloadSize() % sizeof(CheckpointNodeEntry) != 0 ||
+		nCheckpointPos + checkpoint.GetSize() + checkpoint.GetPayloadSize() > nFileSize)
+	{
+		XN_LOG_WARNING_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Invalid checkpoint record");
+	}
+
+	// the record buffer is reused while reading the chunks
+	xnl::Array<CheckpointNodeEntry> nodes;
+	nRetVal = nodes.SetSize(checkpoint.GetPayloadSize() / sizeof(CheckpointNodeEntry));
+	XN_IS_STATUS_OK(nRetVal);
+	XnUInt32 nBytesRead = 0;
+	nRetVal = Read(nodes.GetData(), checkpoint.GetPayloadSize(), nBytesRead);
+	XN_IS_STATUS_OK(nRetVal);
+	if (nBytesRead != checkpoint.GetPayloadSize())
+	{
+		XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Incorrect number of bytes read");
+	}
+	XnUInt64 nCheckpointEnd = TellStream();
+	XnUInt32 nCheckpointConfigurationID = checkpoint.GetConfigurationID();
+
+	for (XnUInt32 i = 0; i < nodes.GetSize(); ++i)
+	{
+		nRetVal = LoadSeekTableChunks(nodes[i], nFileSize);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
+	xnLogVerbose(XN_MASK_OPEN_NI, "Recording was indexed up to its checkpoint at %llu", nCheckpointPos);
+	nScanPos = nCheckpointEnd;
+	nConfigurationID = nCheckpointConfigurationID;
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerNode::LoadSeekTableChunks(const CheckpointNodeEntry& node, XnUInt64 nFileSize)
+{
+	// The chunks are linked from the last one back to the first, through their undo records.
+	XnUInt32 nFramesLeft = node.nFrames;
+	XnUInt64 nChunkPos = node.nLastChunkPos;
+	SeekTableChunkRecordHeader chunk(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+	while (nFramesLeft > 0)
+	{
+		if (nChunkPos == 0 || nChunkPos + chunk.HEADER_SIZE > nFileSize)
+		{
+			XN_LOG_WARNING_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Seek table chunks of node %u are missing", node.nNodeID);
+		}
+
+		XnStatus nRetVal = SeekStream(XN_OS_SEEK_SET, nChunkPos);
+		XN_IS_STATUS_OK(nRetVal);
+		nRetVal = ReadRecord(chunk);
+		XN_IS_STATUS_OK(nRetVal);
+		nRetVal = chunk.Decode();
+		XN_IS_STATUS_OK(nRetVal);
+
+		XnUInt32 nEntries = chunk.GetPayloadSize() / sizeof(DataIndexEntry);
+		if (chunk.GetType() != RECORD_SEEK_TABLE || chunk.GetNodeID() != node.nNodeID ||
+			chunk.GetPayloadSize() % sizeof(DataIndexEntry) != 0 || nEntries == 0 || nEntries > nFramesLeft ||
+			chunk.GetFirstFrame() + nEntries - 1 != nFramesLeft ||
+			chunk.GetSize() + chunk.GetPayloadSize() > RECORD_MAX_SIZE ||
+			nChunkPos + chunk.GetSize() + chunk.GetPayloadSize() > nFileSize)
+		{
+			XN_LOG_WARNING_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Invalid seek table chunk of node %u", node.nNodeID);
+		}
+
+		DataIndexEntry* pEntries = (DataIndexEntry*)(m_pRecordBuffer + chunk.GetSize());
+		XnUInt32 nBytesRead = 0;
+		nRetVal = Read(pEntries, chunk.GetPayloadSize(), nBytesRead);
+		XN_IS_STATUS_OK(nRetVal);
+		if (nBytesRead != chunk.GetPayloadSize())
+		{
+			XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Incorrect number of bytes read");
+		}
+
+		for (XnUInt32 i = 0; i < nEntries; ++i)
+		{
+			nRetVal = m_seekIndex.AddFrame(node.nNodeID, chunk.GetFirstFrame() + i, pEntries[i]);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+
+		nFramesLeft -= nEntries;
+		nChunkPos = chunk.GetUndoRecordPos();
+	}
+
+	return XN_STATUS_OK;
+}
+
+void PlayerNode::AttachSeekIndex(XnUInt32 nNodeID)
+{
+	PlayerNodeInfo* pPlayerNodeInfo = &m_pNodeInfoMap[nNodeID];
+	if (!pPlayerNodeInfo->bIsGenerator || pPlayerNodeInfo->pDataIndex != NULL)
+	{
+		return;
+	}
+
+	XnUInt32 nFrames = 0;
+	DataIndexEntry* pEntries = m_seekIndex.GetEntries(nNodeID, nFrames);
+	if (pEntries == NULL)
+	{
+		return;
+	}
+
+	if (pPlayerNodeInfo->nFrames == XN_MAX_UINT32)
+	{
+		// the recording was never closed, so its header doesn't know how many frames it has
+		pPlayerNodeInfo->nFrames = nFrames;
+	}
+	else if (pPlayerNodeInfo->nFrames != nFrames)
+	{
+		xnLogWarning(XN_MASK_OPEN_NI, "Seek index has %u frames for node %u, but node has %u frames!", nFrames, nNodeID, pPlayerNodeInfo->nFrames);
+		return;
+	}
+
+	pPlayerNodeInfo->pDataIndex = pEntries;
+	pPlayerNodeInfo->bSharedDataIndex = TRUE;
+}
+
 XnStatus PlayerNode::SeekToFrameAbsolute(XnUInt32 nNodeID, XnUInt32 nDestFrame)
 {
 	XN_ASSERT((nNodeID != INVALID_NODE_ID) && (nNodeID < m_nMaxNodes));
@@ -540,6 +1082,8 @@ XnStatus PlayerNode::ProcessEachNodeLastData(XnUInt32 nIDToProcessLast)
 			{
 				/*This means we had to undo this node's data, but found no data frame before our main node's
 			      data frame. In this case we push a 0 frame.*/
+				nRetVal = FlushDecodeJobs();
+				XN_IS_STATUS_OK(nRetVal);
 				memset(m_pRecordBuffer, 0, RECORD_MAX_SIZE);
 				nRetVal = m_pNodeNotifications->OnNodeNewData(m_pNotificationsCookie, pni.strName, 0, 0, m_pRecordBuffer, RECORD_MAX_SIZE);
 				XN_IS_STATUS_OK(nRetVal);
@@ -592,6 +1136,23 @@ XnUInt32 PlayerNode::GetNumFrames(const XnChar* strNodeName, XnUInt32& nFrames)
 	return XN_STATUS_OK;
 }
 
+XnStatus PlayerNode::GetDataIndex(const XnChar* strNodeName, XnUInt32& nNodeID, const DataIndexEntry*& pDataIndex, XnUInt32& nFrames)
+{
+	nNodeID = GetPlayerNodeIDByName(strNodeName);
+	if (nNodeID == INVALID_NODE_ID || !m_pNodeInfoMap[nNodeID].bValid)
+	{
+		return XN_STATUS_BAD_NODE_NAME;
+	}
+
+	XnStatus nRetVal = EnsureSeekIndex();
+	XN_IS_STATUS_OK(nRetVal);
+
+	PlayerNodeInfo* pPlayerNodeInfo = &m_pNodeInfoMap[nNodeID];
+	pDataIndex = pPlayerNodeInfo->bIsGenerator ? pPlayerNodeInfo->pDataIndex : NULL;
+	nFrames = (pDataIndex != NULL) ? pPlayerNodeInfo->nFrames : 0;
+	return XN_STATUS_OK;
+}
+
 const XnChar* PlayerNode::GetSupportedFormat()
 {
 	return XN_FORMAT_NAME_ONI;
@@ -650,6 +1211,22 @@ XnStatus PlayerNode::ValidateStream(void *pStreamCookie, XnPlayerInputStreamInte
 
 XnStatus PlayerNode::ReadNext()
 {
+	if (!m_pendingDecodeJobs.IsEmpty())
+	{
+		// Frames read ahead are delivered before anything else is handled. Leave any other record for the next
+		// call, so that a seek requested while delivering them is handled before it.
+		Record record(m_pRecordBuffer, RECORD_MAX_SIZE, m_bIs32bitFileFormat);
+		XnUInt64 nPos = TellStream();
+		XnStatus nRetVal = ReadRecordHeader(record);
+		XN_IS_STATUS_OK(nRetVal);
+		nRetVal = SeekStream(XN_OS_SEEK_SET, nPos);
+		XN_IS_STATUS_OK(nRetVal);
+		if (record.GetType() != RECORD_NEW_DATA)
+		{
+			return FlushDecodeJobs();
+		}
+	}
+
 	return ProcessRecord(TRUE);
 }
 
@@ -729,6 +1306,11 @@ XnStatus PlayerNode::OpenStream()
 	m_pNodeInfoMap = XN_NEW_ARR(PlayerNodeInfo, m_nMaxNodes);
 	XN_VALIDATE_ALLOC_PTR(m_pNodeInfoMap);
 	XN_VALIDATE_CALLOC(m_aSeekTempArray, DataIndexEntry*, m_nMaxNodes);
+
+	// a cached index (if any) is attached to nodes without seek tables as they are added
+	nRetVal = m_seekIndex.Init((m_strSeekIndexRecordingFile[0] != '\0') ? m_strSeekIndexRecordingFile : NULL, m_nMaxNodes);
+	XN_IS_STATUS_OK(nRetVal);
+	m_bSeekIndexReady = (m_seekIndex.Load() == XN_STATUS_OK);
 	
 	m_bOpen = TRUE;
 	nRetVal = ProcessUntilFirstData();
@@ -824,6 +1406,15 @@ XnStatus PlayerNode::CloseStream()
 XnStatus PlayerNode::HandleRecord(Record &record, XnBool bHandlePayload)
 {
 	XN_ASSERT(record.IsHeaderValid());
+
+	// Anything but a frame may change what the frames read ahead of it are delivered to (or end the stream),
+	// so they are delivered first.
+	if (record.GetType() != RECORD_NEW_DATA)
+	{
+		XnStatus nRetVal = FlushDecodeJobs();
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
 	switch (record.GetType())
 	{
 		case RECORD_NODE_ADDED:
@@ -897,6 +1488,11 @@ XnStatus PlayerNode::RemovePlayerNodeInfo(XnUInt32 nNodeID)
 											   pPlayerNodeInfo->pCodec);
 			pPlayerNodeInfo->pCodec = NULL;
 		}
+		// no frames are in flight at this point (see HandleRecord() and Destroy())
+		for (XnUInt32 i = 0; i < m_decodeWorkers.GetSize(); ++i)
+		{
+			m_decodeWorkers[i]->RemoveCodec(nNodeID);
+		}
 		pPlayerNodeInfo->Reset(); //Now it's not valid anymore
 	}
 
@@ -936,6 +1532,7 @@ XnStatus PlayerNode::HandleNodeAddedImpl(XnUInt32 nNodeID, XnProductionNodeType
 		pPlayerNodeInfo->bIsGenerator = TRUE;
 		pPlayerNodeInfo->nFrames = nNumberOfFrames;
 		pPlayerNodeInfo->nMaxTimeStamp = nMaxTimestamp;
+		AttachSeekIndex(nNodeID);
 	}
 
 	//Mark this player node as valid
@@ -1425,18 +2022,40 @@ XnStatus PlayerNode::HandleNewDataRecord(NewDataRecordHeader record, XnBool bRea
 
 	if (bReadPayload)
 	{
-		//Now read the actual data
+		//Now read the actual data. If the stream is mapped to memory, the data is decoded (or passed on) right
+		//where it is, instead of being read into the record buffer.
+		const XnUInt8* pCompressedData = record.GetPayload(); //The new (compressed) data is right at the end of the header
+		XnUInt32 nCompressedDataSize = record.GetPayloadSize();
 		XnUInt32 nBytesRead = 0;
-		nRetVal = Read(record.GetPayload(), record.GetPayloadSize(), nBytesRead);
+		XnBool bMapped = FALSE;
+		nRetVal = XN_STATUS_NOT_IMPLEMENTED;
+		if (m_pInputStream->Map != NULL)
+		{
+			const void* pMappedData = NULL;
+			nRetVal = m_pInputStream->Map(m_pStreamCookie, nCompressedDataSize, &pMappedData, &nBytesRead);
+			if (nRetVal == XN_STATUS_OK)
+			{
+				pCompressedData = (const XnUInt8*)pMappedData;
+				bMapped = TRUE;
+			}
+		}
+		if (nRetVal == XN_STATUS_NOT_IMPLEMENTED)
+		{
+			nRetVal = Read(record.GetPayload(), nCompressedDataSize, nBytesRead);
+		}
 		XN_IS_STATUS_OK(nRetVal);
-		if (nBytesRead < record.GetPayloadSize())
+		if (nBytesRead < nCompressedDataSize)
 		{
 			XN_ASSERT(FALSE);
 			XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Not enough bytes read");
 		}
 
-		const XnUInt8* pCompressedData = record.GetPayload(); //The new (compressed) data is right at the end of the header
-		XnUInt32 nCompressedDataSize = record.GetPayloadSize();
+		if (!m_decodeWorkers.IsEmpty())
+		{
+			return DispatchNewData(record.GetNodeID(), record.GetTimeStamp(), record.GetFrameNumber(), 
+								   pCompressedData, nCompressedDataSize, bMapped);
+		}
+
 		const XnUInt8* pUncompressedData = NULL;
 		XnUInt32 nUncompressedDataSize = 0;
 		XnCodecID compression = (pPlayerNodeInfo->pCodec == NULL) ? XN_CODEC_NULL :
@@ -1471,6 +2090,217 @@ XnStatus PlayerNode::HandleNewDataRecord(NewDataRecordHeader record, XnBool bRea
 	return XN_STATUS_OK;
 }
 
+void PlayerNode::DecodeFrame(DecodeJob* pJob)
+{
+	pJob->nOutputSize = (XnUInt32)DATA_MAX_SIZE;
+	pJob->nStatus = pJob->pCodec->Decompress(pJob->pInput, pJob->nInputSize, pJob->pOutputBuffer, &pJob->nOutputSize);
+	pJob->pOutput = pJob->pOutputBuffer;
+}
+
+XnStatus PlayerNode::DispatchNewData(XnUInt32 nNodeID, XnUInt64 nTimeStamp, XnUInt32 nFrame, const XnUInt8* pData, XnUInt32 nSize, XnBool bMapped)
+{
+	PlayerNodeInfo* pPlayerNodeInfo = &m_pNodeInfoMap[nNodeID];
+
+	// Keep every worker busy, but don't read further ahead than that. A frame that failed does not stop the
+	// following ones - its error is returned once they were dispatched.
+	XnStatus nDeliverRetVal = XN_STATUS_OK;
+	XnUInt32 nMaxPendingJobs = 2 * m_decodeWorkers.GetSize();
+	while (m_pendingDecodeJobs.Size() >= nMaxPendingJobs)
+	{
+		XnStatus nRetVal = DeliverNextJob();
+		if (nDeliverRetVal == XN_STATUS_OK)
+		{
+			nDeliverRetVal = nRetVal;
+		}
+	}
+
+	DecodeJob* pJob = NULL;
+	if (!m_freeDecodeJobs.IsEmpty())
+	{
+		pJob = *m_freeDecodeJobs.Begin();
+		m_freeDecodeJobs.Remove(m_freeDecodeJobs.Begin());
+	}
+	else
+	{
+		XN_VALIDATE_NEW(pJob, DecodeJob);
+		pJob->pInputBuffer = NULL;
+		pJob->nInputBufferSize = 0;
+		pJob->pOutputBuffer = NULL;
+	}
+
+	XnStatus nRetVal = XN_STATUS_OK;
+	XnCodecID compression = (pPlayerNodeInfo->pCodec == NULL) ? XN_CODEC_NULL :
+							 pPlayerNodeInfo->pCodec->GetCodecID();
+	DecodeWorker* pWorker = NULL;
+	XnCodec* pCodec = NULL;
+	if (compression != XN_CODEC_UNCOMPRESSED)
+	{
+		pWorker = m_decodeWorkers[m_nNextDecodeWorker];
+		pCodec = pWorker->GetCodec(nNodeID);
+		if (pCodec == NULL)
+		{
+			nRetVal = m_pNodeCodecFactory->Create(m_pNodeCodecFactoryCookie, pPlayerNodeInfo->strName, 
+												  pPlayerNodeInfo->compression, &pCodec);
+			if (nRetVal == XN_STATUS_OK)
+			{
+				nRetVal = pWorker->SetCodec(nNodeID, pCodec);
+				if (nRetVal != XN_STATUS_OK)
+				{
+					m_pNodeCodecFactory->Destroy(m_pNodeCodecFactoryCookie, pCodec);
+				}
+			}
+		}
+
+		if (nRetVal == XN_STATUS_OK && pJob->pOutputBuffer == NULL)
+		{
+			pJob->pOutputBuffer = XN_NEW_ARR(XnUInt8, DATA_MAX_SIZE);
+			if (pJob->pOutputBuffer == NULL)
+			{
+				nRetVal = XN_STATUS_ALLOC_FAILED;
+			}
+		}
+	}
+
+	// the record buffer is reused by the next record
+	if (nRetVal == XN_STATUS_OK && !bMapped)
+	{
+		if (pJob->nInputBufferSize < nSize)
+		{
+			XN_DELETE_ARR(pJob->pInputBuffer);
+			pJob->pInputBuffer = XN_NEW_ARR(XnUInt8, nSize);
+			pJob->nInputBufferSize = (pJob->pInputBuffer != NULL) ? nSize : 0;
+		}
+		if (pJob->pInputBuffer == NULL)
+		{
+			nRetVal = XN_STATUS_ALLOC_FAILED;
+		}
+		else
+		{
+			xnOSMemCopy(pJob->pInputBuffer, pData, nSize);
+			pData = pJob->pInputBuffer;
+		}
+	}
+
+	if (nRetVal != XN_STATUS_OK)
+	{
+		m_freeDecodeJobs.AddLast(pJob);
+		XN_IS_STATUS_OK_LOG_ERROR("Dispatch frame", nRetVal);
+	}
+
+	pJob->nNodeID = nNodeID;
+	pJob->nTimeStamp = nTimeStamp;
+	pJob->nFrame = nFrame;
+	pJob->pCodec = pCodec;
+	pJob->pInput = pData;
+	pJob->nInputSize = nSize;
+	pJob->pOutput = pData;
+	pJob->nOutputSize = nSize;
+	pJob->nStatus = XN_STATUS_OK;
+	pJob->bDone = (pCodec == NULL);
+	m_pendingDecodeJobs.AddLast(pJob);
+
+	if (pCodec != NULL)
+	{
+		pWorker->Submit(pJob);
+		m_nNextDecodeWorker = (m_nNextDecodeWorker + 1) % m_decodeWorkers.GetSize();
+	}
+
+	nRetVal = DeliverCompletedJobs();
+	return (nDeliverRetVal != XN_STATUS_OK) ? nDeliverRetVal : nRetVal;
+}
+
+void PlayerNode::OnDecodeJobDone(DecodeJob* pJob)
+{
+	{
+		xnl::AutoCSLocker lock(m_decodeLock);
+		pJob->bDone = TRUE;
+	}
+	m_decodeDoneEvent.Set();
+}
+
+void PlayerNode::WaitForDecodeJob(DecodeJob* pJob)
+{
+	xnl::AutoCSLocker lock(m_decodeLock);
+	while (!pJob->bDone)
+	{
+		lock.Unlock();
+		m_decodeDoneEvent.Wait(XN_WAIT_INFINITE);
+		lock.Lock();
+	}
+}
+
+XnStatus PlayerNode::DeliverCompletedJobs()
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	while (!m_pendingDecodeJobs.IsEmpty())
+	{
+		{
+			xnl::AutoCSLocker lock(m_decodeLock);
+			if (!(*m_pendingDecodeJobs.Begin())->bDone)
+			{
+				break;
+			}
+		}
+
+		XnStatus nJobRetVal = DeliverNextJob();
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = nJobRetVal;
+		}
+	}
+
+	return nRetVal;
+}
+
+XnStatus PlayerNode::DeliverNextJob()
+{
+	DecodeJob* pJob = *m_pendingDecodeJobs.Begin();
+	WaitForDecodeJob(pJob);
+	m_pendingDecodeJobs.Remove(m_pendingDecodeJobs.Begin());
+
+	PlayerNodeInfo* pPlayerNodeInfo = &m_pNodeInfoMap[pJob->nNodeID];
+	XnStatus nRetVal = pJob->nStatus;
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = m_pNodeNotifications->OnNodeNewData(m_pNotificationsCookie, pPlayerNodeInfo->strName, 
+													  pJob->nTimeStamp, pJob->nFrame, 
+													  pJob->pOutput, pJob->nOutputSize);
+	}
+	else
+	{
+		xnLogWarning(XN_MASK_OPEN_NI, "Failed to decode frame %u of node '%s': %s", pJob->nFrame, pPlayerNodeInfo->strName, xnGetStatusString(nRetVal));
+	}
+
+	m_freeDecodeJobs.AddLast(pJob);
+	return nRetVal;
+}
+
+XnStatus PlayerNode::FlushDecodeJobs()
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+	while (!m_pendingDecodeJobs.IsEmpty())
+	{
+		XnStatus nJobRetVal = DeliverNextJob();
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = nJobRetVal;
+		}
+	}
+
+	return nRetVal;
+}
+
+void PlayerNode::DiscardDecodeJobs()
+{
+	// jobs can't be taken back from the workers - let them finish
+	for (xnl::List<DecodeJob*>::Iterator i = m_pendingDecodeJobs.Begin(); i != m_pendingDecodeJobs.End(); ++i)
+	{
+		WaitForDecodeJob(*i);
+		m_freeDecodeJobs.AddLast(*i);
+	}
+	m_pendingDecodeJobs.Clear();
+}
+
 XnStatus PlayerNode::HandleDataIndexRecord(DataIndexRecordHeader record, XnBool bReadPayload)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -1510,7 +2340,8 @@ XnStatus PlayerNode::HandleDataIndexRecord(DataIndexRecordHeader record, XnBool
 			XN_LOG_WARNING_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_OPEN_NI, "Seek table has %u entries, but node has %u frames!", record.GetPayloadSize() / DIESize, pPlayerNodeInfo->nFrames);
 		}
 
-		// allocate our data index
+		// allocate our data index (the file's own seek table always wins over a cached one)
+		pPlayerNodeInfo->ReleaseDataIndex();
 		pPlayerNodeInfo->pDataIndex = (DataIndexEntry*)xnOSCalloc(pPlayerNodeInfo->nFrames+1, sizeof(DataIndexEntry));
 		XN_VALIDATE_ALLOC_PTR(pPlayerNodeInfo->pDataIndex);
 
@@ -1623,6 +2454,20 @@ XnStatus PlayerNode::SeekToTimeStampAbsolute(XnUInt64 nDestTimeStamp)
 	XnUInt64 nStartPos = TellStream(); //We'll revert to this in case nDestTimeStamp is beyond end of stream
 	XN_IS_STATUS_OK(nRetVal);
 
+	if (nDestTimeStamp != m_nTimeStamp)
+	{
+		nRetVal = EnsureSeekIndex();
+		XN_IS_STATUS_OK(nRetVal);
+
+		XnBool bSeeked = FALSE;
+		nRetVal = SeekToTimeStampFromDataIndex(XN_MIN(nDestTimeStamp, m_nGlobalMaxTimeStamp), bSeeked);
+		XN_IS_STATUS_OK(nRetVal);
+		if (bSeeked)
+		{
+			return XN_STATUS_OK;
+		}
+	}
+
 	if (nDestTimeStamp < m_nTimeStamp)
 	{
 		nRetVal = Rewind();
@@ -1779,6 +2624,7 @@ PlayerNode::PlayerNodeInfo::PlayerNodeInfo()
 {
 	pCodec = NULL;
 	pDataIndex = NULL;
+	bSharedDataIndex = FALSE;
 	Reset();
 }
 
@@ -1799,8 +2645,17 @@ void PlayerNode::PlayerNodeInfo::Reset()
 	recordUndoInfoMap.Clear();
 	newDataUndoInfo.Reset();
 	bValid = FALSE;
-	xnOSFree(pDataIndex);
+	ReleaseDataIndex();
+}
+
+void PlayerNode::PlayerNodeInfo::ReleaseDataIndex()
+{
+	if (!bSharedDataIndex)
+	{
+		xnOSFree(pDataIndex);
+	}
 	pDataIndex = NULL;
+	bSharedDataIndex = FALSE;
 }
 
 }
@@ -22,11 +22,15 @@
 #define __PLAYER_H__
 
 #include "DataRecords.h"
+#include "PlayerSeekIndex.h"
 #include "XnPlayerTypes.h"
 #include "Formats/XnCodecIDs.h"
 #include "Formats/XnStreamFormats.h"
 #include "XnHash.h"
 #include "XnEvent.h"
+#include "XnList.h"
+#include "XnArray.h"
+#include "XnOSCpp.h"
 
 class XnCodec;
 
@@ -58,6 +62,11 @@ public:
 	virtual XnStatus ReadNext();
 	virtual XnStatus SetNodeNotifications(void* pNotificationsCookie, XnNodeNotifications* pNodeNotifications);
 	virtual XnStatus SetNodeCodecFactory(void* pFactoryCookie, PlayerNode::CodecFactory* pPlayerNodeCodecFactory);
+	// Lets recordings without seek tables cache the index built for them next to the file. Call before SetInputStream().
+	virtual XnStatus SetSeekIndexCacheFile(const XnChar* strRecordingFile);
+	// Decodes frames on the given number of worker threads, while the player thread reads ahead and hands the
+	// decoded frames out in file order. 0 decodes each frame on the player thread. Call before SetInputStream().
+	virtual XnStatus SetDecodeThreads(XnUInt32 nThreads);
 	virtual XnStatus SetRepeat(XnBool bRepeat);
 	virtual XnStatus SeekToTimeStamp(XnInt64 nTimeOffset, XnPlayerSeekOrigin origin);
 
@@ -65,6 +74,9 @@ public:
 	virtual XnStatus TellTimestamp(XnUInt64& nTimestamp);
 	virtual XnStatus TellFrame(const XnChar* strNodeName, XnUInt32& nFrameNumber);
 	virtual XnUInt32 GetNumFrames(const XnChar* strNodeName, XnUInt32& nFrames);
+	// Returns the ID of a node in the file, and its frame index (entry i is frame i, entry 0 is unused). Recordings
+	// without seek tables are indexed first. pDataIndex is NULL for nodes that have no data, or could not be indexed.
+	virtual XnStatus GetDataIndex(const XnChar* strNodeName, XnUInt32& nNodeID, const DataIndexEntry*& pDataIndex, XnUInt32& nFrames);
 
 	virtual const XnChar* GetSupportedFormat();
 	virtual XnBool IsEOF();
@@ -73,6 +85,9 @@ public:
 
 	static XnStatus ValidateStream(void *pStreamCookie, XnPlayerInputStreamInterface* pInputStream);
 
+	static XnInt32 CompareVersions(const XnVersion* pV0, const XnVersion* pV1);
+	static const XnVersion FIRST_FILESIZE64BIT_FILE_FORMAT_VERSION;
+
 private:
 	struct RecordUndoInfo
 	{
@@ -90,6 +105,7 @@ private:
 		~PlayerNodeInfo();
 
 		void Reset();
+		void ReleaseDataIndex();
 
 		XnBool bValid;
 		XnChar strName[XN_MAX_NAME_LENGTH];
@@ -104,8 +120,42 @@ private:
 		RecordUndoInfoMap recordUndoInfoMap;
 		RecordUndoInfo newDataUndoInfo;
 		DataIndexEntry* pDataIndex;
+		XnBool bSharedDataIndex; // pDataIndex belongs to m_seekIndex
 	};
 
+	// A frame read ahead of its delivery. Jobs are recycled along with their buffers.
+	struct DecodeJob
+	{
+		XnUInt32 nNodeID;
+		XnUInt64 nTimeStamp;
+		XnUInt32 nFrame;
+		XnCodec* pCodec;			// the codec of the worker, NULL when the data is passed on as is
+		const XnUInt8* pInput;		// either mapped, or copied to pInputBuffer
+		XnUInt32 nInputSize;
+		XnUInt8* pInputBuffer;
+		XnUInt32 nInputBufferSize;
+		XnUInt8* pOutputBuffer;		// DATA_MAX_SIZE bytes, allocated on first decode
+		const XnUInt8* pOutput;
+		XnUInt32 nOutputSize;
+		XnStatus nStatus;
+		XnBool bDone;				// under m_decodeLock
+	};
+
+	class DecodeWorker;
+	friend class DecodeWorker;
+
+	static void DecodeFrame(DecodeJob* pJob);
+
+	// Frames are decoded out of order by the workers, but delivered in the order they were read.
+	XnStatus DispatchNewData(XnUInt32 nNodeID, XnUInt64 nTimeStamp, XnUInt32 nFrame, const XnUInt8* pData, XnUInt32 nSize, XnBool bMapped);
+	void OnDecodeJobDone(DecodeJob* pJob);
+	void WaitForDecodeJob(DecodeJob* pJob);
+	XnStatus DeliverCompletedJobs();
+	XnStatus DeliverNextJob();
+	XnStatus FlushDecodeJobs();
+	void DiscardDecodeJobs();
+	void StopDecodeWorkers();
+
 	XnStatus ProcessRecord(XnBool bProcessPayload);
 	XnStatus SeekToTimeStampAbsolute(XnUInt64 nDestTimeStamp);
 	XnStatus SeekToTimeStampRelative(XnInt64 nOffset);
@@ -113,7 +163,6 @@ private:
 	XnStatus SeekToFrameAbsolute(XnUInt32 nNodeID, XnUInt32 nFrameNumber);
 	XnStatus ProcessEachNodeLastData(XnUInt32 nIDToProcessLast);
 
-	static XnInt32 CompareVersions(const XnVersion* pV0, const XnVersion* pV1);
 	XnStatus OpenStream();
 	XnStatus Read(void* pData, XnUInt32 nSize, XnUInt32& nBytesRead);
 	XnStatus ReadRecordHeader(Record& record);
@@ -151,6 +200,12 @@ private:
 	XnStatus SeekToRecordByType(XnUInt32 nNodeID, RecordType type);
 	DataIndexEntry* FindTimestampInDataIndex(XnUInt32 nNodeID, XnUInt64 nTimestamp);
 	DataIndexEntry** GetSeekLocationsFromDataIndex(XnUInt32 nNodeID, XnUInt32 nDestFrame);
+	XnStatus SeekToTimeStampFromDataIndex(XnUInt64 nDestTimeStamp, XnBool& bSeeked);
+	XnStatus EnsureSeekIndex();
+	XnStatus BuildSeekIndex();
+	XnStatus LoadCheckpoints(XnUInt64 nFileSize, XnUInt64& nScanPos, XnUInt32& nConfigurationID);
+	XnStatus LoadSeekTableChunks(const CheckpointNodeEntry& node, XnUInt64 nFileSize);
+	void AttachSeekIndex(XnUInt32 nNodeID);
 
 	// BC functions
 	XnStatus HandleNodeAdded_1_0_0_5_Record(NodeAdded_1_0_0_5_Record record);
@@ -159,7 +214,6 @@ private:
 	static const XnUInt64 DATA_MAX_SIZE;
 	static const XnUInt64 RECORD_MAX_SIZE;
 	static const XnVersion OLDEST_SUPPORTED_FILE_FORMAT_VERSION;
-	static const XnVersion FIRST_FILESIZE64BIT_FILE_FORMAT_VERSION;
 
 	XnVersion m_fileVersion;
 	XnChar m_strName[XN_MAX_NAME_LENGTH];
@@ -187,7 +241,18 @@ private:
 
 	DataIndexEntry** m_aSeekTempArray;
 
+	XnChar m_strSeekIndexRecordingFile[XN_FILE_MAX_PATH];
+	PlayerSeekIndex m_seekIndex;
+	XnBool m_bSeekIndexReady;
+
 	XnMapOutputMode m_lastOutputMode;
+
+	xnl::Array<DecodeWorker*> m_decodeWorkers;
+	XnUInt32 m_nNextDecodeWorker;
+	xnl::List<DecodeJob*> m_pendingDecodeJobs; // read ahead, in file order
+	xnl::List<DecodeJob*> m_freeDecodeJobs;
+	xnl::CriticalSection m_decodeLock;
+	xnl::OSEvent m_decodeDoneEvent;
 };
 
 }
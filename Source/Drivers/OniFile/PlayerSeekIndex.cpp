@@ -0,0 +1,293 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "PlayerSeekIndex.h"
+#include <XnLog.h>
+
+#define XN_MASK_OPEN_NI ""
+
+#define PLAYER_SEEK_INDEX_FILE_EXTENSION	".seek"
+#define PLAYER_SEEK_INDEX_MAGIC				0x4B455358 // "XSEK"
+#define PLAYER_SEEK_INDEX_VERSION			1
+
+namespace oni_file {
+
+namespace {
+
+typedef struct
+{
+	XnUInt32 nMagic;
+	XnUInt32 nVersion;
+	XnUInt64 nRecordingSize;
+	XnUInt64 nRecordingModificationTime;
+	XnUInt32 nNodes;
+	XnUInt32 nReserved;
+} SeekIndexFileHeader;
+
+XnStatus ReadExactly(XN_FILE_HANDLE file, void* pData, XnUInt32 nSize)
+{
+	XnUInt32 nRead = nSize;
+	XnStatus nRetVal = xnOSReadFile(file, pData, &nRead);
+	XN_IS_STATUS_OK(nRetVal);
+	return (nRead == nSize) ? XN_STATUS_OK : XN_STATUS_CORRUPT_FILE;
+}
+
+} // namespace
+
+PlayerSeekIndex::PlayerSeekIndex() :
+	m_aNodes(NULL), m_nNodes(0), m_bComplete(FALSE)
+{
+	m_strRecordingFile[0] = '\0';
+	m_strIndexFile[0] = '\0';
+}
+
+PlayerSeekIndex::~PlayerSeekIndex()
+{
+	Clear();
+}
+
+XnStatus PlayerSeekIndex::Init(const XnChar* strRecordingFile, XnUInt32 nMaxNodes)
+{
+	Clear();
+
+	m_aNodes = XN_NEW_ARR(xnl::Array<DataIndexEntry>, nMaxNodes);
+	XN_VALIDATE_ALLOC_PTR(m_aNodes);
+	m_nNodes = nMaxNodes;
+
+	if (strRecordingFile != NULL)
+	{
+		XnStatus nRetVal = xnOSStrCopy(m_strRecordingFile, strRecordingFile, sizeof(m_strRecordingFile));
+		XN_IS_STATUS_OK(nRetVal);
+		nRetVal = xnOSStrCopy(m_strIndexFile, strRecordingFile, sizeof(m_strIndexFile));
+		XN_IS_STATUS_OK(nRetVal);
+		nRetVal = xnOSStrAppend(m_strIndexFile, PLAYER_SEEK_INDEX_FILE_EXTENSION, sizeof(m_strIndexFile));
+		if (nRetVal != XN_STATUS_OK)
+		{
+			// path too long - just don't cache the index
+			m_strRecordingFile[0] = '\0';
+			m_strIndexFile[0] = '\0';
+		}
+	}
+
+	return XN_STATUS_OK;
+}
+
+void PlayerSeekIndex::Clear()
+{
+	XN_DELETE_ARR(m_aNodes);
+	m_aNodes = NULL;
+	m_nNodes = 0;
+	m_bComplete = FALSE;
+	m_strRecordingFile[0] = '\0';
+	m_strIndexFile[0] = '\0';
+}
+
+XnStatus PlayerSeekIndex::GetRecordingKey(XnUInt64& nFileSize, XnUInt64& nModificationTime)
+{
+	XnStatus nRetVal = xnOSGetFileSize64(m_strRecordingFile, &nFileSize);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = xnOSGetFileModificationTime(m_strRecordingFile, &nModificationTime);
+	XN_IS_STATUS_OK(nRetVal);
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerSeekIndex::Load()
+{
+	if (m_strIndexFile[0] == '\0' || m_aNodes == NULL)
+	{
+		return XN_STATUS_NO_MATCH;
+	}
+
+	XnBool bExists = FALSE;
+	XnStatus nRetVal = xnOSDoesFileExist(m_strIndexFile, &bExists);
+	if (nRetVal != XN_STATUS_OK || !bExists)
+	{
+		return XN_STATUS_OS_FILE_NOT_FOUND;
+	}
+
+	XnUInt64 nFileSize = 0;
+	XnUInt64 nModificationTime = 0;
+	nRetVal = GetRecordingKey(nFileSize, nModificationTime);
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnUInt64 nIndexFileSize = 0;
+	nRetVal = xnOSGetFileSize64(m_strIndexFile, &nIndexFileSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	XN_FILE_HANDLE file;
+	nRetVal = xnOSOpenFile(m_strIndexFile, XN_OS_FILE_READ, &file);
+	XN_IS_STATUS_OK(nRetVal);
+
+	SeekIndexFileHeader header;
+	nRetVal = ReadExactly(file, &header, sizeof(header));
+	if (nRetVal == XN_STATUS_OK &&
+		(header.nMagic != PLAYER_SEEK_INDEX_MAGIC ||
+		 header.nVersion != PLAYER_SEEK_INDEX_VERSION ||
+		 header.nRecordingSize != nFileSize ||
+		 header.nRecordingModificationTime != nModificationTime ||
+		 header.nNodes != m_nNodes))
+	{
+		xnLogVerbose(XN_MASK_OPEN_NI, "Seek index '%s' does not match the recording, ignoring it", m_strIndexFile);
+		nRetVal = XN_STATUS_NO_MATCH;
+	}
+
+	XnUInt64 nIndexPos = sizeof(header);
+	for (XnUInt32 i = 0; i < m_nNodes && nRetVal == XN_STATUS_OK; ++i)
+	{
+		XnUInt32 nEntries = 0;
+		nRetVal = ReadExactly(file, &nEntries, sizeof(nEntries));
+		nIndexPos += sizeof(nEntries);
+
+		// don't trust the count for more than the file can hold
+		XnUInt64 nEntriesSize = (XnUInt64)nEntries * sizeof(DataIndexEntry);
+		if (nRetVal == XN_STATUS_OK && (nEntriesSize > nIndexFileSize - XN_MIN(nIndexPos, nIndexFileSize) || nEntriesSize > XN_MAX_UINT32))
+		{
+			nRetVal = XN_STATUS_CORRUPT_FILE;
+		}
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = m_aNodes[i].SetSize(nEntries);
+		}
+		if (nRetVal == XN_STATUS_OK && nEntries > 0)
+		{
+			nRetVal = ReadExactly(file, m_aNodes[i].GetData(), (XnUInt32)nEntriesSize);
+			nIndexPos += nEntriesSize;
+		}
+
+		// and all the frames must be in the recording
+		for (XnUInt32 nFrame = 1; nFrame < nEntries && nRetVal == XN_STATUS_OK; ++nFrame)
+		{
+			if (m_aNodes[i][nFrame].nSeekPos >= nFileSize)
+			{
+				nRetVal = XN_STATUS_CORRUPT_FILE;
+			}
+		}
+	}
+
+	if (nRetVal == XN_STATUS_CORRUPT_FILE)
+	{
+		xnLogWarning(XN_MASK_OPEN_NI, "Seek index '%s' is corrupt, ignoring it", m_strIndexFile);
+	}
+
+	xnOSCloseFile(&file);
+
+	if (nRetVal != XN_STATUS_OK)
+	{
+		for (XnUInt32 i = 0; i < m_nNodes; ++i)
+		{
+			m_aNodes[i].Clear();
+		}
+		return nRetVal;
+	}
+
+	m_bComplete = TRUE;
+	xnLogVerbose(XN_MASK_OPEN_NI, "Loaded seek index from '%s'", m_strIndexFile);
+
+	return XN_STATUS_OK;
+}
+
+XnStatus PlayerSeekIndex::Save()
+{
+	if (m_strIndexFile[0] == '\0' || !m_bComplete)
+	{
+		return XN_STATUS_NO_MATCH;
+	}
+
+	SeekIndexFileHeader header;
+	xnOSMemSet(&header, 0, sizeof(header));
+	header.nMagic = PLAYER_SEEK_INDEX_MAGIC;
+	header.nVersion = PLAYER_SEEK_INDEX_VERSION;
+	header.nNodes = m_nNodes;
+	XnStatus nRetVal = GetRecordingKey(header.nRecordingSize, header.nRecordingModificationTime);
+	XN_IS_STATUS_OK(nRetVal);
+
+	XN_FILE_HANDLE file;
+	nRetVal = xnOSOpenFile(m_strIndexFile, XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, &file);
+	XN_IS_STATUS_OK(nRetVal);
+
+	nRetVal = xnOSWriteFile(file, &header, sizeof(header));
+	for (XnUInt32 i = 0; i < m_nNodes && nRetVal == XN_STATUS_OK; ++i)
+	{
+		XnUInt32 nEntries = m_aNodes[i].GetSize();
+		nRetVal = xnOSWriteFile(file, &nEntries, sizeof(nEntries));
+		if (nRetVal == XN_STATUS_OK && nEntries > 0)
+		{
+			nRetVal = xnOSWriteFile(file, m_aNodes[i].GetData(), nEntries * sizeof(DataIndexEntry));
+		}
+	}
+
+	xnOSCloseFile(&file);
+
+	if (nRetVal != XN_STATUS_OK)
+	{
+		// don't leave a partial index behind
+		xnOSDeleteFile(m_strIndexFile);
+	}
+
+	return nRetVal;
+}
+
+XnStatus PlayerSeekIndex::AddFrame(XnUInt32 nNodeID, XnUInt32 nFrame, const DataIndexEntry& entry)
+{
+	if (nNodeID >= m_nNodes || nFrame == 0)
+	{
+		return XN_STATUS_CORRUPT_FILE;
+	}
+
+	DataIndexEntry emptyEntry;
+	xnOSMemSet(&emptyEntry, 0, sizeof(emptyEntry));
+	XnStatus nRetVal = m_aNodes[nNodeID].SetMinSize(nFrame + 1, emptyEntry);
+	XN_IS_STATUS_OK(nRetVal);
+
+	m_aNodes[nNodeID][nFrame] = entry;
+	return XN_STATUS_OK;
+}
+
+void PlayerSeekIndex::Complete()
+{
+	for (XnUInt32 i = 0; i < m_nNodes; ++i)
+	{
+		for (XnUInt32 nFrame = 1; nFrame < m_aNodes[i].GetSize(); ++nFrame)
+		{
+			if (m_aNodes[i][nFrame].nSeekPos == 0)
+			{
+				xnLogWarning(XN_MASK_OPEN_NI, "Frame %u of node %u is missing from the recording, not indexing this node", nFrame, i);
+				m_aNodes[i].Clear();
+				break;
+			}
+		}
+	}
+
+	m_bComplete = TRUE;
+}
+
+DataIndexEntry* PlayerSeekIndex::GetEntries(XnUInt32 nNodeID, XnUInt32& nFrames)
+{
+	if (!m_bComplete || nNodeID >= m_nNodes || m_aNodes[nNodeID].GetSize() < 2)
+	{
+		nFrames = 0;
+		return NULL;
+	}
+
+	nFrames = m_aNodes[nNodeID].GetSize() - 1;
+	return m_aNodes[nNodeID].GetData();
+}
+
+} // namespace oni_file
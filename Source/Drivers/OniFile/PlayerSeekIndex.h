@@ -0,0 +1,78 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __PLAYER_SEEK_INDEX_H__
+#define __PLAYER_SEEK_INDEX_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "DataRecords.h"
+#include "XnArray.h"
+
+namespace oni_file {
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/// Frame index of a recording that has no seek tables of its own (an old file format, or a recording that was never
+/// closed properly). It holds the same entries a seek table would, per node, and is cached in a sidecar file next to
+/// the recording ("<recording>.seek"), keyed by the size and modification time of the recording, so it is built only
+/// once per file.
+class PlayerSeekIndex
+{
+public:
+	PlayerSeekIndex();
+	~PlayerSeekIndex();
+
+	/// Starts an empty index. strRecordingFile may be NULL, in which case the index is never cached.
+	XnStatus Init(const XnChar* strRecordingFile, XnUInt32 nMaxNodes);
+	void Clear();
+
+	/// Loads the index from the sidecar file. Fails if there is none, or if it doesn't match the recording anymore.
+	XnStatus Load();
+	XnStatus Save();
+
+	/// Records the position of a frame. Frames of a node may be added in any order.
+	XnStatus AddFrame(XnUInt32 nNodeID, XnUInt32 nFrame, const DataIndexEntry& entry);
+
+	/// Marks the index as complete, and drops nodes that miss some of their frames.
+	void Complete();
+	XnBool IsComplete() const { return m_bComplete; }
+
+	/// Returns the entries of a node, indexed by frame number (entry 0 is unused, like in seek tables), or NULL if
+	/// the node has no frames in the index.
+	DataIndexEntry* GetEntries(XnUInt32 nNodeID, XnUInt32& nFrames);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(PlayerSeekIndex);
+
+	XnStatus GetRecordingKey(XnUInt64& nFileSize, XnUInt64& nModificationTime);
+
+	XnChar m_strRecordingFile[XN_FILE_MAX_PATH]; // empty if the index is not cached
+	XnChar m_strIndexFile[XN_FILE_MAX_PATH];
+	xnl::Array<DataIndexEntry>* m_aNodes;
+	XnUInt32 m_nNodes;
+	XnBool m_bComplete;
+};
+
+} // namespace oni_file
+
+#endif // __PLAYER_SEEK_INDEX_H__
@@ -0,0 +1,1017 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#include "PlayerSegmentExporter.h"
+#include <XnLog.h>
+
+#define XN_MASK_PLAYER_SEGMENT_EXPORTER "PlayerSegmentExporter"
+
+#define PLAYER_SEGMENT_EXPORTER_MIN_BUFFER_SIZE		4096
+
+namespace oni_file {
+
+namespace {
+
+XnBool IsTypeGenerator(XnProductionNodeType type)
+{
+	return (type == XN_NODE_TYPE_DEPTH) || (type == XN_NODE_TYPE_IMAGE) || (type == XN_NODE_TYPE_IR);
+}
+
+XnBool IsPropertyRecord(XnUInt32 nRecordType)
+{
+	return (nRecordType == RECORD_INT_PROPERTY) || (nRecordType == RECORD_REAL_PROPERTY) ||
+		(nRecordType == RECORD_STRING_PROPERTY) || (nRecordType == RECORD_GENERAL_PROPERTY);
+}
+
+XnBool IsOld32bitFileFormat(const XnVersion& version)
+{
+	return (PlayerNode::CompareVersions(&version, &PlayerNode::FIRST_FILESIZE64BIT_FILE_FORMAT_VERSION) < 0);
+}
+
+// Grows a buffer so it holds at least nSize bytes. Its content is not kept.
+XnStatus EnsureBufferSize(XnUInt8*& pBuffer, XnUInt32& nBufferSize, XnUInt32 nSize)
+{
+	if (nSize <= nBufferSize)
+	{
+		return XN_STATUS_OK;
+	}
+
+	xnOSFree(pBuffer);
+	nBufferSize = XN_MAX(nSize, (XnUInt32)PLAYER_SEGMENT_EXPORTER_MIN_BUFFER_SIZE);
+	pBuffer = (XnUInt8*)xnOSMalloc(nBufferSize);
+	if (pBuffer == NULL)
+	{
+		nBufferSize = 0;
+		return XN_STATUS_ALLOC_FAILED;
+	}
+
+	return XN_STATUS_OK;
+}
+
+// Returns the first frame with a timestamp at or after nTimestamp, or nFrames + 1 if there is none.
+XnUInt32 FindFirstFrameAtOrAfter(const DataIndexEntry* pDataIndex, XnUInt32 nFrames, XnUInt64 nTimestamp)
+{
+	XnUInt32 first = 1;
+	XnUInt32 last = nFrames + 1;
+	while (first < last)
+	{
+		XnUInt32 mid = first + (last - first) / 2;
+		if (pDataIndex[mid].nTimestamp < nTimestamp)
+		{
+			first = mid + 1;
+		}
+		else
+		{
+			last = mid;
+		}
+	}
+	return first;
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------
+// PlayerSegmentExporter::SegmentJob
+//---------------------------------------------------------------------------
+// Exports a single segment: collects the properties the nodes had when it starts, writes the nodes, copies the
+// records of the segment, and ends the file with the seek tables.
+class PlayerSegmentExporter::SegmentJob
+{
+public:
+	SegmentJob(const PlayerSegmentExporter* pExporter, const Segment& segment) :
+		m_pExporter(pExporter),
+		m_segment(segment),
+		m_pNodes(NULL),
+		m_sourceFile(XN_INVALID_FILE_HANDLE),
+		m_pFields(NULL),
+		m_nFieldsBufferSize(0),
+		m_pPayload(NULL),
+		m_nPayloadBufferSize(0),
+		m_outFile(XN_INVALID_FILE_HANDLE),
+		m_nOutPos(0),
+		m_pOut(NULL),
+		m_nOutBufferSize(0),
+		m_nConfigurationID(0),
+		m_nStartPos(0),
+		m_nPropertiesEndPos(0),
+		m_nFramesLeft(0),
+		m_nMaxTimestamp(0)
+	{}
+
+	~SegmentJob()
+	{
+		XN_DELETE_ARR(m_pNodes);
+		if (m_sourceFile != XN_INVALID_FILE_HANDLE)
+		{
+			xnOSCloseFile(&m_sourceFile);
+		}
+		if (m_outFile != XN_INVALID_FILE_HANDLE)
+		{
+			xnOSCloseFile(&m_outFile);
+		}
+		xnOSFree(m_pFields);
+		xnOSFree(m_pPayload);
+		xnOSFree(m_pOut);
+	}
+
+	XnStatus Run()
+	{
+		XnStatus nRetVal = Plan();
+		XN_IS_STATUS_OK(nRetVal);
+
+		if (m_pExporter->m_pMapping == NULL)
+		{
+			nRetVal = xnOSOpenFile(m_pExporter->m_strFileName, XN_OS_FILE_READ, &m_sourceFile);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+
+		nRetVal = CollectProperties();
+		XN_IS_STATUS_OK(nRetVal);
+
+		nRetVal = xnOSOpenFile(m_segment.strFileName, XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, &m_outFile);
+		XN_IS_STATUS_OK(nRetVal);
+
+		nRetVal = WriteNodes();
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = CopyRecords();
+		}
+		if (nRetVal == XN_STATUS_OK)
+		{
+			nRetVal = WriteSeekTables();
+		}
+
+		xnOSCloseFile(&m_outFile);
+		m_outFile = XN_INVALID_FILE_HANDLE;
+		if (nRetVal != XN_STATUS_OK)
+		{
+			// don't leave a recording that can't be played behind
+			xnOSDeleteFile(m_segment.strFileName);
+		}
+
+		return nRetVal;
+	}
+
+private:
+	struct Property
+	{
+		XnUInt32 nRecordType;
+		XnChar strName[XN_MAX_NAME_LENGTH];
+		xnl::Array<XnUInt8> data;
+		XnUInt64 nLastRecordPos; // in the exported file, 0 until written
+	};
+
+	struct NodeState
+	{
+		NodeState() : bExported(FALSE), nFirstFrame(0), nLastFrame(0), nNodeAddedPos(0), nLastDataPos(0) {}
+
+		XnBool bExported;
+		XnUInt32 nFirstFrame; // frame numbers in the recording
+		XnUInt32 nLastFrame;
+		xnl::Array<Property> properties; // in the order they were first set
+		xnl::Array<DataIndexEntry> dataIndex; // of the exported file
+		XnUInt64 nNodeAddedPos;
+		XnUInt64 nLastDataPos;
+	};
+
+	const NodeInfo& GetNode(XnUInt32 i) const { return m_pExporter->m_nodes[i]; }
+
+	// Returns the index of the node with the given ID in the recording, or the number of nodes if there is none.
+	XnUInt32 FindNode(XnUInt32 nNodeID) const
+	{
+		XnUInt32 i = 0;
+		while (i < m_pExporter->m_nodes.GetSize() && GetNode(i).nNodeID != nNodeID)
+		{
+			++i;
+		}
+		return i;
+	}
+
+	XnStatus Plan()
+	{
+		const XnUInt32 nNodes = m_pExporter->m_nodes.GetSize();
+		m_pNodes = XN_NEW_ARR(NodeState, nNodes);
+		XN_VALIDATE_ALLOC_PTR(m_pNodes);
+
+		XnUInt32 nRef = 0;
+		while (nRef < nNodes && xnOSStrCmp(GetNode(nRef).strName, m_segment.strNodeName) != 0)
+		{
+			++nRef;
+		}
+		if (nRef == nNodes || GetNode(nRef).pDataIndex == NULL)
+		{
+			XN_LOG_WARNING_RETURN(XN_STATUS_BAD_NODE_NAME, XN_MASK_PLAYER_SEGMENT_EXPORTER, "Can't export segment of '%s': no such node, or it has no frame index", m_segment.strNodeName);
+		}
+
+		const NodeInfo& ref = GetNode(nRef);
+		if (m_segment.nFirstFrame < 1 || m_segment.nFirstFrame > m_segment.nLastFrame || m_segment.nLastFrame > ref.nFrames)
+		{
+			XN_LOG_WARNING_RETURN(XN_STATUS_BAD_PARAM, XN_MASK_PLAYER_SEGMENT_EXPORTER, "Can't export frames %u-%u of '%s': it has %u frames", m_segment.nFirstFrame, m_segment.nLastFrame, ref.strName, ref.nFrames);
+		}
+
+		// the segment spans from its first frame up to the frame following it
+		XnUInt64 nBeginTimestamp = ref.pDataIndex[m_segment.nFirstFrame].nTimestamp;
+		XnUInt64 nEndTimestamp = (m_segment.nLastFrame < ref.nFrames) ? ref.pDataIndex[m_segment.nLastFrame + 1].nTimestamp : XN_MAX_UINT64;
+
+		XnBool bSameConfiguration = TRUE;
+		XnUInt64 nFirstDataPos = 0;
+		m_nStartPos = XN_MAX_UINT64;
+
+		for (XnUInt32 i = 0; i < nNodes; ++i)
+		{
+			const NodeInfo& node = GetNode(i);
+			NodeState& state = m_pNodes[i];
+
+			if (!node.bIsGenerator)
+			{
+				state.bExported = TRUE;
+				continue;
+			}
+			if (node.pDataIndex == NULL)
+			{
+				xnLogWarning(XN_MASK_PLAYER_SEGMENT_EXPORTER, "Node '%s' has no frame index, and is not exported", node.strName);
+				continue;
+			}
+
+			if (i == nRef)
+			{
+				state.nFirstFrame = m_segment.nFirstFrame;
+				state.nLastFrame = m_segment.nLastFrame;
+			}
+			else
+			{
+				state.nFirstFrame = FindFirstFrameAtOrAfter(node.pDataIndex, node.nFrames, nBeginTimestamp);
+				state.nLastFrame = (nEndTimestamp == XN_MAX_UINT64) ? node.nFrames :
+					FindFirstFrameAtOrAfter(node.pDataIndex, node.nFrames, nEndTimestamp) - 1;
+				if (state.nFirstFrame > state.nLastFrame)
+				{
+					// no frames in the segment
+					continue;
+				}
+			}
+
+			XnUInt32 nFrames = state.nLastFrame - state.nFirstFrame + 1;
+			DataIndexEntry emptyEntry;
+			xnOSMemSet(&emptyEntry, 0, sizeof(emptyEntry));
+			XnStatus nRetVal = state.dataIndex.SetSize(nFrames + 1, emptyEntry);
+			XN_IS_STATUS_OK(nRetVal);
+
+			state.bExported = TRUE;
+			m_nFramesLeft += nFrames;
+			m_nMaxTimestamp = XN_MAX(m_nMaxTimestamp, node.pDataIndex[state.nLastFrame].nTimestamp);
+			m_nStartPos = XN_MIN(m_nStartPos, node.pDataIndex[state.nFirstFrame].nSeekPos);
+
+			if (node.pDataIndex[state.nFirstFrame].nConfigurationID != node.pDataIndex[1].nConfigurationID)
+			{
+				bSameConfiguration = FALSE;
+			}
+			nFirstDataPos = XN_MAX(nFirstDataPos, node.pDataIndex[1].nSeekPos);
+		}
+
+		// If no property changed since the first frames, the properties are all set before them, and there is no
+		// need to look any further.
+		m_nPropertiesEndPos = bSameConfiguration ? XN_MIN(nFirstDataPos, m_nStartPos) : m_nStartPos;
+
+		return XN_STATUS_OK;
+	}
+
+	// Points pData to nSize bytes of the recording at nPos. Unless the recording is mapped, they are read into the
+	// given buffer.
+	XnStatus ReadAt(XnUInt64 nPos, XnUInt32 nSize, XnUInt8*& pBuffer, XnUInt32& nBufferSize, const XnUInt8*& pData)
+	{
+		if (nPos + nSize > m_pExporter->m_nFileSize)
+		{
+			XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_PLAYER_SEGMENT_EXPORTER, "Record at %llu is past the end of the recording", nPos);
+		}
+
+		PlayerFileMapping* pMapping = m_pExporter->m_pMapping;
+		if (pMapping != NULL)
+		{
+			pData = pMapping->GetData() + nPos;
+			return XN_STATUS_OK;
+		}
+
+		XnStatus nRetVal = EnsureBufferSize(pBuffer, nBufferSize, nSize);
+		XN_IS_STATUS_OK(nRetVal);
+		nRetVal = xnOSSeekFile64(m_sourceFile, XN_OS_SEEK_SET, nPos);
+		XN_IS_STATUS_OK(nRetVal);
+		XnUInt32 nRead = nSize;
+		nRetVal = xnOSReadFile(m_sourceFile, pBuffer, &nRead);
+		XN_IS_STATUS_OK(nRetVal);
+		if (nRead != nSize)
+		{
+			return XN_STATUS_CORRUPT_FILE;
+		}
+
+		pData = pBuffer;
+		return XN_STATUS_OK;
+	}
+
+	// Reads the header and fields of the record at nPos into m_pFields.
+	XnStatus ReadRecordFields(XnUInt64 nPos)
+	{
+		XnUInt8 headerBuffer[NewDataRecordHeader::MAX_SIZE];
+		Record header(headerBuffer, sizeof(headerBuffer), m_pExporter->m_bIs32bitFileFormat);
+		const XnUInt8* pData = NULL;
+
+		// the header tells how long the fields are
+		XnStatus nRetVal = ReadAt(nPos, header.HEADER_SIZE, m_pFields, m_nFieldsBufferSize, pData);
+		XN_IS_STATUS_OK(nRetVal);
+		xnOSMemCopy(headerBuffer, pData, header.HEADER_SIZE);
+		if (!header.IsHeaderValid())
+		{
+			XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_PLAYER_SEGMENT_EXPORTER, "Invalid record at %llu", nPos);
+		}
+
+		XnUInt32 nFieldsSize = header.GetSize();
+		nRetVal = EnsureBufferSize(m_pFields, m_nFieldsBufferSize, nFieldsSize);
+		XN_IS_STATUS_OK(nRetVal);
+		// when reading from the file, the fields are read directly into m_pFields
+		nRetVal = ReadAt(nPos, nFieldsSize, m_pFields, m_nFieldsBufferSize, pData);
+		XN_IS_STATUS_OK(nRetVal);
+		if (pData != m_pFields)
+		{
+			xnOSMemCopy(m_pFields, pData, nFieldsSize);
+		}
+
+		return XN_STATUS_OK;
+	}
+
+	// Keeps the latest value of a property.
+	XnStatus StoreProperty(XnUInt32 nNode, const GeneralPropRecord& record, Property*& pProperty)
+	{
+		xnl::Array<Property>& properties = m_pNodes[nNode].properties;
+		XnUInt32 i = 0;
+		while (i < properties.GetSize() && xnOSStrCmp(properties[i].strName, record.GetPropName()) != 0)
+		{
+			++i;
+		}
+
+		if (i == properties.GetSize())
+		{
+			Property property;
+			property.nLastRecordPos = 0;
+			XnStatus nRetVal = xnOSStrCopy(property.strName, record.GetPropName(), sizeof(property.strName));
+			XN_IS_STATUS_OK(nRetVal);
+			nRetVal = properties.AddLast(property);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+
+		pProperty = &properties[i];
+		pProperty->nRecordType = record.GetType();
+		return pProperty->data.SetData((const XnUInt8*)record.GetPropData(), record.GetPropDataSize());
+	}
+
+	XnStatus CollectProperties()
+	{
+		XnUInt64 nPos = sizeof(RecordingHeader);
+		while (nPos < m_nPropertiesEndPos)
+		{
+			XnStatus nRetVal = ReadRecordFields(nPos);
+			XN_IS_STATUS_OK(nRetVal);
+
+			Record record(m_pFields, m_nFieldsBufferSize, m_pExporter->m_bIs32bitFileFormat);
+			XnUInt32 nNode = FindNode(record.GetNodeID());
+			if (IsPropertyRecord(record.GetType()) && nNode < m_pExporter->m_nodes.GetSize() && m_pNodes[nNode].bExported)
+			{
+				GeneralPropRecord propRecord(record);
+				nRetVal = propRecord.Decode();
+				XN_IS_STATUS_OK(nRetVal);
+				Property* pProperty = NULL;
+				nRetVal = StoreProperty(nNode, propRecord, pProperty);
+				XN_IS_STATUS_OK(nRetVal);
+			}
+			else if (record.GetType() == RECORD_END)
+			{
+				break;
+			}
+
+			nPos += record.GetSize() + record.GetPayloadSize();
+		}
+
+		return XN_STATUS_OK;
+	}
+
+	XnStatus Write(const void* pData, XnUInt32 nSize)
+	{
+		XnStatus nRetVal = xnOSWriteFile(m_outFile, pData, nSize);
+		XN_IS_STATUS_OK(nRetVal);
+		m_nOutPos += nSize;
+		return XN_STATUS_OK;
+	}
+
+	XnStatus WriteRecord(const Record& record, const void* pPayload, XnUInt32 nPayloadSize)
+	{
+		XnOSFileSegment segments[2] = {
+			{ record.GetData(), record.GetSize() },
+			{ pPayload, nPayloadSize }
+		};
+		XnStatus nRetVal = xnOSWriteFileGather(m_outFile, segments, (nPayloadSize > 0) ? 2 : 1);
+		XN_IS_STATUS_OK(nRetVal);
+		m_nOutPos += record.GetSize() + nPayloadSize;
+		return XN_STATUS_OK;
+	}
+
+	// Completes a record encoded into m_pOut, and writes it.
+	XnStatus WriteOutRecord(Record& record, XnUInt32 nNodeID, XnUInt64 nUndoRecordPos, const void* pPayload = NULL, XnUInt32 nPayloadSize = 0)
+	{
+		record.SetNodeID(nNodeID);
+		record.SetPayloadSize(nPayloadSize);
+		record.SetUndoRecordPos(nUndoRecordPos);
+		return WriteRecord(record, pPayload, nPayloadSize);
+	}
+
+	XnStatus WriteProperty(XnUInt32 nNode, Property& property)
+	{
+		XnStatus nRetVal = EnsureBufferSize(m_pOut, m_nOutBufferSize, NewDataRecordHeader::MAX_SIZE + property.data.GetSize());
+		XN_IS_STATUS_OK(nRetVal);
+
+		GeneralPropRecord record(m_pOut, m_nOutBufferSize, FALSE, property.nRecordType);
+		record.SetPropName(property.strName);
+		record.SetPropDataSize(property.data.GetSize());
+		record.SetPropData(property.data.GetData());
+		nRetVal = record.Encode();
+		XN_IS_STATUS_OK(nRetVal);
+
+		XnUInt64 nRecordPos = m_nOutPos;
+		nRetVal = WriteOutRecord(record, GetNode(nNode).nNodeID, property.nLastRecordPos);
+		XN_IS_STATUS_OK(nRetVal);
+		property.nLastRecordPos = nRecordPos;
+
+		// like the recorder, every property starts a new configuration
+		++m_nConfigurationID;
+		return XN_STATUS_OK;
+	}
+
+	XnStatus WriteNodeAdded(XnUInt32 nNode, XnUInt64 nSeekTablePos)
+	{
+		const NodeInfo& node = GetNode(nNode);
+		const NodeState& state = m_pNodes[nNode];
+		XnStatus nRetVal = EnsureBufferSize(m_pOut, m_nOutBufferSize, NewDataRecordHeader::MAX_SIZE * 2);
+		XN_IS_STATUS_OK(nRetVal);
+
+		NodeAddedRecord record(m_pOut, m_nOutBufferSize, FALSE);
+		record.SetNodeName(node.strName);
+		record.SetNodeType(node.type);
+		record.SetCompression(node.compression);
+		if (node.bIsGenerator)
+		{
+			record.SetNumberOfFrames(state.nLastFrame - state.nFirstFrame + 1);
+			record.SetMinTimestamp(node.pDataIndex[state.nFirstFrame].nTimestamp);
+			record.SetMaxTimestamp(node.pDataIndex[state.nLastFrame].nTimestamp);
+		}
+		record.SetSeekTablePosition(nSeekTablePos);
+		nRetVal = record.Encode();
+		XN_IS_STATUS_OK(nRetVal);
+
+		return WriteOutRecord(record, node.nNodeID, 0);
+	}
+
+	XnStatus WriteNodes()
+	{
+		RecordingHeader header = DEFAULT_RECORDING_HEADER;
+		header.nGlobalMaxTimeStamp = m_nMaxTimestamp;
+		header.nMaxNodeID = m_pExporter->m_header.nMaxNodeID;
+		XnStatus nRetVal = Write(&header, sizeof(header));
+		XN_IS_STATUS_OK(nRetVal);
+
+		const XnUInt32 nNodes = m_pExporter->m_nodes.GetSize();
+
+		// the nodes, as they were when the segment starts (the seek tables are filled in at the end)
+		for (XnUInt32 i = 0; i < nNodes; ++i)
+		{
+			NodeState& state = m_pNodes[i];
+			if (!state.bExported)
+			{
+				continue;
+			}
+
+			state.nNodeAddedPos = m_nOutPos;
+			nRetVal = WriteNodeAdded(i, 0);
+			XN_IS_STATUS_OK(nRetVal);
+
+			for (XnUInt32 j = 0; j < state.properties.GetSize(); ++j)
+			{
+				nRetVal = WriteProperty(i, state.properties[j]);
+				XN_IS_STATUS_OK(nRetVal);
+			}
+		}
+
+		nRetVal = EnsureBufferSize(m_pOut, m_nOutBufferSize, NewDataRecordHeader::MAX_SIZE);
+		XN_IS_STATUS_OK(nRetVal);
+
+		for (XnUInt32 i = 0; i < nNodes; ++i)
+		{
+			const NodeInfo& node = GetNode(i);
+			const NodeState& state = m_pNodes[i];
+			if (!state.bExported)
+			{
+				continue;
+			}
+
+			NodeStateReadyRecord stateReady(m_pOut, m_nOutBufferSize, FALSE);
+			nRetVal = stateReady.Encode();
+			XN_IS_STATUS_OK(nRetVal);
+			nRetVal = WriteOutRecord(stateReady, node.nNodeID, 0);
+			XN_IS_STATUS_OK(nRetVal);
+
+			if (node.bIsGenerator)
+			{
+				NodeDataBeginRecord dataBegin(m_pOut, m_nOutBufferSize, FALSE);
+				dataBegin.SetNumFrames(state.nLastFrame - state.nFirstFrame + 1);
+				dataBegin.SetMaxTimeStamp(node.pDataIndex[state.nLastFrame].nTimestamp);
+				nRetVal = dataBegin.Encode();
+				XN_IS_STATUS_OK(nRetVal);
+				nRetVal = WriteOutRecord(dataBegin, node.nNodeID, 0);
+				XN_IS_STATUS_OK(nRetVal);
+			}
+		}
+
+		return XN_STATUS_OK;
+	}
+
+	XnStatus CopyFrame(XnUInt32 nNode, const Record& record, XnUInt64 nPayloadPos)
+	{
+		NodeState& state = m_pNodes[nNode];
+		NewDataRecordHeader source(record);
+		XnStatus nRetVal = source.Decode();
+		XN_IS_STATUS_OK(nRetVal);
+
+		XnUInt32 nFrame = source.GetFrameNumber();
+		if (nFrame < state.nFirstFrame || nFrame > state.nLastFrame)
+		{
+			return XN_STATUS_OK;
+		}
+
+		XnUInt32 nNewFrame = nFrame - state.nFirstFrame + 1;
+		DataIndexEntry& entry = state.dataIndex[nNewFrame];
+		if (entry.nSeekPos != 0)
+		{
+			// already copied
+			return XN_STATUS_OK;
+		}
+
+		// the frame itself is copied as it is, compressed or not
+		const XnUInt8* pPayload = NULL;
+		nRetVal = ReadAt(nPayloadPos, record.GetPayloadSize(), m_pPayload, m_nPayloadBufferSize, pPayload);
+		XN_IS_STATUS_OK(nRetVal);
+
+		nRetVal = EnsureBufferSize(m_pOut, m_nOutBufferSize, NewDataRecordHeader::MAX_SIZE);
+		XN_IS_STATUS_OK(nRetVal);
+		NewDataRecordHeader target(m_pOut, m_nOutBufferSize, FALSE);
+		target.SetTimeStamp(source.GetTimeStamp());
+		target.SetFrameNumber(nNewFrame);
+		nRetVal = target.Encode();
+		XN_IS_STATUS_OK(nRetVal);
+
+		entry.nTimestamp = source.GetTimeStamp();
+		entry.nConfigurationID = m_nConfigurationID;
+		entry.nSeekPos = m_nOutPos;
+
+		nRetVal = WriteOutRecord(target, record.GetNodeID(), state.nLastDataPos, pPayload, record.GetPayloadSize());
+		XN_IS_STATUS_OK(nRetVal);
+		state.nLastDataPos = entry.nSeekPos;
+
+		--m_nFramesLeft;
+		return XN_STATUS_OK;
+	}
+
+	XnStatus CopyRecords()
+	{
+		XnUInt64 nPos = m_nStartPos;
+		while (m_nFramesLeft > 0)
+		{
+			XnStatus nRetVal = ReadRecordFields(nPos);
+			XN_IS_STATUS_OK(nRetVal);
+
+			Record record(m_pFields, m_nFieldsBufferSize, m_pExporter->m_bIs32bitFileFormat);
+			XnUInt32 nNode = FindNode(record.GetNodeID());
+			XnBool bExported = (nNode < m_pExporter->m_nodes.GetSize()) && m_pNodes[nNode].bExported;
+
+			if (record.GetType() == RECORD_END)
+			{
+				XN_LOG_ERROR_RETURN(XN_STATUS_CORRUPT_FILE, XN_MASK_PLAYER_SEGMENT_EXPORTER, "Recording ended before all frames of the segment were found");
+			}
+			else if (record.GetType() == RECORD_NEW_DATA && bExported)
+			{
+				nRetVal = CopyFrame(nNode, record, nPos + record.GetSize());
+				XN_IS_STATUS_OK(nRetVal);
+			}
+			else if (IsPropertyRecord(record.GetType()) && bExported)
+			{
+				GeneralPropRecord propRecord(record);
+				nRetVal = propRecord.Decode();
+				XN_IS_STATUS_OK(nRetVal);
+				Property* pProperty = NULL;
+				nRetVal = StoreProperty(nNode, propRecord, pProperty);
+				XN_IS_STATUS_OK(nRetVal);
+				nRetVal = WriteProperty(nNode, *pProperty);
+				XN_IS_STATUS_OK(nRetVal);
+			}
+			// anything else (other nodes, seek tables of the recording) stays out
+
+			nPos += record.GetSize() + record.GetPayloadSize();
+		}
+
+		return XN_STATUS_OK;
+	}
+
+	XnStatus WriteSeekTables()
+	{
+		XnStatus nRetVal = EnsureBufferSize(m_pOut, m_nOutBufferSize, NewDataRecordHeader::MAX_SIZE * 2);
+		XN_IS_STATUS_OK(nRetVal);
+
+		// the same records the recorder ends a node with
+		for (XnUInt32 i = 0; i < m_pExporter->m_nodes.GetSize(); ++i)
+		{
+			const NodeInfo& node = GetNode(i);
+			NodeState& state = m_pNodes[i];
+			if (!state.bExported || !node.bIsGenerator)
+			{
+				continue;
+			}
+
+			NodeRemovedRecord nodeRemoved(m_pOut, m_nOutBufferSize, FALSE);
+			nRetVal = nodeRemoved.Encode();
+			XN_IS_STATUS_OK(nRetVal);
+			nRetVal = WriteOutRecord(nodeRemoved, node.nNodeID, state.nNodeAddedPos);
+			XN_IS_STATUS_OK(nRetVal);
+
+			XnUInt64 nSeekTablePos = m_nOutPos;
+			DataIndexRecordHeader seekTable(m_pOut, m_nOutBufferSize, FALSE);
+			nRetVal = seekTable.Encode();
+			XN_IS_STATUS_OK(nRetVal);
+			nRetVal = WriteOutRecord(seekTable, node.nNodeID, 0, state.dataIndex.GetData(), state.dataIndex.GetSize() * sizeof(DataIndexEntry));
+			XN_IS_STATUS_OK(nRetVal);
+
+			// point the node to its seek table
+			XnUInt64 nEndPos = m_nOutPos;
+			nRetVal = xnOSSeekFile64(m_outFile, XN_OS_SEEK_SET, state.nNodeAddedPos);
+			XN_IS_STATUS_OK(nRetVal);
+			nRetVal = WriteNodeAdded(i, nSeekTablePos);
+			XN_IS_STATUS_OK(nRetVal);
+			nRetVal = xnOSSeekFile64(m_outFile, XN_OS_SEEK_SET, nEndPos);
+			XN_IS_STATUS_OK(nRetVal);
+			m_nOutPos = nEndPos;
+		}
+
+		EndRecord end(m_pOut, m_nOutBufferSize, FALSE);
+		nRetVal = end.Encode();
+		XN_IS_STATUS_OK(nRetVal);
+		return WriteOutRecord(end, 0, 0);
+	}
+
+	const PlayerSegmentExporter* m_pExporter;
+	const Segment& m_segment;
+	NodeState* m_pNodes; // by index in m_pExporter->m_nodes
+
+	XN_FILE_HANDLE m_sourceFile; // if the recording is not mapped
+	XnUInt8* m_pFields;
+	XnUInt32 m_nFieldsBufferSize;
+	XnUInt8* m_pPayload;
+	XnUInt32 m_nPayloadBufferSize;
+
+	XN_FILE_HANDLE m_outFile;
+	XnUInt64 m_nOutPos;
+	XnUInt8* m_pOut;
+	XnUInt32 m_nOutBufferSize;
+	XnUInt32 m_nConfigurationID;
+
+	XnUInt64 m_nStartPos; // the first record of the segment
+	XnUInt64 m_nPropertiesEndPos; // properties are collected up to here
+	XnUInt32 m_nFramesLeft;
+	XnUInt64 m_nMaxTimestamp;
+};
+
+//---------------------------------------------------------------------------
+// PlayerSegmentExporter
+//---------------------------------------------------------------------------
+PlayerSegmentExporter::PlayerSegmentExporter() :
+	m_bOpen(FALSE),
+	m_bIs32bitFileFormat(FALSE),
+	m_nFileSize(0),
+	m_index("PlayerSegmentExporter"),
+	m_indexFile(XN_INVALID_FILE_HANDLE),
+	m_pMapping(NULL),
+	m_aSegments(NULL),
+	m_nSegments(0),
+	m_nNextSegment(0)
+{
+	m_strFileName[0] = '\0';
+	xnOSMemSet(&m_header, 0, sizeof(m_header));
+}
+
+PlayerSegmentExporter::~PlayerSegmentExporter()
+{
+	Close();
+}
+
+XnStatus PlayerSegmentExporter::Open(const XnChar* strFileName)
+{
+	static XnNodeNotifications notifications =
+	{
+		OnNodeAdded,
+		OnNodeRemoved,
+		OnNodeIntPropChanged,
+		OnNodeRealPropChanged,
+		OnNodeStringPropChanged,
+		OnNodeGeneralPropChanged,
+		OnNodeStateReady,
+		OnNodeNewData,
+	};
+	static XnPlayerInputStreamInterface inputInterface =
+	{
+		FileOpen,
+		FileRead,
+		FileSeek,
+		FileTell,
+		FileClose,
+		FileSeek64,
+		FileTell64,
+		NULL,
+	};
+	static PlayerNode::CodecFactory codecFactory =
+	{
+		CodecCreate,
+		CodecDestroy
+	};
+
+	XN_VALIDATE_INPUT_PTR(strFileName);
+	if (m_bOpen)
+	{
+		return XN_STATUS_ALREADY_INIT;
+	}
+
+	XnStatus nRetVal = xnOSStrCopy(m_strFileName, strFileName, sizeof(m_strFileName));
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = xnOSGetFileSize64(m_strFileName, &m_nFileSize);
+	XN_IS_STATUS_OK(nRetVal);
+
+	// the player validates the header, the exporter only needs its format
+	XN_FILE_HANDLE file = XN_INVALID_FILE_HANDLE;
+	nRetVal = xnOSOpenFile(m_strFileName, XN_OS_FILE_READ, &file);
+	XN_IS_STATUS_OK(nRetVal);
+	XnUInt32 nRead = sizeof(m_header);
+	nRetVal = xnOSReadFile(file, &m_header, &nRead);
+	xnOSCloseFile(&file);
+	XN_IS_STATUS_OK(nRetVal);
+	if (nRead != sizeof(m_header))
+	{
+		return XN_STATUS_CORRUPT_FILE;
+	}
+	m_bIs32bitFileFormat = IsOld32bitFileFormat(m_header.version);
+
+	nRetVal = m_index.Init();
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = m_index.SetNodeNotifications(this, &notifications);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = m_index.SetNodeCodecFactory(this, &codecFactory);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = m_index.SetSeekIndexCacheFile(m_strFileName);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = m_index.SetInputStream(this, &inputInterface);
+	XN_IS_STATUS_OK(nRetVal);
+
+	// the nodes were added while opening the recording
+	for (XnUInt32 i = 0; i < m_nodes.GetSize(); ++i)
+	{
+		NodeInfo& node = m_nodes[i];
+		nRetVal = m_index.GetDataIndex(node.strName, node.nNodeID, node.pDataIndex, node.nFrames);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
+	if (PlayerFileMapping::Open(m_strFileName, &m_pMapping) != XN_STATUS_OK)
+	{
+		m_pMapping = NULL;
+	}
+
+	m_bOpen = TRUE;
+	return XN_STATUS_OK;
+}
+
+void PlayerSegmentExporter::Close()
+{
+	m_index.Destroy();
+	if (m_indexFile != XN_INVALID_FILE_HANDLE)
+	{
+		xnOSCloseFile(&m_indexFile);
+		m_indexFile = XN_INVALID_FILE_HANDLE;
+	}
+	if (m_pMapping != NULL)
+	{
+		m_pMapping->Release();
+		m_pMapping = NULL;
+	}
+	m_nodes.Clear();
+	m_bOpen = FALSE;
+}
+
+XnStatus PlayerSegmentExporter::Export(Segment* aSegments, XnUInt32 nSegments, XnUInt32 nThreads)
+{
+	XN_VALIDATE_INPUT_PTR(aSegments);
+	if (!m_bOpen)
+	{
+		return XN_STATUS_NOT_INIT;
+	}
+
+	for (XnUInt32 i = 0; i < nSegments; ++i)
+	{
+		aSegments[i].nStatus = XN_STATUS_NOT_INIT;
+	}
+
+	m_aSegments = aSegments;
+	m_nSegments = nSegments;
+	m_nNextSegment = 0;
+
+	// the calling thread exports segments as well
+	xnl::Array<XN_THREAD_HANDLE> threads;
+	for (XnUInt32 i = 1; i < XN_MIN(nThreads, nSegments); ++i)
+	{
+		XN_THREAD_HANDLE hThread = NULL;
+		XnStatus nRetVal = xnOSCreateThread(ExportThread, this, &hThread);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_PLAYER_SEGMENT_EXPORTER, "Failed to start export thread - using %u threads", i);
+			break;
+		}
+		threads.AddLast(hThread);
+	}
+
+	ExportSegments();
+
+	for (XnUInt32 i = 0; i < threads.GetSize(); ++i)
+	{
+		xnOSWaitForThreadExit(threads[i], XN_WAIT_INFINITE);
+		xnOSCloseThread(&threads[i]);
+	}
+
+	m_aSegments = NULL;
+	m_nSegments = 0;
+
+	for (XnUInt32 i = 0; i < nSegments; ++i)
+	{
+		if (aSegments[i].nStatus != XN_STATUS_OK)
+		{
+			return aSegments[i].nStatus;
+		}
+	}
+
+	return XN_STATUS_OK;
+}
+
+XN_THREAD_PROC PlayerSegmentExporter::ExportThread(XN_THREAD_PARAM pThreadParam)
+{
+	PlayerSegmentExporter* pThis = (PlayerSegmentExporter*)pThreadParam;
+	pThis->ExportSegments();
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void PlayerSegmentExporter::ExportSegments()
+{
+	for (;;)
+	{
+		Segment* pSegment = NULL;
+		{
+			xnl::AutoCSLocker lock(m_lock);
+			if (m_nNextSegment == m_nSegments)
+			{
+				return;
+			}
+			pSegment = &m_aSegments[m_nNextSegment++];
+		}
+
+		SegmentJob job(this, *pSegment);
+		pSegment->nStatus = job.Run();
+		if (pSegment->nStatus != XN_STATUS_OK)
+		{
+			xnLogWarning(XN_MASK_PLAYER_SEGMENT_EXPORTER, "Failed to export segment to '%s': %s", pSegment->strFileName, xnGetStatusString(pSegment->nStatus));
+		}
+	}
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeAdded(void* pCookie, const XnChar* strNodeName, XnProductionNodeType type, XnCodecID compression, XnUInt32 /*nNumberOfFrames*/)
+{
+	PlayerSegmentExporter* pThis = (PlayerSegmentExporter*)pCookie;
+
+	NodeInfo node;
+	XnStatus nRetVal = xnOSStrCopy(node.strName, strNodeName, sizeof(node.strName));
+	XN_IS_STATUS_OK(nRetVal);
+	node.nNodeID = INVALID_NODE_ID;
+	node.type = type;
+	node.compression = compression;
+	node.bIsGenerator = IsTypeGenerator(type);
+	node.pDataIndex = NULL;
+	node.nFrames = 0;
+
+	return pThis->m_nodes.AddLast(node);
+}
+
+// Only the nodes are of interest - their properties are copied from the recording as they are.
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeRemoved(void* /*pCookie*/, const XnChar* /*strNodeName*/)
+{
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeIntPropChanged(void* /*pCookie*/, const XnChar* /*strNodeName*/, const XnChar* /*strPropName*/, XnUInt64 /*nValue*/)
+{
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeRealPropChanged(void* /*pCookie*/, const XnChar* /*strNodeName*/, const XnChar* /*strPropName*/, XnDouble /*dValue*/)
+{
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeStringPropChanged(void* /*pCookie*/, const XnChar* /*strNodeName*/, const XnChar* /*strPropName*/, const XnChar* /*strValue*/)
+{
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeGeneralPropChanged(void* /*pCookie*/, const XnChar* /*strNodeName*/, const XnChar* /*strPropName*/, XnUInt32 /*nBufferSize*/, const void* /*pBuffer*/)
+{
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeStateReady(void* /*pCookie*/, const XnChar* /*strNodeName*/)
+{
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::OnNodeNewData(void* /*pCookie*/, const XnChar* /*strNodeName*/, XnUInt64 /*nTimeStamp*/, XnUInt32 /*nFrame*/, const void* /*pData*/, XnUInt32 /*nSize*/)
+{
+	return XN_STATUS_OK;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::FileOpen(void* pCookie)
+{
+	PlayerSegmentExporter* pThis = (PlayerSegmentExporter*)pCookie;
+	return xnOSOpenFile(pThis->m_strFileName, XN_OS_FILE_READ, &pThis->m_indexFile);
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::FileRead(void* pCookie, void* pBuffer, XnUInt32 nSize, XnUInt32* pnBytesRead)
+{
+	PlayerSegmentExporter* pThis = (PlayerSegmentExporter*)pCookie;
+	*pnBytesRead = nSize;
+	return xnOSReadFile(pThis->m_indexFile, pBuffer, pnBytesRead);
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::FileSeek(void* pCookie, XnOSSeekType seekType, const XnInt32 nOffset)
+{
+	return FileSeek64(pCookie, seekType, nOffset);
+}
+
+XnUInt32 XN_CALLBACK_TYPE PlayerSegmentExporter::FileTell(void* pCookie)
+{
+	return (XnUInt32)FileTell64(pCookie);
+}
+
+void XN_CALLBACK_TYPE PlayerSegmentExporter::FileClose(void* pCookie)
+{
+	PlayerSegmentExporter* pThis = (PlayerSegmentExporter*)pCookie;
+	xnOSCloseFile(&pThis->m_indexFile);
+	pThis->m_indexFile = XN_INVALID_FILE_HANDLE;
+}
+
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::FileSeek64(void* pCookie, XnOSSeekType seekType, const XnInt64 nOffset)
+{
+	PlayerSegmentExporter* pThis = (PlayerSegmentExporter*)pCookie;
+	return xnOSSeekFile64(pThis->m_indexFile, seekType, nOffset);
+}
+
+XnUInt64 XN_CALLBACK_TYPE PlayerSegmentExporter::FileTell64(void* pCookie)
+{
+	PlayerSegmentExporter* pThis = (PlayerSegmentExporter*)pCookie;
+	XnUInt64 nPos = 0;
+	XnStatus nRetVal = xnOSTellFile64(pThis->m_indexFile, &nPos);
+	return (nRetVal == XN_STATUS_OK) ? nPos : (XnUInt64)-1;
+}
+
+// Frames are never decoded, so the nodes get no codecs.
+XnStatus XN_CALLBACK_TYPE PlayerSegmentExporter::CodecCreate(void* /*pCookie*/, const char* /*strNodeName*/, XnCodecID /*nCodecId*/, XnCodec** ppCodec)
+{
+	*ppCodec = NULL;
+	return XN_STATUS_OK;
+}
+
+void XN_CALLBACK_TYPE PlayerSegmentExporter::CodecDestroy(void* /*pCookie*/, XnCodec* /*pCodec*/)
+{
+}
+
+} // namespace oni_file
@@ -0,0 +1,131 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __PLAYER_SEGMENT_EXPORTER_H__
+#define __PLAYER_SEGMENT_EXPORTER_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "PlayerNode.h"
+#include "PlayerFileMapping.h"
+#include "XnOSCpp.h"
+
+namespace oni_file {
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/// Cuts segments out of a recording into recordings of their own, without decoding the frames. The frames of each
+/// segment are found through the frame index of the recording, and their records are copied as they are (only the
+/// record headers are rewritten), so the time it takes depends on the size of the segment, not on the size of the
+/// recording. The nodes, their properties as they were at the start of the segment, and the seek tables are written
+/// anew. Several segments are exported in parallel, each on a thread of its own.
+class PlayerSegmentExporter
+{
+public:
+	struct Segment
+	{
+		/// The node whose frames delimit the segment. The frames of the other nodes are exported from the timestamp
+		/// of the first frame, up to the timestamp of the frame following the last one.
+		const XnChar* strNodeName;
+		XnUInt32 nFirstFrame;
+		XnUInt32 nLastFrame;
+		const XnChar* strFileName;
+		/// Filled by Export().
+		XnStatus nStatus;
+	};
+
+	PlayerSegmentExporter();
+	~PlayerSegmentExporter();
+
+	/// Reads the nodes of the recording, and its frame index (which is built first for recordings without seek
+	/// tables).
+	XnStatus Open(const XnChar* strFileName);
+	void Close();
+
+	/// Exports the segments on up to nThreads threads. Fails if any of them failed (see Segment::nStatus).
+	XnStatus Export(Segment* aSegments, XnUInt32 nSegments, XnUInt32 nThreads);
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(PlayerSegmentExporter);
+
+	struct NodeInfo
+	{
+		XnUInt32 nNodeID;
+		XnChar strName[XN_MAX_NAME_LENGTH];
+		XnProductionNodeType type;
+		XnCodecID compression;
+		XnBool bIsGenerator;
+		const DataIndexEntry* pDataIndex; // owned by m_index
+		XnUInt32 nFrames;
+	};
+
+	class SegmentJob;
+	friend class SegmentJob;
+
+	static XN_THREAD_PROC ExportThread(XN_THREAD_PARAM pThreadParam);
+	void ExportSegments();
+
+	static XnStatus XN_CALLBACK_TYPE OnNodeAdded(void* pCookie, const XnChar* strNodeName, XnProductionNodeType type, XnCodecID compression, XnUInt32 nNumberOfFrames);
+	static XnStatus XN_CALLBACK_TYPE OnNodeRemoved(void* pCookie, const XnChar* strNodeName);
+	static XnStatus XN_CALLBACK_TYPE OnNodeIntPropChanged(void* pCookie, const XnChar* strNodeName, const XnChar* strPropName, XnUInt64 nValue);
+	static XnStatus XN_CALLBACK_TYPE OnNodeRealPropChanged(void* pCookie, const XnChar* strNodeName, const XnChar* strPropName, XnDouble dValue);
+	static XnStatus XN_CALLBACK_TYPE OnNodeStringPropChanged(void* pCookie, const XnChar* strNodeName, const XnChar* strPropName, const XnChar* strValue);
+	static XnStatus XN_CALLBACK_TYPE OnNodeGeneralPropChanged(void* pCookie, const XnChar* strNodeName, const XnChar* strPropName, XnUInt32 nBufferSize, const void* pBuffer);
+	static XnStatus XN_CALLBACK_TYPE OnNodeStateReady(void* pCookie, const XnChar* strNodeName);
+	static XnStatus XN_CALLBACK_TYPE OnNodeNewData(void* pCookie, const XnChar* strNodeName, XnUInt64 nTimeStamp, XnUInt32 nFrame, const void* pData, XnUInt32 nSize);
+
+	static XnStatus XN_CALLBACK_TYPE FileOpen(void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE FileRead(void* pCookie, void* pBuffer, XnUInt32 nSize, XnUInt32* pnBytesRead);
+	static XnStatus XN_CALLBACK_TYPE FileSeek(void* pCookie, XnOSSeekType seekType, const XnInt32 nOffset);
+	static XnUInt32 XN_CALLBACK_TYPE FileTell(void* pCookie);
+	static void     XN_CALLBACK_TYPE FileClose(void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE FileSeek64(void* pCookie, XnOSSeekType seekType, const XnInt64 nOffset);
+	static XnUInt64 XN_CALLBACK_TYPE FileTell64(void* pCookie);
+
+	static XnStatus XN_CALLBACK_TYPE CodecCreate(void* pCookie, const char* strNodeName, XnCodecID nCodecId, XnCodec** ppCodec);
+	static void     XN_CALLBACK_TYPE CodecDestroy(void* pCookie, XnCodec* pCodec);
+
+	XnChar m_strFileName[XN_FILE_MAX_PATH];
+	XnBool m_bOpen;
+	RecordingHeader m_header;
+	XnBool m_bIs32bitFileFormat;
+	XnUInt64 m_nFileSize;
+
+	// Reads the nodes and the frame index of the file (through m_indexFile). Nothing is ever decoded.
+	PlayerNode m_index;
+	XN_FILE_HANDLE m_indexFile;
+
+	// All segments read the file through the same mapping, if it could be mapped. Otherwise, each opens the file.
+	PlayerFileMapping* m_pMapping;
+
+	xnl::Array<NodeInfo> m_nodes; // in the order they were added
+
+	// The segments being exported, handed out to the export threads under m_lock.
+	Segment* m_aSegments;
+	XnUInt32 m_nSegments;
+	XnUInt32 m_nNextSegment;
+	xnl::CriticalSection m_lock;
+};
+
+} // namespace oni_file
+
+#endif // __PLAYER_SEGMENT_EXPORTER_H__
@@ -128,7 +128,7 @@ OniStatus PlayerSource::SetProperty(int propertyId, const void* data, int dataSi
 }
 
 // Process new data.
-void PlayerSource::ProcessNewData(XnUInt64 nTimeStamp, XnUInt32 nFrameId, void* pData, XnUInt32 nSize)
+void PlayerSource::ProcessNewData(XnUInt64 nTimeStamp, XnUInt32 nFrameId, void* pData, XnUInt32 nSize, PlayerFileMapping* pMapping)
 {
 	// Raise the event to all registered callbacks.
 	NewDataEventArgs args;
@@ -136,6 +136,7 @@ void PlayerSource::ProcessNewData(XnUInt64 nTimeStamp, XnUInt32 nFrameId, void*
 	args.nFrameId = nFrameId;
 	args.pData = pData;
 	args.nSize = nSize;
+	args.pMapping = pMapping;
 	m_newDataEvent.Raise(args);
 }
 
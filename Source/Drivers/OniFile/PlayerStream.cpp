@@ -32,7 +32,7 @@
 namespace oni_file {
 
 PlayerStream::PlayerStream(PlayerSource* pSource) :
-	m_pSource(pSource), m_newDataHandle(NULL), m_isStarted(false), m_requiredFrameSize(0)
+	m_pSource(pSource), m_newDataHandle(NULL), m_isStarted(false), m_bLockstep(FALSE), m_pFrameCredits(NULL), m_requiredFrameSize(0)
 {
 }
 
@@ -41,10 +41,24 @@ PlayerStream::~PlayerStream()
 {
 	// Destroy the stream (if it was not destroyed before).
 	destroy();
+
+	// Frames still held by the application keep their own reference.
+	if (m_pFrameCredits != NULL)
+	{
+		m_pFrameCredits->Release();
+		m_pFrameCredits = NULL;
+	}
 }
 
 OniStatus PlayerStream::Initialize()
 {
+	// Create the frame credits (used in lockstep mode).
+	XnStatus xnrc = PlayerFrameCredits::Create(&m_pFrameCredits);
+	if (xnrc != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
 	// Register events in the source.
 	OniStatus rc = m_pSource->RegisterNewDataEvent(OnNewDataCallback, this, m_newDataHandle);
 	if (rc != ONI_STATUS_OK)
@@ -77,6 +91,12 @@ OniStatus PlayerStream::start()
 {
 	m_isStarted = true;
 	m_requiredFrameSize = getRequiredFrameSize();
+
+	// Let the device know there is a stream to play to.
+	ReadyForDataEventArgs readyForDataEventArgs;
+	readyForDataEventArgs.pStream = this;
+	m_readyForDataEvent.Raise(readyForDataEventArgs);
+
 	return ONI_STATUS_OK;
 }
 
@@ -180,12 +200,63 @@ void ONI_CALLBACK_TYPE PlayerStream::OnNewDataCallback(const PlayerSource::NewDa
 		return;
 	}
 
+	// Clamp the frame to the size the stream reported.
+	int nDataSize = newDataEventArgs.nSize;
+	if (nDataSize > pStream->m_requiredFrameSize)
+	{
+		xnLogWarning("Player", "File contains a frame with size %d whereas required frame size is %d", nDataSize, pStream->m_requiredFrameSize);
+		XN_ASSERT(FALSE);
+		nDataSize = pStream->m_requiredFrameSize;
+	}
+
 	pStream->m_cs.Lock();
 
-	// Allocate new frame and fill it.
-	OniFrame* pFrame = pStream->getServices().acquireFrame();
+	// Data still in the mapped file is handed out as is - the frame keeps the file mapped for as long as it lives.
+	// Otherwise, allocate a new frame and copy the data into it.
+	OniFrame* pFrame = NULL;
+	PlayerFileMapping* pMapping = newDataEventArgs.pMapping;
+	void* pCopyData = NULL;
+	if (pStream->m_bLockstep && pStream->getServices().isExternalFrameSupported())
+	{
+		// The free callback of the frame returns its credit, so copied data goes to a buffer of our own rather than
+		// to a frame of the core's pool.
+		void* pFrameData = newDataEventArgs.pData;
+		if (pMapping == NULL)
+		{
+			pCopyData = PlayerFrameCredits::AllocateFrameData(nDataSize);
+			pFrameData = pCopyData;
+		}
+		void* pCookie = (pFrameData != NULL) ? pStream->m_pFrameCredits->AcquireCredit(pMapping) : NULL;
+		if (pCookie != NULL)
+		{
+			pFrame = pStream->getServices().acquireExternalFrame(pFrameData, nDataSize, PlayerFrameCredits::ReleaseFrameData, pCookie);
+			if (pFrame == NULL)
+			{
+				PlayerFrameCredits::ReleaseFrameData(pFrameData, pCookie);
+			}
+		}
+		else if (pCopyData != NULL)
+		{
+			xnOSFreeAligned(pCopyData);
+		}
+	}
+	else if (pMapping != NULL && pStream->getServices().isExternalFrameSupported())
+	{
+		pMapping->AddRef();
+		pFrame = pStream->getServices().acquireExternalFrame(newDataEventArgs.pData, nDataSize, PlayerFileMapping::ReleaseFrameData, pMapping);
+		if (pFrame == NULL)
+		{
+			pMapping->Release();
+		}
+	}
+	else
+	{
+		pMapping = NULL;
+		pFrame = pStream->getServices().acquireFrame();
+	}
 	if (pFrame == NULL)
 	{
+		pStream->m_cs.Unlock();
 		return;
 	}
 
@@ -218,14 +289,11 @@ void ONI_CALLBACK_TYPE PlayerStream::OnNewDataCallback(const PlayerSource::NewDa
 	}
 	pFrame->sensorType = pStream->m_pSource->GetInfo()->sensorType;
 	pFrame->timestamp = newDataEventArgs.nTimeStamp;
-	pFrame->dataSize = newDataEventArgs.nSize;
-	if (pFrame->dataSize > pStream->m_requiredFrameSize)
+	pFrame->dataSize = nDataSize;
+	if (pMapping == NULL)
 	{
-		xnLogWarning("Player", "File contains a frame with size %d whereas required frame size is %d", pFrame->dataSize, pStream->m_requiredFrameSize);
-		XN_ASSERT(FALSE);
-		pFrame->dataSize = pStream->m_requiredFrameSize;
+		memcpy(pFrame->data, newDataEventArgs.pData, pFrame->dataSize);
 	}
-	memcpy(pFrame->data, newDataEventArgs.pData, pFrame->dataSize);
 
 	pStream->m_cs.Unlock();
 
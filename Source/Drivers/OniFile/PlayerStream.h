@@ -28,6 +28,7 @@
 #include "Driver/OniDriverAPI.h"
 #include "PlayerProperties.h"
 #include "PlayerSource.h"
+#include "PlayerFrameCredits.h"
 #include "XnOSCpp.h"
 
 namespace oni_file {
@@ -81,6 +82,12 @@ public:
 	// Return the player source the stream was created on.
 	PlayerSource* GetSource();
 
+	// In lockstep mode, every frame is handed out with a credit, which returns once all consumers freed it.
+	void SetLockstep(OniBool bLockstep) { m_bLockstep = bLockstep; }
+
+	// Return the credits of the frames the stream handed out in lockstep mode.
+	PlayerFrameCredits* GetFrameCredits() { return m_pFrameCredits; }
+
     /// @copydoc OniStreamBase::getProperty(int,void*,int*)
     virtual OniStatus getProperty(int propertyId, void* pData, int* pDataSize);
 
@@ -132,6 +139,10 @@ private:
 	// Are we streaming right now?
 	bool m_isStarted;
 
+	// Lockstep mode, and the credits of the frames handed out in it.
+	OniBool m_bLockstep;
+	PlayerFrameCredits* m_pFrameCredits;
+
 	int m_requiredFrameSize;
 };
 
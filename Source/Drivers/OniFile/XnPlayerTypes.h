@@ -263,6 +263,18 @@ typedef struct XnPlayerInputStreamInterface
 	 */
 	XnUInt64 (XN_CALLBACK_TYPE* Tell64)(void* pCookie);
 
+	/**
+	 * Optional. Returns a pointer to the next bytes of the stream, and moves past them, without copying them.
+	 * The memory stays valid until the stream is closed. May map less data than asked, if the stream is near
+	 * its end. Returns XN_STATUS_NOT_IMPLEMENTED if the stream can't be mapped, in which case Read() is used.
+	 *
+	 * @param	pCookie		  [in]	A cookie that was received with this interface.
+	 * @param	nSize		  [in]	Number of bytes to map.
+	 * @param	ppData		  [out]	The mapped data.
+	 * @param	pnBytesMapped [out]	Number of bytes actually mapped.
+	 */
+	XnStatus (XN_CALLBACK_TYPE* Map)(void* pCookie, XnUInt32 nSize, const void** ppData, XnUInt32* pnBytesMapped);
+
 } XnPlayerInputStreamInterface;
 
 /** 
@@ -26,6 +26,7 @@
 #include <Formats/XnUncompressedCodec.h>
 #include <Formats/Xn16zCodec.h>
 #include <Formats/Xn16zEmbTablesCodec.h>
+#include <Formats/Xn16zRowsCodec.h>
 #include <Formats/Xn8zCodec.h>
 #include <Formats/XnJpegCodec.h>
 #include <XnLog.h>
@@ -61,6 +62,21 @@ XnStatus XnCodecFactory::Create(XnCompressionFormats nFormat, XnDeviceModule* pS
 			XN_VALIDATE_NEW_AND_INIT(pCodec, Xn16zEmbTablesCodec, (OniDepthPixel)nMaxDepth);
 		}
 		break;
+	case XN_COMPRESSION_16Z_ROWS:
+		{
+			XnUInt64 nMaxDepth, nXRes, nYRes;
+			nRetVal = pStream->GetProperty(XN_STREAM_PROPERTY_MAX_DEPTH, &nMaxDepth);
+			XN_IS_STATUS_OK(nRetVal);
+
+			nRetVal = pStream->GetProperty(XN_STREAM_PROPERTY_X_RES, &nXRes);
+			XN_IS_STATUS_OK(nRetVal);
+
+			nRetVal = pStream->GetProperty(XN_STREAM_PROPERTY_Y_RES, &nYRes);
+			XN_IS_STATUS_OK(nRetVal);
+
+			XN_VALIDATE_NEW_AND_INIT(pCodec, Xn16zRowsCodec, (OniDepthPixel)nMaxDepth, (XnUInt32)nXRes, (XnUInt32)nYRes);
+		}
+		break;
 	case XN_COMPRESSION_COLOR_8Z:
 		{
 			XN_VALIDATE_NEW_AND_INIT(pCodec, Xn8zCodec);
@@ -34,7 +34,15 @@ XnFrameBufferManager::XnFrameBufferManager() :
 	m_nStableFrameID(0),
 	m_newFrameCallback(NULL),
 	m_newFrameCallbackCookie(NULL),
-	m_hLock(NULL)
+	m_hLock(NULL),
+	m_bPlaceWrites(FALSE),
+	m_nPlaceBytesPerPixel(0),
+	m_nPlaceLineWidth(0),
+	m_nPlaceFirstX(0),
+	m_nPlaceEndX(0),
+	m_nPlaceFirstY(0),
+	m_nPlaceEndY(0),
+	m_bPlaceMirror(FALSE)
 {
 }
 
@@ -83,6 +91,7 @@ XnStatus XnFrameBufferManager::Start(oni::driver::StreamServices& services)
 	}
 
 	m_writeBuffer.SetExternalBuffer((XnUChar*)m_pWorkingBuffer->data, m_pWorkingBuffer->dataSize);
+	m_bPlaceWrites = FALSE;
 
 	return (XN_STATUS_OK);
 }
@@ -98,12 +107,83 @@ void XnFrameBufferManager::Stop()
 	m_pServices = NULL;
 }
 
+void XnFrameBufferManager::SetWritePlacement(XnUInt32 nBytesPerPixel, XnUInt32 nLineWidth, XnUInt32 nLines, const OniCropping* pCropping, XnBool bMirror)
+{
+	m_nPlaceBytesPerPixel = nBytesPerPixel;
+	m_nPlaceLineWidth = nLineWidth;
+	m_nPlaceFirstX = 0;
+	m_nPlaceEndX = nLineWidth;
+	m_nPlaceFirstY = 0;
+	m_nPlaceEndY = nLines;
+	m_bPlaceMirror = bMirror;
+
+	if (pCropping != NULL && pCropping->enabled)
+	{
+		m_nPlaceFirstX = XN_MIN((XnUInt32)pCropping->originX, nLineWidth);
+		m_nPlaceEndX = XN_MIN(m_nPlaceFirstX + (XnUInt32)pCropping->width, nLineWidth);
+		m_nPlaceFirstY = XN_MIN((XnUInt32)pCropping->originY, nLines);
+		m_nPlaceEndY = XN_MIN(m_nPlaceFirstY + (XnUInt32)pCropping->height, nLines);
+	}
+
+	m_bPlaceWrites = TRUE;
+}
+
+void XnFrameBufferManager::ClearWritePlacement()
+{
+	m_bPlaceWrites = FALSE;
+}
+
+XnUChar* XnFrameBufferManager::GetPlacedWritePointer(XnUInt32 nPixels, XnUInt32* pnRunPixels, XnInt32* pnStep)
+{
+	// the write buffer size is the number of pixels written so far
+	XnUInt32 nWritten = m_writeBuffer.GetSize() / m_nPlaceBytesPerPixel;
+	XnUInt32 nY = nWritten / m_nPlaceLineWidth;
+	XnUInt32 nX = nWritten % m_nPlaceLineWidth;
+
+	*pnStep = m_bPlaceMirror ? -1 : 1;
+
+	if (nY < m_nPlaceFirstY || nY >= m_nPlaceEndY || nX >= m_nPlaceEndX)
+	{
+		// skip to the end of the line
+		*pnRunPixels = XN_MIN(nPixels, m_nPlaceLineWidth - nX);
+		return NULL;
+	}
+
+	if (nX < m_nPlaceFirstX)
+	{
+		// skip to the start of the cropped line
+		*pnRunPixels = XN_MIN(nPixels, m_nPlaceFirstX - nX);
+		return NULL;
+	}
+
+	*pnRunPixels = XN_MIN(nPixels, m_nPlaceEndX - nX);
+
+	XnUInt32 nCroppedWidth = m_nPlaceEndX - m_nPlaceFirstX;
+	XnUInt32 nCroppedX = m_bPlaceMirror ? (m_nPlaceEndX - 1 - nX) : (nX - m_nPlaceFirstX);
+	XnUInt32 nCroppedY = nY - m_nPlaceFirstY;
+
+	return m_writeBuffer.GetData() + (nCroppedY * nCroppedWidth + nCroppedX) * m_nPlaceBytesPerPixel;
+}
+
+XnUInt32 XnFrameBufferManager::GetWriteDataSize()
+{
+	if (m_bPlaceWrites)
+	{
+		// the frame holds the cropped pixels only
+		return (m_nPlaceEndX - m_nPlaceFirstX) * (m_nPlaceEndY - m_nPlaceFirstY) * m_nPlaceBytesPerPixel;
+	}
+	else
+	{
+		return m_writeBuffer.GetSize();
+	}
+}
+
 void XnFrameBufferManager::MarkWriteBufferAsStable(XnUInt32* pnFrameID)
 {
 	xnOSEnterCriticalSection(&m_hLock);
 
 	OniFrame* pStableBuffer = m_pWorkingBuffer;
-	pStableBuffer->dataSize = m_writeBuffer.GetSize();
+	pStableBuffer->dataSize = GetWriteDataSize();
 
 	// mark working as stable
 	m_nStableFrameID++;
@@ -61,6 +61,25 @@ public:
 		return m_pWorkingBuffer;
 	}
 
+	/**
+	* Makes pixels written from now on land where they belong in a cropped and / or mirrored frame,
+	* instead of one after the other. Written pixels are nLineWidth pixels per line, pCropping (may be NULL)
+	* is in written pixel coordinates, and lines are mirrored within the cropped width.
+	*/
+	void SetWritePlacement(XnUInt32 nBytesPerPixel, XnUInt32 nLineWidth, XnUInt32 nLines, const OniCropping* pCropping, XnBool bMirror);
+	void ClearWritePlacement();
+	inline XnBool IsWritePlaced() const { return m_bPlaceWrites; }
+
+	/**
+	* Gets where the next written pixels (up to nPixels of them) go. The returned run is *pnRunPixels pixels,
+	* each *pnStep pixels after the previous one, and should be skipped if NULL is returned. Either way, the
+	* write buffer size keeps counting written pixels, and should be updated with the run once it's written.
+	*/
+	XnUChar* GetPlacedWritePointer(XnUInt32 nPixels, XnUInt32* pnRunPixels, XnInt32* pnStep);
+
+	/** Gets the size of the data in the write buffer, as the frame will have it once marked as stable. */
+	XnUInt32 GetWriteDataSize();
+
 	void MarkWriteBufferAsStable(XnUInt32* pnFrameID);
 
 	inline XnUInt32 GetLastFrameID() const { return m_nStableFrameID; }
@@ -75,6 +94,15 @@ private:
 	void* m_newFrameCallbackCookie;
 	XN_CRITICAL_SECTION_HANDLE m_hLock;
 	XnBuffer m_writeBuffer;
+
+	XnBool m_bPlaceWrites;
+	XnUInt32 m_nPlaceBytesPerPixel;
+	XnUInt32 m_nPlaceLineWidth;
+	XnUInt32 m_nPlaceFirstX;
+	XnUInt32 m_nPlaceEndX;
+	XnUInt32 m_nPlaceFirstY;
+	XnUInt32 m_nPlaceEndY;
+	XnBool m_bPlaceMirror;
 };
 
 #endif //__XN_MULTI_FRAME_BUFFER_H__
\ No newline at end of file
@@ -41,7 +41,8 @@ XnPixelStream::XnPixelStream(const XnChar* csType, const XnChar* csName, XnBool
 	m_SupportedModesCount(XN_STREAM_PROPERTY_SUPPORT_MODES_COUNT, "SupportedModesCount", 0),
 	m_SupportedModes(XN_STREAM_PROPERTY_SUPPORT_MODES, "SupportedModes"),
 	m_supportedModesData(30),
-	m_bAllowCustomResolutions(bAllowCustomResolutions)
+	m_bAllowCustomResolutions(bAllowCustomResolutions),
+	m_bMirrorWorkersStarted(FALSE)
 {
 	xnOSMemSet(&m_CroppingData, 0, sizeof(OniCropping));
 	m_SupportedModes.UpdateGetCallback(GetSupportedModesCallback, this);
@@ -335,7 +336,15 @@ void XnPixelStream::NewDataAvailable(OniFrame* pFrame)
 
 XnStatus XnPixelStream::Mirror(OniFrame* pFrame) const
 {
-	return XnFormatsMirrorPixelData(GetOutputFormat(), (XnUChar*)pFrame->data, pFrame->dataSize, pFrame->width);
+	// large frames are mirrored on several threads, started on the first one. Without them, they're just
+	// mirrored on the calling one.
+	if (!m_bMirrorWorkersStarted && pFrame->dataSize >= XN_FORMATS_MIRROR_PARALLEL_MIN_SIZE)
+	{
+		m_mirrorWorkers.Init(XN_MIN(xnOSGetProcessorCount(), (XnUInt32)XN_FORMATS_MIRROR_MAX_THREADS));
+		m_bMirrorWorkersStarted = TRUE;
+	}
+
+	return XnFormatsMirrorPixelData(GetOutputFormat(), (XnUChar*)pFrame->data, pFrame->dataSize, pFrame->width, &m_mirrorWorkers);
 }
 
 XnStatus XnPixelStream::CropImpl(OniFrame* pFrame, const OniCropping* pCropping)
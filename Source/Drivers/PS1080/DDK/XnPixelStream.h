@@ -27,6 +27,7 @@
 #include <DDK/XnFrameStream.h>
 #include <DDK/XnActualGeneralProperty.h>
 #include <XnArray.h>
+#include <XnWorkerPool.h>
 
 //---------------------------------------------------------------------------
 // Types
@@ -133,6 +134,10 @@ private:
 
 	xnl::Array<XnCmosPreset> m_supportedModesData;
 	XnBool m_bAllowCustomResolutions;
+
+	// Mirror() is const, but starts and runs the workers
+	mutable xnl::WorkerPool m_mirrorWorkers;
+	mutable XnBool m_bMirrorWorkersStarted;
 };
 
 #endif //__XN_PIXEL_STREAM_H__
\ No newline at end of file
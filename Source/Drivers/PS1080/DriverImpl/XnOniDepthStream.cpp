@@ -182,3 +182,49 @@ OniStatus XnOniDepthStream::convertDepthToColorCoordinates(StreamBase* colorStre
 	return ONI_STATUS_OK;
 }
 
+OniStatus XnOniDepthStream::convertDepthPointsToColorCoordinates(StreamBase* colorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY)
+{
+	// take video mode from the color stream
+	XnOniMapStream* pColorStream = (XnOniMapStream*)colorStream;
+
+	OniVideoMode videoMode;
+	XnStatus retVal = pColorStream->GetVideoMode(&videoMode);
+	if (retVal != XN_STATUS_OK)
+	{
+		XN_ASSERT(FALSE);
+		return ONI_STATUS_ERROR;
+	}
+
+	XnSensorDepthStream* pDepthStream = (XnSensorDepthStream*)m_pDeviceStream;
+	retVal = pDepthStream->GetImageCoordinatesOfDepthPixels(count, pDepthXY, pDepthZ, videoMode.resolutionX, videoMode.resolutionY, pColorXY);
+	if (retVal != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
+OniStatus XnOniDepthStream::convertDepthMapToColorCoordinates(StreamBase* colorStream, const OniDepthPixel* pDepth, int stride, int originX, int originY, int width, int height, int* pColorXY)
+{
+	// take video mode from the color stream
+	XnOniMapStream* pColorStream = (XnOniMapStream*)colorStream;
+
+	OniVideoMode videoMode;
+	XnStatus retVal = pColorStream->GetVideoMode(&videoMode);
+	if (retVal != XN_STATUS_OK)
+	{
+		XN_ASSERT(FALSE);
+		return ONI_STATUS_ERROR;
+	}
+
+	XnSensorDepthStream* pDepthStream = (XnSensorDepthStream*)m_pDeviceStream;
+	retVal = pDepthStream->GetImageCoordinatesOfDepthMap(pDepth, stride / sizeof(OniDepthPixel), originX, originY, width, height, videoMode.resolutionX, videoMode.resolutionY, pColorXY);
+	if (retVal != XN_STATUS_OK)
+	{
+		return ONI_STATUS_ERROR;
+	}
+
+	return ONI_STATUS_OK;
+}
+
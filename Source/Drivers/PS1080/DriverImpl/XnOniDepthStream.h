@@ -39,6 +39,8 @@ public:
 	virtual OniBool isPropertySupported(int propertyId);
 	virtual void notifyAllProperties();
 	virtual OniStatus convertDepthToColorCoordinates(StreamBase* colorStream, int depthX, int depthY, OniDepthPixel depthZ, int* pColorX, int* pColorY);
+	virtual OniStatus convertDepthPointsToColorCoordinates(StreamBase* colorStream, int count, const int* pDepthXY, const OniDepthPixel* pDepthZ, int* pColorXY);
+	virtual OniStatus convertDepthMapToColorCoordinates(StreamBase* colorStream, const OniDepthPixel* pDepth, int stride, int originX, int originY, int width, int height, int* pColorXY);
 };
 
 #endif // __XN_ONI_DEPTH_STREAM_H__
\ No newline at end of file
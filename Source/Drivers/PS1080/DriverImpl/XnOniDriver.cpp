@@ -154,6 +154,17 @@ void XnOniDriver::deviceClose(oni::driver::DeviceBase* pDevice)
 	XN_ASSERT(FALSE);
 }
 
+OniStatus XnOniDriver::tryDevice(const char* uri)
+{
+	// USB captures of supported devices are opened as devices that replay them
+	if (XnDeviceEnumeration::AddCaptureFile(uri) == XN_STATUS_OK)
+	{
+		return ONI_STATUS_OK;
+	}
+
+	return DriverBase::tryDevice(uri);
+}
+
 void* XnOniDriver::enableFrameSync(oni::driver::StreamBase** pStreams, int streamCount)
 {
 	// Make sure all the streams belong to same device.
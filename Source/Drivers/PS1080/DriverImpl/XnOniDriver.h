@@ -46,6 +46,8 @@ public:
 	virtual oni::driver::DeviceBase* deviceOpen(const char* uri, const char* mode);
 	virtual void deviceClose(oni::driver::DeviceBase* pDevice);
 
+	virtual OniStatus tryDevice(const char* uri);
+
 	virtual void* enableFrameSync(oni::driver::StreamBase** pStreams, int streamCount);
 	virtual void disableFrameSync(void* frameSyncGroup);
 
@@ -0,0 +1,86 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __XN_16Z_ROWS_CODEC_H__
+#define __XN_16Z_ROWS_CODEC_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "XnCodecBase.h"
+#include <Formats/XnStreamCompression.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_16Z_ROWS_CODEC_ROWS_PER_BLOCK 16
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/** 16z with embedded tables, in blocks of rows that can be decoded on their own (and so in parallel). */
+class Xn16zRowsCodec : public XnCodecBase
+{
+public:
+	Xn16zRowsCodec(XnUInt16 nMaxValue, XnUInt32 nXRes, XnUInt32 nYRes) : 
+		m_nMaxValue(nMaxValue), m_nXRes(nXRes), m_nYRes(nYRes), m_pEmbTable(NULL) {}
+
+	virtual ~Xn16zRowsCodec()
+	{
+		XN_DELETE_ARR(m_pEmbTable);
+	}
+
+	virtual XnCompressionFormats GetCompressionFormat() const { return XN_COMPRESSION_16Z_ROWS; }
+
+	virtual XnFloat GetWorseCompressionRatio() const { return XN_STREAM_COMPRESSION_DEPTH16Z_WORSE_RATIO; }
+	virtual XnUInt32 GetOverheadSize() const 
+	{
+		XnUInt32 nBlocks = (m_nYRes + XN_16Z_ROWS_CODEC_ROWS_PER_BLOCK - 1) / XN_16Z_ROWS_CODEC_ROWS_PER_BLOCK;
+		return (m_nMaxValue + 1) * sizeof(XnUInt16) + 3 * sizeof(XnUInt32) + nBlocks * (sizeof(XnUInt32) + sizeof(XnUInt16));
+	}
+
+protected:
+	virtual XnStatus CompressImpl(const XnUChar* pData, XnUInt32 nDataSize, XnUChar* pCompressedData, XnUInt32* pnCompressedDataSize)
+	{
+		// only needed for compression
+		if (m_pEmbTable == NULL)
+		{
+			m_pEmbTable = XN_NEW_ARR(XnUInt16, XN_MAX_UINT16 + 1);
+			XN_VALIDATE_ALLOC_PTR(m_pEmbTable);
+		}
+
+		return XnStreamCompressDepth16ZRows((XnUInt16*)pData, nDataSize, pCompressedData, pnCompressedDataSize, m_nXRes * XN_16Z_ROWS_CODEC_ROWS_PER_BLOCK, m_pEmbTable);
+	}
+
+	virtual XnStatus DecompressImpl(const XnUChar* pCompressedData, XnUInt32 nCompressedDataSize, XnUChar* pData, XnUInt32* pnDataSize) 
+	{
+		return XnStreamUncompressDepth16ZRows(pCompressedData, nCompressedDataSize, (XnUInt16*)pData, pnDataSize);
+	}
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(Xn16zRowsCodec);
+
+	XnUInt16 m_nMaxValue;
+	XnUInt32 m_nXRes;
+	XnUInt32 m_nYRes;
+	XnUInt16* m_pEmbTable; // working space of the compression, allocated on first use
+};
+
+#endif //__XN_16Z_ROWS_CODEC_H__
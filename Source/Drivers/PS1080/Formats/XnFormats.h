@@ -34,6 +34,17 @@
 //---------------------------------------------------------------------------
 #define XN_MASK_FORMATS "XnFormats"
 
+/** The number of threads worth mirroring a frame on. */
+#define XN_FORMATS_MIRROR_MAX_THREADS	4
+
+/** Smaller buffers aren't worth waking up other threads for. */
+#define XN_FORMATS_MIRROR_PARALLEL_MIN_SIZE	(640*480*2)
+
+namespace xnl
+{
+	class WorkerPool;
+}
+
 //---------------------------------------------------------------------------
 // Exported Functions
 //---------------------------------------------------------------------------
@@ -45,7 +56,8 @@
 * @param	pBuffer			[in]	A pointer to the buffer.
 * @param	nBufferSize		[in]	The size of the buffer, in bytes.
 * @param	nXRes			[in]	X-resolution (line size in pixels) of the buffer.
+* @param	pWorkers		[in]	Optional. Threads to split large buffers between, by lines.
 */
-XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nXRes);
+XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nXRes, xnl::WorkerPool* pWorkers = NULL);
 
 #endif //_XN_FORMATS_H_
@@ -26,195 +26,501 @@
 #include "XnFormats.h"
 #include <XnOS.h>
 #include <XnLog.h>
+#include <XnWorkerPool.h>
+
+// SSSE3 and AVX2 code is compiled regardless of compiler flags, and only used if the CPU supports it
+#if (XN_PLATFORM == XN_PLATFORM_WIN32) || defined(__SSE2__)
+	#if defined(_MSC_VER) && (_MSC_VER >= 1700)
+		#define XN_MIRROR_SIMD
+		#define XN_MIRROR_SSSE3_FUNCTION
+		#define XN_MIRROR_AVX2_FUNCTION
+	#elif defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+		#define XN_MIRROR_SIMD
+		#define XN_MIRROR_SSSE3_FUNCTION __attribute__((target("ssse3")))
+		#define XN_MIRROR_AVX2_FUNCTION __attribute__((target("avx2")))
+	#endif
+#endif
+
+#ifdef XN_MIRROR_SIMD
+#include <immintrin.h>
+#elif defined(XN_NEON)
+#include <arm_neon.h>
+#endif
 
 //---------------------------------------------------------------------------
-// Defines
+// Types
 //---------------------------------------------------------------------------
-#define XN_MIRROR_MAX_LINE_SIZE	1920*3
+/* Reverses the order of the units in [pLeft, pRight), in place. */
+typedef void (*XnMirrorUnitsFunc)(XnUChar* pLeft, XnUChar* pRight);
+
+typedef struct XnMirrorFormat
+{
+	/* Size of what is mirrored as a whole: a pixel, or a YUV macro pixel. */
+	XnUInt32 nUnitSize;
+	XnMirrorUnitsFunc pMirrorUnits;
+	/* Byte shuffle that mirrors the units of 16 bytes (for units of 1, 2 or 4 bytes). */
+	XnUInt8 aShuffle[16];
+} XnMirrorFormat;
+
+typedef void (*XnMirrorLinesFunc)(const XnMirrorFormat* pFormat, XnUChar* pLines, XnUInt32 nLines, XnUInt32 nLineSize);
+
+typedef struct XnMirrorJob
+{
+	XnMirrorLinesFunc pMirrorLines;
+	const XnMirrorFormat* pFormat;
+	XnUChar* pBuffer;
+	XnUInt32 nLines;
+	XnUInt32 nLineSize;
+	XnUInt32 nBands;
+} XnMirrorJob;
 
 //---------------------------------------------------------------------------
-// Code
+// Scalar Code
 //---------------------------------------------------------------------------
-XnStatus XnMirrorOneBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+static void XnMirrorOneByteUnits(XnUChar* pLeft, XnUChar* pRight)
 {
-	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[0] + nLineSize - 1;
-	XnUInt8* pDestEnd = &pLineBuffer[0] - 1;
+	XnUInt8* pSrc = pLeft;
+	XnUInt8* pDest = pRight - 1;
+	XnUInt8 nValue;
 
-	if (nLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	while (pSrc < pDest)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		nValue = *pSrc;
+		*pSrc = *pDest;
+		*pDest = nValue;
+
+		pSrc++;
+		pDest--;
 	}
+}
+
+static void XnMirrorTwoByteUnits(XnUChar* pLeft, XnUChar* pRight)
+{
+	XnUInt16* pSrc = (XnUInt16*)pLeft;
+	XnUInt16* pDest = (XnUInt16*)pRight - 1;
+	XnUInt16 nValue;
 
-	while (pSrc < pSrcEnd)
+	while (pSrc < pDest)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nLineSize);
+		nValue = *pSrc;
+		*pSrc = *pDest;
+		*pDest = nValue;
 
-		pDest = pDestVal;
-		while (pDest != pDestEnd)
-		{
-			*pSrc = *pDest;
+		pSrc++;
+		pDest--;
+	}
+}
 
-			pSrc++;
-			pDest--;
-		}
+static void XnMirrorThreeByteUnits(XnUChar* pLeft, XnUChar* pRight)
+{
+	XnUInt8* pSrc = pLeft;
+	XnUInt8* pDest = pRight - 3;
+	XnUInt8 aValue[3];
+
+	while (pSrc < pDest)
+	{
+		aValue[0] = pSrc[0];
+		aValue[1] = pSrc[1];
+		aValue[2] = pSrc[2];
+		pSrc[0] = pDest[0];
+		pSrc[1] = pDest[1];
+		pSrc[2] = pDest[2];
+		pDest[0] = aValue[0];
+		pDest[1] = aValue[1];
+		pDest[2] = aValue[2];
+
+		pSrc+=3;
+		pDest-=3;
 	}
+}
 
-	// All is good...
-	return (XN_STATUS_OK);
+static void XnMirrorYUV422Units(XnUChar* pLeft, XnUChar* pRight)
+{
+	XnUInt8* pSrc = pLeft;
+	XnUInt8* pDest = pRight - 4;
+	XnUInt8 aSrc[4];
+	XnUInt8 aDest[4];
+
+	// the middle macro pixel (if any) is mirrored onto itself
+	while (pSrc <= pDest)
+	{
+		xnOSMemCopy(aSrc, pSrc, 4);
+		xnOSMemCopy(aDest, pDest, 4);
+
+		pSrc[0] = aDest[0]; // u
+		pSrc[1] = aDest[3]; // y1 <-> y2
+		pSrc[2] = aDest[2]; // v
+		pSrc[3] = aDest[1]; // y2 <-> y1
+
+		pDest[0] = aSrc[0];
+		pDest[1] = aSrc[3];
+		pDest[2] = aSrc[2];
+		pDest[3] = aSrc[1];
+
+		pSrc += 4;
+		pDest -= 4;
+	}
 }
 
-XnStatus XnMirrorTwoBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+static void XnMirrorYUYVUnits(XnUChar* pLeft, XnUChar* pRight)
 {
-	// Local function variables
-	XnUInt16* pSrc = (XnUInt16*)pBuffer;
-	XnUInt16 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt16* pSrcEnd = pSrc + nBufferSize / sizeof(XnUInt16);
-	XnUInt16* pDest = NULL;
-	XnUInt16* pDestVal = &pLineBuffer[0] + nLineSize - 1;
-	XnUInt16* pDestEnd = &pLineBuffer[0] - 1;
-	XnUInt16 nMemCpyLineSize = (XnUInt16)(nLineSize * sizeof(XnUInt16));
-	XnUInt16 nValue;
+	XnUInt8* pSrc = pLeft;
+	XnUInt8* pDest = pRight - 4;
+	XnUInt8 aSrc[4];
+	XnUInt8 aDest[4];
 
-	if (nLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	// the middle macro pixel (if any) is mirrored onto itself
+	while (pSrc <= pDest)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		xnOSMemCopy(aSrc, pSrc, 4);
+		xnOSMemCopy(aDest, pDest, 4);
+
+		// the two pixels share u and v, so only their y values trade places
+		pSrc[0] = aDest[2]; // y1 <-> y2
+		pSrc[1] = aDest[1]; // u
+		pSrc[2] = aDest[0]; // y2 <-> y1
+		pSrc[3] = aDest[3]; // v
+
+		pDest[0] = aSrc[2];
+		pDest[1] = aSrc[1];
+		pDest[2] = aSrc[0];
+		pDest[3] = aSrc[3];
+
+		pSrc += 4;
+		pDest -= 4;
 	}
+}
 
-	while (pSrc < pSrcEnd)
+static void XnMirrorLinesScalar(const XnMirrorFormat* pFormat, XnUChar* pLines, XnUInt32 nLines, XnUInt32 nLineSize)
+{
+	for (XnUInt32 y = 0; y < nLines; ++y, pLines += nLineSize)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
+		pFormat->pMirrorUnits(pLines, pLines + nLineSize);
+	}
+}
 
-		pDest = pDestVal;
-		while (pDest != pDestEnd)
-		{
-			nValue = pDest[0];
-			pSrc[0] = nValue;
+//---------------------------------------------------------------------------
+// Formats
+//---------------------------------------------------------------------------
+static const XnMirrorFormat g_MirrorOneByte = { 1, XnMirrorOneByteUnits, { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 } };
+static const XnMirrorFormat g_MirrorTwoByte = { 2, XnMirrorTwoByteUnits, { 14, 15, 12, 13, 10, 11, 8, 9, 6, 7, 4, 5, 2, 3, 0, 1 } };
+static const XnMirrorFormat g_MirrorThreeByte = { 3, XnMirrorThreeByteUnits, { 0 } };
+static const XnMirrorFormat g_MirrorYUV422 = { 4, XnMirrorYUV422Units, { 12, 15, 14, 13, 8, 11, 10, 9, 4, 7, 6, 5, 0, 3, 2, 1 } };
+static const XnMirrorFormat g_MirrorYUYV = { 4, XnMirrorYUYVUnits, { 14, 13, 12, 15, 10, 9, 8, 11, 6, 5, 4, 7, 2, 1, 0, 3 } };
 
-			pDest--;
-			pSrc++;
+//---------------------------------------------------------------------------
+// SIMD Code
+//---------------------------------------------------------------------------
+// Lines are mirrored by swapping blocks from both of their ends, mirroring each block with a byte shuffle,
+// until the blocks meet. What's left in the middle is mirrored by the scalar code.
+
+#ifdef XN_MIRROR_SIMD
+
+static const XnBool g_bMirrorUseSSSE3 = xnOSIsCPUFeatureSupported(XN_CPU_FEATURE_SSSE3);
+static const XnBool g_bMirrorUseAVX2 = xnOSIsCPUFeatureSupported(XN_CPU_FEATURE_AVX2);
+
+/* Byte shuffles that mirror 16 three-byte pixels (3 vectors). Output vector k is the OR of input vector m
+*  shuffled by [k][m], for every m. */
+static XnUInt8 g_aThreeByteShuffles[3][3][16];
+
+static XnBool XnMirrorInitThreeByteShuffles()
+{
+	for (XnUInt32 nOut = 0; nOut < 48; ++nOut)
+	{
+		XnUInt32 nIn = (15 - nOut / 3) * 3 + nOut % 3;
+		for (XnUInt32 m = 0; m < 3; ++m)
+		{
+			g_aThreeByteShuffles[nOut / 16][m][nOut % 16] = (nIn / 16 == m) ? (XnUInt8)(nIn % 16) : 0x80;
 		}
 	}
 
-	// All is good...
-	return (XN_STATUS_OK);
+	return TRUE;
 }
 
-XnStatus XnMirrorThreeBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+static const XnBool g_bThreeByteShufflesInit = XnMirrorInitThreeByteShuffles();
+
+static XN_MIRROR_SSSE3_FUNCTION void XnMirrorLinesSSSE3(const XnMirrorFormat* pFormat, XnUChar* pLines, XnUInt32 nLines, XnUInt32 nLineSize)
 {
-	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[0] + nLineSize * 3 - 1;
-	XnUInt8* pDestEnd = &pLineBuffer[0] - 1;
-	XnUInt16 nMemCpyLineSize = (XnUInt16)(nLineSize * 3);
+	const __m128i shuffle = _mm_loadu_si128((const __m128i*)pFormat->aShuffle);
 
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
+	for (XnUInt32 y = 0; y < nLines; ++y, pLines += nLineSize)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		XnUChar* pLeft = pLines;
+		XnUChar* pRight = pLines + nLineSize;
+
+		while (pRight - pLeft >= 32)
+		{
+			pRight -= 16;
+
+			__m128i left = _mm_loadu_si128((const __m128i*)pLeft);
+			__m128i right = _mm_loadu_si128((const __m128i*)pRight);
+			_mm_storeu_si128((__m128i*)pLeft, _mm_shuffle_epi8(right, shuffle));
+			_mm_storeu_si128((__m128i*)pRight, _mm_shuffle_epi8(left, shuffle));
+
+			pLeft += 16;
+		}
+
+		pFormat->pMirrorUnits(pLeft, pRight);
 	}
+}
+
+static XN_MIRROR_AVX2_FUNCTION void XnMirrorLinesAVX2(const XnMirrorFormat* pFormat, XnUChar* pLines, XnUInt32 nLines, XnUInt32 nLineSize)
+{
+	const __m128i shuffle128 = _mm_loadu_si128((const __m128i*)pFormat->aShuffle);
+	const __m256i shuffle = _mm256_inserti128_si256(_mm256_castsi128_si256(shuffle128), shuffle128, 1);
 
-	while (pSrc < pSrcEnd)
+	for (XnUInt32 y = 0; y < nLines; ++y, pLines += nLineSize)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
+		XnUChar* pLeft = pLines;
+		XnUChar* pRight = pLines + nLineSize;
 
-		pDest = pDestVal;
-		while (pDest != pDestEnd)
+		// the shuffle is within 128-bit lanes, so lanes are swapped as well
+		while (pRight - pLeft >= 64)
 		{
-			*pSrc = *(pDest-2);
-			*(pSrc+1) = *(pDest-1);
-			*(pSrc+2) = *pDest;
+			pRight -= 32;
 
-			pSrc+=3;
-			pDest-=3;
+			__m256i left = _mm256_loadu_si256((const __m256i*)pLeft);
+			__m256i right = _mm256_loadu_si256((const __m256i*)pRight);
+			_mm256_storeu_si256((__m256i*)pLeft, _mm256_permute4x64_epi64(_mm256_shuffle_epi8(right, shuffle), _MM_SHUFFLE(1, 0, 3, 2)));
+			_mm256_storeu_si256((__m256i*)pRight, _mm256_permute4x64_epi64(_mm256_shuffle_epi8(left, shuffle), _MM_SHUFFLE(1, 0, 3, 2)));
+
+			pLeft += 32;
 		}
-	}
 
-	// All is good...
-	return (XN_STATUS_OK);
+		while (pRight - pLeft >= 32)
+		{
+			pRight -= 16;
+
+			__m128i left = _mm_loadu_si128((const __m128i*)pLeft);
+			__m128i right = _mm_loadu_si128((const __m128i*)pRight);
+			_mm_storeu_si128((__m128i*)pLeft, _mm_shuffle_epi8(right, shuffle128));
+			_mm_storeu_si128((__m128i*)pRight, _mm_shuffle_epi8(left, shuffle128));
+
+			pLeft += 16;
+		}
+
+		pFormat->pMirrorUnits(pLeft, pRight);
+	}
 }
 
-XnStatus XnMirrorYUV422Pixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+static inline XN_MIRROR_SSSE3_FUNCTION void XnMirrorThreeByteBlockSSSE3(XnUChar* pDest, const __m128i aIn[3], const __m128i aShuffles[3][3])
 {
-	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = (XnUInt8*)pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[(nLineSize/2-1)*sizeof(XnUInt32)]; // last element
-	XnUInt8* pDestEnd = &pLineBuffer[0]; // first element
-	XnUInt32 nMemCpyLineSize = nLineSize/2*sizeof(XnUInt32);
+	for (XnUInt32 k = 0; k < 3; ++k)
+	{
+		__m128i out = _mm_or_si128(_mm_or_si128(
+			_mm_shuffle_epi8(aIn[0], aShuffles[k][0]),
+			_mm_shuffle_epi8(aIn[1], aShuffles[k][1])),
+			_mm_shuffle_epi8(aIn[2], aShuffles[k][2]));
+		_mm_storeu_si128((__m128i*)pDest + k, out);
+	}
+}
 
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
+// RGB pixels don't fit evenly in 16 (or 32) bytes, so blocks are 16 pixels, in 3 vectors. This is also
+// used when AVX2 is supported.
+static XN_MIRROR_SSSE3_FUNCTION void XnMirrorThreeByteLinesSSSE3(const XnMirrorFormat* pFormat, XnUChar* pLines, XnUInt32 nLines, XnUInt32 nLineSize)
+{
+	__m128i aShuffles[3][3];
+	for (XnUInt32 k = 0; k < 3; ++k)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		for (XnUInt32 m = 0; m < 3; ++m)
+		{
+			aShuffles[k][m] = _mm_loadu_si128((const __m128i*)g_aThreeByteShuffles[k][m]);
+		}
 	}
 
-	while (pSrc < pSrcEnd)
+	for (XnUInt32 y = 0; y < nLines; ++y, pLines += nLineSize)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
-		pDest = pDestVal;
+		XnUChar* pLeft = pLines;
+		XnUChar* pRight = pLines + nLineSize;
 
-		while (pDest >= pDestEnd)
+		while (pRight - pLeft >= 96)
 		{
-			pSrc[0] = pDest[0]; // u
-			pSrc[1] = pDest[3]; // y1 <-> y2
-			pSrc[2] = pDest[2]; // v
-			pSrc[3] = pDest[1]; // y2 <-> y1
+			pRight -= 48;
+
+			__m128i aLeft[3];
+			__m128i aRight[3];
+			for (XnUInt32 m = 0; m < 3; ++m)
+			{
+				aLeft[m] = _mm_loadu_si128((const __m128i*)pLeft + m);
+				aRight[m] = _mm_loadu_si128((const __m128i*)pRight + m);
+			}
 
-			pSrc += 4;
-			pDest -= 4;
+			XnMirrorThreeByteBlockSSSE3(pLeft, aRight, aShuffles);
+			XnMirrorThreeByteBlockSSSE3(pRight, aLeft, aShuffles);
+
+			pLeft += 48;
 		}
+
+		pFormat->pMirrorUnits(pLeft, pRight);
 	}
+}
 
-	// All is good...
-	return (XN_STATUS_OK);
+#elif defined(XN_NEON)
+
+static inline uint8x16_t XnMirrorShuffleNEON(uint8x16_t in, uint8x8_t shuffleLow, uint8x8_t shuffleHigh)
+{
+	uint8x8x2_t table = { { vget_low_u8(in), vget_high_u8(in) } };
+	return vcombine_u8(vtbl2_u8(table, shuffleLow), vtbl2_u8(table, shuffleHigh));
 }
 
-XnStatus XnMirrorYUYVPixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize)
+static inline uint8x16_t XnMirrorReverseNEON(uint8x16_t in)
 {
-	// Local function variables
-	XnUInt8* pSrc = pBuffer;
-	XnUInt8 pLineBuffer[XN_MIRROR_MAX_LINE_SIZE];
-	XnUInt8* pSrcEnd = (XnUInt8*)pSrc + nBufferSize;
-	XnUInt8* pDest = NULL;
-	XnUInt8* pDestVal = &pLineBuffer[(nLineSize/2-1)*sizeof(XnUInt32)]; // last element
-	XnUInt8* pDestEnd = &pLineBuffer[0]; // first element
-	XnUInt32 nMemCpyLineSize = nLineSize/2*sizeof(XnUInt32);
+	uint8x16_t reversed = vrev64q_u8(in);
+	return vcombine_u8(vget_high_u8(reversed), vget_low_u8(reversed));
+}
 
-	if (nMemCpyLineSize > XN_MIRROR_MAX_LINE_SIZE)
+static void XnMirrorLinesNEON(const XnMirrorFormat* pFormat, XnUChar* pLines, XnUInt32 nLines, XnUInt32 nLineSize)
+{
+	const uint8x8_t shuffleLow = vld1_u8(pFormat->aShuffle);
+	const uint8x8_t shuffleHigh = vld1_u8(pFormat->aShuffle + 8);
+
+	for (XnUInt32 y = 0; y < nLines; ++y, pLines += nLineSize)
 	{
-		return (XN_STATUS_INTERNAL_BUFFER_TOO_SMALL);
+		XnUChar* pLeft = pLines;
+		XnUChar* pRight = pLines + nLineSize;
+
+		while (pRight - pLeft >= 32)
+		{
+			pRight -= 16;
+
+			uint8x16_t left = vld1q_u8(pLeft);
+			uint8x16_t right = vld1q_u8(pRight);
+			vst1q_u8(pLeft, XnMirrorShuffleNEON(right, shuffleLow, shuffleHigh));
+			vst1q_u8(pRight, XnMirrorShuffleNEON(left, shuffleLow, shuffleHigh));
+
+			pLeft += 16;
+		}
+
+		pFormat->pMirrorUnits(pLeft, pRight);
 	}
+}
 
-	while (pSrc < pSrcEnd)
+// blocks of 16 RGB pixels, loaded one plane per color, so each plane is simply reversed
+static void XnMirrorThreeByteLinesNEON(const XnMirrorFormat* pFormat, XnUChar* pLines, XnUInt32 nLines, XnUInt32 nLineSize)
+{
+	for (XnUInt32 y = 0; y < nLines; ++y, pLines += nLineSize)
 	{
-		xnOSMemCopy(pLineBuffer, pSrc, nMemCpyLineSize);
-		pDest = pDestVal;
+		XnUChar* pLeft = pLines;
+		XnUChar* pRight = pLines + nLineSize;
 
-		while (pDest >= pDestEnd)
+		while (pRight - pLeft >= 96)
 		{
-			pSrc[0] = pDest[2]; // y1 <-> y2
-			pSrc[1] = pDest[3]; // u
-			pSrc[2] = pDest[0]; // y2 <-> y1
-			pSrc[3] = pDest[1]; // v
-
-			pSrc += 4;
-			pDest -= 4;
+			pRight -= 48;
+
+			uint8x16x3_t left = vld3q_u8(pLeft);
+			uint8x16x3_t right = vld3q_u8(pRight);
+			for (int c = 0; c < 3; ++c)
+			{
+				left.val[c] = XnMirrorReverseNEON(left.val[c]);
+				right.val[c] = XnMirrorReverseNEON(right.val[c]);
+			}
+			vst3q_u8(pLeft, right);
+			vst3q_u8(pRight, left);
+
+			pLeft += 48;
 		}
+
+		pFormat->pMirrorUnits(pLeft, pRight);
+	}
+}
+
+#endif
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+static XnMirrorLinesFunc XnMirrorChooseLinesFunc(const XnMirrorFormat* pFormat)
+{
+#ifdef XN_MIRROR_SIMD
+	if (pFormat->nUnitSize == 3)
+	{
+		return g_bMirrorUseSSSE3 ? XnMirrorThreeByteLinesSSSE3 : XnMirrorLinesScalar;
+	}
+	else if (g_bMirrorUseAVX2)
+	{
+		return XnMirrorLinesAVX2;
+	}
+	else if (g_bMirrorUseSSSE3)
+	{
+		return XnMirrorLinesSSSE3;
+	}
+#elif defined(XN_NEON)
+	return (pFormat->nUnitSize == 3) ? XnMirrorThreeByteLinesNEON : XnMirrorLinesNEON;
+#endif
+
+	return XnMirrorLinesScalar;
+}
+
+static void XN_CALLBACK_TYPE XnMirrorBandTask(XnUInt32 nTask, void* pCookie)
+{
+	XnMirrorJob* pJob = (XnMirrorJob*)pCookie;
+
+	XnUInt32 nFirstLine = pJob->nLines * nTask / pJob->nBands;
+	XnUInt32 nEndLine = pJob->nLines * (nTask + 1) / pJob->nBands;
+
+	pJob->pMirrorLines(pJob->pFormat, pJob->pBuffer + nFirstLine * pJob->nLineSize, nEndLine - nFirstLine, pJob->nLineSize);
+}
+
+static XnStatus XnMirrorLines(const XnMirrorFormat* pFormat, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize, xnl::WorkerPool* pWorkers)
+{
+	if (nLineSize == 0)
+	{
+		return (XN_STATUS_BAD_PARAM);
+	}
+
+	XnMirrorJob job;
+	job.pMirrorLines = XnMirrorChooseLinesFunc(pFormat);
+	job.pFormat = pFormat;
+	job.pBuffer = pBuffer;
+	job.nLines = nBufferSize / nLineSize;
+	job.nLineSize = nLineSize;
+	job.nBands = 1;
+
+	if (pWorkers != NULL && nBufferSize >= XN_FORMATS_MIRROR_PARALLEL_MIN_SIZE)
+	{
+		job.nBands = XN_MIN(pWorkers->GetThreadCount(), job.nLines);
+	}
+
+	if (job.nBands > 1)
+	{
+		// each thread mirrors a range of lines
+		pWorkers->Run(job.nBands, XnMirrorBandTask, &job);
+	}
+	else
+	{
+		job.pMirrorLines(pFormat, pBuffer, job.nLines, nLineSize);
 	}
 
 	// All is good...
 	return (XN_STATUS_OK);
 }
 
-XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nXRes)
+XnStatus XnMirrorOneBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize, xnl::WorkerPool* pWorkers)
+{
+	return XnMirrorLines(&g_MirrorOneByte, pBuffer, nBufferSize, nLineSize, pWorkers);
+}
+
+XnStatus XnMirrorTwoBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize, xnl::WorkerPool* pWorkers)
+{
+	return XnMirrorLines(&g_MirrorTwoByte, pBuffer, nBufferSize, nLineSize * sizeof(XnUInt16), pWorkers);
+}
+
+XnStatus XnMirrorThreeBytePixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize, xnl::WorkerPool* pWorkers)
+{
+	return XnMirrorLines(&g_MirrorThreeByte, pBuffer, nBufferSize, nLineSize * 3, pWorkers);
+}
+
+XnStatus XnMirrorYUV422Pixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize, xnl::WorkerPool* pWorkers)
+{
+	return XnMirrorLines(&g_MirrorYUV422, pBuffer, nBufferSize, nLineSize/2*sizeof(XnUInt32), pWorkers);
+}
+
+XnStatus XnMirrorYUYVPixels(XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nLineSize, xnl::WorkerPool* pWorkers)
+{
+	return XnMirrorLines(&g_MirrorYUYV, pBuffer, nBufferSize, nLineSize/2*sizeof(XnUInt32), pWorkers);
+}
+
+XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nXRes, xnl::WorkerPool* pWorkers)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
 	XN_VALIDATE_INPUT_PTR(pBuffer);
@@ -225,15 +531,15 @@ XnStatus XnFormatsMirrorPixelData(OniPixelFormat nOutputFormat, XnUChar* pBuffer
 	case ONI_PIXEL_FORMAT_DEPTH_1_MM:
 	case ONI_PIXEL_FORMAT_DEPTH_100_UM:
 	case ONI_PIXEL_FORMAT_GRAY16:
-		return XnMirrorTwoBytePixels(pBuffer, nBufferSize, nXRes);
+		return XnMirrorTwoBytePixels(pBuffer, nBufferSize, nXRes, pWorkers);
 	case ONI_PIXEL_FORMAT_GRAY8:
-		return XnMirrorOneBytePixels(pBuffer, nBufferSize, nXRes);
+		return XnMirrorOneBytePixels(pBuffer, nBufferSize, nXRes, pWorkers);
 	case ONI_PIXEL_FORMAT_YUV422:
-		return XnMirrorYUV422Pixels(pBuffer, nBufferSize, nXRes);
+		return XnMirrorYUV422Pixels(pBuffer, nBufferSize, nXRes, pWorkers);
 	case ONI_PIXEL_FORMAT_YUYV:
-		return XnMirrorYUYVPixels(pBuffer, nBufferSize, nXRes);
+		return XnMirrorYUYVPixels(pBuffer, nBufferSize, nXRes, pWorkers);
 	case ONI_PIXEL_FORMAT_RGB888:
-		return XnMirrorThreeBytePixels(pBuffer, nBufferSize, nXRes);
+		return XnMirrorThreeBytePixels(pBuffer, nBufferSize, nXRes, pWorkers);
 	default:
 		xnLogError(XN_MASK_FORMATS, "Mirror was not implemented for output format %d", nOutputFormat);
 		XN_ASSERT(FALSE);
@@ -28,9 +28,138 @@ extern "C" {
 }
 #include <XnLog.h>
 
+// SSE2 is there on every x86 CPU this runs on, so it needs no runtime check
+#if (XN_PLATFORM == XN_PLATFORM_WIN32) || defined(__SSE2__)
+	#define XN_STREAM_COMPRESSION_SSE2
+	#include <emmintrin.h>
+#endif
+
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
+/* Encodes values in 16z, after translating them through pTable. Returns the end of the output. */
+static XnUInt8* XnStreamCompress16ZTranslated(const XnUInt16* pInput, const XnUInt16* pInputEnd, const XnUInt16* pTable, XnUInt8* pOutput)
+{
+	XnUInt16 nCurrValue = 0;
+	XnUInt16 nLastValue = 0;
+	XnUInt16 nAbsDiffValue = 0;
+	XnInt16 nDiffValue = 0;
+	XnUInt8 cOutStage = 0;
+	XnUInt8 cOutChar = 0;
+	XnUInt8 cZeroCounter = 0;
+
+	nLastValue = pTable[*pInput];
+	*(XnUInt16*)pOutput = nLastValue;
+	pInput++;
+	pOutput+=2;
+
+	while (pInput != pInputEnd)
+	{
+		nCurrValue = pTable[*pInput];
+
+		nDiffValue = (nLastValue - nCurrValue);
+		nAbsDiffValue = (XnUInt16)abs(nDiffValue);
+
+		if (nAbsDiffValue <= 6)
+		{
+			nDiffValue += 6;
+
+			if (cOutStage == 0)
+			{
+				cOutChar = (XnUInt8)(nDiffValue << 4);
+
+				cOutStage = 1;
+			}
+			else
+			{
+				cOutChar += (XnUInt8)nDiffValue;
+
+				if (cOutChar == 0x66)
+				{
+					cZeroCounter++;
+
+					if (cZeroCounter == 15)
+					{
+						*pOutput = 0xEF;
+						pOutput++;
+
+						cZeroCounter = 0;
+					}
+				}
+				else
+				{
+					if (cZeroCounter != 0)
+					{
+						*pOutput = 0xE0 + cZeroCounter;
+						pOutput++;
+
+						cZeroCounter = 0;
+					}
+
+					*pOutput = cOutChar;
+					pOutput++;
+				}
+
+				cOutStage = 0;
+			}
+		}
+		else
+		{
+			if (cZeroCounter != 0)
+			{
+				*pOutput = 0xE0 + cZeroCounter;
+				pOutput++;
+
+				cZeroCounter = 0;
+			}
+
+			if (cOutStage == 0)
+			{
+				cOutChar = 0xFF;
+			}
+			else
+			{
+				cOutChar += 0x0F;
+				cOutStage = 0;
+			}
+
+			*pOutput = cOutChar;
+			pOutput++;
+
+			if (nAbsDiffValue <= 63)
+			{
+				nDiffValue += 192;
+
+				*pOutput = (XnUInt8)nDiffValue;
+				pOutput++;
+			}
+			else
+			{
+				*(XnUInt16*)pOutput = (nCurrValue << 8) + (nCurrValue >> 8);
+				pOutput+=2;
+			}
+		}
+
+		nLastValue = nCurrValue;
+		pInput++;
+	}
+
+	// the pending zeros come before the last value
+	if (cZeroCounter != 0)
+	{
+		*pOutput = 0xE0 + cZeroCounter;
+		pOutput++;
+	}
+
+	if (cOutStage != 0)
+	{
+		*pOutput = cOutChar + 0x0D;
+		pOutput++;
+	}
+
+	return pOutput;
+}
+
 XnStatus XnStreamCompressDepth16Z(const XnUInt16* pInput, const XnUInt32 nInputSize, XnUInt8* pOutput, XnUInt32* pnOutputSize)
 {
 	// Local function variables
@@ -154,15 +283,16 @@ XnStatus XnStreamCompressDepth16Z(const XnUInt16* pInput, const XnUInt32 nInputS
 		pInput++;
 	}
 
-	if (cOutStage != 0)
+	// the pending zeros come before the last value
+	if (cZeroCounter != 0)
 	{
-		*pOutput = cOutChar + 0x0D;
+		*pOutput = 0xE0 + cZeroCounter;
 		pOutput++;
 	}
 
-	if (cZeroCounter != 0)
+	if (cOutStage != 0)
 	{
-		*pOutput = 0xE0 + cZeroCounter;
+		*pOutput = cOutChar + 0x0D;
 		pOutput++;
 	}
 
@@ -185,7 +315,8 @@ XnStatus XnStreamCompressDepth16ZWithEmbTable(const XnUInt16* pInput, const XnUI
 	XnUInt8 cOutStage = 0;
 	XnUInt8 cOutChar = 0;
 	XnUInt8 cZeroCounter = 0;
-	static XnUInt16 nEmbTable[XN_MAX_UINT16];
+	// one per thread, as frames may be compressed on several threads at once
+	static XN_THREAD_STATIC XnUInt16 nEmbTable[XN_MAX_UINT16];
 	XnUInt16 nEmbTableIdx=0;
 
 	// Note: this function does not make sure it stay within the output memory boundaries!
@@ -320,15 +451,16 @@ XnStatus XnStreamCompressDepth16ZWithEmbTable(const XnUInt16* pInput, const XnUI
 		pInput++;
 	}
 
-	if (cOutStage != 0)
+	// the pending zeros come before the last value
+	if (cZeroCounter != 0)
 	{
-		*pOutput = cOutChar + 0x0D;
+		*pOutput = 0xE0 + cZeroCounter;
 		pOutput++;
 	}
 
-	if (cZeroCounter != 0)
+	if (cOutStage != 0)
 	{
-		*pOutput = 0xE0 + cZeroCounter;
+		*pOutput = cOutChar + 0x0D;
 		pOutput++;
 	}
 
@@ -457,6 +589,20 @@ XnStatus XnStreamUncompressDepth16Z(const XnUInt8* pInput, const XnUInt32 nInput
 		{
 			cZeroCounter = cInput - 0xE0;
 
+#ifdef XN_STREAM_COMPRESSION_SSE2
+			// a run is at most 15 pairs, so when there's room, it's written 8 values at a time (past its end too)
+			if (pOutputEnd - pOutput >= 32)
+			{
+				const __m128i values = _mm_set1_epi16((short)nLastFullValue);
+				_mm_storeu_si128((__m128i*)pOutput, values);
+				_mm_storeu_si128((__m128i*)(pOutput + 8), values);
+				_mm_storeu_si128((__m128i*)(pOutput + 16), values);
+				_mm_storeu_si128((__m128i*)(pOutput + 24), values);
+				pOutput += cZeroCounter * 2;
+				cZeroCounter = 0;
+			}
+#endif
+
 			while (cZeroCounter != 0)
 			{
 				XN_CHECK_OUTPUT_OVERFLOW(pOutput+1, pOutputEnd);
@@ -607,6 +753,20 @@ XnStatus XnStreamUncompressDepth16ZWithEmbTable(const XnUInt8* pInput, const XnU
 		{
 			cZeroCounter = cInput - 0xE0;
 
+#ifdef XN_STREAM_COMPRESSION_SSE2
+			// a run is at most 15 pairs, so when there's room, it's written 8 values at a time (past its end too)
+			if (pOutputEnd - pOutput >= 32)
+			{
+				const __m128i values = _mm_set1_epi16((short)pEmbTable[nLastFullValue]);
+				_mm_storeu_si128((__m128i*)pOutput, values);
+				_mm_storeu_si128((__m128i*)(pOutput + 8), values);
+				_mm_storeu_si128((__m128i*)(pOutput + 16), values);
+				_mm_storeu_si128((__m128i*)(pOutput + 24), values);
+				pOutput += cZeroCounter * 2;
+				cZeroCounter = 0;
+			}
+#endif
+
 			while (cZeroCounter != 0)
 			{
 				XN_CHECK_OUTPUT_OVERFLOW(pOutput+1, pOutputEnd);
@@ -629,6 +789,170 @@ XnStatus XnStreamUncompressDepth16ZWithEmbTable(const XnUInt8* pInput, const XnU
 	return (XN_STATUS_OK);
 }
 
+XnStatus XnStreamCompressDepth16ZRows(const XnUInt16* pInput, const XnUInt32 nInputSize, XnUInt8* pOutput, XnUInt32* pnOutputSize, XnUInt32 nBlockSize, XnUInt16* pEmbTable)
+{
+	// Local function variables
+	const XnUInt16* pInputEnd = pInput + (nInputSize / sizeof(XnUInt16));
+	const XnUInt8* pOrigOutput = pOutput;
+	XnUInt16 nMaxValue = 0;
+	XnUInt32 nValues = 0;
+
+	// Note: this function does not make sure it stay within the output memory boundaries!
+
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(pInput);
+	XN_VALIDATE_INPUT_PTR(pOutput);
+	XN_VALIDATE_INPUT_PTR(pnOutputSize);
+	XN_VALIDATE_INPUT_PTR(pEmbTable);
+
+	if (nBlockSize == 0)
+	{
+		return (XN_STATUS_BAD_PARAM);
+	}
+
+	// Create the embedded value translation table (only the values that appear in the frame)...
+	for (const XnUInt16* pCurr = pInput; pCurr != pInputEnd; ++pCurr)
+	{
+		nMaxValue = XN_MAX(nMaxValue, *pCurr);
+	}
+
+	xnOSMemSet(pEmbTable, 0, (nMaxValue + 1) * sizeof(XnUInt16));
+	for (const XnUInt16* pCurr = pInput; pCurr != pInputEnd; ++pCurr)
+	{
+		pEmbTable[*pCurr] = 1;
+	}
+
+	pOutput += sizeof(XnUInt32);
+	for (XnUInt32 i = 0; i <= nMaxValue; i++)
+	{
+		if (pEmbTable[i] == 1)
+		{
+			pEmbTable[i] = (XnUInt16)nValues;
+			nValues++;
+			*(XnUInt16*)pOutput = XN_PREPARE_VAR16_IN_BUFFER(XnUInt16(i));
+			pOutput+=2;
+		}
+	}
+	xnOSMemCopy((XnUInt8*)pOrigOutput, &nValues, sizeof(nValues));
+
+	// 16z can't tell full values of 0x8000 and above from differences, so that's as many indices as there can be
+	if (nValues > 0x8000)
+	{
+		return (XN_STATUS_BAD_PARAM);
+	}
+
+	// ...then each block of values, on its own
+	XnUInt32 nPixels = (XnUInt32)(pInputEnd - pInput);
+	XnUInt32 nBlocks = (nPixels + nBlockSize - 1) / nBlockSize;
+	xnOSMemCopy(pOutput, &nBlockSize, sizeof(nBlockSize));
+	pOutput += sizeof(XnUInt32);
+	xnOSMemCopy(pOutput, &nBlocks, sizeof(nBlocks));
+	pOutput += sizeof(XnUInt32);
+
+	XnUInt8* pBlockSizes = pOutput;
+	pOutput += nBlocks * sizeof(XnUInt32);
+
+	for (XnUInt32 nBlock = 0; nBlock < nBlocks; ++nBlock)
+	{
+		const XnUInt16* pBlock = pInput + nBlock * nBlockSize;
+		const XnUInt16* pBlockEnd = XN_MIN(pBlock + nBlockSize, pInputEnd);
+
+		XnUInt8* pBlockOutput = pOutput;
+		pOutput = XnStreamCompress16ZTranslated(pBlock, pBlockEnd, pEmbTable, pOutput);
+
+		XnUInt32 nBlockBytes = (XnUInt32)(pOutput - pBlockOutput);
+		xnOSMemCopy(pBlockSizes + nBlock * sizeof(XnUInt32), &nBlockBytes, sizeof(nBlockBytes));
+	}
+
+	*pnOutputSize = (XnUInt32)(pOutput - pOrigOutput);
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnStreamUncompressDepth16ZRows(const XnUInt8* pInput, const XnUInt32 nInputSize, XnUInt16* pOutput, XnUInt32* pnOutputSize)
+{
+	// Local function variables
+	const XnUInt8* pInputEnd = pInput + nInputSize;
+	XnUInt32 nOutputSize = *pnOutputSize / sizeof(XnUInt16);
+	XnUInt32 nValues = 0;
+	XnUInt32 nBlockSize = 0;
+	XnUInt32 nBlocks = 0;
+	XnUInt32 nPixels = 0;
+
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(pInput);
+	XN_VALIDATE_INPUT_PTR(pOutput);
+	XN_VALIDATE_INPUT_PTR(pnOutputSize);
+
+	if (nInputSize < sizeof(XnUInt32))
+	{
+		return (XN_STATUS_IO_COMPRESSED_BUFFER_TOO_SMALL);
+	}
+
+	xnOSMemCopy(&nValues, pInput, sizeof(nValues));
+	pInput += sizeof(XnUInt32);
+	if (XnUInt64(pInputEnd - pInput) < XnUInt64(nValues) * sizeof(XnUInt16) + 2 * sizeof(XnUInt32))
+	{
+		return (XN_STATUS_IO_COMPRESSED_BUFFER_TOO_SMALL);
+	}
+
+	const XnUInt16* pEmbTable = (const XnUInt16*)pInput;
+	pInput += nValues * sizeof(XnUInt16);
+
+	xnOSMemCopy(&nBlockSize, pInput, sizeof(nBlockSize));
+	pInput += sizeof(XnUInt32);
+	xnOSMemCopy(&nBlocks, pInput, sizeof(nBlocks));
+	pInput += sizeof(XnUInt32);
+	if (nBlockSize == 0 || XnUInt64(pInputEnd - pInput) < XnUInt64(nBlocks) * sizeof(XnUInt32))
+	{
+		return (XN_STATUS_IO_INVALID_COMPRESSED_BUFFER_SIZE);
+	}
+
+	const XnUInt8* pBlockSizes = pInput;
+	pInput += nBlocks * sizeof(XnUInt32);
+
+	// Blocks don't depend on each other - each starts with a full value, and decodes to nBlockSize values (but the
+	// last one).
+	for (XnUInt32 nBlock = 0; nBlock < nBlocks; ++nBlock)
+	{
+		XnUInt32 nBlockBytes = 0;
+		xnOSMemCopy(&nBlockBytes, pBlockSizes + nBlock * sizeof(XnUInt32), sizeof(nBlockBytes));
+		if (XnUInt64(pInputEnd - pInput) < nBlockBytes || nPixels >= nOutputSize)
+		{
+			return (XN_STATUS_IO_INVALID_COMPRESSED_BUFFER_SIZE);
+		}
+
+		XnUInt16* pBlockOutput = pOutput + nPixels;
+		XnUInt32 nBlockOutputSize = XN_MIN(nBlockSize, nOutputSize - nPixels) * sizeof(XnUInt16);
+		XnStatus nRetVal = XnStreamUncompressDepth16Z(pInput, nBlockBytes, pBlockOutput, &nBlockOutputSize);
+		XN_IS_STATUS_OK(nRetVal);
+
+		XnUInt32 nBlockPixels = nBlockOutputSize / sizeof(XnUInt16);
+		if (nBlockPixels != nBlockSize && nBlock != nBlocks - 1)
+		{
+			return (XN_STATUS_IO_INVALID_COMPRESSED_BUFFER_SIZE);
+		}
+
+		for (XnUInt32 i = 0; i < nBlockPixels; ++i)
+		{
+			if (pBlockOutput[i] >= nValues)
+			{
+				return (XN_STATUS_IO_INVALID_COMPRESSED_BUFFER_SIZE);
+			}
+			pBlockOutput[i] = XN_PREPARE_VAR16_IN_BUFFER(pEmbTable[pBlockOutput[i]]);
+		}
+
+		pInput += nBlockBytes;
+		nPixels += nBlockPixels;
+	}
+
+	*pnOutputSize = nPixels * sizeof(XnUInt16);
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XnStatus XnStreamCompressImage8Z(const XnUInt8* pInput, const XnUInt32 nInputSize, XnUInt8* pOutput, XnUInt32* pnOutputSize)
 {
 	// Local function variables
@@ -748,15 +1072,16 @@ XnStatus XnStreamCompressImage8Z(const XnUInt8* pInput, const XnUInt32 nInputSiz
 		pInput++;
 	}
 
-	if (cOutStage != 0)
+	// the pending zeros come before the last value
+	if (cZeroCounter != 0)
 	{
-		*pOutput = cOutChar + 0x0D;
+		*pOutput = 0xE0 + cZeroCounter;
 		pOutput++;
 	}
 
-	if (cZeroCounter != 0)
+	if (cOutStage != 0)
 	{
-		*pOutput = 0xE0 + cZeroCounter;
+		*pOutput = cOutChar + 0x0D;
 		pOutput++;
 	}
 
@@ -45,6 +45,8 @@ typedef enum
 	XN_COMPRESSION_JPEG = 4,
 	/** Data is packed in 10-bit values. */
 	XN_COMPRESSION_10BIT_PACKED = 5,
+	/** Data is compressed using PS lossless 16-bit depth compression with embedded tables, in independent blocks of rows. */
+	XN_COMPRESSION_16Z_ROWS = 6,
 } XnCompressionFormats;
 
 #endif //__XN_STREAM_FORMATS_H__
\ No newline at end of file
@@ -39,8 +39,11 @@ XnDepthProcessor::XnDepthProcessor(XnSensorDepthStream* pStream, XnSensorStreamH
 	m_applyRegistrationOnEnd(FALSE),
 	m_nExpectedFrameSize(0),
 	m_bShiftToDepthAllocated(FALSE),
-	m_pShiftToDepthTable(pStream->GetShiftToDepthTable())
+	m_pShiftToDepthTable(pStream->GetShiftToDepthTable()),
+	m_bPlacesPixels(FALSE),
+	m_bPlacedMirror(FALSE)
 {
+	xnOSMemSet(&m_placedCropping, 0, sizeof(m_placedCropping));
 }
 
 XnDepthProcessor::~XnDepthProcessor()
@@ -98,6 +101,8 @@ void XnDepthProcessor::OnStartOfFrame(const XnSensorProtocolResponseHeader* pHea
 		GetStream()->m_DepthRegistration.GetValue() == TRUE && 
 		GetStream()->m_FirmwareRegistration.GetValue() == FALSE);
 
+	SetWritePlacement();
+
 	if (m_pDevicePrivateData->FWInfo.nFWVer >= XN_SENSOR_FW_VER_5_1 && pHeader->nTimeStamp != 0)
 	{
 		// PATCH: starting with v5.1, the timestamp field of the SOF packet, is the number of pixels
@@ -124,6 +129,40 @@ XnUInt32 XnDepthProcessor::CalculateExpectedSize()
 	return nExpectedDepthBufferSize;
 }
 
+void XnDepthProcessor::SetWritePlacement()
+{
+	XnSensorDepthStream* pStream = GetStream();
+
+	xnOSEnterCriticalSection(pStream->GetLock());
+	XnBool bMirror = pStream->IsMirrored();
+	m_placedCropping = *pStream->GetCropping();
+	xnOSLeaveCriticalSection(pStream->GetLock());
+
+	XnUInt32 nLineWidth = pStream->GetXRes();
+	XnUInt32 nLines = pStream->GetYRes();
+	if (pStream->m_FirmwareCropMode.GetValue() != XN_FIRMWARE_CROPPING_MODE_DISABLED)
+	{
+		// firmware already cropped it
+		nLineWidth = (XnUInt32)pStream->m_FirmwareCropSizeX.GetValue();
+		nLines = (XnUInt32)pStream->m_FirmwareCropSizeY.GetValue();
+		m_placedCropping.enabled = FALSE;
+	}
+
+	// mirror is our job only if firmware doesn't do it
+	m_bPlacedMirror = (bMirror && pStream->m_FirmwareMirror.GetValue() == FALSE);
+
+	// registration needs the whole frame, so in that case, the stream mirrors and crops it once it's done
+	if (!m_bPlacesPixels || m_applyRegistrationOnEnd || nLineWidth == 0 || (!m_bPlacedMirror && !m_placedCropping.enabled))
+	{
+		m_bPlacedMirror = FALSE;
+		m_placedCropping.enabled = FALSE;
+		GetBufferManager()->ClearWritePlacement();
+		return;
+	}
+
+	GetBufferManager()->SetWritePlacement(sizeof(OniDepthPixel), nLineWidth, nLines, &m_placedCropping, m_bPlacedMirror);
+}
+
 void XnDepthProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeader)
 {
 	// pad pixels
@@ -162,6 +201,14 @@ void XnDepthProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeade
 		pFrame->cropOriginY = (int)GetStream()->m_FirmwareCropOffsetY.GetValue();
 		pFrame->croppingEnabled = TRUE;
 	}
+	else if (m_placedCropping.enabled)
+	{
+		pFrame->width = m_placedCropping.width;
+		pFrame->height = m_placedCropping.height;
+		pFrame->cropOriginX = m_placedCropping.originX;
+		pFrame->cropOriginY = m_placedCropping.originY;
+		pFrame->croppingEnabled = TRUE;
+	}
 	else
 	{
 		pFrame->width = pFrame->videoMode.resolutionX;
@@ -173,6 +220,9 @@ void XnDepthProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader* pHeade
 
 	pFrame->stride = pFrame->width * GetStream()->GetBytesPerPixel();
 
+	// let the stream know it shouldn't mirror this one again
+	GetStream()->m_bMirroredOnWrite = m_bPlacedMirror;
+
 	// call base
 	XnFrameStreamProcessor::OnEndOfFrame(pHeader);
 }
@@ -187,6 +237,27 @@ void XnDepthProcessor::PadPixels(XnUInt32 nPixels)
 		return;
 	}
 
+	XnFrameBufferManager* pBufferManager = GetBufferManager();
+	if (pBufferManager->IsWritePlaced())
+	{
+		while (nPixels > 0)
+		{
+			XnUInt32 nRunPixels;
+			XnInt32 nStep;
+			OniDepthPixel* pDepth = (OniDepthPixel*)pBufferManager->GetPlacedWritePointer(nPixels, &nRunPixels, &nStep);
+			if (pDepth != NULL)
+			{
+				for (XnUInt32 i = 0; i < nRunPixels; ++i, pDepth += nStep)
+				{
+					*pDepth = m_noDepthValue;
+				}
+			}
+			pWriteBuffer->UnsafeUpdateSize(nRunPixels * sizeof(OniDepthPixel));
+			nPixels -= nRunPixels;
+		}
+		return;
+	}
+
 	OniDepthPixel* pDepth = (OniDepthPixel*)GetWriteBuffer()->GetUnsafeWritePointer();
 
 	// place the no-depth value
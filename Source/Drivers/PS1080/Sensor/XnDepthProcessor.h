@@ -72,14 +72,30 @@ protected:
 		return m_pShiftToDepthTable[nShift];
 	}
 
+	// Returns the LUT used by GetOutput(), or NULL if output is shift values (and the LUT is the identity).
+	inline const OniDepthPixel* GetOutputTable()
+	{
+		return m_bShiftToDepthAllocated ? NULL : m_pShiftToDepthTable;
+	}
+
 	inline XnUInt32 GetExpectedSize()
 	{
 		return m_nExpectedFrameSize;
 	}
 
+	/*
+	* Processors that write their pixels through the buffer manager placement (see XnFrameBufferManager::GetPlacedWritePointer())
+	* can have frames mirrored and cropped while they are written, instead of by the stream once they're done.
+	*/
+	inline void SetPlacesPixels(XnBool bPlacesPixels)
+	{
+		m_bPlacesPixels = bPlacesPixels;
+	}
+
 private:
 	void PadPixels(XnUInt32 nPixels);
 	XnUInt32 CalculateExpectedSize();
+	void SetWritePlacement();
 
 	XnUInt32 m_nPaddingPixelsOnEnd;
 	XnBool m_applyRegistrationOnEnd;
@@ -87,6 +103,9 @@ private:
 	XnBool m_bShiftToDepthAllocated;
 	OniDepthPixel* m_pShiftToDepthTable;
 	OniDepthPixel m_noDepthValue;
+	XnBool m_bPlacesPixels;
+	OniCropping m_placedCropping;
+	XnBool m_bPlacedMirror;
 };
 
 #endif //__XN_DEPTH_PROCESSOR_H__
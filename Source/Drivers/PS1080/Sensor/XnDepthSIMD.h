@@ -0,0 +1,78 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __XN_DEPTH_SIMD_H__
+#define __XN_DEPTH_SIMD_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnOS.h>
+#include <OniCTypes.h>
+
+// SSSE3 and AVX2 code is compiled regardless of compiler flags, and only used if the CPU supports it
+#if (XN_PLATFORM == XN_PLATFORM_WIN32) || defined(__SSE2__)
+	#if defined(_MSC_VER) && (_MSC_VER >= 1700)
+		#define XN_DEPTH_SIMD
+		#define XN_DEPTH_SSSE3_FUNCTION
+		#define XN_DEPTH_AVX2_FUNCTION
+	#elif defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+		#define XN_DEPTH_SIMD
+		#define XN_DEPTH_SSSE3_FUNCTION __attribute__((target("ssse3")))
+		#define XN_DEPTH_AVX2_FUNCTION __attribute__((target("avx2")))
+	#endif
+#endif
+
+#ifdef XN_DEPTH_SIMD
+
+#include <immintrin.h>
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+
+/* Looks up 16 shift values (each < 2048) in a 2048-entry shift-to-depth table.
+*  The table is gathered as 32-bit pairs (index / 2), and the right half of each pair is 
+*  then selected, so no lane ever reads past the end of the table.
+*/
+static inline XN_DEPTH_AVX2_FUNCTION __m256i xnDepthLookupAVX2(__m256i shifts, const OniDepthPixel* pTable)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i one = _mm256_set1_epi32(1);
+	const __m256i lowWord = _mm256_set1_epi32(0xFFFF);
+
+	// 4 and 4 shifts of each 128-bit lane, widened to 32 bits
+	__m256i lo = _mm256_unpacklo_epi16(shifts, zero);
+	__m256i hi = _mm256_unpackhi_epi16(shifts, zero);
+
+	__m256i pairLo = _mm256_i32gather_epi32((const int*)pTable, _mm256_srli_epi32(lo, 1), 4);
+	__m256i pairHi = _mm256_i32gather_epi32((const int*)pTable, _mm256_srli_epi32(hi, 1), 4);
+
+	// odd entries are in the high word of the pair (x86 is little endian)
+	pairLo = _mm256_and_si256(_mm256_srlv_epi32(pairLo, _mm256_slli_epi32(_mm256_and_si256(lo, one), 4)), lowWord);
+	pairHi = _mm256_and_si256(_mm256_srlv_epi32(pairHi, _mm256_slli_epi32(_mm256_and_si256(hi, one), 4)), lowWord);
+
+	// packing is per 128-bit lane as well, so this restores the original order
+	return _mm256_packus_epi32(pairLo, pairHi);
+}
+
+#endif // XN_DEPTH_SIMD
+
+#endif //__XN_DEPTH_SIMD_H__
@@ -154,6 +154,26 @@ void XN_CALLBACK_TYPE XnDeviceEnumeration::OnConnectivityEventCallback(XnUSBEven
 	OnConnectivityEvent(pArgs->strDevicePath, pArgs->eventType, usbId);
 }
 
+XnStatus XnDeviceEnumeration::AddCaptureFile(const XnChar* uri)
+{
+	XnUsbId usbId;
+	if (!xnUSBIsCaptureFile(uri, &usbId.vendorID, &usbId.productID))
+	{
+		return (XN_STATUS_DEVICE_NOT_CONNECTED);
+	}
+
+	for (XnUInt32 i = 0; i < ms_supportedProductsCount; ++i)
+	{
+		if (ms_supportedProducts[i].vendorID == usbId.vendorID && ms_supportedProducts[i].productID == usbId.productID)
+		{
+			OnConnectivityEvent(uri, XN_USB_EVENT_DEVICE_CONNECT, usbId);
+			return (XN_STATUS_OK);
+		}
+	}
+
+	return (XN_STATUS_DEVICE_NOT_CONNECTED);
+}
+
 XnStatus XnDeviceEnumeration::IsSensorLowBandwidth(const XnChar* uri, XnBool* pbIsLowBandwidth)
 {
 	*pbIsLowBandwidth = FALSE;
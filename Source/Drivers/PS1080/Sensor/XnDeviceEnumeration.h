@@ -43,6 +43,9 @@ public:
 	static XnStatus EnumerateSensors(OniDeviceInfo* aDevices, XnUInt32* pnCount);
 	static XnStatus IsSensorLowBandwidth(const XnChar* connectionString, XnBool* pbIsLowband);
 
+	// Adds a USB capture file of a supported device as a device, that is replayed when opened.
+	static XnStatus AddCaptureFile(const XnChar* uri);
+
 private:
 	typedef struct XnUsbId
 	{
@@ -40,7 +40,7 @@ XnSensorIO::~XnSensorIO()
 {
 }
 
-XnStatus XnSensorIO::OpenDevice(const XnChar* strPath)
+XnStatus XnSensorIO::OpenDevice(const XnChar* strPath, const XnChar* strCaptureFile, XnDouble dReplaySpeed)
 {
 	XnStatus nRetVal;
 
@@ -51,6 +51,22 @@ XnStatus XnSensorIO::OpenDevice(const XnChar* strPath)
 	nRetVal = xnUSBOpenDeviceByPath(strPath, &m_pSensorHandle->USBDevice);
 	XN_IS_STATUS_OK(nRetVal);
 
+	if (xnUSBIsReplayDevice(m_pSensorHandle->USBDevice))
+	{
+		xnLogInfo(XN_MASK_DEVICE_IO, "Replaying USB capture '%s'", strPath);
+
+		nRetVal = xnUSBSetReplaySpeed(m_pSensorHandle->USBDevice, dReplaySpeed);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+	else if (strCaptureFile[0] != '\0')
+	{
+		// capture starts before anything is sent to the device, so that the capture replays from the same point
+		const OniDeviceInfo* pInfo = XnDeviceEnumeration::GetDeviceInfo(strPath);
+		nRetVal = xnUSBStartCapture(m_pSensorHandle->USBDevice, strCaptureFile, 
+			pInfo == NULL ? 0 : pInfo->usbVendorId, pInfo == NULL ? 0 : pInfo->usbProductId);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
 	// on older firmwares, control was sent over BULK endpoints. Check if this is the case
 	xnLogVerbose(XN_MASK_DEVICE_IO, "Trying to open endpoint 0x4 for control out (for old firmwares)...");
 	nRetVal = xnUSBOpenEndPoint(m_pSensorHandle->USBDevice, 0x4, XN_USB_EP_BULK, XN_USB_DIRECTION_OUT, &m_pSensorHandle->ControlConnection.ControlOutConnectionEp);
@@ -80,6 +96,16 @@ XnStatus XnSensorIO::OpenDevice(const XnChar* strPath)
 	return XN_STATUS_OK;
 }
 
+XnStatus XnSensorIO::SetReplaySpeed(XnDouble dSpeed)
+{
+	if (m_pSensorHandle->USBDevice == NULL || !xnUSBIsReplayDevice(m_pSensorHandle->USBDevice))
+	{
+		return (XN_STATUS_OK);
+	}
+
+	return xnUSBSetReplaySpeed(m_pSensorHandle->USBDevice, dSpeed);
+}
+
 XnStatus XnSensorIO::OpenDataEndPoints(XnSensorUsbInterface nInterface, const XnFirmwareInfo& fwInfo)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -75,7 +75,11 @@ public:
 	XnSensorIO(XN_SENSOR_HANDLE* pSensorHandle);
 	~XnSensorIO();
 
-	XnStatus OpenDevice(const XnChar* strPath);
+	/// Starts capturing the USB traffic of the device to strCaptureFile, if it isn't empty (and the device isn't
+	/// replayed from a capture to begin with).
+	XnStatus OpenDevice(const XnChar* strPath, const XnChar* strCaptureFile, XnDouble dReplaySpeed);
+	/// Has no effect on devices that aren't replayed.
+	XnStatus SetReplaySpeed(XnDouble dSpeed);
 
 	XnStatus OpenDataEndPoints(XnSensorUsbInterface nInterface, const XnFirmwareInfo& fwInfo);
 
@@ -28,6 +28,7 @@
 #include "XnHostProtocol.h"
 #include <XnLog.h>
 #include "XnSensor.h"
+#include "XnUsbReadPipeline.h"
 
 #define XN_HOST_PROTOCOL_MUTEX_NAME_PREFIX	"HostProtocolMutex"
 
@@ -60,8 +61,87 @@ XnStatus XnDeviceSensorInit(XnDevicePrivateData* pDevicePrivateData)
 	return (XN_STATUS_OK);
 }
 
+static void XnDeviceSensorConfigureReadThread(XnSpecificUsbDevice* pSpecificUsb, XnUInt32 nBytesPerSecond)
+{
+	XnUInt32 nMaxPacketSize = pSpecificUsb->pUsbConnection->nMaxPacketSize;
+	XnBool bBulk = (pSpecificUsb->pDevicePrivateData->pSensor->GetCurrentUsbInterface() == XN_SENSOR_USB_INTERFACE_BULK_ENDPOINTS);
+
+	pSpecificUsb->nBytesPerSecond = nBytesPerSecond;
+	pSpecificUsb->nChunkReadBytes = pSpecificUsb->nDefaultChunkReadBytes;
+	pSpecificUsb->nNumberOfBuffers = pSpecificUsb->nDefaultNumberOfBuffers;
+
+	if (bBulk)
+	{
+		if (nBytesPerSecond != 0 && nMaxPacketSize != 0)
+		{
+			// bulk transfers complete when full (or on a short packet), so their size sets how long data waits in them
+			XnUInt64 nTransferBytes = (XnUInt64)nBytesPerSecond * XN_SENSOR_USB_TRANSFER_DURATION / 1000000;
+			XnUInt32 nPackets = (XnUInt32)((nTransferBytes + nMaxPacketSize - 1) / nMaxPacketSize);
+			nPackets = XN_MIN(nPackets, pSpecificUsb->nDefaultChunkReadBytes / nMaxPacketSize);
+			nPackets = XN_MAX(nPackets, XN_SENSOR_USB_MIN_PACKETS_PER_TRANSFER);
+			pSpecificUsb->nChunkReadBytes = nPackets * nMaxPacketSize;
+		}
+
+		pSpecificUsb->nTransferDuration = (nBytesPerSecond == 0) ? 0 : (XnUInt32)((XnUInt64)pSpecificUsb->nChunkReadBytes * 1000000 / nBytesPerSecond);
+	}
+	else
+	{
+		// isochronous transfers take the same time to complete no matter how much data the stream has
+		pSpecificUsb->nTransferDuration = (nMaxPacketSize == 0) ? 0 : pSpecificUsb->nChunkReadBytes / nMaxPacketSize * XN_SENSOR_USB_ISO_PACKET_DURATION;
+	}
+
+	if (nBytesPerSecond != 0 && pSpecificUsb->nTransferDuration != 0)
+	{
+		XnUInt32 nBuffers = (XN_SENSOR_USB_IN_FLIGHT_DURATION + pSpecificUsb->nTransferDuration - 1) / pSpecificUsb->nTransferDuration;
+		if (!bBulk)
+		{
+			// the defaults were picked for the bandwidth isochronous end points reserve, keep at least those
+			nBuffers = XN_MAX(nBuffers, pSpecificUsb->nDefaultNumberOfBuffers);
+		}
+		pSpecificUsb->nNumberOfBuffers = XN_MIN(XN_MAX(nBuffers, XN_SENSOR_USB_MIN_BUFFERS), XN_SENSOR_USB_MAX_BUFFERS);
+	}
+
+	// whatever the auto-tune found to be needed still is
+	pSpecificUsb->nNumberOfBuffers = XN_MAX(pSpecificUsb->nNumberOfBuffers, pSpecificUsb->nTunedNumberOfBuffers);
+
+	if (pSpecificUsb->nTransferDuration != 0)
+	{
+		pSpecificUsb->nInFlightDuration = pSpecificUsb->nTransferDuration * pSpecificUsb->nNumberOfBuffers;
+	}
+	else
+	{
+		// nothing to go by, so don't consider any completion late
+		pSpecificUsb->nInFlightDuration = XN_MAX_UINT32;
+	}
+}
+
+static XnStatus XnDeviceSensorInitReadThreadConfig(XnSpecificUsbDevice* pSpecificUsb)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	pSpecificUsb->CurrState.bSynced = FALSE;
+	pSpecificUsb->nDefaultChunkReadBytes = pSpecificUsb->nChunkReadBytes;
+	pSpecificUsb->nDefaultNumberOfBuffers = pSpecificUsb->nNumberOfBuffers;
+	pSpecificUsb->bReading = FALSE;
+	pSpecificUsb->nBytesPerSecond = 0;
+	pSpecificUsb->nLateCompletions = 0;
+	pSpecificUsb->nLostSyncs = 0;
+	pSpecificUsb->nTunedLateCompletions = 0;
+	pSpecificUsb->nTunedLostSyncs = 0;
+	pSpecificUsb->nTunedNumberOfBuffers = 0;
+	pSpecificUsb->bTuneSettling = FALSE;
+
+	XnDeviceSensorConfigureReadThread(pSpecificUsb, 0);
+
+	nRetVal = xnOSCreateCriticalSection(&pSpecificUsb->hReadThreadLock);
+	XN_IS_STATUS_OK(nRetVal);
+
+	return (XN_STATUS_OK);
+}
+
 XnStatus XnDeviceSensorOpenInputThreads(XnDevicePrivateData* pDevicePrivateData)
 {
+	XnStatus nRetVal = XN_STATUS_OK;
 	XnSensorUsbInterface usbInterface = pDevicePrivateData->pSensor->GetCurrentUsbInterface();
 
 	// common stuff
@@ -70,18 +150,21 @@ XnStatus XnDeviceSensorOpenInputThreads(XnDevicePrivateData* pDevicePrivateData)
 	pDevicePrivateData->pSpecificDepthUsb->pUsbConnection = &pDevicePrivateData->SensorHandle.DepthConnection;
 	pDevicePrivateData->pSpecificDepthUsb->CurrState.State = XN_WAITING_FOR_CONFIGURATION;
 	pDevicePrivateData->pSpecificDepthUsb->nIgnoreBytes = (pDevicePrivateData->FWInfo.nFWVer >= XN_SENSOR_FW_VER_5_0) ? 0 : pDevicePrivateData->pSpecificDepthUsb->nChunkReadBytes;
+	pDevicePrivateData->pSpecificDepthUsb->pReadPipeline = NULL;
 
 	pDevicePrivateData->pSpecificImageUsb = (XnSpecificUsbDevice*)xnOSMallocAligned(sizeof(XnSpecificUsbDevice), XN_DEFAULT_MEM_ALIGN);
 	pDevicePrivateData->pSpecificImageUsb->pDevicePrivateData = pDevicePrivateData;
 	pDevicePrivateData->pSpecificImageUsb->pUsbConnection = &pDevicePrivateData->SensorHandle.ImageConnection;
 	pDevicePrivateData->pSpecificImageUsb->CurrState.State = XN_WAITING_FOR_CONFIGURATION;
 	pDevicePrivateData->pSpecificImageUsb->nIgnoreBytes = (pDevicePrivateData->FWInfo.nFWVer >= XN_SENSOR_FW_VER_5_0) ? 0 : pDevicePrivateData->pSpecificImageUsb->nChunkReadBytes;
+	pDevicePrivateData->pSpecificImageUsb->pReadPipeline = NULL;
 
 	pDevicePrivateData->pSpecificMiscUsb = (XnSpecificUsbDevice*)xnOSMallocAligned(sizeof(XnSpecificUsbDevice), XN_DEFAULT_MEM_ALIGN);
 	pDevicePrivateData->pSpecificMiscUsb->pDevicePrivateData = pDevicePrivateData;
 	pDevicePrivateData->pSpecificMiscUsb->pUsbConnection = &pDevicePrivateData->SensorHandle.MiscConnection;
 	pDevicePrivateData->pSpecificMiscUsb->CurrState.State = XN_WAITING_FOR_CONFIGURATION;
 	pDevicePrivateData->pSpecificMiscUsb->nIgnoreBytes = (pDevicePrivateData->FWInfo.nFWVer >= XN_SENSOR_FW_VER_5_0) ? 0 : pDevicePrivateData->pSpecificMiscUsb->nChunkReadBytes;
+	pDevicePrivateData->pSpecificMiscUsb->pReadPipeline = NULL;
 
 	// timeout
 	if (usbInterface == XN_SENSOR_USB_INTERFACE_ISO_ENDPOINTS || usbInterface == XN_SENSOR_USB_INTERFACE_ISO_ENDPOINTS_LOW_DEPTH)
@@ -129,6 +212,13 @@ XnStatus XnDeviceSensorOpenInputThreads(XnDevicePrivateData* pDevicePrivateData)
 		pDevicePrivateData->pSpecificDepthUsb->nNumberOfBuffers = XN_SENSOR_USB_DEPTH_BUFFERS;
 	}
 
+	nRetVal = XnDeviceSensorInitReadThreadConfig(pDevicePrivateData->pSpecificDepthUsb);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = XnDeviceSensorInitReadThreadConfig(pDevicePrivateData->pSpecificImageUsb);
+	XN_IS_STATUS_OK(nRetVal);
+	nRetVal = XnDeviceSensorInitReadThreadConfig(pDevicePrivateData->pSpecificMiscUsb);
+	XN_IS_STATUS_OK(nRetVal);
+
 	// Switch depth & image EPs for older FWs
 	if (pDevicePrivateData->FWInfo.nFWVer <= XN_SENSOR_FW_VER_5_1)
 	{
@@ -137,9 +227,131 @@ XnStatus XnDeviceSensorOpenInputThreads(XnDevicePrivateData* pDevicePrivateData)
 		pDevicePrivateData->pSpecificImageUsb = pTempUsbDevice;
 	}
 
+	if (pDevicePrivateData->pSensor->IsUsbReadPipelined())
+	{
+		nRetVal = XnDeviceSensorCreateReadPipeline(pDevicePrivateData->pSpecificDepthUsb);
+		XN_IS_STATUS_OK(nRetVal);
+
+		nRetVal = XnDeviceSensorCreateReadPipeline(pDevicePrivateData->pSpecificImageUsb);
+		XN_IS_STATUS_OK(nRetVal);
+
+		if (pDevicePrivateData->pSensor->IsMiscSupported())
+		{
+			nRetVal = XnDeviceSensorCreateReadPipeline(pDevicePrivateData->pSpecificMiscUsb);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+	}
+
 	return XN_STATUS_OK;
 }
 
+XnStatus XnDeviceSensorCreateReadPipeline(XnSpecificUsbDevice* pSpecificUsb)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_VALIDATE_NEW(pSpecificUsb->pReadPipeline, XnUsbReadPipeline);
+
+	nRetVal = pSpecificUsb->pReadPipeline->Init(pSpecificUsb->nNumberOfBuffers * XN_SENSOR_USB_READ_PIPELINE_BUFFERS_FACTOR, pSpecificUsb->nChunkReadBytes, XnDeviceSensorProtocolProcessUsbData, pSpecificUsb);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		XN_DELETE(pSpecificUsb->pReadPipeline);
+		pSpecificUsb->pReadPipeline = NULL;
+		return (nRetVal);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus XnDeviceSensorStartReadThread(XnSpecificUsbDevice* pSpecificUsb, XnUInt32 nBytesPerSecond)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	xnOSEnterCriticalSection(&pSpecificUsb->hReadThreadLock);
+
+	XnDeviceSensorConfigureReadThread(pSpecificUsb, nBytesPerSecond);
+
+	// the pipeline was sized for the transfers the end point started with. The read thread is stopped, so if the
+	// bandwidth or the auto-tune asks for more, it can be re-created (dropping whatever it still holds).
+	if (pSpecificUsb->pReadPipeline != NULL &&
+		pSpecificUsb->pReadPipeline->GetCapacity() < pSpecificUsb->nNumberOfBuffers * XN_SENSOR_USB_READ_PIPELINE_BUFFERS_FACTOR)
+	{
+		nRetVal = pSpecificUsb->pReadPipeline->Resize(pSpecificUsb->nNumberOfBuffers * XN_SENSOR_USB_READ_PIPELINE_BUFFERS_FACTOR);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnOSLeaveCriticalSection(&pSpecificUsb->hReadThreadLock);
+			return (nRetVal);
+		}
+	}
+
+	xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Reading %u bytes/sec with %u transfers of %u bytes (%u us each)", nBytesPerSecond, pSpecificUsb->nNumberOfBuffers, pSpecificUsb->nChunkReadBytes, pSpecificUsb->nTransferDuration);
+
+	nRetVal = xnUSBInitReadThread(pSpecificUsb->pUsbConnection->UsbEp, pSpecificUsb->nChunkReadBytes, pSpecificUsb->nNumberOfBuffers, pSpecificUsb->nTimeout, XnDeviceSensorProtocolUsbEpCb, pSpecificUsb);
+	if (nRetVal == XN_STATUS_OK)
+	{
+		pSpecificUsb->bReading = TRUE;
+		pSpecificUsb->bTuneSettling = TRUE;
+	}
+
+	xnOSLeaveCriticalSection(&pSpecificUsb->hReadThreadLock);
+
+	return (nRetVal);
+}
+
+void XnDeviceSensorStopReadThread(XnSpecificUsbDevice* pSpecificUsb)
+{
+	xnOSEnterCriticalSection(&pSpecificUsb->hReadThreadLock);
+	xnUSBShutdownReadThread(pSpecificUsb->pUsbConnection->UsbEp);
+	pSpecificUsb->bReading = FALSE;
+	xnOSLeaveCriticalSection(&pSpecificUsb->hReadThreadLock);
+}
+
+static void XnDeviceSensorTuneReadThread(XnSpecificUsbDevice* pSpecificUsb, const XnChar* strName)
+{
+	xnOSEnterCriticalSection(&pSpecificUsb->hReadThreadLock);
+
+	XnUInt32 nLateCompletions = pSpecificUsb->nLateCompletions;
+	XnUInt32 nLostSyncs = pSpecificUsb->nLostSyncs;
+
+	if (pSpecificUsb->bTuneSettling)
+	{
+		// a read thread that just started may well have cut a packet short. Only count from here on.
+		pSpecificUsb->nTunedLateCompletions = nLateCompletions;
+		pSpecificUsb->nTunedLostSyncs = nLostSyncs;
+		pSpecificUsb->bTuneSettling = FALSE;
+	}
+	else if (pSpecificUsb->bReading &&
+		(nLateCompletions != pSpecificUsb->nTunedLateCompletions || nLostSyncs != pSpecificUsb->nTunedLostSyncs) &&
+		pSpecificUsb->nNumberOfBuffers < XN_SENSOR_USB_MAX_BUFFERS)
+	{
+		XnUInt32 nBuffers = XN_MIN(pSpecificUsb->nNumberOfBuffers * 2, XN_SENSOR_USB_MAX_BUFFERS);
+
+		xnLogInfo(XN_MASK_DEVICE_SENSOR, "%s end point: %u late completions and %u lost syncs. Growing from %u to %u transfers in flight.", 
+			strName, nLateCompletions - pSpecificUsb->nTunedLateCompletions, nLostSyncs - pSpecificUsb->nTunedLostSyncs, pSpecificUsb->nNumberOfBuffers, nBuffers);
+
+		pSpecificUsb->nTunedNumberOfBuffers = nBuffers;
+
+		// restart it without letting the streams in between (the lock is recursive)
+		XnDeviceSensorStopReadThread(pSpecificUsb);
+		XnStatus nRetVal = XnDeviceSensorStartReadThread(pSpecificUsb, pSpecificUsb->nBytesPerSecond);
+		if (nRetVal != XN_STATUS_OK)
+		{
+			xnLogError(XN_MASK_DEVICE_SENSOR, "Failed to restart the %s read thread: %s", strName, xnGetStatusString(nRetVal));
+		}
+	}
+
+	xnOSLeaveCriticalSection(&pSpecificUsb->hReadThreadLock);
+}
+
+void XnDeviceSensorTuneReadThreads(XnDevicePrivateData* pDevicePrivateData)
+{
+	XnDeviceSensorTuneReadThread(pDevicePrivateData->pSpecificDepthUsb, "Depth");
+	XnDeviceSensorTuneReadThread(pDevicePrivateData->pSpecificImageUsb, "Image");
+	if (pDevicePrivateData->pSensor->IsMiscSupported())
+	{
+		XnDeviceSensorTuneReadThread(pDevicePrivateData->pSpecificMiscUsb, "Misc");
+	}
+}
+
 XnStatus XnDeviceSensorAllocateBuffers(XnDevicePrivateData* pDevicePrivateData)
 {
 	pDevicePrivateData->SensorHandle.DepthConnection.pUSBBuffer = (XnUInt8*)xnOSCallocAligned(XN_SENSOR_PROTOCOL_USB_BUFFER_SIZE, sizeof(XnUInt8), XN_DEFAULT_MEM_ALIGN);
@@ -181,18 +393,25 @@ XnStatus XnDeviceSensorFreeBuffers(XnDevicePrivateData* pDevicePrivateData)
 		XN_ALIGNED_FREE_AND_NULL(pDevicePrivateData->SensorHandle.MiscConnection.pUSBBuffer);
 	}
 
+	// the read threads are already shut down, so nothing pushes into the read pipelines anymore
 	if (pDevicePrivateData->pSpecificDepthUsb != NULL)
 	{
+		XN_DELETE(pDevicePrivateData->pSpecificDepthUsb->pReadPipeline);
+		xnOSCloseCriticalSection(&pDevicePrivateData->pSpecificDepthUsb->hReadThreadLock);
 		XN_ALIGNED_FREE_AND_NULL(pDevicePrivateData->pSpecificDepthUsb);
 	}
 
 	if (pDevicePrivateData->pSpecificImageUsb != NULL)
 	{
+		XN_DELETE(pDevicePrivateData->pSpecificImageUsb->pReadPipeline);
+		xnOSCloseCriticalSection(&pDevicePrivateData->pSpecificImageUsb->hReadThreadLock);
 		XN_ALIGNED_FREE_AND_NULL(pDevicePrivateData->pSpecificImageUsb);
 	}
 
 	if (pDevicePrivateData->pSpecificMiscUsb != NULL)
 	{
+		XN_DELETE(pDevicePrivateData->pSpecificMiscUsb->pReadPipeline);
+		xnOSCloseCriticalSection(&pDevicePrivateData->pSpecificMiscUsb->hReadThreadLock);
 		XN_ALIGNED_FREE_AND_NULL(pDevicePrivateData->pSpecificMiscUsb);
 	}
 
@@ -75,6 +75,22 @@
 	#define XN_SENSOR_USB_MISC_BUFFERS									5
 #endif
 
+// The read pipeline of an end point holds this many times the number of buffers its read thread has in flight
+#define XN_SENSOR_USB_READ_PIPELINE_BUFFERS_FACTOR	4
+
+// Read threads are sized from the bandwidth of the stream they read: bulk transfers hold about this much of it (but no
+// less than a few packets, and no more than the platform default), and there are enough of them in flight to cover
+// this much of it.
+#define XN_SENSOR_USB_TRANSFER_DURATION				2000 // us
+#define XN_SENSOR_USB_IN_FLIGHT_DURATION			40000 // us
+#define XN_SENSOR_USB_MIN_PACKETS_PER_TRANSFER		8
+#define XN_SENSOR_USB_MIN_BUFFERS					4
+#define XN_SENSOR_USB_MAX_BUFFERS					64
+#define XN_SENSOR_USB_ISO_PACKET_DURATION			125 // us, one micro-frame
+
+// How often the auto-tune checks the read threads, in ms
+#define XN_SENSOR_USB_AUTO_TUNE_INTERVAL			1000
+
 #define XN_SENSOR_READ_THREAD_TIMEOUT_ISO	100
 #define XN_SENSOR_READ_THREAD_TIMEOUT_BULK	1000
 
@@ -89,6 +105,16 @@ XnStatus XnDeviceSensorFreeBuffers(XnDevicePrivateData* pDevicePrivateData);
 XnStatus XnDeviceSensorConfigureVersion(XnDevicePrivateData* pDevicePrivateData);
 
 XnStatus XnDeviceSensorOpenInputThreads(XnDevicePrivateData* pDevicePrivateData);
+XnStatus XnDeviceSensorCreateReadPipeline(XnSpecificUsbDevice* pSpecificUsb);
+
+/**
+* Starts the read thread of an end point, with transfers sized for a stream of nBytesPerSecond (0 if unknown, which
+* keeps the platform defaults).
+*/
+XnStatus XnDeviceSensorStartReadThread(XnSpecificUsbDevice* pSpecificUsb, XnUInt32 nBytesPerSecond);
+void XnDeviceSensorStopReadThread(XnSpecificUsbDevice* pSpecificUsb);
+/** Adds transfers in flight to read threads that completed late or dropped data since the last call. */
+void XnDeviceSensorTuneReadThreads(XnDevicePrivateData* pDevicePrivateData);
 
 XnStatus XnDeviceSensorConfigure(XnDevicePrivateData* pDevicePrivateData);
 
@@ -29,6 +29,7 @@
 #include <XnProfiling.h>
 #include "XnStreamProcessor.h"
 #include "XnSensor.h"
+#include "XnUsbReadPipeline.h"
 #include <XnOS.h>
 
 FILE* g_fUSBDump;
@@ -38,7 +39,36 @@ FILE* g_fUSBDump;
 //---------------------------------------------------------------------------
 XnBool XN_CALLBACK_TYPE XnDeviceSensorProtocolUsbEpCb(XnUChar* pBuffer, XnUInt32 nBufferSize, void* pCallbackData)
 {
-	XN_PROFILING_START_MT_SECTION("XnDeviceSensorProtocolUsbEpCb");
+	XnSpecificUsbDevice* pDevice = (XnSpecificUsbDevice*)pCallbackData;
+
+	XnUInt64 nStart;
+	xnOSGetHighResTimeStamp(&nStart);
+
+	XnBool bResult = TRUE;
+	if (pDevice->pReadPipeline != NULL)
+	{
+		pDevice->pReadPipeline->Push(pBuffer, nBufferSize);
+	}
+	else
+	{
+		bResult = XnDeviceSensorProtocolProcessUsbData(pBuffer, nBufferSize, pCallbackData);
+	}
+
+	// while the read thread is here, the transfers in flight are the only ones the device can fill. Taking
+	// half of their time leaves little room before it has nowhere to put its data.
+	XnUInt64 nEnd;
+	xnOSGetHighResTimeStamp(&nEnd);
+	if (nEnd - nStart > pDevice->nInFlightDuration / 2)
+	{
+		++pDevice->nLateCompletions;
+	}
+
+	return bResult;
+}
+
+XnBool XN_CALLBACK_TYPE XnDeviceSensorProtocolProcessUsbData(XnUChar* pBuffer, XnUInt32 nBufferSize, void* pCallbackData)
+{
+	XN_PROFILING_START_MT_SECTION("XnDeviceSensorProtocolProcessUsbData");
 
 	XnUInt32 nReadBytes;
 	XnUInt16 nMagic;
@@ -56,6 +86,7 @@ XnBool XN_CALLBACK_TYPE XnDeviceSensorProtocolUsbEpCb(XnUChar* pBuffer, XnUInt32
 		case XN_WAITING_FOR_CONFIGURATION:
 			pCurrState->State = XN_IGNORING_GARBAGE;
 			pCurrState->nMissingBytesInState = pDevice->nIgnoreBytes;
+			pCurrState->bSynced = FALSE;
 			break;
 
 		case XN_IGNORING_GARBAGE:
@@ -95,27 +126,41 @@ XnBool XN_CALLBACK_TYPE XnDeviceSensorProtocolUsbEpCb(XnUChar* pBuffer, XnUInt32
 				break;
 			}
 
-			while (pBuffer < pBufEnd)
 			{
-				if ((pBuffer + sizeof(XnUInt16) <= pBufEnd) && 
-					nMagic == *(XnUInt16*)(pBuffer))
+				XnUChar* pSearchStart = pBuffer;
+
+				while (pBuffer < pBufEnd)
 				{
-					pCurrState->CurrHeader.nMagic = nMagic;
-					pCurrState->State = XN_PACKET_HEADER;
-					pCurrState->nMissingBytesInState = sizeof(XnSensorProtocolResponseHeader);
-					break;
+					if ((pBuffer + sizeof(XnUInt16) <= pBufEnd) && 
+						nMagic == *(XnUInt16*)(pBuffer))
+					{
+						pCurrState->CurrHeader.nMagic = nMagic;
+						pCurrState->State = XN_PACKET_HEADER;
+						pCurrState->nMissingBytesInState = sizeof(XnSensorProtocolResponseHeader);
+						break;
+					}
+					else
+					{
+						pBuffer++;
+					}
 				}
-				else
+
+				XnUInt32 nSkippedBytes = (XnUInt32)(pBuffer - pSearchStart);
+
+				if (pBuffer == pBufEnd &&					// magic wasn't found
+					pBuffer[-1] == ((XnUInt8*)&nMagic)[0])	// last byte in buffer is first in magic
 				{
-					pBuffer++;
+					// mark that we found first one
+					pCurrState->nMissingBytesInState--;
+					nSkippedBytes--;
 				}
-			}
 
-			if (pBuffer == pBufEnd &&					// magic wasn't found
-				pBuffer[-1] == ((XnUInt8*)&nMagic)[0])	// last byte in buffer is first in magic
-			{
-				// mark that we found first one
-				pCurrState->nMissingBytesInState--;
+				// a packet always follows the previous one, so skipping bytes means data was dropped on the way
+				if (nSkippedBytes > 0 && pCurrState->bSynced)
+				{
+					++pDevice->nLostSyncs;
+					pCurrState->bSynced = FALSE;
+				}
 			}
 
 			break;
@@ -140,6 +185,7 @@ XnBool XN_CALLBACK_TYPE XnDeviceSensorProtocolUsbEpCb(XnUChar* pBuffer, XnUInt32
 
 				pCurrState->State = XN_PACKET_DATA;
 				pCurrState->nMissingBytesInState = pCurrState->CurrHeader.nBufSize;
+				pCurrState->bSynced = TRUE;
 			}
 			break;
 
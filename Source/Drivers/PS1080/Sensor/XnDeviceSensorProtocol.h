@@ -106,8 +106,12 @@ typedef struct XnSpecificUsbDeviceState
 	XnMiniPacketState State;
 	XnSensorProtocolResponseHeader CurrHeader;
 	XnUInt32 nMissingBytesInState;
+	/** TRUE once a packet header was found, until bytes have to be skipped to find the next one. */
+	XnBool bSynced;
 } XnSpecificUsbDeviceState;
 
+class XnUsbReadPipeline; // Forward Declaration
+
 typedef struct XnSpecificUsbDevice
 {
 	XnDevicePrivateData* pDevicePrivateData;
@@ -117,6 +121,26 @@ typedef struct XnSpecificUsbDevice
 	XnUInt32 nNumberOfBuffers;
 	XnSpecificUsbDeviceState CurrState;
 	XnUInt32 nTimeout;
+	/** When not NULL, the read thread only queues the data here, and it's processed by the pipeline's thread. */
+	XnUsbReadPipeline* pReadPipeline;
+	/** The transfer size and number of transfers the platform defaults give this end point. */
+	XnUInt32 nDefaultChunkReadBytes;
+	XnUInt32 nDefaultNumberOfBuffers;
+	/** How long it takes to fill one transfer, and all the transfers in flight, in microseconds. */
+	XnUInt32 nTransferDuration;
+	XnUInt32 nInFlightDuration;
+	/** Protects the read thread and its configuration from the auto-tune task. */
+	XN_CRITICAL_SECTION_HANDLE hReadThreadLock;
+	XnBool bReading;
+	XnUInt32 nBytesPerSecond;
+	/** Completions handled slower than the transfers in flight can cover, and times data was dropped. */
+	volatile XnUInt32 nLateCompletions;
+	volatile XnUInt32 nLostSyncs;
+	/** Auto-tune bookkeeping: counters at the last check, the number of transfers it settled on, and whether the read thread was started since. */
+	XnUInt32 nTunedLateCompletions;
+	XnUInt32 nTunedLostSyncs;
+	XnUInt32 nTunedNumberOfBuffers;
+	XnBool bTuneSettling;
 } XnSpecificUsbDevice;
 
 
@@ -124,6 +148,7 @@ typedef struct XnSpecificUsbDevice
 // Functions Declaration
 //---------------------------------------------------------------------------
 XnBool XN_CALLBACK_TYPE XnDeviceSensorProtocolUsbEpCb(XnUChar* pBuffer, XnUInt32 nBufferSize, void* pCallbackData);
+XnBool XN_CALLBACK_TYPE XnDeviceSensorProtocolProcessUsbData(XnUChar* pBuffer, XnUInt32 nBufferSize, void* pCallbackData);
 
 XnStatus XnCalculateExpectedImageSize(XnDevicePrivateData* pDevicePrivateData, XnUInt32* pnExpectedSize);
 void XnProcessUncompressedDepthPacket(XnSensorProtocolResponseHeader* pCurrHeader, XnUChar* pData, XnUInt32 nDataSize, XnBool bEOP, XnSpecificUsbDevice* pSpecificDevice);
@@ -100,7 +100,7 @@ void XnFrameStreamProcessor::OnEndOfFrame(const XnSensorProtocolResponseHeader*
 {
 	// write dump
 	XnBuffer* pCurWriteBuffer = m_pTripleBuffer->GetWriteBuffer();
-	xnDumpFileWriteBuffer(m_InternalDump, pCurWriteBuffer->GetData(), pCurWriteBuffer->GetSize());
+	xnDumpFileWriteBuffer(m_InternalDump, pCurWriteBuffer->GetData(), m_pTripleBuffer->GetWriteDataSize());
 	xnDumpFileClose(m_InternalDump);
 	xnDumpFileClose(m_InDump);
 
@@ -125,6 +125,11 @@ protected:
 		return m_pTripleBuffer->GetWriteFrame();
 	}
 
+	inline XnFrameBufferManager* GetBufferManager()
+	{
+		return m_pTripleBuffer;
+	}
+
 	/*
 	* Gets current frame ID (for logging purposes mainly).
 	*/
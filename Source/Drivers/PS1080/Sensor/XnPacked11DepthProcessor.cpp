@@ -22,6 +22,7 @@
 // Includes
 //---------------------------------------------------------------------------
 #include "XnPacked11DepthProcessor.h"
+#include "XnDepthSIMD.h"
 #include <XnProfiling.h>
 #ifdef XN_NEON
 #include <arm_neon.h>
@@ -54,6 +55,113 @@
 */
 #define XN_TAKE_BITS(source, count, offset)		((source & XN_CREATE_MASK(count, offset)) >> offset)
 
+#ifdef XN_DEPTH_SIMD
+//---------------------------------------------------------------------------
+// Global Variables
+//---------------------------------------------------------------------------
+static const XnBool g_bPacked11UseSSSE3 = xnOSIsCPUFeatureSupported(XN_CPU_FEATURE_SSSE3);
+static const XnBool g_bPacked11UseAVX2 = xnOSIsCPUFeatureSupported(XN_CPU_FEATURE_AVX2);
+
+//---------------------------------------------------------------------------
+// SIMD Code
+//---------------------------------------------------------------------------
+
+/*
+	Shift i of an element starts at bit 11*i, i.e. in byte k = 11*i/8, at bit r = 11*i%8 (MSB first).
+	Each 16-bit lane gets the big endian word (in[k], in[k+1]) using pshufb. Multiplying it by 2^r
+	(dropping the overflow) and shifting right by 5 leaves the 11 bits of the shift.
+	For shifts 2 and 5 (r = 6, 7) the word only holds the top 10 and 9 bits. The missing bits are 
+	the top bits of in[k+2], which are shifted into place using a high multiply and OR-ed in.
+*/
+#define XN_PACKED11_WORD_MASK		1, 0, 2, 1, 3, 2, 5, 4, 6, 5, 7, 6, 9, 8, 10, 9
+#define XN_PACKED11_TAIL_MASK		-1, -1, -1, -1, 4, -1, -1, -1, -1, -1, 8, -1, -1, -1, -1, -1
+#define XN_PACKED11_WORD_MUL		1, 8, 64, 2, 16, 128, 4, 32
+#define XN_PACKED11_TAIL_MUL		0, 0, 512, 0, 0, 1024, 0, 0
+
+// Unpacks the 8 shifts of the element at the start of in.
+static inline XN_DEPTH_SSSE3_FUNCTION __m128i Unpack11x8_SSSE3(__m128i in)
+{
+	__m128i words = _mm_shuffle_epi8(in, _mm_setr_epi8(XN_PACKED11_WORD_MASK));
+	__m128i tail = _mm_shuffle_epi8(in, _mm_setr_epi8(XN_PACKED11_TAIL_MASK));
+
+	words = _mm_srli_epi16(_mm_mullo_epi16(words, _mm_setr_epi16(XN_PACKED11_WORD_MUL)), 5);
+	tail = _mm_mulhi_epu16(tail, _mm_setr_epi16(XN_PACKED11_TAIL_MUL));
+
+	return _mm_or_si128(words, tail);
+}
+
+// Same as Unpack11x8_SSSE3(), on one element in each 128-bit lane.
+static inline XN_DEPTH_AVX2_FUNCTION __m256i Unpack11x16_AVX2(__m256i in)
+{
+	__m256i words = _mm256_shuffle_epi8(in, _mm256_setr_epi8(XN_PACKED11_WORD_MASK, XN_PACKED11_WORD_MASK));
+	__m256i tail = _mm256_shuffle_epi8(in, _mm256_setr_epi8(XN_PACKED11_TAIL_MASK, XN_PACKED11_TAIL_MASK));
+
+	words = _mm256_srli_epi16(_mm256_mullo_epi16(words, _mm256_setr_epi16(XN_PACKED11_WORD_MUL, XN_PACKED11_WORD_MUL)), 5);
+	tail = _mm256_mulhi_epu16(tail, _mm256_setr_epi16(XN_PACKED11_TAIL_MUL, XN_PACKED11_TAIL_MUL));
+
+	return _mm256_or_si256(words, tail);
+}
+
+/* Unpacks up to nElements elements, without reading past nInputSize bytes (each element is loaded 
+*  as 16 bytes). pTable is the shift-to-depth LUT, or NULL to output shifts.
+*  Returns the number of elements unpacked.
+*/
+static XN_DEPTH_SSSE3_FUNCTION XnUInt32 Unpack11to16_SSSE3(const XnUInt8* pcInput, XnUInt32 nInputSize, XnUInt32 nElements, XnUInt16* pnOutput, const OniDepthPixel* pTable)
+{
+	XnUInt16 shift[8];
+	XnUInt32 nElem = 0;
+
+	for (; nElem < nElements && nInputSize - nElem * XN_INPUT_ELEMENT_SIZE >= sizeof(__m128i); ++nElem)
+	{
+		__m128i shifts = Unpack11x8_SSSE3(_mm_loadu_si128((const __m128i*)pcInput));
+
+		if (pTable == NULL)
+		{
+			_mm_storeu_si128((__m128i*)pnOutput, shifts);
+		}
+		else
+		{
+			_mm_storeu_si128((__m128i*)shift, shifts);
+			for (int i = 0; i < 8; ++i)
+			{
+				pnOutput[i] = pTable[shift[i]];
+			}
+		}
+
+		pcInput += XN_INPUT_ELEMENT_SIZE;
+		pnOutput += 8;
+	}
+
+	return nElem;
+}
+
+// Same as Unpack11to16_SSSE3(), 2 elements at a time, with the LUT gathered.
+static XN_DEPTH_AVX2_FUNCTION XnUInt32 Unpack11to16_AVX2(const XnUInt8* pcInput, XnUInt32 nInputSize, XnUInt32 nElements, XnUInt16* pnOutput, const OniDepthPixel* pTable)
+{
+	XnUInt32 nElem = 0;
+
+	for (; nElem + 2 <= nElements && nInputSize - nElem * XN_INPUT_ELEMENT_SIZE >= XN_INPUT_ELEMENT_SIZE + sizeof(__m128i); nElem += 2)
+	{
+		__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)pcInput)), 
+			_mm_loadu_si128((const __m128i*)(pcInput + XN_INPUT_ELEMENT_SIZE)), 1);
+
+		__m256i shifts = Unpack11x16_AVX2(in);
+		if (pTable != NULL)
+		{
+			shifts = xnDepthLookupAVX2(shifts, pTable);
+		}
+
+		_mm256_storeu_si256((__m256i*)pnOutput, shifts);
+
+		pcInput += 2 * XN_INPUT_ELEMENT_SIZE;
+		pnOutput += 16;
+	}
+
+	return nElem;
+}
+
+#endif // XN_DEPTH_SIMD
+
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
@@ -95,6 +203,24 @@ XnStatus XnPacked11DepthProcessor::Unpack11to16(const XnUInt8* pcInput, const Xn
 	}
 
 	XnUInt16* pnOutput = (XnUInt16*)pWriteBuffer->GetUnsafeWritePointer();
+	XnUInt32 nElem = 0;
+
+#ifdef XN_DEPTH_SIMD
+	const OniDepthPixel* pTable = GetOutputTable();
+	if (g_bPacked11UseAVX2)
+	{
+		nElem = Unpack11to16_AVX2(pcInput, nInputSize, nElements, pnOutput, pTable);
+	}
+	if (g_bPacked11UseSSSE3)
+	{
+		nElem += Unpack11to16_SSSE3(pcInput + nElem * XN_INPUT_ELEMENT_SIZE, nInputSize - nElem * XN_INPUT_ELEMENT_SIZE, 
+			nElements - nElem, pnOutput + nElem * 8, pTable);
+	}
+
+	// whatever is left (the last element or so of the input) goes through the regular code
+	pcInput += nElem * XN_INPUT_ELEMENT_SIZE;
+	pnOutput += nElem * 8;
+#endif
 
 	XnUInt16 a0,a1,a2,a3,a4,a5,a6,a7;
 #ifdef XN_NEON
@@ -103,7 +229,7 @@ XnStatus XnPacked11DepthProcessor::Unpack11to16(const XnUInt8* pcInput, const Xn
 #endif
 
 	// Convert the 11bit packed data into 16bit shorts
-	for (XnUInt32 nElem = 0; nElem < nElements; ++nElem)
+	for (; nElem < nElements; ++nElem)
 	{
 		// input:	0,  1,  2,3,  4,  5,  6,7,  8,  9,10
 		//			-,---,---,-,---,---,---,-,---,---,-
@@ -22,6 +22,7 @@
 // Includes
 //---------------------------------------------------------------------------
 #include "XnPacked12DepthProcessor.h"
+#include "XnDepthSIMD.h"
 #include <XnProfiling.h>
 #ifdef XN_NEON
 #include <arm_neon.h>
@@ -54,6 +55,96 @@
 */
 #define XN_TAKE_BITS(source, count, offset)		((source & XN_CREATE_MASK(count, offset)) >> offset)
 
+#ifdef XN_DEPTH_SIMD
+//---------------------------------------------------------------------------
+// Global Variables
+//---------------------------------------------------------------------------
+static const XnBool g_bPacked12UseSSSE3 = xnOSIsCPUFeatureSupported(XN_CPU_FEATURE_SSSE3);
+static const XnBool g_bPacked12UseAVX2 = xnOSIsCPUFeatureSupported(XN_CPU_FEATURE_AVX2);
+
+//---------------------------------------------------------------------------
+// SIMD Code
+//---------------------------------------------------------------------------
+
+/*
+	Every 3 bytes hold 2 shifts. Each 16-bit lane gets a big endian word using pshufb: (in0, in1) for 
+	the even shift, and (in1, in2) for the odd one. Multiplying odd words by 16 drops their 4 high bits,
+	so a shift right by 4 leaves the 12 bits of the shift in all lanes.
+	An element (16 shifts) is loaded as bytes 0-15 and 8-23, so nothing is read past its end.
+*/
+#define XN_PACKED12_LOW_MASK		1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10
+#define XN_PACKED12_HIGH_MASK		5, 4, 6, 5, 8, 7, 9, 8, 11, 10, 12, 11, 14, 13, 15, 14
+#define XN_PACKED12_WORD_MUL		1, 16, 1, 16, 1, 16, 1, 16
+
+// Unpacks 8 shifts from in, and zeroes the ones that are out of range (like the regular code does).
+static inline XN_DEPTH_SSSE3_FUNCTION __m128i Unpack12x8_SSSE3(__m128i in, __m128i mask)
+{
+	__m128i shifts = _mm_shuffle_epi8(in, mask);
+	shifts = _mm_srli_epi16(_mm_mullo_epi16(shifts, _mm_setr_epi16(XN_PACKED12_WORD_MUL)), 4);
+	return _mm_and_si128(shifts, _mm_cmplt_epi16(shifts, _mm_set1_epi16(XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)));
+}
+
+/* Unpacks nElements elements. pTable is the shift-to-depth LUT, or NULL to output shifts. */
+static XN_DEPTH_SSSE3_FUNCTION void Unpack12to16_SSSE3(const XnUInt8* pcInput, XnUInt32 nElements, XnUInt16* pnOutput, const OniDepthPixel* pTable)
+{
+	const __m128i lowMask = _mm_setr_epi8(XN_PACKED12_LOW_MASK);
+	const __m128i highMask = _mm_setr_epi8(XN_PACKED12_HIGH_MASK);
+	XnUInt16 shift[16];
+
+	for (XnUInt32 nElem = 0; nElem < nElements; ++nElem)
+	{
+		__m128i shiftsLow = Unpack12x8_SSSE3(_mm_loadu_si128((const __m128i*)pcInput), lowMask);
+		__m128i shiftsHigh = Unpack12x8_SSSE3(_mm_loadu_si128((const __m128i*)(pcInput + 8)), highMask);
+
+		if (pTable == NULL)
+		{
+			_mm_storeu_si128((__m128i*)pnOutput, shiftsLow);
+			_mm_storeu_si128((__m128i*)(pnOutput + 8), shiftsHigh);
+		}
+		else
+		{
+			_mm_storeu_si128((__m128i*)shift, shiftsLow);
+			_mm_storeu_si128((__m128i*)(shift + 8), shiftsHigh);
+			for (int i = 0; i < 16; ++i)
+			{
+				pnOutput[i] = pTable[shift[i]];
+			}
+		}
+
+		pcInput += XN_INPUT_ELEMENT_SIZE;
+		pnOutput += 16;
+	}
+}
+
+// Same as Unpack12to16_SSSE3(), with both halves of the element in one register, and the LUT gathered.
+static XN_DEPTH_AVX2_FUNCTION void Unpack12to16_AVX2(const XnUInt8* pcInput, XnUInt32 nElements, XnUInt16* pnOutput, const OniDepthPixel* pTable)
+{
+	const __m256i mask = _mm256_setr_epi8(XN_PACKED12_LOW_MASK, XN_PACKED12_HIGH_MASK);
+	const __m256i mul = _mm256_setr_epi16(XN_PACKED12_WORD_MUL, XN_PACKED12_WORD_MUL);
+	const __m256i maxShift = _mm256_set1_epi16(XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1);
+
+	for (XnUInt32 nElem = 0; nElem < nElements; ++nElem)
+	{
+		__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)pcInput)), 
+			_mm_loadu_si128((const __m128i*)(pcInput + 8)), 1);
+
+		__m256i shifts = _mm256_srli_epi16(_mm256_mullo_epi16(_mm256_shuffle_epi8(in, mask), mul), 4);
+		shifts = _mm256_and_si256(shifts, _mm256_cmpgt_epi16(maxShift, shifts));
+
+		if (pTable != NULL)
+		{
+			shifts = xnDepthLookupAVX2(shifts, pTable);
+		}
+
+		_mm256_storeu_si256((__m256i*)pnOutput, shifts);
+
+		pcInput += XN_INPUT_ELEMENT_SIZE;
+		pnOutput += 16;
+	}
+}
+
+#endif // XN_DEPTH_SIMD
+
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
@@ -93,6 +184,25 @@ XnStatus XnPacked12DepthProcessor::Unpack12to16(const XnUInt8* pcInput, const Xn
 	}
 
 	XnUInt16* pnOutput = (XnUInt16*)pWriteBuffer->GetUnsafeWritePointer();
+
+	XnUInt32 nElem = 0;
+
+#ifdef XN_DEPTH_SIMD
+	if (g_bPacked12UseAVX2)
+	{
+		Unpack12to16_AVX2(pcInput, nElements, pnOutput, GetOutputTable());
+		nElem = nElements;
+	}
+	else if (g_bPacked12UseSSSE3)
+	{
+		Unpack12to16_SSSE3(pcInput, nElements, pnOutput, GetOutputTable());
+		nElem = nElements;
+	}
+
+	pcInput += nElem * XN_INPUT_ELEMENT_SIZE;
+	pnOutput += nElem * 16;
+#endif
+
 	XnUInt16 shift[16];
 #ifdef XN_NEON
 	XnUInt16 depth[16];
@@ -104,7 +214,7 @@ XnStatus XnPacked12DepthProcessor::Unpack12to16(const XnUInt8* pcInput, const Xn
 #endif
 
 	// Convert the 11bit packed data into 16bit shorts
-	for (XnUInt32 nElem = 0; nElem < nElements; ++nElem)
+	for (; nElem < nElements; ++nElem)
 	{
 #ifndef XN_NEON
 		// input:	0,  1,2,3,  4,5,6,  7,8,9, 10,11,12, 13,14,15, 16,17,18, 19,20,21, 22,23
@@ -30,6 +30,7 @@
 #include "XnDeviceSensor.h"
 #include "XnHostProtocol.h"
 #include "XnDeviceSensorInit.h"
+#include "XnUsbReadPipeline.h"
 #include "XnDeviceEnumeration.h"
 #include <XnPsVersion.h>
 
@@ -100,6 +101,12 @@ XnSensor::XnSensor(XnBool bResetOnStartup /* = TRUE */, XnBool bLeanInit /* = FA
 	m_FirmwareCPUInterval(XN_MODULE_PROPERTY_FIRMWARE_CPU_INTERVAL, "FirmwareCPUInterval", 0),
 	m_APCEnabled(XN_MODULE_PROPERTY_APC_ENABLED, "APCEnabled", TRUE),
 	m_FirmwareTecDebugPrint(XN_MODULE_PROPERTY_FIRMWARE_TEC_DEBUG_PRINT, "TecDebugPrint", FALSE),
+	m_UsbCaptureFile(XN_MODULE_PROPERTY_USB_CAPTURE_FILE, "UsbCaptureFile"),
+	m_UsbReplaySpeed(XN_MODULE_PROPERTY_USB_REPLAY_SPEED, "UsbReplaySpeed", 1.0),
+	m_UsbReadPipeline(XN_MODULE_PROPERTY_USB_READ_PIPELINE, "UsbReadPipeline", FALSE),
+	m_UsbReadPipelineStatistics(XN_MODULE_PROPERTY_USB_READ_PIPELINE_STATISTICS, "UsbReadPipelineStatistics", NULL),
+	m_UsbTransfers(XN_MODULE_PROPERTY_USB_TRANSFERS, "UsbTransfers", NULL),
+	m_UsbTransfersAutoTune(XN_MODULE_PROPERTY_USB_TRANSFERS_AUTO_TUNE, "UsbTransfersAutoTune", FALSE),
 	m_I2C(XN_MODULE_PROPERTY_I2C, "I2C", NULL),
 	m_DeleteFile(XN_MODULE_PROPERTY_DELETE_FILE, "DeleteFile"),
 	m_TecSetPoint(XN_MODULE_PROPERTY_TEC_SET_POINT, "TecSetPoint"),
@@ -122,6 +129,7 @@ XnSensor::XnSensor(XnBool bResetOnStartup /* = TRUE */, XnBool bLeanInit /* = FA
 	m_pScheduler(NULL),
 	m_pLogTask(NULL),
 	m_pCPUTask(NULL),
+	m_pUsbTransfersAutoTuneTask(NULL),
 	m_FirmwareLogDump(NULL),
 	m_FrameSyncDump(NULL),
 	m_bInitialized(FALSE)
@@ -178,6 +186,12 @@ XnSensor::XnSensor(XnBool bResetOnStartup /* = TRUE */, XnBool bLeanInit /* = FA
 	m_BIST.UpdateSetCallback(RunBISTCallback, this);
 	m_ProjectorFault.UpdateSetCallback(SetProjectorFaultCallback, this);
 	m_FirmwareTecDebugPrint.UpdateSetCallbackToDefault();
+	m_UsbCaptureFile.UpdateSetCallbackToDefault();
+	m_UsbReplaySpeed.UpdateSetCallback(SetUsbReplaySpeedCallback, this);
+	m_UsbReadPipeline.UpdateSetCallbackToDefault();
+	m_UsbReadPipelineStatistics.UpdateGetCallback(GetUsbReadPipelineStatisticsCallback, this);
+	m_UsbTransfers.UpdateGetCallback(GetUsbTransfersCallback, this);
+	m_UsbTransfersAutoTune.UpdateSetCallback(SetUsbTransfersAutoTuneCallback, this);
 
 	// Clear the frame-synced streams.
 	m_nFrameSyncEnabled = FALSE;
@@ -246,9 +260,11 @@ XnStatus XnSensor::InitSensor(const XnDeviceConfig* pDeviceConfig)
 	pDevicePrivateData->pSensor = this;
 
 	// open IO
-	nRetVal = m_SensorIO.OpenDevice(pDeviceConfig->cpConnectionString);
+	nRetVal = m_SensorIO.OpenDevice(pDeviceConfig->cpConnectionString, m_UsbCaptureFile.GetValue(), m_UsbReplaySpeed.GetValue());
 	XN_IS_STATUS_OK(nRetVal);
 
+	m_UsbCaptureFile.UpdateSetCallback(NULL, NULL);
+
 	// initialize
 	nRetVal = XnDeviceSensorInit(pDevicePrivateData);
 	XN_IS_STATUS_OK(nRetVal);
@@ -260,6 +276,14 @@ XnStatus XnSensor::InitSensor(const XnDeviceConfig* pDeviceConfig)
 
 	m_ResetSensorOnStartup.UpdateSetCallback(NULL, NULL);
 	m_LeanInit.UpdateSetCallback(NULL, NULL);
+	m_UsbReadPipeline.UpdateSetCallback(NULL, NULL);
+
+	// auto-tune may have been turned on (from the INI file) before there was anything to tune
+	if (m_UsbTransfersAutoTune.GetValue() == TRUE)
+	{
+		nRetVal = ChangeTaskInterval(&m_pUsbTransfersAutoTuneTask, ExecuteUsbTransfersAutoTuneTask, XN_SENSOR_USB_AUTO_TUNE_INTERVAL);
+		XN_IS_STATUS_OK(nRetVal);
+	}
 
 	// update device info properties
 	nRetVal = m_DeviceName.UnsafeUpdateValue(GetFixedParams()->GetDeviceName());
@@ -317,6 +341,17 @@ XnStatus XnSensor::Destroy()
 		m_Firmware.GetParams()->m_Stream2Mode.SetValue(XN_AUDIO_STREAM_OFF);
 	}
 
+	// stop the auto-tune. A run of it that already started only restarts read threads that are still reading, so
+	// stopping them makes sure it leaves them alone.
+	if (m_pUsbTransfersAutoTuneTask != NULL)
+	{
+		ChangeTaskInterval(&m_pUsbTransfersAutoTuneTask, ExecuteUsbTransfersAutoTuneTask, 0);
+
+		XnDeviceSensorStopReadThread(pDevicePrivateData->pSpecificDepthUsb);
+		XnDeviceSensorStopReadThread(pDevicePrivateData->pSpecificImageUsb);
+		XnDeviceSensorStopReadThread(pDevicePrivateData->pSpecificMiscUsb);
+	}
+
 	// close IO (including all reading threads)
 	m_SensorIO.CloseDevice();
 	m_bInitialized = FALSE;
@@ -376,7 +411,8 @@ XnStatus XnSensor::CreateDeviceModule(XnDeviceModuleHolder** ppModuleHolder)
 		&m_FirmwareLogInterval, &m_FirmwareLogPrint, &m_FirmwareCPUInterval, &m_DeleteFile, 
 		&m_APCEnabled, &m_TecSetPoint, &m_TecStatus, &m_TecFastConvergenceStatus, &m_EmitterSetPoint, &m_EmitterStatus, &m_I2C,
 		&m_FileAttributes, &m_FlashFile, &m_FirmwareLogFilter, &m_FirmwareLog, &m_FlashChunk, &m_FileList, 
-		&m_ProjectorFault, &m_BIST, &m_FirmwareTecDebugPrint, &m_DeviceName 
+		&m_ProjectorFault, &m_BIST, &m_FirmwareTecDebugPrint, &m_DeviceName, &m_UsbCaptureFile, &m_UsbReplaySpeed, 
+		&m_UsbReadPipeline, &m_UsbReadPipelineStatistics, &m_UsbTransfers, &m_UsbTransfersAutoTune 
 	};
 
 	nRetVal = pModule->AddProperties(pProps, sizeof(pProps)/sizeof(XnProperty*));
@@ -873,6 +909,73 @@ XnStatus XnSensor::GetTecStatus(XnTecData* pTecData)
 	return (XN_STATUS_OK);
 }
 
+static void GetUsbEndPointReadPipelineStatistics(XnSpecificUsbDevice* pSpecificUsb, XnUsbReadPipelineStatistics* pStats)
+{
+	if (pSpecificUsb == NULL)
+	{
+		return;
+	}
+
+	// the read thread re-creates the pipeline under this lock
+	xnOSEnterCriticalSection(&pSpecificUsb->hReadThreadLock);
+	if (pSpecificUsb->pReadPipeline != NULL)
+	{
+		pSpecificUsb->pReadPipeline->GetStatistics(pStats);
+	}
+	xnOSLeaveCriticalSection(&pSpecificUsb->hReadThreadLock);
+}
+
+XnStatus XnSensor::GetUsbReadPipelineStatistics(XnUsbReadPipelinesStatistics* pStats)
+{
+	xnOSMemSet(pStats, 0, sizeof(XnUsbReadPipelinesStatistics));
+
+	if (!m_bInitialized)
+	{
+		return (XN_STATUS_DEVICE_NOT_CONNECTED);
+	}
+
+	GetUsbEndPointReadPipelineStatistics(m_DevicePrivateData.pSpecificDepthUsb, &pStats->depth);
+	GetUsbEndPointReadPipelineStatistics(m_DevicePrivateData.pSpecificImageUsb, &pStats->image);
+	GetUsbEndPointReadPipelineStatistics(m_DevicePrivateData.pSpecificMiscUsb, &pStats->misc);
+
+	return (XN_STATUS_OK);
+}
+
+static void GetUsbEndPointTransfers(XnSpecificUsbDevice* pSpecificUsb, XnUsbEndPointTransfers* pTransfers)
+{
+	if (pSpecificUsb == NULL)
+	{
+		return;
+	}
+
+	xnOSEnterCriticalSection(&pSpecificUsb->hReadThreadLock);
+	pTransfers->nBytesPerSecond = pSpecificUsb->nBytesPerSecond;
+	pTransfers->nTransferSize = pSpecificUsb->nChunkReadBytes;
+	pTransfers->nTransfers = pSpecificUsb->nNumberOfBuffers;
+	pTransfers->nLateCompletions = pSpecificUsb->nLateCompletions;
+	pTransfers->nLostSyncs = pSpecificUsb->nLostSyncs;
+	xnOSLeaveCriticalSection(&pSpecificUsb->hReadThreadLock);
+}
+
+XnStatus XnSensor::GetUsbTransfers(XnUsbTransfers* pTransfers)
+{
+	xnOSMemSet(pTransfers, 0, sizeof(XnUsbTransfers));
+
+	if (!m_bInitialized)
+	{
+		return (XN_STATUS_DEVICE_NOT_CONNECTED);
+	}
+
+	GetUsbEndPointTransfers(m_DevicePrivateData.pSpecificDepthUsb, &pTransfers->depth);
+	GetUsbEndPointTransfers(m_DevicePrivateData.pSpecificImageUsb, &pTransfers->image);
+	if (IsMiscSupported())
+	{
+		GetUsbEndPointTransfers(m_DevicePrivateData.pSpecificMiscUsb, &pTransfers->misc);
+	}
+
+	return (XN_STATUS_OK);
+}
+
 XnStatus XnSensor::GetTecFastConvergenceStatus(XnTecFastConvergenceData* pTecData)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -1116,6 +1219,24 @@ XnStatus XnSensor::SetInterface(XnSensorUsbInterface nInterface)
 	return (XN_STATUS_OK);
 }
 
+XnStatus XnSensor::SetUsbReplaySpeed(XnDouble dSpeed)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	if (dSpeed < 0)
+	{
+		return (XN_STATUS_BAD_PARAM);
+	}
+
+	nRetVal = m_SensorIO.SetReplaySpeed(dSpeed);
+	XN_IS_STATUS_OK(nRetVal);
+
+	nRetVal = m_UsbReplaySpeed.UnsafeUpdateValue(dSpeed);
+	XN_IS_STATUS_OK(nRetVal);
+
+	return (XN_STATUS_OK);
+}
+
 XnStatus XnSensor::SetHostTimestamps(XnBool bHostTimestamps)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -1250,6 +1371,23 @@ XnStatus XnSensor::SetFirmwareCPUInterval(XnUInt32 nMilliSeconds)
 	return (XN_STATUS_OK);
 }
 
+XnStatus XnSensor::SetUsbTransfersAutoTune(XnBool bAutoTune)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	// until the device is open, there are no read threads to tune. InitSensor() starts it then.
+	if (m_bInitialized)
+	{
+		nRetVal = ChangeTaskInterval(&m_pUsbTransfersAutoTuneTask, ExecuteUsbTransfersAutoTuneTask, bAutoTune ? XN_SENSOR_USB_AUTO_TUNE_INTERVAL : 0);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
+	nRetVal = m_UsbTransfersAutoTune.UnsafeUpdateValue(bAutoTune);
+	XN_IS_STATUS_OK(nRetVal);
+
+	return (XN_STATUS_OK);
+}
+
 XnStatus XnSensor::SetAPCEnabled(XnBool bEnabled)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -1435,6 +1573,12 @@ void XnSensor::ExecuteFirmwareCPUTask(void* pCookie)
 	pThis->ReadFirmwareCPU();
 }
 
+void XnSensor::ExecuteUsbTransfersAutoTuneTask(void* pCookie)
+{
+	XnSensor* pThis = (XnSensor*)pCookie;
+	XnDeviceSensorTuneReadThreads(pThis->GetDevicePrivateData());
+}
+
 XnStatus XnSensor::OnFrameSyncPropertyChanged()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -1801,6 +1945,12 @@ XnStatus XN_CALLBACK_TYPE XnSensor::SetEmitterStateCallback(XnIntProperty* /*pSe
 	return pThis->SetEmitterState(nValue == TRUE);
 }
 
+XnStatus XN_CALLBACK_TYPE XnSensor::SetUsbReplaySpeedCallback(XnActualRealProperty* /*pSender*/, XnDouble dValue, void* pCookie)
+{
+	XnSensor* pThis = (XnSensor*)pCookie;
+	return pThis->SetUsbReplaySpeed(dValue);
+}
+
 XnStatus XN_CALLBACK_TYPE XnSensor::SetFirmwareFrameSyncCallback(XnActualIntProperty* /*pSender*/, XnUInt64 nValue, void* pCookie)
 {
 	XnSensor* pThis = (XnSensor*)pCookie;
@@ -1831,6 +1981,12 @@ XnStatus XN_CALLBACK_TYPE XnSensor::SetFirmwareCPUIntervalCallback(XnActualIntPr
 	return pThis->SetFirmwareCPUInterval((XnUInt32)nValue);
 }
 
+XnStatus XN_CALLBACK_TYPE XnSensor::SetUsbTransfersAutoTuneCallback(XnActualIntProperty* /*pSender*/, XnUInt64 nValue, void* pCookie)
+{
+	XnSensor* pThis = (XnSensor*)pCookie;
+	return pThis->SetUsbTransfersAutoTune((XnBool)nValue);
+}
+
 XnStatus XN_CALLBACK_TYPE XnSensor::SetAPCEnabledCallback(XnActualIntProperty* /*pSender*/, XnUInt64 nValue, void* pCookie)
 {
 	XnSensor* pThis = (XnSensor*)pCookie;
@@ -1897,6 +2053,20 @@ XnStatus XN_CALLBACK_TYPE XnSensor::GetTecStatusCallback(const XnGeneralProperty
 	return pThis->GetTecStatus((XnTecData*)gbValue.data);
 }
 
+XnStatus XN_CALLBACK_TYPE XnSensor::GetUsbReadPipelineStatisticsCallback(const XnGeneralProperty* /*pSender*/, const OniGeneralBuffer& gbValue, void* pCookie)
+{
+	XN_VALIDATE_GENERAL_BUFFER_TYPE(gbValue, XnUsbReadPipelinesStatistics);
+	XnSensor* pThis = (XnSensor*)pCookie;
+	return pThis->GetUsbReadPipelineStatistics((XnUsbReadPipelinesStatistics*)gbValue.data);
+}
+
+XnStatus XN_CALLBACK_TYPE XnSensor::GetUsbTransfersCallback(const XnGeneralProperty* /*pSender*/, const OniGeneralBuffer& gbValue, void* pCookie)
+{
+	XN_VALIDATE_GENERAL_BUFFER_TYPE(gbValue, XnUsbTransfers);
+	XnSensor* pThis = (XnSensor*)pCookie;
+	return pThis->GetUsbTransfers((XnUsbTransfers*)gbValue.data);
+}
+
 XnStatus XN_CALLBACK_TYPE XnSensor::GetTecFastConvergenceStatusCallback(const XnGeneralProperty* /*pSender*/, const OniGeneralBuffer& gbValue, void* pCookie)
 {
 	XN_VALIDATE_GENERAL_BUFFER_TYPE(gbValue, XnTecFastConvergenceData);
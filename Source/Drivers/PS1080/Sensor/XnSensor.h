@@ -87,6 +87,7 @@ public:
 	XnBool ShouldUseHostTimestamps() { return (m_HostTimestamps.GetValue() == TRUE); }
 	XnBool HasReadingStarted() { return (m_ReadData.GetValue() == TRUE); }
 	inline XnBool IsTecDebugPring() const { return (XnBool)m_FirmwareTecDebugPrint.GetValue(); }
+	inline XnBool IsUsbReadPipelined() const { return (XnBool)m_UsbReadPipeline.GetValue(); }
 
 	XnStatus SetFrameSyncStreamGroup(XnDeviceStream** ppStreamList, XnUInt32 numStreams);
 
@@ -127,6 +128,8 @@ private:
 	XnStatus ReadAHB(XnAHBData* pData);
 	XnStatus GetI2C(XnI2CReadData* pI2CReadData);
 	XnStatus GetTecStatus(XnTecData* pTecData);
+	XnStatus GetUsbReadPipelineStatistics(XnUsbReadPipelinesStatistics* pStats);
+	XnStatus GetUsbTransfers(XnUsbTransfers* pTransfers);
 	XnStatus GetTecFastConvergenceStatus(XnTecFastConvergenceData* pTecData);
 	XnStatus GetEmitterStatus(XnEmitterData* pEmitterData);
 	XnStatus ReadFlashFile(const XnParamFileData* pFile);
@@ -138,6 +141,7 @@ private:
 	// Setters
 	//---------------------------------------------------------------------------
 	XnStatus SetInterface(XnSensorUsbInterface nInterface);
+	XnStatus SetUsbReplaySpeed(XnDouble dSpeed);
 	XnStatus SetHostTimestamps(XnBool bHostTimestamps);
 	XnStatus SetNumberOfBuffers(XnUInt32 nCount);
 	XnStatus SetReadData(XnBool bRead);
@@ -157,6 +161,7 @@ private:
 	XnStatus SetFirmwareLogInterval(XnUInt32 nMilliSeconds);
 	XnStatus SetFirmwareLogPrint(XnBool bPrint);
 	XnStatus SetFirmwareCPUInterval(XnUInt32 nMilliSeconds);
+	XnStatus SetUsbTransfersAutoTune(XnBool bAutoTune);
 	XnStatus SetAPCEnabled(XnBool bEnabled);
 	XnStatus DeleteFile(XnUInt16 nFileID);
 	XnStatus SetTecSetPoint(XnUInt16 nSetPoint);
@@ -172,6 +177,7 @@ private:
 	static void XN_CALLBACK_TYPE OnDeviceDisconnected(const OniDeviceInfo& deviceInfo, void* pCookie);
 
 	static XnStatus XN_CALLBACK_TYPE SetInterfaceCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE SetUsbReplaySpeedCallback(XnActualRealProperty* pSender, XnDouble dValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetHostTimestampsCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetNumberOfBuffersCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetReadDataCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
@@ -202,6 +208,7 @@ private:
 	static XnStatus XN_CALLBACK_TYPE SetFirmwareLogIntervalCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetFirmwareLogPrintCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetFirmwareCPUIntervalCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE SetUsbTransfersAutoTuneCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetAPCEnabledCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetI2CCallback(XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE DeleteFileCallback(XnIntProperty* pSender, XnUInt64 nValue, void* pCookie);
@@ -214,8 +221,11 @@ private:
 	static XnStatus XN_CALLBACK_TYPE GetFileListCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 	static void XN_CALLBACK_TYPE ExecuteFirmwareLogTask(void* pCookie);
 	static void XN_CALLBACK_TYPE ExecuteFirmwareCPUTask(void* pCookie);
+	static void XN_CALLBACK_TYPE ExecuteUsbTransfersAutoTuneTask(void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE GetI2CCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE GetTecStatusCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE GetUsbReadPipelineStatisticsCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
+	static XnStatus XN_CALLBACK_TYPE GetUsbTransfersCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE GetTecFastConvergenceStatusCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE GetEmitterStatusCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE ReadFlashFileCallback(const XnGeneralProperty* pSender, const OniGeneralBuffer& gbValue, void* pCookie);
@@ -259,6 +269,12 @@ private:
 	XnActualIntProperty m_FirmwareCPUInterval;
 	XnActualIntProperty m_APCEnabled;
 	XnActualIntProperty m_FirmwareTecDebugPrint;
+	XnActualStringProperty m_UsbCaptureFile;
+	XnActualRealProperty m_UsbReplaySpeed;
+	XnActualIntProperty m_UsbReadPipeline;
+	XnGeneralProperty m_UsbReadPipelineStatistics;
+	XnGeneralProperty m_UsbTransfers;
+	XnActualIntProperty m_UsbTransfersAutoTune;
 	XnGeneralProperty m_I2C;
 	XnIntProperty m_DeleteFile;
 	XnIntProperty m_TecSetPoint;
@@ -285,6 +301,7 @@ private:
 	XnScheduler* m_pScheduler;
 	XnScheduledTask* m_pLogTask;
 	XnScheduledTask* m_pCPUTask;
+	XnScheduledTask* m_pUsbTransfersAutoTuneTask;
 	XnDumpFile* m_FirmwareLogDump;
 	XnDumpFile* m_FrameSyncDump;
 	XnBool m_nFrameSyncEnabled;
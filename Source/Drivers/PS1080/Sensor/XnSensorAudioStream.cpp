@@ -144,7 +144,7 @@ XnStatus XnSensorAudioStream::ConfigureStreamImpl()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificMiscUsb->pUsbConnection->UsbEp);
+	XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificMiscUsb);
 
 	nRetVal = SetActualRead(TRUE);
 	XN_IS_STATUS_OK(nRetVal);
@@ -170,14 +170,14 @@ XnStatus XnSensorAudioStream::SetActualRead(XnBool bRead)
 		if (bRead)
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Creating USB audio read thread...");
-			XnSpecificUsbDevice* pUSB = GetHelper()->GetPrivateData()->pSpecificMiscUsb;
-			nRetVal = xnUSBInitReadThread(pUSB->pUsbConnection->UsbEp, pUSB->nChunkReadBytes, pUSB->nNumberOfBuffers, pUSB->nTimeout, XnDeviceSensorProtocolUsbEpCb, pUSB);
+			// the misc end point carries more than audio, so it keeps the default transfers
+			nRetVal = XnDeviceSensorStartReadThread(GetHelper()->GetPrivateData()->pSpecificMiscUsb, 0);
 			XN_IS_STATUS_OK(nRetVal);
 		}
 		else
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Shutting down USB audio read thread...");
-			xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificMiscUsb->pUsbConnection->UsbEp);
+			XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificMiscUsb);
 		}
 
 		nRetVal = m_ActualRead.UnsafeUpdateValue(bRead);
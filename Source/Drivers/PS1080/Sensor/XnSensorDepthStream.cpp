@@ -77,7 +77,8 @@ XnSensorDepthStream::XnSensorDepthStream(const XnChar* strName, XnSensorObjects*
 	m_WavelengthCorrection(XN_STREAM_PROPERTY_WAVELENGTH_CORRECTION, "WavelengthCorrection", XN_DEPTH_STREAM_DEFAULT_WAVELENGTH_CORRECTION),
 	m_WavelengthCorrectionDebug(XN_STREAM_PROPERTY_WAVELENGTH_CORRECTION_DEBUG, "WavelengthCorrectionDebug", XN_DEPTH_STREAM_DEFAULT_WAVELENGTH_CORRECTION_DEBUG),
 	m_depthUtilsHandle(NULL),
-	m_hReferenceSizeChangedCallback(NULL)
+	m_hReferenceSizeChangedCallback(NULL),
+	m_bMirroredOnWrite(FALSE)
 {
 	m_ActualRead.UpdateSetCallback(SetActualReadCallback, this);
 }
@@ -321,7 +322,7 @@ XnStatus XnSensorDepthStream::ConfigureStreamImpl()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificDepthUsb->pUsbConnection->UsbEp);
+	XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificDepthUsb);
 
 	nRetVal = SetActualRead(TRUE);
 	XN_IS_STATUS_OK(nRetVal);
@@ -373,14 +374,13 @@ XnStatus XnSensorDepthStream::SetActualRead(XnBool bRead)
 		if (bRead)
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Creating USB depth read thread...");
-			XnSpecificUsbDevice* pUSB = GetHelper()->GetPrivateData()->pSpecificDepthUsb;
-			nRetVal = xnUSBInitReadThread(pUSB->pUsbConnection->UsbEp, pUSB->nChunkReadBytes, pUSB->nNumberOfBuffers, pUSB->nTimeout, XnDeviceSensorProtocolUsbEpCb, pUSB);
+			nRetVal = XnDeviceSensorStartReadThread(GetHelper()->GetPrivateData()->pSpecificDepthUsb, CalculateUsbBytesPerSecond());
 			XN_IS_STATUS_OK(nRetVal);
 		}
 		else
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Shutting down USB depth read thread...");
-			xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificDepthUsb->pUsbConnection->UsbEp);
+			XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificDepthUsb);
 		}
 
 		nRetVal = m_ActualRead.UnsafeUpdateValue(bRead);
@@ -390,6 +390,36 @@ XnStatus XnSensorDepthStream::SetActualRead(XnBool bRead)
 	return (XN_STATUS_OK);
 }
 
+XnUInt32 XnSensorDepthStream::CalculateUsbBytesPerSecond()
+{
+	XnUInt32 nPixels = GetXRes() * GetYRes();
+
+	const OniCropping* pCropping = GetCropping();
+	if (pCropping->enabled)
+	{
+		nPixels = pCropping->width * pCropping->height;
+	}
+
+	// PS compressed depth is taken at its uncompressed size, which is what it comes to at worst
+	XnUInt32 nBitsPerPixel;
+	switch (m_InputFormat.GetValue())
+	{
+	case XN_IO_DEPTH_FORMAT_UNCOMPRESSED_10_BIT:
+		nBitsPerPixel = 10;
+		break;
+	case XN_IO_DEPTH_FORMAT_UNCOMPRESSED_11_BIT:
+		nBitsPerPixel = 11;
+		break;
+	case XN_IO_DEPTH_FORMAT_UNCOMPRESSED_12_BIT:
+		nBitsPerPixel = 12;
+		break;
+	default:
+		nBitsPerPixel = 16;
+	}
+
+	return (XnUInt32)((XnUInt64)nPixels * nBitsPerPixel / 8 * GetFPS());
+}
+
 XnStatus XnSensorDepthStream::OpenStreamImpl()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -881,11 +911,18 @@ XnStatus XnSensorDepthStream::CropImpl(OniFrame* pFrame, const OniCropping* pCro
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	// if firmware cropping is disabled, crop
-	if (m_FirmwareCropMode.GetValue() == XN_FIRMWARE_CROPPING_MODE_DISABLED)
+	// crop only if the frame isn't cropped yet (by firmware, or while it was written)
+	if (!pFrame->croppingEnabled)
 	{
 		nRetVal = XnDepthStream::CropImpl(pFrame, pCropping);
 		XN_IS_STATUS_OK(nRetVal);
+
+		pFrame->width = pCropping->width;
+		pFrame->height = pCropping->height;
+		pFrame->cropOriginX = pCropping->originX;
+		pFrame->cropOriginY = pCropping->originY;
+		pFrame->croppingEnabled = TRUE;
+		pFrame->stride = pFrame->width * GetBytesPerPixel();
 	}
 
 	return (XN_STATUS_OK);
@@ -895,8 +932,9 @@ XnStatus XnSensorDepthStream::Mirror(OniFrame* pFrame) const
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	// only perform mirror if it's our job. if mirror is performed by FW, we don't need to do anything.
-	if (m_FirmwareMirror.GetValue() == FALSE)
+	// only perform mirror if it's our job. if mirror is performed by FW, or the frame was mirrored while it
+	// was written, we don't need to do anything.
+	if (m_FirmwareMirror.GetValue() == FALSE && !m_bMirroredOnWrite)
 	{
 		nRetVal = XnDepthStream::Mirror(pFrame);
 		XN_IS_STATUS_OK(nRetVal);
@@ -1026,6 +1064,28 @@ XnStatus XnSensorDepthStream::GetImageCoordinatesOfDepthPixel(XnUInt32 x, XnUInt
 	return nRetVal;
 }
 
+XnStatus XnSensorDepthStream::GetImageCoordinatesOfDepthPixels(XnUInt32 nCount, const XnInt32* pDepthXY, const OniDepthPixel* pDepthZ, XnUInt32 imageXRes, XnUInt32 imageYRes, XnInt32* pImageXY)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	nRetVal = DepthUtilsSetColorResolution(m_depthUtilsHandle, imageXRes, imageYRes);
+	XN_IS_STATUS_OK(nRetVal);
+
+	nRetVal = DepthUtilsTranslatePixels(m_depthUtilsHandle, nCount, pDepthXY, pDepthZ, pImageXY);
+	return nRetVal;
+}
+
+XnStatus XnSensorDepthStream::GetImageCoordinatesOfDepthMap(const OniDepthPixel* pDepth, XnUInt32 nStride, XnUInt32 nOriginX, XnUInt32 nOriginY, XnUInt32 nWidth, XnUInt32 nHeight, XnUInt32 imageXRes, XnUInt32 imageYRes, XnInt32* pImageXY)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	nRetVal = DepthUtilsSetColorResolution(m_depthUtilsHandle, imageXRes, imageYRes);
+	XN_IS_STATUS_OK(nRetVal);
+
+	nRetVal = DepthUtilsTranslateDepthMapPixels(m_depthUtilsHandle, pDepth, nStride, nOriginX, nOriginY, nWidth, nHeight, pImageXY);
+	return nRetVal;
+}
+
 OniStatus XnSensorDepthStream::GetSensorCalibrationInfo(void* data, int* pDataSize)
 {
 	if ((size_t)*pDataSize < sizeof(DepthUtilsSensorCalibrationInfo))
@@ -95,6 +95,8 @@ protected:
 
 	XnStatus ApplyRegistration(OniDepthPixel* pDetphmap);
 	OniStatus GetSensorCalibrationInfo(void* data, int* dataSize);
+	XnStatus GetImageCoordinatesOfDepthPixels(XnUInt32 nCount, const XnInt32* pDepthXY, const OniDepthPixel* pDepthZ, XnUInt32 imageXRes, XnUInt32 imageYRes, XnInt32* pImageXY);
+	XnStatus GetImageCoordinatesOfDepthMap(const OniDepthPixel* pDepth, XnUInt32 nStride, XnUInt32 nOriginX, XnUInt32 nOriginY, XnUInt32 nWidth, XnUInt32 nHeight, XnUInt32 imageXRes, XnUInt32 imageYRes, XnInt32* pImageXY);
 	XnStatus PopulateSensorCalibrationInfo();
 
 protected:
@@ -125,6 +127,7 @@ protected:
 
 private:
 	XnUInt32 CalculateExpectedSize();
+	XnUInt32 CalculateUsbBytesPerSecond();
 	XnStatus DecideFirmwareRegistration(XnBool bRegistration, XnProcessingType registrationType, XnResolutions nRes);
 	XnStatus DecidePixelSizeFactor();
 	XnStatus SetCroppingImpl(const OniCropping* pCropping, XnCroppingMode mode);
@@ -187,6 +190,9 @@ private:
 	DepthUtilsHandle m_depthUtilsHandle;
 	DepthUtilsSensorCalibrationInfo m_calibrationInfo;
 	XnCallbackHandle m_hReferenceSizeChangedCallback;
+
+	// set by the processor when the frame it's done with was mirrored as it was written
+	XnBool m_bMirroredOnWrite;
 };
 
 #endif //__XN_SENSOR_DEPTH_STREAM_H__
@@ -130,7 +130,7 @@ XnStatus XnSensorIRStream::ConfigureStreamImpl()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb->pUsbConnection->UsbEp);
+	XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb);
 
 	nRetVal = SetActualRead(TRUE);
 	XN_IS_STATUS_OK(nRetVal);
@@ -163,14 +163,13 @@ XnStatus XnSensorIRStream::SetActualRead(XnBool bRead)
 		if (bRead)
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Creating USB IR read thread...");
-			XnSpecificUsbDevice* pUSB = GetHelper()->GetPrivateData()->pSpecificImageUsb;
-			nRetVal = xnUSBInitReadThread(pUSB->pUsbConnection->UsbEp, pUSB->nChunkReadBytes, pUSB->nNumberOfBuffers, pUSB->nTimeout, XnDeviceSensorProtocolUsbEpCb, pUSB);
+			nRetVal = XnDeviceSensorStartReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb, CalculateUsbBytesPerSecond());
 			XN_IS_STATUS_OK(nRetVal);
 		}
 		else
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Shutting down IR image read thread...");
-			xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb->pUsbConnection->UsbEp);
+			XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb);
 		}
 
 		nRetVal = m_ActualRead.UnsafeUpdateValue(bRead);
@@ -180,6 +179,20 @@ XnStatus XnSensorIRStream::SetActualRead(XnBool bRead)
 	return (XN_STATUS_OK);
 }
 
+XnUInt32 XnSensorIRStream::CalculateUsbBytesPerSecond()
+{
+	XnUInt32 nPixels = GetXRes() * GetYRes();
+
+	const OniCropping* pCropping = GetCropping();
+	if (pCropping->enabled)
+	{
+		nPixels = pCropping->width * pCropping->height;
+	}
+
+	// IR is sent as packed 10-bit
+	return (XnUInt32)((XnUInt64)nPixels * 10 / 8 * GetFPS());
+}
+
 XnStatus XnSensorIRStream::OpenStreamImpl()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -85,6 +85,7 @@ protected:
 private:
 	XnStatus OnIsMirroredChanged();
 	XnStatus SetCroppingImpl(const OniCropping* pCropping, XnCroppingMode mode);
+	XnUInt32 CalculateUsbBytesPerSecond();
 
 	XnStatus FixFirmwareBug();
 
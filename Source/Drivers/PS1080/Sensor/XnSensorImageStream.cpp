@@ -287,7 +287,7 @@ XnStatus XnSensorImageStream::ConfigureStreamImpl()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 
-	xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb->pUsbConnection->UsbEp);
+	XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb);
 
 	nRetVal = SetActualRead(TRUE);
 	XN_IS_STATUS_OK(nRetVal);
@@ -332,14 +332,13 @@ XnStatus XnSensorImageStream::SetActualRead(XnBool bRead)
 		if (bRead)
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Creating USB image read thread...");
-			XnSpecificUsbDevice* pUSB = GetHelper()->GetPrivateData()->pSpecificImageUsb;
-			nRetVal = xnUSBInitReadThread(pUSB->pUsbConnection->UsbEp, pUSB->nChunkReadBytes, pUSB->nNumberOfBuffers, pUSB->nTimeout, XnDeviceSensorProtocolUsbEpCb, pUSB);
+			nRetVal = XnDeviceSensorStartReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb, CalculateUsbBytesPerSecond());
 			XN_IS_STATUS_OK(nRetVal);
 		}
 		else
 		{
 			xnLogVerbose(XN_MASK_DEVICE_SENSOR, "Shutting down USB image read thread...");
-			xnUSBShutdownReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb->pUsbConnection->UsbEp);
+			XnDeviceSensorStopReadThread(GetHelper()->GetPrivateData()->pSpecificImageUsb);
 		}
 
 		nRetVal = m_ActualRead.UnsafeUpdateValue(bRead);
@@ -349,6 +348,35 @@ XnStatus XnSensorImageStream::SetActualRead(XnBool bRead)
 	return (XN_STATUS_OK);
 }
 
+XnUInt32 XnSensorImageStream::CalculateUsbBytesPerSecond()
+{
+	XnUInt32 nPixels = GetXRes() * GetYRes();
+
+	const OniCropping* pCropping = GetCropping();
+	if (pCropping->enabled)
+	{
+		nPixels = pCropping->width * pCropping->height;
+	}
+
+	// compressed formats are taken at the size of the uncompressed format they encode, which they don't exceed
+	XnUInt32 nBitsPerPixel;
+	switch (m_InputFormat.GetValue())
+	{
+	case XN_IO_IMAGE_FORMAT_BAYER:
+	case XN_IO_IMAGE_FORMAT_UNCOMPRESSED_BAYER:
+	case XN_IO_IMAGE_FORMAT_JPEG_MONO:
+		nBitsPerPixel = 8;
+		break;
+	case XN_IO_IMAGE_FORMAT_JPEG_420:
+		nBitsPerPixel = 12;
+		break;
+	default:
+		nBitsPerPixel = 16;
+	}
+
+	return (XnUInt32)((XnUInt64)nPixels * nBitsPerPixel / 8 * GetFPS());
+}
+
 XnStatus XnSensorImageStream::OpenStreamImpl()
 {
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -117,6 +117,7 @@ private:
 	XnStatus SetCroppingImpl(const OniCropping* pCropping, XnCroppingMode mode);
 	XnStatus SetAutoExposureForOldFirmware(XnBool bAutoExposure);
 	XnStatus SetAutoWhiteBalanceForOldFirmware(XnBool bAutoWhiteBalance);
+	XnUInt32 CalculateUsbBytesPerSecond();
 
 	static XnStatus XN_CALLBACK_TYPE SetInputFormatCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
 	static XnStatus XN_CALLBACK_TYPE SetAntiFlickerCallback(XnActualIntProperty* pSender, XnUInt64 nValue, void* pCookie);
@@ -31,6 +31,7 @@
 XnUncompressedDepthProcessor::XnUncompressedDepthProcessor(XnSensorDepthStream* pStream, XnSensorStreamHelper* pHelper, XnFrameBufferManager* pBufferManager) :
 	XnDepthProcessor(pStream, pHelper, pBufferManager)
 {
+	SetPlacesPixels(TRUE);
 }
 
 XnUncompressedDepthProcessor::~XnUncompressedDepthProcessor()
@@ -58,19 +59,52 @@ void XnUncompressedDepthProcessor::ProcessFramePacketChunk(const XnSensorProtoco
 		// copy values. Make sure we do not get corrupted shifts
 		XnUInt16* pRaw = (XnUInt16*)(pData);
 		XnUInt16* pRawEnd = (XnUInt16*)(pData + nDataSize);
-		OniDepthPixel* pDepthBuf = (OniDepthPixel*)pWriteBuffer->GetUnsafeWritePointer();
-
 		XnUInt16 shift;
-		while (pRaw < pRawEnd)
+
+		XnFrameBufferManager* pBufferManager = GetBufferManager();
+		if (pBufferManager->IsWritePlaced())
 		{
-			shift = (((*pRaw) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (*pRaw) : 0);
-			*pDepthBuf = GetOutput(shift);
+			// write each run of pixels directly to its place in the mirrored / cropped frame
+			while (pRaw < pRawEnd)
+			{
+				XnUInt32 nRunPixels;
+				XnInt32 nStep;
+				OniDepthPixel* pDepthBuf = (OniDepthPixel*)pBufferManager->GetPlacedWritePointer((XnUInt32)(pRawEnd - pRaw), &nRunPixels, &nStep);
+				XnUInt16* pRunEnd = pRaw + nRunPixels;
+
+				if (pDepthBuf == NULL)
+				{
+					// cropped out
+					pRaw = pRunEnd;
+				}
+
+				while (pRaw < pRunEnd)
+				{
+					shift = (((*pRaw) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (*pRaw) : 0);
+					*pDepthBuf = GetOutput(shift);
+
+					++pRaw;
+					pDepthBuf += nStep;
+				}
 
-			++pRaw;
-			++pDepthBuf;
+				pWriteBuffer->UnsafeUpdateSize(nRunPixels * sizeof(OniDepthPixel));
+			}
 		}
+		else
+		{
+			OniDepthPixel* pDepthBuf = (OniDepthPixel*)pWriteBuffer->GetUnsafeWritePointer();
+
+			while (pRaw < pRawEnd)
+			{
+				shift = (((*pRaw) < (XN_DEVICE_SENSOR_MAX_SHIFT_VALUE-1)) ? (*pRaw) : 0);
+				*pDepthBuf = GetOutput(shift);
 
- 		pWriteBuffer->UnsafeUpdateSize(nDataSize);
+				++pRaw;
+				++pDepthBuf;
+			}
+
+			pWriteBuffer->UnsafeUpdateSize(nDataSize);
+		}
 	}
 
 	XN_PROFILING_END_SECTION
@@ -0,0 +1,241 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "XnUsbReadPipeline.h"
+#include <XnLog.h>
+#include "XnDeviceSensor.h"
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_USB_READ_PIPELINE_WORKER_TIMEOUT		1000
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+XnUsbReadPipeline::XnUsbReadPipeline() :
+	m_aSlots(NULL),
+	m_nSlots(0),
+	m_nSlotSize(0),
+	m_pProcessFunc(NULL),
+	m_pProcessCookie(NULL),
+	m_nWriteIndex(0),
+	m_nReadIndex(0),
+	m_nPeakOccupancy(0),
+	m_nQueued(0),
+	m_nOverruns(0),
+	m_hDataQueued(NULL),
+	m_hThread(NULL),
+	m_bStop(FALSE)
+{
+}
+
+XnUsbReadPipeline::~XnUsbReadPipeline()
+{
+	Free();
+}
+
+XnStatus XnUsbReadPipeline::Init(XnUInt32 nBuffers, XnUInt32 nBufferSize, XnUSBReadCallbackFunctionPtr pProcessFunc, void* pProcessCookie)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	Free();
+
+	// a power of 2, so that the free-running indices stay valid when they wrap around
+	m_nSlots = 1;
+	while (m_nSlots < nBuffers)
+	{
+		m_nSlots <<= 1;
+	}
+	m_nSlotSize = nBufferSize;
+	m_pProcessFunc = pProcessFunc;
+	m_pProcessCookie = pProcessCookie;
+
+	m_aSlots = XN_NEW_ARR(Slot, m_nSlots);
+	XN_VALIDATE_ALLOC_PTR(m_aSlots);
+	xnOSMemSet(m_aSlots, 0, sizeof(Slot) * m_nSlots);
+
+	for (XnUInt32 i = 0; i < m_nSlots; ++i)
+	{
+		m_aSlots[i].pData = (XnUChar*)xnOSMallocAligned(m_nSlotSize, XN_DEFAULT_MEM_ALIGN);
+		if (m_aSlots[i].pData == NULL)
+		{
+			Free();
+			return (XN_STATUS_ALLOC_FAILED);
+		}
+	}
+
+	nRetVal = xnOSCreateEvent(&m_hDataQueued, FALSE);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		Free();
+		return (nRetVal);
+	}
+
+	nRetVal = xnOSCreateThread(WorkerThread, this, &m_hThread);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		Free();
+		return (nRetVal);
+	}
+
+	xnLogVerbose(XN_MASK_DEVICE_SENSOR, "USB read pipeline started (%u buffers of %u bytes)", m_nSlots, m_nSlotSize);
+
+	return (XN_STATUS_OK);
+}
+
+void XnUsbReadPipeline::Free()
+{
+	if (m_hThread != NULL)
+	{
+		m_bStop = TRUE;
+		xnOSSetEvent(m_hDataQueued);
+		xnOSWaitForThreadExit(m_hThread, XN_WAIT_INFINITE);
+		xnOSCloseThread(&m_hThread);
+		m_bStop = FALSE;
+	}
+
+	if (m_hDataQueued != NULL)
+	{
+		xnOSCloseEvent(&m_hDataQueued);
+		m_hDataQueued = NULL;
+	}
+
+	if (m_aSlots != NULL)
+	{
+		for (XnUInt32 i = 0; i < m_nSlots; ++i)
+		{
+			xnOSFreeAligned(m_aSlots[i].pData);
+		}
+		XN_DELETE_ARR(m_aSlots);
+		m_aSlots = NULL;
+	}
+
+	m_nSlots = 0;
+	m_nWriteIndex = 0;
+	m_nReadIndex = 0;
+	m_nPeakOccupancy = 0;
+	m_nQueued = 0;
+	m_nOverruns = 0;
+}
+
+XnStatus XnUsbReadPipeline::Resize(XnUInt32 nBuffers)
+{
+	// the statistics are about the end point, not about this ring
+	XnUInt32 nPeakOccupancy = m_nPeakOccupancy;
+	XnUInt32 nQueued = m_nQueued;
+	XnUInt32 nOverruns = m_nOverruns;
+
+	XnStatus nRetVal = Init(nBuffers, m_nSlotSize, m_pProcessFunc, m_pProcessCookie);
+
+	m_nPeakOccupancy = nPeakOccupancy;
+	m_nQueued = nQueued;
+	m_nOverruns = nOverruns;
+
+	return (nRetVal);
+}
+
+XnBool XnUsbReadPipeline::Push(const XnUChar* pBuffer, XnUInt32 nBufferSize)
+{
+	if (nBufferSize == 0)
+	{
+		return (TRUE);
+	}
+
+	if (nBufferSize > m_nSlotSize)
+	{
+		xnLogWarning(XN_MASK_DEVICE_SENSOR, "USB read pipeline: got %u bytes, which is more than a buffer (%u bytes). Dropping them.", nBufferSize, m_nSlotSize);
+		++m_nOverruns;
+		return (FALSE);
+	}
+
+	XnUInt32 nWriteIndex = m_nWriteIndex;
+	XnUInt32 nOccupancy = nWriteIndex - m_nReadIndex;
+	if (nOccupancy == m_nSlots)
+	{
+		++m_nOverruns;
+		return (FALSE);
+	}
+
+	// make sure the consumer is done with the slot before reusing it
+	xnOSMemoryBarrier();
+
+	Slot& slot = m_aSlots[nWriteIndex & (m_nSlots - 1)];
+	xnOSMemCopy(slot.pData, pBuffer, nBufferSize);
+	slot.nSize = nBufferSize;
+
+	// publish the slot only once its data is in place
+	xnOSMemoryBarrier();
+	m_nWriteIndex = nWriteIndex + 1;
+
+	++m_nQueued;
+	if (nOccupancy + 1 > m_nPeakOccupancy)
+	{
+		m_nPeakOccupancy = nOccupancy + 1;
+	}
+
+	xnOSSetEvent(m_hDataQueued);
+
+	return (TRUE);
+}
+
+void XnUsbReadPipeline::ProcessQueued()
+{
+	XnUInt32 nReadIndex = m_nReadIndex;
+
+	while (nReadIndex != m_nWriteIndex)
+	{
+		// don't read the slot before seeing it published
+		xnOSMemoryBarrier();
+
+		Slot& slot = m_aSlots[nReadIndex & (m_nSlots - 1)];
+		m_pProcessFunc(slot.pData, slot.nSize, m_pProcessCookie);
+
+		// hand the slot back only once we're done with it
+		xnOSMemoryBarrier();
+		m_nReadIndex = ++nReadIndex;
+	}
+}
+
+XN_THREAD_PROC XnUsbReadPipeline::WorkerThread(XN_THREAD_PARAM pThreadParam)
+{
+	XnUsbReadPipeline* pThis = (XnUsbReadPipeline*)pThreadParam;
+
+	while (!pThis->m_bStop)
+	{
+		// the event is set for every buffer, so waking up on one we already processed is harmless
+		xnOSWaitEvent(pThis->m_hDataQueued, XN_USB_READ_PIPELINE_WORKER_TIMEOUT);
+		pThis->ProcessQueued();
+	}
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+void XnUsbReadPipeline::GetStatistics(XnUsbReadPipelineStatistics* pStats) const
+{
+	pStats->nCapacity = m_nSlots;
+	pStats->nOccupancy = m_nWriteIndex - m_nReadIndex;
+	pStats->nPeakOccupancy = m_nPeakOccupancy;
+	pStats->nQueued = m_nQueued;
+	pStats->nOverruns = m_nOverruns;
+}
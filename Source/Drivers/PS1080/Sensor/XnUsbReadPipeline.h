@@ -0,0 +1,93 @@
+/*****************************************************************************
+*                                                                            *
+*  OpenNI 2.x Alpha                                                          *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of OpenNI.                                              *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef __XN_USB_READ_PIPELINE_H__
+#define __XN_USB_READ_PIPELINE_H__
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnOS.h>
+#include <XnUSB.h>
+#include <PS1080.h>
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+/**
+* Moves the processing of the data read from an end point off its USB read thread. The read thread only
+* copies each buffer it reads into a single-producer single-consumer ring, and a worker thread takes them
+* out of the ring, in order, and hands them to the processing function.
+* When the ring is full, new buffers are dropped (and counted as overruns).
+*/
+class XnUsbReadPipeline
+{
+public:
+	XnUsbReadPipeline();
+	~XnUsbReadPipeline();
+
+	/** nBuffers is rounded up to a power of 2. */
+	XnStatus Init(XnUInt32 nBuffers, XnUInt32 nBufferSize, XnUSBReadCallbackFunctionPtr pProcessFunc, void* pProcessCookie);
+	void Free();
+
+	/** Re-creates the ring with nBuffers (dropping the buffers it holds), but keeps the statistics. Only when nothing pushes. */
+	XnStatus Resize(XnUInt32 nBuffers);
+
+	/** Called by the read thread. */
+	XnBool Push(const XnUChar* pBuffer, XnUInt32 nBufferSize);
+
+	void GetStatistics(XnUsbReadPipelineStatistics* pStats) const;
+
+	inline XnUInt32 GetCapacity() const { return m_nSlots; }
+
+private:
+	XN_DISABLE_COPY_AND_ASSIGN(XnUsbReadPipeline);
+
+	static XN_THREAD_PROC WorkerThread(XN_THREAD_PARAM pThreadParam);
+	void ProcessQueued();
+
+	struct Slot
+	{
+		XnUChar* pData;
+		XnUInt32 nSize;
+	};
+
+	Slot* m_aSlots;
+	XnUInt32 m_nSlots;
+	XnUInt32 m_nSlotSize;
+
+	XnUSBReadCallbackFunctionPtr m_pProcessFunc;
+	void* m_pProcessCookie;
+
+	// free-running counters. The producer only writes m_nWriteIndex, and the consumer only writes m_nReadIndex.
+	volatile XnUInt32 m_nWriteIndex;
+	volatile XnUInt32 m_nReadIndex;
+
+	// written by the producer only
+	volatile XnUInt32 m_nPeakOccupancy;
+	volatile XnUInt32 m_nQueued;
+	volatile XnUInt32 m_nOverruns;
+
+	XN_EVENT_HANDLE m_hDataQueued;
+	XN_THREAD_HANDLE m_hThread;
+	volatile XnBool m_bStop;
+};
+
+#endif //__XN_USB_READ_PIPELINE_H__
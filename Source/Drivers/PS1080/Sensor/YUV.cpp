@@ -23,18 +23,33 @@
 //---------------------------------------------------------------------------
 #include "YUV.h"
 #include <math.h>
+#include <string.h>
 
-#if (XN_PLATFORM == XN_PLATFORM_WIN32)
+#if (XN_PLATFORM == XN_PLATFORM_WIN32) || defined(__SSE2__)
+	#define XN_YUV_SSE2
 	#ifdef __INTEL_COMPILER
 		#include <ia32intrin.h>
 	#else
 		#include <emmintrin.h>
+		#include <immintrin.h>
+	#endif
+
+	// AVX2 code is compiled regardless of compiler flags, and only used if the CPU supports it
+	#if defined(_MSC_VER) && (_MSC_VER >= 1700)
+		#define XN_YUV_AVX2
+		#define XN_YUV_AVX2_FUNCTION
+	#elif defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9)))
+		#define XN_YUV_AVX2
+		#define XN_YUV_AVX2_FUNCTION __attribute__((target("avx2")))
 	#endif
 #endif
 
 //---------------------------------------------------------------------------
 // Global Variables
 //---------------------------------------------------------------------------
+#ifdef XN_YUV_AVX2
+static const XnBool g_bYUVUseAVX2 = xnOSIsCPUFeatureSupported(XN_CPU_FEATURE_AVX2);
+#endif
 
 //---------------------------------------------------------------------------
 // Code
@@ -53,287 +68,213 @@ void YUV444ToRGB888(XnUInt8 cY, XnUInt8 cU, XnUInt8 cV,
 	cB = (XnUInt8)XN_MIN(XN_MAX((nC + 516 * nD           ) >> 8, 0), 255);
 }
 
-#if (XN_PLATFORM == XN_PLATFORM_WIN32)
+#ifdef XN_YUV_SSE2
 
-void YUV422ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+/*
+	The SIMD code does the same integer math as YUV444ToRGB888(), so results are bit-exact:
+		R = (298 * (Y - 16) + 409 * (V - 128) + 128) >> 8
+		G = (298 * (Y - 16) - 100 * (U - 128) - 208 * (V - 128) + 128) >> 8
+		B = (298 * (Y - 16) + 516 * (U - 128) + 128) >> 8
+	Sums don't fit in 16 bits, so each term pair is a 16-bit pair multiplied and added into 32 bits (pmaddwd).
+	Input is unpacked to one 16-bit value per byte, so each 32-bit lane holds the Y of a pixel and one of the
+	U/V values of its macro pixel. bYFirst tells their order (YUYV vs. UYVY).
+*/
+
+// Converts 4 pixels. in16 holds their 2 macro pixels (8 bytes), unpacked to 16 bits.
+static inline void YUVToRGB32x4_SSE2(__m128i in16, XnBool bYFirst, __m128i& r, __m128i& g, __m128i& b)
 {
-	const XnUInt8* pYUVLast = pYUVImage + nYUVSize - 8;
-	const XnUInt8* pYUVOrig = pYUVImage;
-	const XnUInt8* pRGBOrig = pRGBImage;
-	const XnUInt8* pRGBLast = pRGBImage + *pnRGBSize - 12;
-
-	const __m128 minus128 = _mm_set_ps1(-128);
-	const __m128 plus113983 = _mm_set_ps1(1.13983F);
-	const __m128 minus039466 = _mm_set_ps1(-0.39466F);
-	const __m128 minus058060 = _mm_set_ps1(-0.58060F);
-	const __m128 plus203211 = _mm_set_ps1(2.03211F);
-	const __m128 zero = _mm_set_ps1(0);
-	const __m128 plus255 = _mm_set_ps1(255);
-
-	// define YUV floats
-	__m128 y;
-	__m128 u;
-	__m128 v;
-
-	__m128 temp;
-
-	// define RGB floats
-	__m128 r;
-	__m128 g;
-	__m128 b;
-
-	// define RGB integers
-	__m128i iR;
-	__m128i iG;
-	__m128i iB;
-
-	XnUInt32* piR = (XnUInt32*)&iR;
-	XnUInt32* piG = (XnUInt32*)&iG;
-	XnUInt32* piB = (XnUInt32*)&iB;
-
-	while (pYUVImage <= pYUVLast && pRGBImage <= pRGBLast)
-	{
-		// process 4 pixels at once (values should be ordered backwards)
-		y = _mm_set_ps(pYUVImage[YUV422_Y2 + YUV422_BPP], pYUVImage[YUV422_Y1 + YUV422_BPP], pYUVImage[YUV422_Y2], pYUVImage[YUV422_Y1]);
-		u = _mm_set_ps(pYUVImage[YUV422_U + YUV422_BPP],  pYUVImage[YUV422_U + YUV422_BPP],  pYUVImage[YUV422_U],  pYUVImage[YUV422_U]);
-		v = _mm_set_ps(pYUVImage[YUV422_V + YUV422_BPP],  pYUVImage[YUV422_V + YUV422_BPP],  pYUVImage[YUV422_V],  pYUVImage[YUV422_V]);
+	const __m128i lowWord = _mm_set1_epi32(0xFFFF);
+
+	// Y of each pixel, and U0 V0 U1 V1 of the macro pixels
+	__m128i y = bYFirst ? _mm_and_si128(in16, lowWord) : _mm_srli_epi32(in16, 16);
+	__m128i uv = bYFirst ? _mm_srli_epi32(in16, 16) : _mm_and_si128(in16, lowWord);
+
+	__m128i c = _mm_sub_epi32(y, _mm_set1_epi32(16));
+	__m128i d = _mm_sub_epi32(_mm_shuffle_epi32(uv, _MM_SHUFFLE(2, 2, 0, 0)), _mm_set1_epi32(128));
+	__m128i e = _mm_sub_epi32(_mm_shuffle_epi32(uv, _MM_SHUFFLE(3, 3, 1, 1)), _mm_set1_epi32(128));
+
+	// pair (low word, high word) of each lane: (C, D), (C, E), (E, 1)
+	__m128i cd = _mm_or_si128(_mm_and_si128(c, lowWord), _mm_slli_epi32(d, 16));
+	__m128i ce = _mm_or_si128(_mm_and_si128(c, lowWord), _mm_slli_epi32(e, 16));
+	__m128i e1 = _mm_or_si128(_mm_and_si128(e, lowWord), _mm_set1_epi32(0x10000));
+
+	const __m128i round = _mm_set1_epi32(128);
+	r = _mm_add_epi32(_mm_madd_epi16(ce, _mm_set_epi16(409, 298, 409, 298, 409, 298, 409, 298)), round);
+	g = _mm_add_epi32(_mm_madd_epi16(cd, _mm_set_epi16(-100, 298, -100, 298, -100, 298, -100, 298)),
+					  _mm_madd_epi16(e1, _mm_set_epi16(128, -208, 128, -208, 128, -208, 128, -208)));
+	b = _mm_add_epi32(_mm_madd_epi16(cd, _mm_set_epi16(516, 298, 516, 298, 516, 298, 516, 298)), round);
+
+	r = _mm_srai_epi32(r, 8);
+	g = _mm_srai_epi32(g, 8);
+	b = _mm_srai_epi32(b, 8);
+}
 
-		u = _mm_add_ps(u, minus128); // u -= 128
-		v = _mm_add_ps(v, minus128); // v -= 128
+// Converts 8 pixels (16 input bytes, 24 output bytes). Writes one extra byte after the output.
+static inline void YUVToRGB888x8_SSE2(const XnUInt8* pYUV, XnUInt8* pRGB, XnBool bYFirst)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i in = _mm_loadu_si128((const __m128i*)pYUV);
 
-		/*
+	__m128i rLow, gLow, bLow, rHigh, gHigh, bHigh;
+	YUVToRGB32x4_SSE2(_mm_unpacklo_epi8(in, zero), bYFirst, rLow, gLow, bLow);
+	YUVToRGB32x4_SSE2(_mm_unpackhi_epi8(in, zero), bYFirst, rHigh, gHigh, bHigh);
 
-		http://en.wikipedia.org/wiki/YUV
+	// saturating packs do the clipping to [0, 255]
+	__m128i r = _mm_packus_epi16(_mm_packs_epi32(rLow, rHigh), zero);
+	__m128i g = _mm_packus_epi16(_mm_packs_epi32(gLow, gHigh), zero);
+	__m128i b = _mm_packus_epi16(_mm_packs_epi32(bLow, bHigh), zero);
 
-		From YUV to RGB:
-		R =     Y + 1.13983 V
-		G =     Y - 0.39466 U - 0.58060 V
-		B =     Y + 2.03211 U
+	// RGB0 of each pixel, written 3 bytes apart (each write's 4th byte is overwritten by the next one)
+	__m128i rg = _mm_unpacklo_epi8(r, g);
+	__m128i b0 = _mm_unpacklo_epi8(b, zero);
+	__m128i rgb0[2] = { _mm_unpacklo_epi16(rg, b0), _mm_unpackhi_epi16(rg, b0) };
 
-		*/ 
+	for (int i = 0; i < 2; ++i)
+	{
+		__m128i pixels = rgb0[i];
+		for (int j = 0; j < 4; ++j)
+		{
+			XnUInt32 nPixel = (XnUInt32)_mm_cvtsi128_si32(pixels);
+			memcpy(pRGB, &nPixel, sizeof(nPixel));
+			pRGB += YUV_RGB_BPP;
+			pixels = _mm_srli_si128(pixels, 4);
+		}
+	}
+}
 
-		temp = _mm_mul_ps(plus113983, v);
-		r = _mm_add_ps(y, temp);
+#endif // XN_YUV_SSE2
 
-		temp = _mm_mul_ps(minus039466, u);
-		g = _mm_add_ps(y, temp);
-		temp = _mm_mul_ps(minus058060, v);
-		g = _mm_add_ps(g, temp);
+#ifdef XN_YUV_AVX2
 
-		temp = _mm_mul_ps(plus203211, u);
-		b = _mm_add_ps(y, temp);
+// Same as YUVToRGB32x4_SSE2(), for 8 pixels (4 in each 128-bit lane).
+static XN_YUV_AVX2_FUNCTION inline void YUVToRGB32x8_AVX2(__m256i in16, XnBool bYFirst, __m256i& r, __m256i& g, __m256i& b)
+{
+	const __m256i lowWord = _mm256_set1_epi32(0xFFFF);
 
-		// make sure no value is smaller than 0
-		r = _mm_max_ps(r, zero);
-		g = _mm_max_ps(g, zero);
-		b = _mm_max_ps(b, zero);
+	__m256i y = bYFirst ? _mm256_and_si256(in16, lowWord) : _mm256_srli_epi32(in16, 16);
+	__m256i uv = bYFirst ? _mm256_srli_epi32(in16, 16) : _mm256_and_si256(in16, lowWord);
 
-		// make sure no value is bigger than 255
-		r = _mm_min_ps(r, plus255);
-		g = _mm_min_ps(g, plus255);
-		b = _mm_min_ps(b, plus255);
+	__m256i c = _mm256_sub_epi32(y, _mm256_set1_epi32(16));
+	__m256i d = _mm256_sub_epi32(_mm256_shuffle_epi32(uv, _MM_SHUFFLE(2, 2, 0, 0)), _mm256_set1_epi32(128));
+	__m256i e = _mm256_sub_epi32(_mm256_shuffle_epi32(uv, _MM_SHUFFLE(3, 3, 1, 1)), _mm256_set1_epi32(128));
 
-		// convert floats to int16 (there is no conversion to uint8, just to int8).
-		iR = _mm_cvtps_epi32(r);
-		iG = _mm_cvtps_epi32(g);
-		iB = _mm_cvtps_epi32(b);
+	__m256i cd = _mm256_or_si256(_mm256_and_si256(c, lowWord), _mm256_slli_epi32(d, 16));
+	__m256i ce = _mm256_or_si256(_mm256_and_si256(c, lowWord), _mm256_slli_epi32(e, 16));
+	__m256i e1 = _mm256_or_si256(_mm256_and_si256(e, lowWord), _mm256_set1_epi32(0x10000));
 
-		// extract the 4 pixels RGB values.
-		// because we made sure values are between 0 and 255, we can just take the lower byte
-		// of each INT16
-		pRGBImage[0] = (XnUInt8)piR[0];
-		pRGBImage[1] = (XnUInt8)piG[0];
-		pRGBImage[2] = (XnUInt8)piB[0];
+	const __m256i round = _mm256_set1_epi32(128);
+	r = _mm256_add_epi32(_mm256_madd_epi16(ce, _mm256_set1_epi32((409 << 16) | 298)), round);
+	g = _mm256_add_epi32(_mm256_madd_epi16(cd, _mm256_set1_epi32((XnInt32)(((XnUInt32)(XnUInt16)-100 << 16) | 298))),
+						 _mm256_madd_epi16(e1, _mm256_set1_epi32((128 << 16) | (XnUInt16)-208)));
+	b = _mm256_add_epi32(_mm256_madd_epi16(cd, _mm256_set1_epi32((516 << 16) | 298)), round);
 
-		pRGBImage[3] = (XnUInt8)piR[1];
-		pRGBImage[4] = (XnUInt8)piG[1];
-		pRGBImage[5] = (XnUInt8)piB[1];
+	r = _mm256_srai_epi32(r, 8);
+	g = _mm256_srai_epi32(g, 8);
+	b = _mm256_srai_epi32(b, 8);
+}
 
-		pRGBImage[6] = (XnUInt8)piR[2];
-		pRGBImage[7] = (XnUInt8)piG[2];
-		pRGBImage[8] = (XnUInt8)piB[2];
+// Converts as many 16 pixel blocks (32 input bytes, 48 output bytes) as fit, advancing the pointers.
+static XN_YUV_AVX2_FUNCTION void YUVToRGB888_AVX2(const XnUInt8*& pYUV, XnUInt8*& pRGB, const XnUInt8* pYUVEnd, const XnUInt8* pRGBEnd, XnBool bYFirst)
+{
+	const __m256i zero = _mm256_setzero_si256();
+
+	// Each 128-bit lane ends up with R0..R7 G0..G7 and B0..B7 of 8 pixels. These pick their bytes into
+	// the 24 interleaved output bytes of the lane (0x80 zeroes a byte).
+	const __m256i rgToFirst16 = _mm256_setr_epi8(
+		0, 8, -128, 1, 9, -128, 2, 10, -128, 3, 11, -128, 4, 12, -128, 5,
+		0, 8, -128, 1, 9, -128, 2, 10, -128, 3, 11, -128, 4, 12, -128, 5);
+	const __m256i bToFirst16 = _mm256_setr_epi8(
+		-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128,
+		-128, -128, 0, -128, -128, 1, -128, -128, 2, -128, -128, 3, -128, -128, 4, -128);
+	const __m256i rgToLast8 = _mm256_setr_epi8(
+		13, -128, 6, 14, -128, 7, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128,
+		13, -128, 6, 14, -128, 7, 15, -128, -128, -128, -128, -128, -128, -128, -128, -128);
+	const __m256i bToLast8 = _mm256_setr_epi8(
+		-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, -128, -128, -128, -128, -128, -128,
+		-128, 5, -128, -128, 6, -128, -128, 7, -128, -128, -128, -128, -128, -128, -128, -128);
+
+	while (pYUV + 32 <= pYUVEnd && pRGB + 48 <= pRGBEnd)
+	{
+		// unpacking works within lanes: low half has macro pixels 0,1 | 4,5 and high half 2,3 | 6,7
+		__m256i in = _mm256_loadu_si256((const __m256i*)pYUV);
 
-		pRGBImage[9] = (XnUInt8)piR[3];
-		pRGBImage[10] = (XnUInt8)piG[3];
-		pRGBImage[11] = (XnUInt8)piB[3];
+		__m256i rLow, gLow, bLow, rHigh, gHigh, bHigh;
+		YUVToRGB32x8_AVX2(_mm256_unpacklo_epi8(in, zero), bYFirst, rLow, gLow, bLow);
+		YUVToRGB32x8_AVX2(_mm256_unpackhi_epi8(in, zero), bYFirst, rHigh, gHigh, bHigh);
 
-		// advance the streams
-		pYUVImage += 8;
-		pRGBImage += 12;
-	}
+		// ... which packing puts back in order (pixels 0-7 in the low lane, 8-15 in the high one)
+		__m256i rg = _mm256_packus_epi16(_mm256_packs_epi32(rLow, rHigh), _mm256_packs_epi32(gLow, gHigh));
+		__m256i bb = _mm256_packus_epi16(_mm256_packs_epi32(bLow, bHigh), zero);
 
-	*pnActualRead = (XnUInt32)(pYUVImage - pYUVOrig);
-	*pnRGBSize = (XnUInt32)(pRGBImage - pRGBOrig);
+		__m256i first16 = _mm256_or_si256(_mm256_shuffle_epi8(rg, rgToFirst16), _mm256_shuffle_epi8(bb, bToFirst16));
+		__m256i last8 = _mm256_or_si256(_mm256_shuffle_epi8(rg, rgToLast8), _mm256_shuffle_epi8(bb, bToLast8));
+
+		_mm_storeu_si128((__m128i*)pRGB, _mm256_castsi256_si128(first16));
+		_mm_storel_epi64((__m128i*)(pRGB + 16), _mm256_castsi256_si128(last8));
+		_mm_storeu_si128((__m128i*)(pRGB + 24), _mm256_extracti128_si256(first16, 1));
+		_mm_storel_epi64((__m128i*)(pRGB + 40), _mm256_extracti128_si256(last8, 1));
+
+		pYUV += 32;
+		pRGB += 48;
+	}
 }
 
-#else // not Win32
+#endif // XN_YUV_AVX2
 
-void YUV422ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+static void YUVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize, XnBool bYFirst)
 {
-	const XnUInt8* pOrigYUV = pYUVImage;
 	const XnUInt8* pCurrYUV = pYUVImage;
-	const XnUInt8* pOrigRGB = pRGBImage;
 	XnUInt8* pCurrRGB = pRGBImage;
-	const XnUInt8* pLastYUV = pYUVImage + nYUVSize - YUV422_BPP;
-	const XnUInt8* pLastRGB = pRGBImage + *pnRGBSize - YUV_RGB_BPP;
+	const XnUInt8* pYUVEnd = pYUVImage + nYUVSize;
+	const XnUInt8* pRGBEnd = pRGBImage + *pnRGBSize;
 
-	while (pCurrYUV <= pLastYUV && pCurrRGB <= pLastRGB)
+#ifdef XN_YUV_AVX2
+	if (g_bYUVUseAVX2)
 	{
-		YUV444ToRGB888(pCurrYUV[YUV422_Y1], pCurrYUV[YUV422_U], pCurrYUV[YUV422_V],
-						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
-		pCurrRGB += YUV_RGB_BPP;
-		YUV444ToRGB888(pCurrYUV[YUV422_Y2], pCurrYUV[YUV422_U], pCurrYUV[YUV422_V],
-						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
-		pCurrRGB += YUV_RGB_BPP;
-		pCurrYUV += YUV422_BPP;
+		YUVToRGB888_AVX2(pCurrYUV, pCurrRGB, pYUVEnd, pRGBEnd, bYFirst);
 	}
-
-	*pnActualRead = pCurrYUV - pOrigYUV;
-	*pnRGBSize = pCurrRGB - pOrigRGB;
-}
-
 #endif
 
-#if (XN_PLATFORM == XN_PLATFORM_WIN32)
-
-void YUYVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
-{
-	const XnUInt8* pYUVLast = pYUVImage + nYUVSize - 8;
-	const XnUInt8* pYUVOrig = pYUVImage;
-	const XnUInt8* pRGBOrig = pRGBImage;
-	const XnUInt8* pRGBLast = pRGBImage + *pnRGBSize - 12;
-
-	const __m128 minus128 = _mm_set_ps1(-128);
-	const __m128 plus113983 = _mm_set_ps1(1.13983F);
-	const __m128 minus039466 = _mm_set_ps1(-0.39466F);
-	const __m128 minus058060 = _mm_set_ps1(-0.58060F);
-	const __m128 plus203211 = _mm_set_ps1(2.03211F);
-	const __m128 zero = _mm_set_ps1(0);
-	const __m128 plus255 = _mm_set_ps1(255);
-
-	// define YUV floats
-	__m128 y;
-	__m128 u;
-	__m128 v;
-
-	__m128 temp;
-
-	// define RGB floats
-	__m128 r;
-	__m128 g;
-	__m128 b;
-
-	// define RGB integers
-	__m128i iR;
-	__m128i iG;
-	__m128i iB;
-
-	XnUInt32* piR = (XnUInt32*)&iR;
-	XnUInt32* piG = (XnUInt32*)&iG;
-	XnUInt32* piB = (XnUInt32*)&iB;
-
-	while (pYUVImage <= pYUVLast && pRGBImage <= pRGBLast)
+#ifdef XN_YUV_SSE2
+	// SSE2 code writes one byte past its output
+	while (pCurrYUV + 16 <= pYUVEnd && pCurrRGB + 24 < pRGBEnd)
 	{
-		// process 4 pixels at once (values should be ordered backwards)
-		y = _mm_set_ps(pYUVImage[YUYV_Y2 + YUYV_BPP], pYUVImage[YUYV_Y1 + YUYV_BPP], pYUVImage[YUYV_Y2], pYUVImage[YUYV_Y1]);
-		u = _mm_set_ps(pYUVImage[YUYV_U + YUYV_BPP],  pYUVImage[YUYV_U + YUYV_BPP],  pYUVImage[YUYV_U],  pYUVImage[YUYV_U]);
-		v = _mm_set_ps(pYUVImage[YUYV_V + YUYV_BPP],  pYUVImage[YUYV_V + YUYV_BPP],  pYUVImage[YUYV_V],  pYUVImage[YUYV_V]);
-
-		u = _mm_add_ps(u, minus128); // u -= 128
-		v = _mm_add_ps(v, minus128); // v -= 128
-
-		/*
-
-		http://en.wikipedia.org/wiki/YUV
-
-		From YUV to RGB:
-		R =     Y + 1.13983 V
-		G =     Y - 0.39466 U - 0.58060 V
-		B =     Y + 2.03211 U
-
-		*/ 
-
-		temp = _mm_mul_ps(plus113983, v);
-		r = _mm_add_ps(y, temp);
-
-		temp = _mm_mul_ps(minus039466, u);
-		g = _mm_add_ps(y, temp);
-		temp = _mm_mul_ps(minus058060, v);
-		g = _mm_add_ps(g, temp);
-
-		temp = _mm_mul_ps(plus203211, u);
-		b = _mm_add_ps(y, temp);
-
-		// make sure no value is smaller than 0
-		r = _mm_max_ps(r, zero);
-		g = _mm_max_ps(g, zero);
-		b = _mm_max_ps(b, zero);
-
-		// make sure no value is bigger than 255
-		r = _mm_min_ps(r, plus255);
-		g = _mm_min_ps(g, plus255);
-		b = _mm_min_ps(b, plus255);
-
-		// convert floats to int16 (there is no conversion to uint8, just to int8).
-		iR = _mm_cvtps_epi32(r);
-		iG = _mm_cvtps_epi32(g);
-		iB = _mm_cvtps_epi32(b);
-
-		// extract the 4 pixels RGB values.
-		// because we made sure values are between 0 and 255, we can just take the lower byte
-		// of each INT16
-		pRGBImage[0] = (XnUInt8)piR[0];
-		pRGBImage[1] = (XnUInt8)piG[0];
-		pRGBImage[2] = (XnUInt8)piB[0];
-
-		pRGBImage[3] = (XnUInt8)piR[1];
-		pRGBImage[4] = (XnUInt8)piG[1];
-		pRGBImage[5] = (XnUInt8)piB[1];
-
-		pRGBImage[6] = (XnUInt8)piR[2];
-		pRGBImage[7] = (XnUInt8)piG[2];
-		pRGBImage[8] = (XnUInt8)piB[2];
-
-		pRGBImage[9] = (XnUInt8)piR[3];
-		pRGBImage[10] = (XnUInt8)piG[3];
-		pRGBImage[11] = (XnUInt8)piB[3];
-
-		// advance the streams
-		pYUVImage += 8;
-		pRGBImage += 12;
+		YUVToRGB888x8_SSE2(pCurrYUV, pCurrRGB, bYFirst);
+		pCurrYUV += 16;
+		pCurrRGB += 24;
 	}
+#endif
 
-	*pnActualRead = (XnUInt32)(pYUVImage - pYUVOrig);
-	*pnRGBSize = (XnUInt32)(pRGBImage - pRGBOrig);
-}
-
-#else // not Win32
-
-void YUYVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
-{
-	const XnUInt8* pOrigYUV = pYUVImage;
-	const XnUInt8* pCurrYUV = pYUVImage;
-	const XnUInt8* pOrigRGB = pRGBImage;
-	XnUInt8* pCurrRGB = pRGBImage;
-	const XnUInt8* pLastYUV = pYUVImage + nYUVSize - YUYV_BPP;
-	const XnUInt8* pLastRGB = pRGBImage + *pnRGBSize - YUV_RGB_BPP;
+	// leftovers (or all of it, with no SIMD)
+	const XnUInt32 nY1 = bYFirst ? YUYV_Y1 : YUV422_Y1;
+	const XnUInt32 nY2 = bYFirst ? YUYV_Y2 : YUV422_Y2;
+	const XnUInt32 nU = bYFirst ? YUYV_U : YUV422_U;
+	const XnUInt32 nV = bYFirst ? YUYV_V : YUV422_V;
 
-	while (pCurrYUV <= pLastYUV && pCurrRGB <= pLastRGB)
+	while (pCurrYUV + YUV422_BPP <= pYUVEnd && pCurrRGB + 2 * YUV_RGB_BPP <= pRGBEnd)
 	{
-		YUV444ToRGB888(pCurrYUV[YUYV_Y1], pCurrYUV[YUYV_U], pCurrYUV[YUYV_V],
+		YUV444ToRGB888(pCurrYUV[nY1], pCurrYUV[nU], pCurrYUV[nV],
 						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
 		pCurrRGB += YUV_RGB_BPP;
-		YUV444ToRGB888(pCurrYUV[YUYV_Y2], pCurrYUV[YUYV_U], pCurrYUV[YUYV_V],
+		YUV444ToRGB888(pCurrYUV[nY2], pCurrYUV[nU], pCurrYUV[nV],
 						pCurrRGB[YUV_RED], pCurrRGB[YUV_GREEN], pCurrRGB[YUV_BLUE]);
 		pCurrRGB += YUV_RGB_BPP;
-		pCurrYUV += YUYV_BPP;
+		pCurrYUV += YUV422_BPP;
 	}
 
-	*pnActualRead = pCurrYUV - pOrigYUV;
-	*pnRGBSize = pCurrRGB - pOrigRGB;
+	*pnActualRead = (XnUInt32)(pCurrYUV - pYUVImage);
+	*pnRGBSize = (XnUInt32)(pCurrRGB - pRGBImage);
 }
 
-#endif
+void YUV422ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+{
+	YUVToRGB888(pYUVImage, pRGBImage, nYUVSize, pnActualRead, pnRGBSize, FALSE);
+}
+
+void YUYVToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32* pnActualRead, XnUInt32* pnRGBSize)
+{
+	YUVToRGB888(pYUVImage, pRGBImage, nYUVSize, pnActualRead, pnRGBSize, TRUE);
+}
 
 void YUV420ToRGB888(const XnUInt8* pYUVImage, XnUInt8* pRGBImage, XnUInt32 nYUVSize, XnUInt32 /*nRGBSize*/)
 {
@@ -775,6 +775,7 @@ LinkFrameInputStream::DefaultStreamServices::DefaultStreamServices()
 	OniStreamServices::acquireFrame = acquireFrameCallback;
 	OniStreamServices::addFrameRef = addFrameRefCallback;
 	OniStreamServices::releaseFrame = releaseFrameCallback;
+	OniStreamServices::acquireExternalFrame = NULL;
 }
 
 void LinkFrameInputStream::DefaultStreamServices::setStream(LinkFrameInputStream* pStream)
@@ -34,6 +34,12 @@ XN_C_API void* XN_C_DECL xnOSReallocAligned(void* pMemory, const XnSizeT nAllocS
 XN_C_API void* XN_C_DECL xnOSRecalloc(void* pMemory, const XnSizeT nAllocNum, const XnSizeT nAllocSize);
 XN_C_API void XN_C_DECL xnOSFree(const void* pMemBlock);
 XN_C_API void XN_C_DECL xnOSFreeAligned(const void* pMemBlock);
+/**
+* Allocates page-aligned memory backed by huge (large) pages, if the OS allows it.
+* Returns NULL if huge pages are not available. Memory must be freed with xnOSFreeHugePages(), using the same size.
+*/
+XN_C_API void* XN_C_DECL xnOSMallocHugePages(const XnSizeT nAllocSize);
+XN_C_API void XN_C_DECL xnOSFreeHugePages(void* pMemBlock, const XnSizeT nAllocSize);
 XN_C_API void XN_C_DECL xnOSMemCopy(void* pDest, const void* pSource, XnSizeT nCount);
 XN_C_API XnInt32 XN_C_DECL xnOSMemCmp(const void *pBuf1, const void *pBuf2, XnSizeT nCount);
 XN_C_API void XN_C_DECL xnOSMemSet(void* pDest, XnUInt8 nValue, XnSizeT nCount);
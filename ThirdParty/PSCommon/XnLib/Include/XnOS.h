@@ -94,6 +94,13 @@ typedef enum {
 	XN_OS_SEEK_END
 } XnOSSeekType;
 
+/** A piece of memory to be written by xnOSWriteFileGather(). */ 
+typedef struct XnOSFileSegment
+{
+	const void* pData;
+	XnUInt32 nSize;
+} XnOSFileSegment;
+
 //---------------------------------------------------------------------------
 // Network
 //---------------------------------------------------------------------------
@@ -312,6 +319,18 @@ typedef enum {
 // Common
 XN_C_API XnStatus XN_C_DECL xnOSGetInfo(xnOSInfo* pOSInfo);
 
+/** Instruction set extensions that optimized code paths can be selected by at runtime. */
+typedef enum XnCPUFeature
+{
+	XN_CPU_FEATURE_SSE2		= 0x01,
+	XN_CPU_FEATURE_SSSE3	= 0x02,
+	XN_CPU_FEATURE_SSE41	= 0x04,
+	XN_CPU_FEATURE_AVX2		= 0x08,
+} XnCPUFeature;
+
+/** Checks if the CPU (and the OS, for AVX state) supports an instruction set extension. */
+XN_C_API XnBool XN_C_DECL xnOSIsCPUFeatureSupported(XnCPUFeature feature);
+
 
 #if XN_PLATFORM_VAARGS_TYPE == XN_PLATFORM_USE_WIN32_VAARGS_STYLE
 	#define XN_NEW(type, ...)		new type(__VA_ARGS__)
@@ -441,6 +460,8 @@ XN_C_API XnStatus XN_C_DECL xnOSOpenFile(const XnChar* cpFileName, const XnUInt3
 XN_C_API XnStatus XN_C_DECL xnOSCloseFile(XN_FILE_HANDLE* pFile);
 XN_C_API XnStatus XN_C_DECL xnOSReadFile(const XN_FILE_HANDLE File, void* pBuffer, XnUInt32* pnBufferSize);
 XN_C_API XnStatus XN_C_DECL xnOSWriteFile(const XN_FILE_HANDLE File, const void* pBuffer, const XnUInt32 nBufferSize);
+/** Writes several buffers one after the other, with a single call to the OS where possible. */ 
+XN_C_API XnStatus XN_C_DECL xnOSWriteFileGather(const XN_FILE_HANDLE File, const XnOSFileSegment* aSegments, const XnUInt32 nSegments);
 XN_C_API XnStatus XN_API_DEPRECATED("Use xnOSSeekFile64() instead") XN_C_DECL 
 			    xnOSSeekFile  (const XN_FILE_HANDLE File, const XnOSSeekType SeekType, const XnInt32 nOffset);
 XN_C_API XnStatus XN_C_DECL xnOSSeekFile64(const XN_FILE_HANDLE File, const XnOSSeekType SeekType, const XnInt64 nOffset);
@@ -449,6 +470,9 @@ XN_C_API XnStatus XN_API_DEPRECATED("Use xnOSTellFile64() instead") XN_C_DECL
 XN_C_API XnStatus XN_C_DECL xnOSTellFile64(const XN_FILE_HANDLE File, XnUInt64* nFilePos);
 XN_C_API XnStatus XN_C_DECL xnOSTruncateFile64(const XN_FILE_HANDLE File, XnUInt64 nFilePos);
 XN_C_API XnStatus XN_C_DECL xnOSFlushFile(const XN_FILE_HANDLE File);
+/** Maps a whole file into memory for reading. Pages are copy-on-write, so writing to them never reaches the file. */ 
+XN_C_API XnStatus XN_C_DECL xnOSMapFile(const XnChar* cpFileName, void** ppData, XnUInt64* pnSize);
+XN_C_API XnStatus XN_C_DECL xnOSUnmapFile(void* pData, XnUInt64 nSize);
 XN_C_API XnStatus XN_C_DECL xnOSDoesFileExist(const XnChar* cpFileName, XnBool* pbResult);
 XN_C_API XnStatus XN_C_DECL xnOSDoesDirectoryExist(const XnChar* cpDirName, XnBool* pbResult);
 XN_C_API XnStatus XN_C_DECL xnOSLoadFile(const XnChar* cpFileName, void* pBuffer, const XnUInt32 nBufferSize);
@@ -457,6 +481,8 @@ XN_C_API XnStatus XN_C_DECL xnOSAppendFile(const XnChar* cpFileName, const void*
 XN_C_API XnStatus XN_API_DEPRECATED("Use xnOSGetFileSize64() instead") XN_C_DECL 
 			    xnOSGetFileSize  (const XnChar* cpFileName, XnUInt32* pnFileSize);
 XN_C_API XnStatus XN_C_DECL xnOSGetFileSize64(const XnChar* cpFileName, XnUInt64* pnFileSize);
+/** Gets the time a file was last modified, in OS specific units. Only meant to be compared with other values it returned. */
+XN_C_API XnStatus XN_C_DECL xnOSGetFileModificationTime(const XnChar* cpFileName, XnUInt64* pnTime);
 XN_C_API XnStatus XN_C_DECL xnOSCreateDirectory(const XnChar* cpDirName);
 XN_C_API XnStatus XN_C_DECL xnOSGetDirName(const XnChar* cpFilePath, XnChar* cpDirName, const XnUInt32 nBufferSize);
 XN_C_API XnStatus XN_C_DECL xnOSGetFileName(const XnChar* cpFilePath, XnChar* cpFileName, const XnUInt32 nBufferSize);
@@ -549,6 +575,22 @@ XN_C_API XnStatus XN_C_DECL xnOSSetThreadPriority(XN_THREAD_HANDLE ThreadHandle,
 XN_C_API XnStatus XN_C_DECL xnOSGetCurrentThreadID(XN_THREAD_ID* pThreadID);
 XN_C_API XnStatus XN_C_DECL xnOSWaitAndTerminateThread(XN_THREAD_HANDLE* pThreadHandle, XnUInt32 nMilliseconds);
 XN_C_API XnBool XN_C_DECL xnOSDoesThreadExistByID(XN_THREAD_ID threadId);
+/** Returns the number of logical processors available (at least 1). */
+XN_C_API XnUInt32 XN_C_DECL xnOSGetProcessorCount();
+
+// Atomics (all operations act as full memory barriers)
+/** Atomically increments the value and returns the incremented value. */
+XN_C_API XnInt32 XN_C_DECL xnOSAtomicIncrement(volatile XnInt32* pValue);
+/** Atomically decrements the value and returns the decremented value. */
+XN_C_API XnInt32 XN_C_DECL xnOSAtomicDecrement(volatile XnInt32* pValue);
+/** Atomically adds nAddend to the value and returns the new value. */
+XN_C_API XnInt32 XN_C_DECL xnOSAtomicAdd(volatile XnInt32* pValue, XnInt32 nAddend);
+/** Sets the value to nExchange if it equals nComparand. Returns the value it had before the call. */
+XN_C_API XnInt32 XN_C_DECL xnOSAtomicCompareExchange(volatile XnInt32* pValue, XnInt32 nExchange, XnInt32 nComparand);
+/** Sets the pointer to pExchange if it equals pComparand. Returns the pointer it had before the call. */
+XN_C_API void* XN_C_DECL xnOSAtomicCompareExchangePointer(void* volatile* ppValue, void* pExchange, void* pComparand);
+/** Issues a full memory barrier. */
+XN_C_API void XN_C_DECL xnOSMemoryBarrier();
 
 // Processes
 XN_C_API XnStatus XN_C_DECL xnOSGetCurrentProcessID(XN_PROCESS_ID* pProcID);
@@ -63,6 +63,20 @@ public:
 		}
 		return XN_STATUS_IS_EMPTY;
 	}
+	// Removes the first value (in pop order) of the given priority for which pMatch returns true.
+	XnStatus RemoveFirst(int priority, XnBool (*pMatch)(const T& value), T& value)
+	{
+		Queue<T, TAlloc>& queue = m_queues[priority];
+		for (typename Queue<T, TAlloc>::ConstIterator it = queue.Begin(); it != queue.End(); ++it)
+		{
+			if (pMatch(*it))
+			{
+				value = *it;
+				return queue.Remove(it);
+			}
+		}
+		return XN_STATUS_NO_MATCH;
+	}
 
 	const T& Top() const
 	{
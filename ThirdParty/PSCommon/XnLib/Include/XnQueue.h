@@ -63,6 +63,10 @@ public:
 		value = *it;
 		return Base::Remove(it);
 	}
+	XnStatus Remove(ConstIterator where)
+	{
+		return Base::Remove(where);
+	}
 
 	const T& Top() const
 	{
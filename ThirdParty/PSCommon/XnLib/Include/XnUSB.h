@@ -124,4 +124,16 @@ XN_C_API XnStatus XN_API_DEPRECATED("Use xnUSBRegisterToConnectivityEvents() ins
 XN_C_API XnStatus XN_C_DECL xnUSBRegisterToConnectivityEvents(XnUInt16 nVendorID, XnUInt16 nProductID, XnUSBDeviceCallbackFunctionPtr pFunc, void* pCookie, XnRegistrationHandle* phRegistration);
 XN_C_API void XN_C_DECL xnUSBUnregisterFromConnectivityEvents(XnRegistrationHandle hRegistration);
 
+// Capture and replay. A capture records the control transfers, end point calls and read thread data of an open
+// device to a file, until the device is closed (or the capture is stopped). Opening a capture file by path (instead
+// of a device path) returns a device that replays it: calls get the results that were captured, in the order they
+// were captured, and read threads get the captured data, no earlier than it was received relative to the transfers
+// around it, at the replay speed.
+XN_C_API XnStatus XN_C_DECL xnUSBStartCapture(XN_USB_DEV_HANDLE pDevHandle, const XnChar* strFileName, XnUInt16 nVendorID, XnUInt16 nProductID);
+XN_C_API XnStatus XN_C_DECL xnUSBStopCapture(XN_USB_DEV_HANDLE pDevHandle);
+XN_C_API XnBool XN_C_DECL xnUSBIsCaptureFile(const XnChar* strFileName, XnUInt16* pnVendorID, XnUInt16* pnProductID);
+XN_C_API XnBool XN_C_DECL xnUSBIsReplayDevice(XN_USB_DEV_HANDLE pDevHandle);
+/// 1.0 replays the data as fast as it was captured, 2.0 twice as fast, and 0 as fast as possible.
+XN_C_API XnStatus XN_C_DECL xnUSBSetReplaySpeed(XN_USB_DEV_HANDLE pDevHandle, XnDouble dSpeed);
+
 #endif //_XN_USB_H_
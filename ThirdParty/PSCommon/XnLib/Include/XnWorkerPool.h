@@ -0,0 +1,209 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _XN_WORKER_POOL_H_
+#define _XN_WORKER_POOL_H_
+
+#include "XnOSCpp.h"
+
+namespace xnl
+{
+
+/**
+* A fixed set of threads for splitting a job into parts. Run() executes the parts on the workers
+* and on the calling thread, and returns once all of them are done. Jobs are run one at a time.
+* A pool with no workers (or one that failed to start them) simply runs everything on the caller.
+*/
+class WorkerPool
+{
+public:
+	typedef void (XN_CALLBACK_TYPE* TaskFunc)(XnUInt32 nTask, void* pCookie);
+
+	WorkerPool() : m_aWorkers(NULL), m_nWorkers(0), m_hDone(NULL), m_bStop(FALSE), m_pFunc(NULL), m_pCookie(NULL), m_nTasks(0), m_nNextTask(0), m_nRunning(0) {}
+	~WorkerPool()
+	{
+		Shutdown();
+	}
+
+	/** Starts nThreads-1 worker threads (the caller of Run() is the last one). On failure, the pool is left without workers. */
+	XnStatus Init(XnUInt32 nThreads)
+	{
+		XnStatus nRetVal = XN_STATUS_OK;
+
+		Shutdown();
+
+		if (nThreads <= 1)
+		{
+			return XN_STATUS_OK;
+		}
+
+		nRetVal = xnOSCreateEvent(&m_hDone, FALSE);
+		XN_IS_STATUS_OK(nRetVal);
+
+		m_aWorkers = XN_NEW_ARR(Worker, nThreads - 1);
+		XN_VALIDATE_ALLOC_PTR(m_aWorkers);
+
+		for (XnUInt32 i = 0; i < nThreads - 1; ++i)
+		{
+			Worker& worker = m_aWorkers[i];
+			worker.pPool = this;
+
+			nRetVal = xnOSCreateEvent(&worker.hStart, FALSE);
+			if (nRetVal == XN_STATUS_OK)
+			{
+				nRetVal = xnOSCreateThread(WorkerThread, &worker, &worker.hThread);
+			}
+			if (nRetVal != XN_STATUS_OK)
+			{
+				if (worker.hStart != NULL)
+				{
+					xnOSCloseEvent(&worker.hStart);
+				}
+				Shutdown();
+				return nRetVal;
+			}
+
+			++m_nWorkers;
+		}
+
+		return XN_STATUS_OK;
+	}
+
+	void Shutdown()
+	{
+		if (m_aWorkers != NULL)
+		{
+			m_bStop = TRUE;
+			for (XnUInt32 i = 0; i < m_nWorkers; ++i)
+			{
+				xnOSSetEvent(m_aWorkers[i].hStart);
+				xnOSWaitForThreadExit(m_aWorkers[i].hThread, XN_WAIT_INFINITE);
+				xnOSCloseThread(&m_aWorkers[i].hThread);
+				xnOSCloseEvent(&m_aWorkers[i].hStart);
+			}
+			XN_DELETE_ARR(m_aWorkers);
+			m_aWorkers = NULL;
+			m_nWorkers = 0;
+			m_bStop = FALSE;
+		}
+
+		if (m_hDone != NULL)
+		{
+			xnOSCloseEvent(&m_hDone);
+			m_hDone = NULL;
+		}
+	}
+
+	/** Number of threads that run tasks, including the caller. */
+	XnUInt32 GetThreadCount() const { return m_nWorkers + 1; }
+
+	/** Calls pFunc(i, pCookie) for every i in [0, nTasks), and waits for all calls to return. */
+	void Run(XnUInt32 nTasks, TaskFunc pFunc, void* pCookie)
+	{
+		AutoCSLocker locker(m_runLock);
+
+		XnUInt32 nWake = XN_MIN(m_nWorkers, nTasks > 0 ? nTasks - 1 : 0);
+
+		m_pFunc = pFunc;
+		m_pCookie = pCookie;
+		m_nTasks = nTasks;
+		m_nNextTask = 0;
+		m_nRunning = (XnInt32)nWake;
+
+		for (XnUInt32 i = 0; i < nWake; ++i)
+		{
+			xnOSSetEvent(m_aWorkers[i].hStart);
+		}
+
+		RunTasks();
+
+		if (nWake > 0)
+		{
+			xnOSWaitEvent(m_hDone, XN_WAIT_INFINITE);
+		}
+	}
+
+private:
+	WorkerPool(const WorkerPool&);
+	WorkerPool& operator=(const WorkerPool&);
+
+	struct Worker
+	{
+		Worker() : pPool(NULL), hThread(NULL), hStart(NULL) {}
+
+		WorkerPool* pPool;
+		XN_THREAD_HANDLE hThread;
+		XN_EVENT_HANDLE hStart;
+	};
+
+	void RunTasks()
+	{
+		for (;;)
+		{
+			XnUInt32 nTask = (XnUInt32)(xnOSAtomicIncrement(&m_nNextTask) - 1);
+			if (nTask >= m_nTasks)
+			{
+				break;
+			}
+			m_pFunc(nTask, m_pCookie);
+		}
+	}
+
+	static XN_THREAD_PROC WorkerThread(XN_THREAD_PARAM pThreadParam)
+	{
+		Worker* pWorker = (Worker*)pThreadParam;
+		WorkerPool* pThis = pWorker->pPool;
+
+		for (;;)
+		{
+			xnOSWaitEvent(pWorker->hStart, XN_WAIT_INFINITE);
+			if (pThis->m_bStop)
+			{
+				break;
+			}
+
+			pThis->RunTasks();
+
+			if (xnOSAtomicDecrement(&pThis->m_nRunning) == 0)
+			{
+				xnOSSetEvent(pThis->m_hDone);
+			}
+		}
+
+		XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+	}
+
+	Worker* m_aWorkers;
+	XnUInt32 m_nWorkers;
+	XN_EVENT_HANDLE m_hDone;
+	volatile XnBool m_bStop;
+	CriticalSection m_runLock;
+
+	// current job
+	TaskFunc m_pFunc;
+	void* m_pCookie;
+	XnUInt32 m_nTasks;
+	volatile XnInt32 m_nNextTask;
+	volatile XnInt32 m_nRunning;
+};
+
+} // xnl
+
+#endif // _XN_WORKER_POOL_H_
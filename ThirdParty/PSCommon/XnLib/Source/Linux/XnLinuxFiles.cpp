@@ -39,6 +39,9 @@
 #include <libgen.h>
 #include <errno.h>
 #include <limits.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <XnLog.h>
 
 //---------------------------------------------------------------------------
@@ -269,6 +272,61 @@ XN_C_API XnStatus xnOSWriteFile(const XN_FILE_HANDLE File, const void* pBuffer,
 	return (XN_STATUS_OK);
 }
 
+XN_C_API XnStatus xnOSWriteFileGather(const XN_FILE_HANDLE File, const XnOSFileSegment* aSegments, const XnUInt32 nSegments)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(aSegments);
+
+	// Make sure the actual file handle isn't invalid
+	if (File == XN_INVALID_FILE_HANDLE)
+	{
+		return XN_STATUS_OS_INVALID_FILE;
+	}
+
+	XnUInt32 nFirst = 0;
+	while (nFirst < nSegments)
+	{
+		struct iovec aVectors[16];
+		XnUInt32 nVectors = XN_MIN(nSegments - nFirst, (XnUInt32)(sizeof(aVectors) / sizeof(aVectors[0])));
+		for (XnUInt32 i = 0; i < nVectors; ++i)
+		{
+			aVectors[i].iov_base = (void*)aSegments[nFirst + i].pData;
+			aVectors[i].iov_len = aSegments[nFirst + i].nSize;
+		}
+
+		// Write all buffers at once, and continue from where the OS stopped if the write was partial
+		struct iovec* pVector = aVectors;
+		while (nVectors > 0)
+		{
+			ssize_t nBytesWritten = writev(File, pVector, nVectors);
+			if (nBytesWritten == -1)
+			{
+				if (errno == EINTR)
+				{
+					continue;
+				}
+				return XN_STATUS_OS_FILE_WRITE_FAILED;
+			}
+
+			while (nVectors > 0 && (size_t)nBytesWritten >= pVector->iov_len)
+			{
+				nBytesWritten -= pVector->iov_len;
+				++pVector;
+				--nVectors;
+				++nFirst;
+			}
+			if (nVectors > 0)
+			{
+				pVector->iov_base = (XnUInt8*)pVector->iov_base + nBytesWritten;
+				pVector->iov_len -= nBytesWritten;
+			}
+		}
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSSeekFile(const XN_FILE_HANDLE File, const XnOSSeekType SeekType, const XnInt32 nOffset)
 {
 	// Local function variables
@@ -467,6 +525,66 @@ XN_C_API XnStatus xnOSFlushFile(const XN_FILE_HANDLE File)
 	return XN_STATUS_OK;
 }
 
+XN_C_API XnStatus xnOSMapFile(const XnChar* cpFileName, void** ppData, XnUInt64* pnSize)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(cpFileName);
+	XN_VALIDATE_OUTPUT_PTR(ppData);
+	XN_VALIDATE_OUTPUT_PTR(pnSize);
+
+	int fd = open(cpFileName, O_RDONLY);
+	if (fd == -1)
+	{
+		return (errno == ENOENT) ? XN_STATUS_OS_FILE_NOT_FOUND : XN_STATUS_OS_FILE_OPEN_FAILED;
+	}
+
+	struct stat fileStat;
+	if (fstat(fd, &fileStat) == -1)
+	{
+		close(fd);
+		return XN_STATUS_OS_FILE_GET_SIZE_FAILED;
+	}
+
+	// empty files can't be mapped, and files larger than the address space can't either
+	XnUInt64 nSize = (XnUInt64)fileStat.st_size;
+	if (nSize == 0 || nSize != (XnUInt64)(size_t)nSize)
+	{
+		close(fd);
+		return XN_STATUS_OS_FILE_OPEN_FAILED;
+	}
+
+	// the mapping holds its own reference to the file
+	void* pData = mmap(NULL, (size_t)nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (pData == MAP_FAILED)
+	{
+		return XN_STATUS_OS_FILE_OPEN_FAILED;
+	}
+
+	// files are mostly read from start to end
+	madvise(pData, (size_t)nSize, MADV_SEQUENTIAL);
+
+	*ppData = pData;
+	*pnSize = nSize;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnOSUnmapFile(void* pData, XnUInt64 nSize)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(pData);
+
+	if (munmap(pData, (size_t)nSize) == -1)
+	{
+		return XN_STATUS_OS_FILE_CLOSE_FAILED;
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSFileExists(const XnChar* cpFileName, XnBool* bResult)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
@@ -526,6 +644,28 @@ XN_C_API XnStatus xnOSGetFileSize64(const XnChar* cpFileName, XnUInt64* pnFileSi
 	return (XN_STATUS_OK);
 }
 
+XN_C_API XnStatus xnOSGetFileModificationTime(const XnChar* cpFileName, XnUInt64* pnTime)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(cpFileName);
+	XN_VALIDATE_OUTPUT_PTR(pnTime);
+
+	struct stat fileStat;
+	if (-1 == stat(cpFileName, &fileStat))
+	{
+		return (XN_STATUS_OS_FILE_NOT_FOUND);
+	}
+
+	// in nanoseconds, so that a file rewritten within the same second still changes it
+#if (XN_PLATFORM == XN_PLATFORM_MACOSX)
+	*pnTime = (XnUInt64)fileStat.st_mtimespec.tv_sec * 1000000000 + fileStat.st_mtimespec.tv_nsec;
+#else
+	*pnTime = (XnUInt64)fileStat.st_mtim.tv_sec * 1000000000 + fileStat.st_mtim.tv_nsec;
+#endif
+
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSCreateDirectory(const XnChar* cpDirName)
 {
 	// Local function variables
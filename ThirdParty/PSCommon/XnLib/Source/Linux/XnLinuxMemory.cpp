@@ -30,6 +30,12 @@
 	#include <malloc.h>
 #endif
 #include <XnLog.h>
+#include <sys/mman.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_HUGE_PAGE_SIZE	(2 * 1024 * 1024)
 
 //---------------------------------------------------------------------------
 // Code
@@ -113,6 +119,46 @@ XN_C_API void  xnOSFreeAligned(const void* pMemBlock)
 	free ((void*)pMemBlock);
 }
 
+static XnSizeT xnOSHugePagesAllocSize(const XnSizeT nAllocSize)
+{
+	return (nAllocSize + XN_HUGE_PAGE_SIZE - 1) & ~((XnSizeT)XN_HUGE_PAGE_SIZE - 1);
+}
+
+XN_C_API void* xnOSMallocHugePages(const XnSizeT nAllocSize)
+{
+#ifdef MAP_HUGETLB
+	XnSizeT nSize = xnOSHugePagesAllocSize(nAllocSize);
+
+	// try reserved huge pages first
+	void* pResult = mmap(NULL, nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+
+#ifdef MADV_HUGEPAGE
+	if (pResult == MAP_FAILED)
+	{
+		// fall back to transparent huge pages
+		pResult = mmap(NULL, nSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (pResult != MAP_FAILED && 0 != madvise(pResult, nSize, MADV_HUGEPAGE))
+		{
+			munmap(pResult, nSize);
+			pResult = MAP_FAILED;
+		}
+	}
+#endif
+
+	return (pResult == MAP_FAILED) ? NULL : pResult;
+#else
+	return NULL;
+#endif
+}
+
+XN_C_API void xnOSFreeHugePages(void* pMemBlock, const XnSizeT nAllocSize)
+{
+	if (pMemBlock != NULL)
+	{
+		munmap(pMemBlock, xnOSHugePagesAllocSize(nAllocSize));
+	}
+}
+
 XN_C_API void xnOSMemCopy(void* pDest, const void* pSource, XnSizeT nCount)
 {
 	memcpy(pDest, pSource, nCount);
@@ -25,6 +25,7 @@
 #include <errno.h>
 #include <sys/time.h>
 #include <sys/resource.h>
+#include <unistd.h>
 #include <XnLog.h>
 
 //---------------------------------------------------------------------------
@@ -202,3 +203,38 @@ XN_C_API XnStatus xnOSGetCurrentThreadID(XN_THREAD_ID* pThreadID)
 	return (XN_STATUS_OK);
 }
 
+XN_C_API XnUInt32 xnOSGetProcessorCount()
+{
+	long nCount = sysconf(_SC_NPROCESSORS_ONLN);
+	return (nCount > 0) ? (XnUInt32)nCount : 1;
+}
+
+XN_C_API XnInt32 xnOSAtomicIncrement(volatile XnInt32* pValue)
+{
+	return __sync_add_and_fetch(pValue, 1);
+}
+
+XN_C_API XnInt32 xnOSAtomicDecrement(volatile XnInt32* pValue)
+{
+	return __sync_sub_and_fetch(pValue, 1);
+}
+
+XN_C_API XnInt32 xnOSAtomicAdd(volatile XnInt32* pValue, XnInt32 nAddend)
+{
+	return __sync_add_and_fetch(pValue, nAddend);
+}
+
+XN_C_API XnInt32 xnOSAtomicCompareExchange(volatile XnInt32* pValue, XnInt32 nExchange, XnInt32 nComparand)
+{
+	return __sync_val_compare_and_swap(pValue, nComparand, nExchange);
+}
+
+XN_C_API void* xnOSAtomicCompareExchangePointer(void* volatile* ppValue, void* pExchange, void* pComparand)
+{
+	return __sync_val_compare_and_swap(ppValue, pComparand, pExchange);
+}
+
+XN_C_API void xnOSMemoryBarrier()
+{
+	__sync_synchronize();
+}
@@ -743,7 +743,7 @@ XN_C_API XnStatus xnUSBOpenDevice(XnUInt16 nVendorID, XnUInt16 nProductID, void*
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBOpenDeviceByPath(const XnUSBConnectionString strDevicePath, XN_USB_DEV_HANDLE* pDevHandlePtr)
+XnStatus xnUSBPlatformSpecificOpenDeviceByPath(const XnUSBConnectionString strDevicePath, XN_USB_DEV_HANDLE* pDevHandlePtr)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 	
@@ -796,7 +796,7 @@ XN_C_API XnStatus xnUSBOpenDeviceByPath(const XnUSBConnectionString strDevicePat
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
+XnStatus xnUSBPlatformSpecificCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -817,7 +817,7 @@ XN_C_API XnStatus xnUSBCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed)
+XnStatus xnUSBPlatformSpecificGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -829,17 +829,17 @@ XN_C_API XnStatus xnUSBGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceS
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBSetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nConfig)
+XnStatus xnUSBPlatformSpecificSetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nConfig)
 {
 	return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
 }
 
-XN_C_API XnStatus xnUSBGetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnConfig)
+XnStatus xnUSBPlatformSpecificGetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnConfig)
 {
 	return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
 }
 
-XN_C_API XnStatus xnUSBSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface)
+XnStatus xnUSBPlatformSpecificSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -857,7 +857,7 @@ XN_C_API XnStatus xnUSBSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInter
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface)
+XnStatus xnUSBPlatformSpecificGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface)
 {
 	XnUInt8 nAltInterface;
 	int rc = libusb_control_transfer(pDevHandle->hDevice, 
@@ -874,7 +874,7 @@ XN_C_API XnStatus xnUSBGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInt
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr)
+XnStatus xnUSBPlatformSpecificOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -1014,7 +1014,7 @@ XN_C_API XnStatus xnUSBOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndP
 	return XN_STATUS_OK;
 }
 
-XN_C_API XnStatus xnUSBCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -1025,7 +1025,7 @@ XN_C_API XnStatus xnUSBCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
 	return XN_STATUS_OK;
 }
 
-XN_C_API XnStatus xnUSBGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize)
+XnStatus xnUSBPlatformSpecificGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize)
 {
 	// Validate xnUSB
 	XN_VALIDATE_USB_INIT();
@@ -1041,22 +1041,22 @@ XN_C_API XnStatus xnUSBGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUI
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBAbortEndPoint(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificAbortEndPoint(XN_USB_EP_HANDLE pEPHandle)
 {
 	return XN_STATUS_OS_UNSUPPORTED_FUNCTION;
 }
 
-XN_C_API XnStatus xnUSBFlushEndPoint(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificFlushEndPoint(XN_USB_EP_HANDLE pEPHandle)
 {
 	return XN_STATUS_OS_UNSUPPORTED_FUNCTION;
 }
 
-XN_C_API XnStatus xnUSBResetEndPoint(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificResetEndPoint(XN_USB_EP_HANDLE pEPHandle)
 {
 	return XN_STATUS_OS_UNSUPPORTED_FUNCTION;
 }
 
-XN_C_API XnStatus xnUSBSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -1109,7 +1109,7 @@ XN_C_API XnStatus xnUSBSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlTyp
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -1175,7 +1175,7 @@ XN_C_API XnStatus xnUSBReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControl
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -1227,7 +1227,7 @@ XN_C_API XnStatus xnUSBWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffe
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
 {
 	// validate parameters
 	XN_VALIDATE_USB_INIT();
@@ -1284,12 +1284,12 @@ XN_C_API XnStatus xnUSBReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
 {
 	return XN_STATUS_OS_UNSUPPORTED_FUNCTION;
 }
 
-XN_C_API XnStatus xnUSBFinishReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificFinishReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
 {	
 	return XN_STATUS_OS_UNSUPPORTED_FUNCTION;
 }
@@ -1524,7 +1524,7 @@ void xnTransferCallback(libusb_transfer *pTransfer)
 	}
 }
 
-XN_C_API XnStatus xnUSBInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUInt32 nNumBuffers, XnUInt32 nTimeOut, XnUSBReadCallbackFunctionPtr pCallbackFunction, void* pCallbackData)
+XnStatus xnUSBPlatformSpecificInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUInt32 nNumBuffers, XnUInt32 nTimeOut, XnUSBReadCallbackFunctionPtr pCallbackFunction, void* pCallbackData)
 {
 	XnStatus nRetVal = XN_STATUS_OK;
 	
@@ -1635,7 +1635,7 @@ XN_C_API XnStatus xnUSBInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBuff
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBShutdownReadThread(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificShutdownReadThread(XN_USB_EP_HANDLE pEPHandle)
 {
 	XN_VALIDATE_USB_INIT();
 	XN_VALIDATE_EP_HANDLE(pEPHandle);
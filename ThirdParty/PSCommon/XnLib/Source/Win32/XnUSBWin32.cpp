@@ -607,7 +607,7 @@ XnStatus xnUSBOpenDeviceImpl(const XnChar* strDevicePath, XN_USB_DEV_HANDLE* pDe
 	pDevHandle->bValid = TRUE;
 
 	// Read the current alt-if settings
-	nRetVal = xnUSBGetInterface(pDevHandle, &pInterfaceProp.nIF, &pInterfaceProp.nAltIF);
+	nRetVal = xnUSBPlatformSpecificGetInterface(pDevHandle, &pInterfaceProp.nIF, &pInterfaceProp.nAltIF);
 	if (nRetVal != XN_STATUS_OK)
 	{
 		XN_ALIGNED_FREE_AND_NULL(pDevHandle);
@@ -627,12 +627,12 @@ XN_C_API XnStatus xnUSBOpenDevice(XnUInt16 /*nVendorID*/, XnUInt16 /*nProductID*
 	return xnUSBOpenDeviceImpl((const XnChar*)pExtraParam2, pDevHandlePtr);
 }
 
-XN_C_API XnStatus xnUSBOpenDeviceByPath(const XnUSBConnectionString strDevicePath, XN_USB_DEV_HANDLE* pDevHandlePtr)
+XnStatus xnUSBPlatformSpecificOpenDeviceByPath(const XnUSBConnectionString strDevicePath, XN_USB_DEV_HANDLE* pDevHandlePtr)
 {
 	return xnUSBOpenDeviceImpl(strDevicePath, pDevHandlePtr);
 }
 
-XN_C_API XnStatus xnUSBCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
+XnStatus xnUSBPlatformSpecificCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
 {
 	// Validate xnUSB
 	XN_VALIDATE_USB_INIT();
@@ -648,7 +648,7 @@ XN_C_API XnStatus xnUSBCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
 	return (XN_STATUS_OK);	
 }
 
-XN_C_API XnStatus xnUSBGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed)
+XnStatus xnUSBPlatformSpecificGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed)
 {
 	// Validate xnUSB
 	XN_VALIDATE_USB_INIT();
@@ -664,17 +664,17 @@ XN_C_API XnStatus xnUSBGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceS
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBSetConfig(XN_USB_DEV_HANDLE /*pDevHandle*/, XnUInt8 /*nConfig*/)
+XnStatus xnUSBPlatformSpecificSetConfig(XN_USB_DEV_HANDLE /*pDevHandle*/, XnUInt8 /*nConfig*/)
 {
 	return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
 }
 
-XN_C_API XnStatus xnUSBGetConfig(XN_USB_DEV_HANDLE /*pDevHandle*/, XnUInt8* /*pnConfig*/)
+XnStatus xnUSBPlatformSpecificGetConfig(XN_USB_DEV_HANDLE /*pDevHandle*/, XnUInt8* /*pnConfig*/)
 {
 	return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
 }
 
-XN_C_API XnStatus xnUSBSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 /*nInterface*/, XnUInt8 nAltInterface)
+XnStatus xnUSBPlatformSpecificSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 /*nInterface*/, XnUInt8 nAltInterface)
 {
 	// Local variables
 	XnBool bResult = FALSE;
@@ -701,7 +701,7 @@ XN_C_API XnStatus xnUSBSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 /*nInt
 	return (XN_STATUS_OK);	
 }
 
-XN_C_API XnStatus xnUSBGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface)
+XnStatus xnUSBPlatformSpecificGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface)
 {
 	// Local variables
 	XnBool bResult = FALSE;
@@ -731,7 +731,7 @@ XN_C_API XnStatus xnUSBGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInt
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr)
+XnStatus xnUSBPlatformSpecificOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr)
 {
 	// Local variables
 	XnBool bResult = TRUE;
@@ -920,7 +920,7 @@ XN_C_API XnStatus xnUSBOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndP
 	return (XN_STATUS_USB_ENDPOINT_NOT_FOUND);
 }
 
-XN_C_API XnStatus xnUSBCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
 {
 	// Validate xnUSB
 	XN_VALIDATE_USB_INIT();
@@ -943,7 +943,7 @@ XN_C_API XnStatus xnUSBCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize)
+XnStatus xnUSBPlatformSpecificGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize)
 {
 	// Validate xnUSB
 	XN_VALIDATE_USB_INIT();
@@ -959,7 +959,7 @@ XN_C_API XnStatus xnUSBGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUI
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBAbortEndPoint(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificAbortEndPoint(XN_USB_EP_HANDLE pEPHandle)
 {
 	// Local variables
 	BOOL bResult = FALSE;
@@ -980,12 +980,12 @@ XN_C_API XnStatus xnUSBAbortEndPoint(XN_USB_EP_HANDLE pEPHandle)
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBFlushEndPoint(XN_USB_EP_HANDLE /*pEPHandle*/)
+XnStatus xnUSBPlatformSpecificFlushEndPoint(XN_USB_EP_HANDLE /*pEPHandle*/)
 {
 	return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
 }
 
-XN_C_API XnStatus xnUSBResetEndPoint(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificResetEndPoint(XN_USB_EP_HANDLE pEPHandle)
 {
 	// Local variables
 	BOOL bResult = FALSE;
@@ -1006,7 +1006,7 @@ XN_C_API XnStatus xnUSBResetEndPoint(XN_USB_EP_HANDLE pEPHandle)
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
 {
 	// Local variables
 	XnBool bResult = FALSE;
@@ -1052,7 +1052,7 @@ XN_C_API XnStatus xnUSBSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlTyp
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
 {
 	// Local variables
 	XnBool bResult = FALSE;
@@ -1112,7 +1112,7 @@ XN_C_API XnStatus xnUSBReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControl
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
 {
 	// Local variables
 	BOOL bResult = FALSE;
@@ -1153,7 +1153,7 @@ XN_C_API XnStatus xnUSBReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer
 	// Reset the endpoint
 	if (pEPHandle->nEPType == XN_USB_EP_ISOCHRONOUS)
 	{
-		nRetVal = xnUSBResetEndPoint(pEPHandle);
+		nRetVal = xnUSBPlatformSpecificResetEndPoint(pEPHandle);
 		XN_IS_STATUS_OK(nRetVal);
 	}
 
@@ -1184,7 +1184,7 @@ XN_C_API XnStatus xnUSBReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
 {
 	// Local variables
 	BOOL bResult = FALSE;
@@ -1222,7 +1222,7 @@ XN_C_API XnStatus xnUSBWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffe
 	// Reset the endpoint
 	if (pEPHandle->nEPType == XN_USB_EP_ISOCHRONOUS)
 	{
-		nRetVal = xnUSBResetEndPoint(pEPHandle);
+		nRetVal = xnUSBPlatformSpecificResetEndPoint(pEPHandle);
 		XN_IS_STATUS_OK(nRetVal);
 	}
 
@@ -1253,7 +1253,7 @@ XN_C_API XnStatus xnUSBWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffe
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
 {
 	// Local variables
 	BOOL bResult = FALSE;
@@ -1291,7 +1291,7 @@ XN_C_API XnStatus xnUSBQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pB
 	// Reset the endpoint
 	if (pEPHandle->nEPType == XN_USB_EP_ISOCHRONOUS)
 	{
-		nRetVal = xnUSBResetEndPoint(pEPHandle);
+		nRetVal = xnUSBPlatformSpecificResetEndPoint(pEPHandle);
 		XN_IS_STATUS_OK(nRetVal);
 	}
 
@@ -1312,7 +1312,7 @@ XN_C_API XnStatus xnUSBQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pB
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBFinishReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+XnStatus xnUSBPlatformSpecificFinishReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
 {	
 	// Local variables
 	XnBool bRetVal = TRUE;
@@ -1466,7 +1466,7 @@ XN_THREAD_PROC xnUSBReadThreadMain(XN_THREAD_PARAM pThreadParam)
 	}
 }
 
-XN_C_API XnStatus xnUSBInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUInt32 nNumBuffers, XnUInt32 nTimeOut, XnUSBReadCallbackFunctionPtr pCallbackFunction, PVOID pCallbackData)
+XnStatus xnUSBPlatformSpecificInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUInt32 nNumBuffers, XnUInt32 nTimeOut, XnUSBReadCallbackFunctionPtr pCallbackFunction, PVOID pCallbackData)
 {
 	// Local variables
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -1533,7 +1533,7 @@ XN_C_API XnStatus xnUSBInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBuff
 	return (XN_STATUS_OK);
 }
 
-XN_C_API XnStatus xnUSBShutdownReadThread(XN_USB_EP_HANDLE pEPHandle)
+XnStatus xnUSBPlatformSpecificShutdownReadThread(XN_USB_EP_HANDLE pEPHandle)
 {
 	// Local variables
 	XnStatus nRetVal = XN_STATUS_OK;
@@ -296,6 +296,22 @@ XN_C_API XnStatus xnOSWriteFile(const XN_FILE_HANDLE File, const void* pBuffer,
 	return (XN_STATUS_OK);
 }
 
+XN_C_API XnStatus xnOSWriteFileGather(const XN_FILE_HANDLE File, const XnOSFileSegment* aSegments, const XnUInt32 nSegments)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(aSegments);
+
+	// WriteFileGather() only works on unbuffered files, so simply write the buffers one by one
+	for (XnUInt32 i = 0; i < nSegments; ++i)
+	{
+		XnStatus nRetVal = xnOSWriteFile(File, aSegments[i].pData, aSegments[i].nSize);
+		XN_IS_STATUS_OK(nRetVal);
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSSeekFile(const XN_FILE_HANDLE File, const XnOSSeekType SeekType, const XnInt32 nOffset)
 {
 	// Local function variables
@@ -490,6 +506,70 @@ XN_C_API XnStatus xnOSFlushFile(const XN_FILE_HANDLE File)
 	return (XN_STATUS_OK);
 }
 
+XN_C_API XnStatus xnOSMapFile(const XnChar* cpFileName, void** ppData, XnUInt64* pnSize)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(cpFileName);
+	XN_VALIDATE_OUTPUT_PTR(ppData);
+	XN_VALIDATE_OUTPUT_PTR(pnSize);
+
+	HANDLE hFile = CreateFile(cpFileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+	{
+		return (GetLastError() == ERROR_FILE_NOT_FOUND) ? XN_STATUS_OS_FILE_NOT_FOUND : XN_STATUS_OS_FILE_OPEN_FAILED;
+	}
+
+	LARGE_INTEGER liSize;
+	if (!GetFileSizeEx(hFile, &liSize))
+	{
+		CloseHandle(hFile);
+		return XN_STATUS_OS_FILE_GET_SIZE_FAILED;
+	}
+
+	// empty files can't be mapped, and files larger than the address space can't either
+	XnUInt64 nSize = (XnUInt64)liSize.QuadPart;
+	if (nSize == 0 || nSize != (XnUInt64)(SIZE_T)nSize)
+	{
+		CloseHandle(hFile);
+		return XN_STATUS_OS_FILE_OPEN_FAILED;
+	}
+
+	// the view keeps the mapping (and the file) open after the handles are closed
+	HANDLE hMapping = CreateFileMapping(hFile, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+	CloseHandle(hFile);
+	if (hMapping == NULL)
+	{
+		return XN_STATUS_OS_FILE_OPEN_FAILED;
+	}
+
+	void* pData = MapViewOfFile(hMapping, FILE_MAP_COPY, 0, 0, (SIZE_T)nSize);
+	CloseHandle(hMapping);
+	if (pData == NULL)
+	{
+		return XN_STATUS_OS_FILE_OPEN_FAILED;
+	}
+
+	*ppData = pData;
+	*pnSize = nSize;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnOSUnmapFile(void* pData, XnUInt64 /*nSize*/)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(pData);
+
+	if (!UnmapViewOfFile(pData))
+	{
+		return XN_STATUS_OS_FILE_CLOSE_FAILED;
+	}
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSDeleteFile(const XnChar* cpFileName)
 {
 	// Validate the input/output pointers (to make sure none of them is NULL)
@@ -601,6 +681,24 @@ XN_C_API XnStatus xnOSGetFileSize64(const XnChar* cpFileName, XnUInt64* pnFileSi
 	return (XN_STATUS_OK);
 }
 
+XN_C_API XnStatus xnOSGetFileModificationTime(const XnChar* cpFileName, XnUInt64* pnTime)
+{
+	// Validate the input/output pointers (to make sure none of them is NULL)
+	XN_VALIDATE_INPUT_PTR(cpFileName);
+	XN_VALIDATE_OUTPUT_PTR(pnTime);
+
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesEx(cpFileName, GetFileExInfoStandard, &attributes))
+	{
+		return (XN_STATUS_OS_FILE_NOT_FOUND);
+	}
+
+	*pnTime = ((XnUInt64)attributes.ftLastWriteTime.dwHighDateTime << 32) | attributes.ftLastWriteTime.dwLowDateTime;
+
+	// All is good...
+	return (XN_STATUS_OK);
+}
+
 XN_C_API XnStatus xnOSCreateDirectory(const XnChar* cpDirName)
 {
 	// Local function variables
@@ -90,6 +90,38 @@ XN_C_API void  xnOSFreeAligned(const void* pMemBlock)
 	_aligned_free((void*)pMemBlock);
 }
 
+static XnSizeT xnOSHugePagesAllocSize(const XnSizeT nAllocSize)
+{
+	XnSizeT nPageSize = GetLargePageMinimum();
+	if (nPageSize == 0)
+	{
+		return 0;
+	}
+
+	return (nAllocSize + nPageSize - 1) / nPageSize * nPageSize;
+}
+
+XN_C_API void* xnOSMallocHugePages(const XnSizeT nAllocSize)
+{
+	XnSizeT nSize = xnOSHugePagesAllocSize(nAllocSize);
+	if (nSize == 0)
+	{
+		// large pages are not supported
+		return NULL;
+	}
+
+	// NOTE: this requires the SeLockMemoryPrivilege privilege. Otherwise, it will fail and we will return NULL.
+	return VirtualAlloc(NULL, nSize, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+}
+
+XN_C_API void xnOSFreeHugePages(void* pMemBlock, const XnSizeT /*nAllocSize*/)
+{
+	if (pMemBlock != NULL)
+	{
+		VirtualFree(pMemBlock, 0, MEM_RELEASE);
+	}
+}
+
 XN_C_API void xnOSMemCopy(void* pDest, const void* pSource, XnSizeT nCount)
 {
 	memcpy(pDest, pSource, nCount);
@@ -176,4 +176,41 @@ XN_C_API XnBool xnOSDoesThreadExistByID(XN_THREAD_ID threadId)
 	CloseHandle(h);
 	return TRUE;
 
-}
\ No newline at end of file
+}
+
+XN_C_API XnUInt32 xnOSGetProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors > 0) ? (XnUInt32)info.dwNumberOfProcessors : 1;
+}
+
+XN_C_API XnInt32 xnOSAtomicIncrement(volatile XnInt32* pValue)
+{
+	return InterlockedIncrement((volatile LONG*)pValue);
+}
+
+XN_C_API XnInt32 xnOSAtomicDecrement(volatile XnInt32* pValue)
+{
+	return InterlockedDecrement((volatile LONG*)pValue);
+}
+
+XN_C_API XnInt32 xnOSAtomicAdd(volatile XnInt32* pValue, XnInt32 nAddend)
+{
+	return InterlockedExchangeAdd((volatile LONG*)pValue, nAddend) + nAddend;
+}
+
+XN_C_API XnInt32 xnOSAtomicCompareExchange(volatile XnInt32* pValue, XnInt32 nExchange, XnInt32 nComparand)
+{
+	return InterlockedCompareExchange((volatile LONG*)pValue, nExchange, nComparand);
+}
+
+XN_C_API void* xnOSAtomicCompareExchangePointer(void* volatile* ppValue, void* pExchange, void* pComparand)
+{
+	return InterlockedCompareExchangePointer(ppValue, pExchange, pComparand);
+}
+
+XN_C_API void xnOSMemoryBarrier()
+{
+	MemoryBarrier();
+}
@@ -24,6 +24,19 @@
 #include <XnOS.h>
 #include <XnLog.h>
 
+#if defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+	#include <intrin.h>
+	#define XN_CPUID_SUPPORTED
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+	#include <cpuid.h>
+	#define XN_CPUID_SUPPORTED
+#endif
+
+//---------------------------------------------------------------------------
+// Globals
+//---------------------------------------------------------------------------
+static volatile XnInt32 g_nCPUFeatures = -1;
+
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
@@ -73,3 +86,86 @@ XnStatus xnOSWaitForCondition(const XN_EVENT_HANDLE EventHandle, XnUInt32 nMilli
 	// condition was met
 	return (XN_STATUS_OK);
 }
+
+#ifdef XN_CPUID_SUPPORTED
+static void xnOSCPUID(XnUInt32 nLeaf, XnUInt32 nSubLeaf, XnUInt32 aRegs[4])
+{
+#if defined(_MSC_VER)
+	int aInfo[4];
+	__cpuidex(aInfo, (int)nLeaf, (int)nSubLeaf);
+	for (int i = 0; i < 4; ++i)
+	{
+		aRegs[i] = (XnUInt32)aInfo[i];
+	}
+#else
+	__cpuid_count(nLeaf, nSubLeaf, aRegs[0], aRegs[1], aRegs[2], aRegs[3]);
+#endif
+}
+
+static XnUInt64 xnOSGetEnabledXStateFeatures()
+{
+#if defined(_MSC_VER)
+	return _xgetbv(0);
+#else
+	XnUInt32 nLow, nHigh;
+	__asm__ __volatile__ ("xgetbv" : "=a"(nLow), "=d"(nHigh) : "c"(0));
+	return ((XnUInt64)nHigh << 32) | nLow;
+#endif
+}
+
+static XnInt32 xnOSDetectCPUFeatures()
+{
+	XnInt32 nFeatures = 0;
+	XnUInt32 aRegs[4]; // eax, ebx, ecx, edx
+
+	xnOSCPUID(0, 0, aRegs);
+	XnUInt32 nMaxLeaf = aRegs[0];
+	if (nMaxLeaf < 1)
+	{
+		return nFeatures;
+	}
+
+	xnOSCPUID(1, 0, aRegs);
+	if (aRegs[3] & (1 << 26))
+	{
+		nFeatures |= XN_CPU_FEATURE_SSE2;
+	}
+	if (aRegs[2] & (1 << 9))
+	{
+		nFeatures |= XN_CPU_FEATURE_SSSE3;
+	}
+	if (aRegs[2] & (1 << 19))
+	{
+		nFeatures |= XN_CPU_FEATURE_SSE41;
+	}
+
+	// AVX2 also needs the OS to save the YMM registers (OSXSAVE, and XCR0 bits 1-2)
+	XnBool bAVXState = (aRegs[2] & (1 << 27)) && (aRegs[2] & (1 << 28)) && ((xnOSGetEnabledXStateFeatures() & 0x6) == 0x6);
+	if (bAVXState && nMaxLeaf >= 7)
+	{
+		xnOSCPUID(7, 0, aRegs);
+		if (aRegs[1] & (1 << 5))
+		{
+			nFeatures |= XN_CPU_FEATURE_AVX2;
+		}
+	}
+
+	return nFeatures;
+}
+#endif
+
+XN_C_API XnBool xnOSIsCPUFeatureSupported(XnCPUFeature feature)
+{
+#ifdef XN_CPUID_SUPPORTED
+	// detection has no side effects, so threads racing on the first call just do it twice
+	if (g_nCPUFeatures == -1)
+	{
+		g_nCPUFeatures = xnOSDetectCPUFeatures();
+	}
+
+	return ((g_nCPUFeatures & feature) != 0);
+#else
+	(void)feature;
+	return FALSE;
+#endif
+}
@@ -22,18 +22,14 @@
 // Includes
 //---------------------------------------------------------------------------
 #include <XnUSB.h>
+#include "XnUSBInternal.h"
+#include "XnUSBCapture.h"
 
 //---------------------------------------------------------------------------
 // Global Variables
 //---------------------------------------------------------------------------
 XnUInt32 g_nRefCount = 0;
 
-//---------------------------------------------------------------------------
-// Function Declaration
-//---------------------------------------------------------------------------
-XnStatus xnUSBPlatformSpecificInit();
-XnStatus xnUSBPlatformSpecificShutdown();
-
 //---------------------------------------------------------------------------
 // Code
 //---------------------------------------------------------------------------
@@ -67,3 +63,249 @@ XN_C_API XnStatus xnUSBShutdown()
 
 	return (XN_STATUS_OK);
 }
+
+XN_C_API XnStatus xnUSBOpenDeviceByPath(const XnUSBConnectionString strDevicePath, XN_USB_DEV_HANDLE* pDevHandlePtr)
+{
+	XN_VALIDATE_USB_INIT();
+
+	if (xnUSBIsCaptureFile(strDevicePath, NULL, NULL))
+	{
+		return xnUSBReplayOpenDevice(strDevicePath, pDevHandlePtr);
+	}
+
+	return xnUSBPlatformSpecificOpenDeviceByPath(strDevicePath, pDevHandlePtr);
+}
+
+XN_C_API XnStatus xnUSBCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return xnUSBReplayCloseDevice(pDevHandle);
+	}
+
+	xnUSBCaptureDeviceClosed(pDevHandle);
+
+	return xnUSBPlatformSpecificCloseDevice(pDevHandle);
+}
+
+XN_C_API XnStatus xnUSBGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return xnUSBReplayGetDeviceSpeed(pDevHandle, pDevSpeed);
+	}
+
+	return xnUSBPlatformSpecificGetDeviceSpeed(pDevHandle, pDevSpeed);
+}
+
+XN_C_API XnStatus xnUSBSetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nConfig)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
+	}
+
+	return xnUSBPlatformSpecificSetConfig(pDevHandle, nConfig);
+}
+
+XN_C_API XnStatus xnUSBGetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnConfig)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
+	}
+
+	return xnUSBPlatformSpecificGetConfig(pDevHandle, pnConfig);
+}
+
+XN_C_API XnStatus xnUSBSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return xnUSBReplaySetInterface(pDevHandle, nInterface, nAltInterface);
+	}
+
+	XnStatus nRetVal = xnUSBPlatformSpecificSetInterface(pDevHandle, nInterface, nAltInterface);
+	xnUSBCaptureSetInterface(pDevHandle, nInterface, nAltInterface, nRetVal);
+
+	return (nRetVal);
+}
+
+XN_C_API XnStatus xnUSBGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return xnUSBReplayGetInterface(pDevHandle, pnInterface, pnAltInterface);
+	}
+
+	return xnUSBPlatformSpecificGetInterface(pDevHandle, pnInterface, pnAltInterface);
+}
+
+XN_C_API XnStatus xnUSBOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return xnUSBReplayOpenEndPoint(pDevHandle, nEndPointID, nEPType, nDirType, pEPHandlePtr);
+	}
+
+	XnStatus nRetVal = xnUSBPlatformSpecificOpenEndPoint(pDevHandle, nEndPointID, nEPType, nDirType, pEPHandlePtr);
+	xnUSBCaptureOpenEndPoint(pDevHandle, nEndPointID, nEPType, nDirType, nRetVal == XN_STATUS_OK ? *pEPHandlePtr : NULL, nRetVal);
+
+	return (nRetVal);
+}
+
+XN_C_API XnStatus xnUSBCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return xnUSBReplayCloseEndPoint(pEPHandle);
+	}
+
+	xnUSBCaptureEndPointClosed(pEPHandle);
+
+	return xnUSBPlatformSpecificCloseEndPoint(pEPHandle);
+}
+
+XN_C_API XnStatus xnUSBGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return xnUSBReplayGetEndPointMaxPacketSize(pEPHandle, pnMaxPacketSize);
+	}
+
+	return xnUSBPlatformSpecificGetEndPointMaxPacketSize(pEPHandle, pnMaxPacketSize);
+}
+
+XN_C_API XnStatus xnUSBAbortEndPoint(XN_USB_EP_HANDLE pEPHandle)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		// nothing is ever pending
+		return (XN_STATUS_OK);
+	}
+
+	return xnUSBPlatformSpecificAbortEndPoint(pEPHandle);
+}
+
+XN_C_API XnStatus xnUSBFlushEndPoint(XN_USB_EP_HANDLE pEPHandle)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return (XN_STATUS_OK);
+	}
+
+	return xnUSBPlatformSpecificFlushEndPoint(pEPHandle);
+}
+
+XN_C_API XnStatus xnUSBResetEndPoint(XN_USB_EP_HANDLE pEPHandle)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return (XN_STATUS_OK);
+	}
+
+	return xnUSBPlatformSpecificResetEndPoint(pEPHandle);
+}
+
+XN_C_API XnStatus xnUSBSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return xnUSBReplaySendControl(pDevHandle, nType, nRequest, nValue, nIndex, pBuffer, nBufferSize);
+	}
+
+	XnStatus nRetVal = xnUSBPlatformSpecificSendControl(pDevHandle, nType, nRequest, nValue, nIndex, pBuffer, nBufferSize, nTimeOut);
+	xnUSBCaptureControl(pDevHandle, XN_USB_CAPTURE_RECORD_SEND_CONTROL, nType, nRequest, nValue, nIndex, pBuffer, nBufferSize, nRetVal);
+
+	return (nRetVal);
+}
+
+XN_C_API XnStatus xnUSBReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+{
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return xnUSBReplayReceiveControl(pDevHandle, nType, nRequest, nValue, nIndex, pBuffer, nBufferSize, pnBytesReceived);
+	}
+
+	XnStatus nRetVal = xnUSBPlatformSpecificReceiveControl(pDevHandle, nType, nRequest, nValue, nIndex, pBuffer, nBufferSize, pnBytesReceived, nTimeOut);
+	xnUSBCaptureControl(pDevHandle, XN_USB_CAPTURE_RECORD_RECEIVE_CONTROL, nType, nRequest, nValue, nIndex, pBuffer, nRetVal == XN_STATUS_OK ? *pnBytesReceived : 0, nRetVal);
+
+	return (nRetVal);
+}
+
+XN_C_API XnStatus xnUSBReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return xnUSBReplayReadEndPoint(pEPHandle, pBuffer, nBufferSize, pnBytesReceived);
+	}
+
+	XnStatus nRetVal = xnUSBPlatformSpecificReadEndPoint(pEPHandle, pBuffer, nBufferSize, pnBytesReceived, nTimeOut);
+	xnUSBCaptureEndPointTransfer(pEPHandle, XN_USB_CAPTURE_RECORD_READ_END_POINT, pBuffer, nRetVal == XN_STATUS_OK ? *pnBytesReceived : 0, nRetVal);
+
+	return (nRetVal);
+}
+
+XN_C_API XnStatus xnUSBWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return xnUSBReplayWriteEndPoint(pEPHandle, pBuffer, nBufferSize);
+	}
+
+	XnStatus nRetVal = xnUSBPlatformSpecificWriteEndPoint(pEPHandle, pBuffer, nBufferSize, nTimeOut);
+	xnUSBCaptureEndPointTransfer(pEPHandle, XN_USB_CAPTURE_RECORD_WRITE_END_POINT, pBuffer, nBufferSize, nRetVal);
+
+	return (nRetVal);
+}
+
+XN_C_API XnStatus xnUSBQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
+	}
+
+	return xnUSBPlatformSpecificQueueReadEndPoint(pEPHandle, pBuffer, nBufferSize, nTimeOut);
+}
+
+XN_C_API XnStatus xnUSBFinishReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return (XN_STATUS_OS_UNSUPPORTED_FUNCTION);
+	}
+
+	return xnUSBPlatformSpecificFinishReadEndPoint(pEPHandle, pnBytesReceived, nTimeOut);
+}
+
+XN_C_API XnStatus xnUSBInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUInt32 nNumBuffers, XnUInt32 nTimeOut, XnUSBReadCallbackFunctionPtr pCallbackFunction, void* pCallbackData)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return xnUSBReplayInitReadThread(pEPHandle, nBufferSize, pCallbackFunction, pCallbackData);
+	}
+
+	XnBool bWrapped = xnUSBCaptureWrapReadCallback(pEPHandle, &pCallbackFunction, &pCallbackData);
+
+	XnStatus nRetVal = xnUSBPlatformSpecificInitReadThread(pEPHandle, nBufferSize, nNumBuffers, nTimeOut, pCallbackFunction, pCallbackData);
+	if (nRetVal != XN_STATUS_OK && bWrapped)
+	{
+		xnUSBCaptureReadThreadShutdown(pEPHandle);
+	}
+
+	return (nRetVal);
+}
+
+XN_C_API XnStatus xnUSBShutdownReadThread(XN_USB_EP_HANDLE pEPHandle)
+{
+	if (xnUSBIsReplayEndPoint(pEPHandle))
+	{
+		return xnUSBReplayShutdownReadThread(pEPHandle);
+	}
+
+	XnStatus nRetVal = xnUSBPlatformSpecificShutdownReadThread(pEPHandle);
+	xnUSBCaptureReadThreadShutdown(pEPHandle);
+
+	return (nRetVal);
+}
@@ -0,0 +1,375 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "XnUSBCapture.h"
+#include "XnUSBInternal.h"
+#include <XnLog.h>
+#include <XnOSCpp.h>
+#include <XnHash.h>
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef struct XnUSBCapture
+{
+	XN_FILE_HANDLE hFile; // XN_INVALID_FILE_HANDLE once stopped
+	XnChar strFileName[XN_FILE_MAX_PATH];
+	XnUInt64 nStartTime;
+	// the device, and each read thread of it that is still running
+	XnUInt32 nRefCount;
+} XnUSBCapture;
+
+typedef struct XnUSBCaptureEndPoint
+{
+	XnUSBCapture* pCapture;
+	XnUInt16 nEndPointID;
+} XnUSBCaptureEndPoint;
+
+typedef struct XnUSBCaptureReadContext
+{
+	XnUSBCapture* pCapture;
+	XnUInt16 nEndPointID;
+	XnUSBReadCallbackFunctionPtr pCallbackFunction;
+	void* pCallbackData;
+} XnUSBCaptureReadContext;
+
+//---------------------------------------------------------------------------
+// Global Variables
+//---------------------------------------------------------------------------
+// All captures write under the same lock (records of a device must be written in the order its calls returned, and
+// there's rarely more than one device captured).
+static xnl::CriticalSection g_captureLock;
+static xnl::Hash<XN_USB_DEV_HANDLE, XnUSBCapture*> g_captureDevices;
+static xnl::Hash<XN_USB_EP_HANDLE, XnUSBCaptureEndPoint> g_captureEndPoints;
+static xnl::Hash<XN_USB_EP_HANDLE, XnUSBCaptureReadContext*> g_captureReadContexts;
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+static void xnUSBCaptureRelease(XnUSBCapture* pCapture)
+{
+	if (--pCapture->nRefCount == 0)
+	{
+		XN_DELETE(pCapture);
+	}
+}
+
+static void xnUSBCaptureStop(XnUSBCapture* pCapture)
+{
+	if (pCapture->hFile != XN_INVALID_FILE_HANDLE)
+	{
+		xnOSCloseFile(&pCapture->hFile);
+		pCapture->hFile = XN_INVALID_FILE_HANDLE;
+		xnLogInfo(XN_MASK_USB_CAPTURE, "USB capture '%s' stopped", pCapture->strFileName);
+	}
+}
+
+static void xnUSBCaptureInitRecord(XnUSBCapture* pCapture, XnUSBCaptureRecordType nType, XnStatus nResult, XnUSBCaptureRecordHeader* pRecord)
+{
+	xnOSMemSet(pRecord, 0, sizeof(*pRecord));
+	pRecord->nType = nType;
+	pRecord->nStatus = nResult;
+
+	XnUInt64 nNow;
+	xnOSGetHighResTimeStamp(&nNow);
+	pRecord->nTimestamp = nNow - pCapture->nStartTime;
+}
+
+// Should be called under g_captureLock
+static void xnUSBCaptureWriteRecord(XnUSBCapture* pCapture, XnUSBCaptureRecordHeader* pRecord, const XnUChar* pData)
+{
+	if (pCapture->hFile == XN_INVALID_FILE_HANDLE)
+	{
+		return;
+	}
+
+	XnStatus nRetVal = xnOSWriteFile(pCapture->hFile, pRecord, sizeof(*pRecord));
+	if (nRetVal == XN_STATUS_OK && pRecord->nDataSize != 0)
+	{
+		nRetVal = xnOSWriteFile(pCapture->hFile, pData, pRecord->nDataSize);
+	}
+
+	if (nRetVal != XN_STATUS_OK)
+	{
+		// a capture with holes in it can't be replayed
+		xnLogError(XN_MASK_USB_CAPTURE, "Failed to write to USB capture '%s': %s", pCapture->strFileName, xnGetStatusString(nRetVal));
+		xnUSBCaptureStop(pCapture);
+	}
+}
+
+XN_C_API XnStatus xnUSBStartCapture(XN_USB_DEV_HANDLE pDevHandle, const XnChar* strFileName, XnUInt16 nVendorID, XnUInt16 nProductID)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_VALIDATE_USB_INIT();
+	XN_VALIDATE_INPUT_PTR(pDevHandle);
+	XN_VALIDATE_INPUT_PTR(strFileName);
+
+	if (xnUSBIsReplayDevice(pDevHandle))
+	{
+		return (XN_STATUS_USB_DEVICE_NOT_VALID);
+	}
+
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	if (g_captureDevices.Find(pDevHandle) != g_captureDevices.End())
+	{
+		return (XN_STATUS_USB_ALREADY_OPEN);
+	}
+
+	XnUSBCaptureFileHeader header;
+	xnOSMemSet(&header, 0, sizeof(header));
+	xnOSMemCopy(header.cMagic, XN_USB_CAPTURE_MAGIC, sizeof(header.cMagic));
+	header.nVersion = XN_USB_CAPTURE_VERSION;
+	header.nVendorID = nVendorID;
+	header.nProductID = nProductID;
+
+	XnUSBDeviceSpeed nSpeed = XN_USB_DEVICE_HIGH_SPEED;
+	xnUSBPlatformSpecificGetDeviceSpeed(pDevHandle, &nSpeed);
+	header.nDeviceSpeed = nSpeed;
+
+	// replay starts from the interface the device is at now
+	xnUSBPlatformSpecificGetInterface(pDevHandle, &header.nInterface, &header.nAltInterface);
+
+	XnUSBCapture* pCapture;
+	XN_VALIDATE_NEW(pCapture, XnUSBCapture);
+	xnOSStrCopy(pCapture->strFileName, strFileName, sizeof(pCapture->strFileName));
+	pCapture->nRefCount = 1;
+
+	nRetVal = xnOSOpenFile(strFileName, XN_OS_FILE_WRITE | XN_OS_FILE_TRUNCATE, &pCapture->hFile);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		XN_DELETE(pCapture);
+		XN_LOG_WARNING_RETURN(nRetVal, XN_MASK_USB_CAPTURE, "Failed to create USB capture file '%s'", strFileName);
+	}
+
+	nRetVal = xnOSWriteFile(pCapture->hFile, &header, sizeof(header));
+	if (nRetVal == XN_STATUS_OK)
+	{
+		nRetVal = g_captureDevices.Set(pDevHandle, pCapture);
+	}
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnOSCloseFile(&pCapture->hFile);
+		XN_DELETE(pCapture);
+		return (nRetVal);
+	}
+
+	xnOSGetHighResTimeStamp(&pCapture->nStartTime);
+
+	xnLogInfo(XN_MASK_USB_CAPTURE, "Capturing USB device %04x:%04x to '%s'", nVendorID, nProductID, strFileName);
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnStatus xnUSBStopCapture(XN_USB_DEV_HANDLE pDevHandle)
+{
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	XnUSBCapture* pCapture = NULL;
+	if (g_captureDevices.Get(pDevHandle, pCapture) != XN_STATUS_OK)
+	{
+		return (XN_STATUS_USB_DEVICE_NOT_VALID);
+	}
+
+	xnUSBCaptureStop(pCapture);
+
+	// end points opened while capturing are no longer captured (read threads keep their reference until shut down)
+	xnl::Hash<XN_USB_EP_HANDLE, XnUSBCaptureEndPoint>::Iterator it = g_captureEndPoints.Begin();
+	while (it != g_captureEndPoints.End())
+	{
+		xnl::Hash<XN_USB_EP_HANDLE, XnUSBCaptureEndPoint>::Iterator curr = it;
+		++it;
+		if (curr->Value().pCapture == pCapture)
+		{
+			g_captureEndPoints.Remove(curr);
+		}
+	}
+
+	g_captureDevices.Remove(pDevHandle);
+	xnUSBCaptureRelease(pCapture);
+
+	return (XN_STATUS_OK);
+}
+
+void xnUSBCaptureDeviceClosed(XN_USB_DEV_HANDLE pDevHandle)
+{
+	xnUSBStopCapture(pDevHandle);
+}
+
+void xnUSBCaptureSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface, XnStatus nResult)
+{
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	XnUSBCapture* pCapture = NULL;
+	if (g_captureDevices.Get(pDevHandle, pCapture) != XN_STATUS_OK)
+	{
+		return;
+	}
+
+	XnUSBCaptureRecordHeader record;
+	xnUSBCaptureInitRecord(pCapture, XN_USB_CAPTURE_RECORD_SET_INTERFACE, nResult, &record);
+	record.nInterface = nInterface;
+	record.nAltInterface = nAltInterface;
+	xnUSBCaptureWriteRecord(pCapture, &record, NULL);
+}
+
+void xnUSBCaptureOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE pEPHandle, XnStatus nResult)
+{
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	XnUSBCapture* pCapture = NULL;
+	if (g_captureDevices.Get(pDevHandle, pCapture) != XN_STATUS_OK)
+	{
+		return;
+	}
+
+	XnUSBCaptureRecordHeader record;
+	xnUSBCaptureInitRecord(pCapture, XN_USB_CAPTURE_RECORD_OPEN_END_POINT, nResult, &record);
+	record.nEndPointID = nEndPointID;
+	record.nEndPointType = (XnUInt8)nEPType;
+	record.nDirection = (XnUInt8)nDirType;
+
+	if (nResult == XN_STATUS_OK)
+	{
+		xnUSBPlatformSpecificGetEndPointMaxPacketSize(pEPHandle, &record.nMaxPacketSize);
+
+		XnUSBCaptureEndPoint endPoint = { pCapture, nEndPointID };
+		g_captureEndPoints.Set(pEPHandle, endPoint);
+	}
+
+	xnUSBCaptureWriteRecord(pCapture, &record, NULL);
+}
+
+void xnUSBCaptureEndPointClosed(XN_USB_EP_HANDLE pEPHandle)
+{
+	xnUSBCaptureReadThreadShutdown(pEPHandle);
+
+	xnl::AutoCSLocker locker(g_captureLock);
+	g_captureEndPoints.Remove(pEPHandle);
+}
+
+void xnUSBCaptureControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBCaptureRecordType nRecordType, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, const XnUChar* pBuffer, XnUInt32 nBufferSize, XnStatus nResult)
+{
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	XnUSBCapture* pCapture = NULL;
+	if (g_captureDevices.Get(pDevHandle, pCapture) != XN_STATUS_OK)
+	{
+		return;
+	}
+
+	XnUSBCaptureRecordHeader record;
+	xnUSBCaptureInitRecord(pCapture, nRecordType, nResult, &record);
+	record.nControlType = (XnUInt8)nType;
+	record.nRequest = nRequest;
+	record.nValue = nValue;
+	record.nIndex = nIndex;
+	record.nDataSize = (pBuffer == NULL) ? 0 : nBufferSize;
+	xnUSBCaptureWriteRecord(pCapture, &record, pBuffer);
+}
+
+void xnUSBCaptureEndPointTransfer(XN_USB_EP_HANDLE pEPHandle, XnUSBCaptureRecordType nRecordType, const XnUChar* pBuffer, XnUInt32 nBufferSize, XnStatus nResult)
+{
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	XnUSBCaptureEndPoint endPoint;
+	if (g_captureEndPoints.Get(pEPHandle, endPoint) != XN_STATUS_OK)
+	{
+		return;
+	}
+
+	XnUSBCaptureRecordHeader record;
+	xnUSBCaptureInitRecord(endPoint.pCapture, nRecordType, nResult, &record);
+	record.nEndPointID = endPoint.nEndPointID;
+	record.nDataSize = (pBuffer == NULL) ? 0 : nBufferSize;
+	xnUSBCaptureWriteRecord(endPoint.pCapture, &record, pBuffer);
+}
+
+static XnBool XN_CALLBACK_TYPE xnUSBCaptureReadCallback(XnUChar* pBuffer, XnUInt32 nBufferSize, void* pCallbackData)
+{
+	XnUSBCaptureReadContext* pContext = (XnUSBCaptureReadContext*)pCallbackData;
+
+	{
+		xnl::AutoCSLocker locker(g_captureLock);
+
+		XnUSBCaptureRecordHeader record;
+		xnUSBCaptureInitRecord(pContext->pCapture, XN_USB_CAPTURE_RECORD_READ_THREAD_DATA, XN_STATUS_OK, &record);
+		record.nEndPointID = pContext->nEndPointID;
+		record.nDataSize = nBufferSize;
+		xnUSBCaptureWriteRecord(pContext->pCapture, &record, pBuffer);
+	}
+
+	return pContext->pCallbackFunction(pBuffer, nBufferSize, pContext->pCallbackData);
+}
+
+XnBool xnUSBCaptureWrapReadCallback(XN_USB_EP_HANDLE pEPHandle, XnUSBReadCallbackFunctionPtr* ppCallbackFunction, void** ppCallbackData)
+{
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	XnUSBCaptureEndPoint endPoint;
+	if (g_captureEndPoints.Get(pEPHandle, endPoint) != XN_STATUS_OK ||
+		g_captureReadContexts.Find(pEPHandle) != g_captureReadContexts.End())
+	{
+		return FALSE;
+	}
+
+	XnUSBCaptureReadContext* pContext = XN_NEW(XnUSBCaptureReadContext);
+	if (pContext == NULL)
+	{
+		return FALSE;
+	}
+
+	pContext->pCapture = endPoint.pCapture;
+	pContext->nEndPointID = endPoint.nEndPointID;
+	pContext->pCallbackFunction = *ppCallbackFunction;
+	pContext->pCallbackData = *ppCallbackData;
+
+	if (g_captureReadContexts.Set(pEPHandle, pContext) != XN_STATUS_OK)
+	{
+		XN_DELETE(pContext);
+		return FALSE;
+	}
+
+	++endPoint.pCapture->nRefCount;
+
+	*ppCallbackFunction = xnUSBCaptureReadCallback;
+	*ppCallbackData = pContext;
+
+	return TRUE;
+}
+
+void xnUSBCaptureReadThreadShutdown(XN_USB_EP_HANDLE pEPHandle)
+{
+	xnl::AutoCSLocker locker(g_captureLock);
+
+	XnUSBCaptureReadContext* pContext = NULL;
+	if (g_captureReadContexts.Get(pEPHandle, pContext) != XN_STATUS_OK)
+	{
+		return;
+	}
+
+	g_captureReadContexts.Remove(pEPHandle);
+	xnUSBCaptureRelease(pContext->pCapture);
+	XN_DELETE(pContext);
+}
@@ -0,0 +1,129 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+#ifndef _XN_USB_CAPTURE_H_
+#define _XN_USB_CAPTURE_H_
+
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include <XnUSB.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_MASK_USB_CAPTURE "xnUSBCapture"
+
+#define XN_USB_CAPTURE_MAGIC "XnUSBCap"
+#define XN_USB_CAPTURE_VERSION 1
+
+//---------------------------------------------------------------------------
+// Capture File Format
+//---------------------------------------------------------------------------
+// A capture file is a file header, followed by records in the order the calls they describe returned. Each record
+// is a record header, followed by nDataSize bytes of data.
+
+typedef enum XnUSBCaptureRecordType
+{
+	XN_USB_CAPTURE_RECORD_SET_INTERFACE = 1,
+	XN_USB_CAPTURE_RECORD_OPEN_END_POINT,
+	// transfers, replayed in the order they were captured
+	XN_USB_CAPTURE_RECORD_SEND_CONTROL,
+	XN_USB_CAPTURE_RECORD_RECEIVE_CONTROL,
+	XN_USB_CAPTURE_RECORD_WRITE_END_POINT,
+	XN_USB_CAPTURE_RECORD_READ_END_POINT,
+	// a buffer handed to the callback of a read thread
+	XN_USB_CAPTURE_RECORD_READ_THREAD_DATA,
+} XnUSBCaptureRecordType;
+
+#pragma pack(push, 1)
+
+typedef struct XnUSBCaptureFileHeader
+{
+	XnChar cMagic[8];
+	XnUInt32 nVersion;
+	XnUInt16 nVendorID;
+	XnUInt16 nProductID;
+	XnUInt32 nDeviceSpeed; // XnUSBDeviceSpeed
+	XnUInt8 nInterface;
+	XnUInt8 nAltInterface; // at the time the capture started
+	XnUInt16 nReserved;
+} XnUSBCaptureFileHeader;
+
+typedef struct XnUSBCaptureRecordHeader
+{
+	XnUInt32 nType; // XnUSBCaptureRecordType
+	XnUInt32 nStatus; // what the call returned
+	XnUInt64 nTimestamp; // in microseconds, since the capture started
+	XnUInt16 nEndPointID; // end point records
+	XnUInt8 nEndPointType; // open end point
+	XnUInt8 nDirection; // open end point
+	XnUInt32 nMaxPacketSize; // open end point
+	XnUInt8 nInterface; // set interface
+	XnUInt8 nAltInterface; // set interface
+	XnUInt8 nControlType; // control transfers
+	XnUInt8 nRequest; // control transfers
+	XnUInt16 nValue; // control transfers
+	XnUInt16 nIndex; // control transfers
+	XnUInt32 nDataSize;
+} XnUSBCaptureRecordHeader;
+
+#pragma pack(pop)
+
+//---------------------------------------------------------------------------
+// Capture
+//---------------------------------------------------------------------------
+// Called by the exported functions after the platform-specific ones returned. They do nothing for devices that
+// aren't being captured.
+void xnUSBCaptureDeviceClosed(XN_USB_DEV_HANDLE pDevHandle);
+void xnUSBCaptureSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface, XnStatus nResult);
+void xnUSBCaptureOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE pEPHandle, XnStatus nResult);
+void xnUSBCaptureEndPointClosed(XN_USB_EP_HANDLE pEPHandle);
+void xnUSBCaptureControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBCaptureRecordType nRecordType, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, const XnUChar* pBuffer, XnUInt32 nBufferSize, XnStatus nResult);
+void xnUSBCaptureEndPointTransfer(XN_USB_EP_HANDLE pEPHandle, XnUSBCaptureRecordType nRecordType, const XnUChar* pBuffer, XnUInt32 nBufferSize, XnStatus nResult);
+
+// Replaces the callback of a read thread about to be started with one that captures the data before passing it on.
+// Returns FALSE if the end point isn't captured (or already has a read thread).
+XnBool xnUSBCaptureWrapReadCallback(XN_USB_EP_HANDLE pEPHandle, XnUSBReadCallbackFunctionPtr* ppCallbackFunction, void** ppCallbackData);
+// Called once the read thread is gone.
+void xnUSBCaptureReadThreadShutdown(XN_USB_EP_HANDLE pEPHandle);
+
+//---------------------------------------------------------------------------
+// Replay
+//---------------------------------------------------------------------------
+// The handles of replayed devices and end points point to objects of the replay, and are only ever passed to these.
+XnBool xnUSBIsReplayEndPoint(XN_USB_EP_HANDLE pEPHandle);
+
+XnStatus xnUSBReplayOpenDevice(const XnChar* strFileName, XN_USB_DEV_HANDLE* pDevHandlePtr);
+XnStatus xnUSBReplayCloseDevice(XN_USB_DEV_HANDLE pDevHandle);
+XnStatus xnUSBReplayGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed);
+XnStatus xnUSBReplaySetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface);
+XnStatus xnUSBReplayGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface);
+XnStatus xnUSBReplayOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr);
+XnStatus xnUSBReplayCloseEndPoint(XN_USB_EP_HANDLE pEPHandle);
+XnStatus xnUSBReplayGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize);
+XnStatus xnUSBReplaySendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize);
+XnStatus xnUSBReplayReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived);
+XnStatus xnUSBReplayReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived);
+XnStatus xnUSBReplayWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize);
+XnStatus xnUSBReplayInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUSBReadCallbackFunctionPtr pCallbackFunction, void* pCallbackData);
+XnStatus xnUSBReplayShutdownReadThread(XN_USB_EP_HANDLE pEPHandle);
+
+#endif //_XN_USB_CAPTURE_H_
@@ -31,6 +31,36 @@
 //---------------------------------------------------------------------------
 extern XnUInt32 g_nRefCount;
 
+//---------------------------------------------------------------------------
+// Function Declaration
+//---------------------------------------------------------------------------
+// Implemented by each platform. The exported functions (XnUSB.cpp) call them for devices that aren't replayed from
+// a capture file.
+XnStatus xnUSBPlatformSpecificInit();
+XnStatus xnUSBPlatformSpecificShutdown();
+
+XnStatus xnUSBPlatformSpecificOpenDeviceByPath(const XnUSBConnectionString strDevicePath, XN_USB_DEV_HANDLE* pDevHandlePtr);
+XnStatus xnUSBPlatformSpecificCloseDevice(XN_USB_DEV_HANDLE pDevHandle);
+XnStatus xnUSBPlatformSpecificGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed);
+XnStatus xnUSBPlatformSpecificSetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nConfig);
+XnStatus xnUSBPlatformSpecificGetConfig(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnConfig);
+XnStatus xnUSBPlatformSpecificSetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface);
+XnStatus xnUSBPlatformSpecificGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface);
+XnStatus xnUSBPlatformSpecificOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr);
+XnStatus xnUSBPlatformSpecificCloseEndPoint(XN_USB_EP_HANDLE pEPHandle);
+XnStatus xnUSBPlatformSpecificGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize);
+XnStatus xnUSBPlatformSpecificAbortEndPoint(XN_USB_EP_HANDLE pEPHandle);
+XnStatus xnUSBPlatformSpecificFlushEndPoint(XN_USB_EP_HANDLE pEPHandle);
+XnStatus xnUSBPlatformSpecificResetEndPoint(XN_USB_EP_HANDLE pEPHandle);
+XnStatus xnUSBPlatformSpecificSendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut);
+XnStatus xnUSBPlatformSpecificReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType nType, XnUInt8 nRequest, XnUInt16 nValue, XnUInt16 nIndex, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut);
+XnStatus xnUSBPlatformSpecificReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut);
+XnStatus xnUSBPlatformSpecificWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut);
+XnStatus xnUSBPlatformSpecificQueueReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32 nTimeOut);
+XnStatus xnUSBPlatformSpecificFinishReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnBytesReceived, XnUInt32 nTimeOut);
+XnStatus xnUSBPlatformSpecificInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUInt32 nNumBuffers, XnUInt32 nTimeOut, XnUSBReadCallbackFunctionPtr pCallbackFunction, void* pCallbackData);
+XnStatus xnUSBPlatformSpecificShutdownReadThread(XN_USB_EP_HANDLE pEPHandle);
+
 //---------------------------------------------------------------------------
 // Macros
 //---------------------------------------------------------------------------
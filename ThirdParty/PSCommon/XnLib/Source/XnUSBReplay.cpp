@@ -0,0 +1,670 @@
+/*****************************************************************************
+*                                                                            *
+*  PrimeSense PSCommon Library                                               *
+*  Copyright (C) 2012 PrimeSense Ltd.                                        *
+*                                                                            *
+*  This file is part of PSCommon.                                            *
+*                                                                            *
+*  Licensed under the Apache License, Version 2.0 (the "License");           *
+*  you may not use this file except in compliance with the License.          *
+*  You may obtain a copy of the License at                                   *
+*                                                                            *
+*      http://www.apache.org/licenses/LICENSE-2.0                            *
+*                                                                            *
+*  Unless required by applicable law or agreed to in writing, software       *
+*  distributed under the License is distributed on an "AS IS" BASIS,         *
+*  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.  *
+*  See the License for the specific language governing permissions and       *
+*  limitations under the License.                                            *
+*                                                                            *
+*****************************************************************************/
+//---------------------------------------------------------------------------
+// Includes
+//---------------------------------------------------------------------------
+#include "XnUSBCapture.h"
+#include "XnUSBInternal.h"
+#include <XnLog.h>
+#include <XnOSCpp.h>
+#include <XnHash.h>
+#include <XnArray.h>
+
+//---------------------------------------------------------------------------
+// Defines
+//---------------------------------------------------------------------------
+#define XN_USB_REPLAY_THREAD_KILL_TIMEOUT 5000
+// while waiting for the time a buffer is due, the thread wakes up at least this often to check if it should exit
+#define XN_USB_REPLAY_MAX_SLEEP 100
+
+//---------------------------------------------------------------------------
+// Types
+//---------------------------------------------------------------------------
+typedef struct XnUSBReplayTransfer
+{
+	XnUSBCaptureRecordHeader record;
+	XnUInt32 nDataOffset; // in XnUSBReplayDevice::transfersData
+} XnUSBReplayTransfer;
+
+typedef struct XnUSBReplayDevice
+{
+	XnChar strFileName[XN_FILE_MAX_PATH];
+	XnUSBCaptureFileHeader header;
+
+	// set interface and open end point calls are looked up, whenever they are made
+	xnl::Array<XnUSBCaptureRecordHeader> interfaces;
+	xnl::Array<XnUSBCaptureRecordHeader> endPoints;
+
+	// transfers are replayed in order
+	xnl::Array<XnUSBReplayTransfer> transfers;
+	xnl::Array<XnUChar> transfersData;
+	volatile XnUInt32 nNextTransfer;
+	xnl::CriticalSection transfersLock;
+
+	XnUInt8 nInterface;
+	XnUInt8 nAltInterface;
+	volatile XnDouble dSpeed;
+} XnUSBReplayDevice;
+
+typedef struct XnUSBReplayEndPoint
+{
+	XnUSBReplayDevice* pDevice;
+	XnUInt16 nEndPointID;
+	XnUInt32 nMaxPacketSize;
+
+	XN_THREAD_HANDLE hThread;
+	volatile XnBool bKillThread;
+	XnUChar* pBuffer;
+	XnUInt32 nBufferSize;
+	XnUSBReadCallbackFunctionPtr pCallbackFunction;
+	void* pCallbackData;
+} XnUSBReplayEndPoint;
+
+//---------------------------------------------------------------------------
+// Global Variables
+//---------------------------------------------------------------------------
+static xnl::CriticalSection g_replayLock;
+static xnl::Hash<XN_USB_DEV_HANDLE, XnUSBReplayDevice*> g_replayDevices;
+static xnl::Hash<XN_USB_EP_HANDLE, XnUSBReplayEndPoint*> g_replayEndPoints;
+
+//---------------------------------------------------------------------------
+// Code
+//---------------------------------------------------------------------------
+static XnBool xnUSBReplayIsTransfer(XnUInt32 nRecordType)
+{
+	return (nRecordType >= XN_USB_CAPTURE_RECORD_SEND_CONTROL && nRecordType <= XN_USB_CAPTURE_RECORD_READ_END_POINT);
+}
+
+static XnStatus xnUSBReplayReadHeader(XN_FILE_HANDLE hFile, XnUSBCaptureFileHeader* pHeader)
+{
+	XnUInt32 nRead = sizeof(*pHeader);
+	XnStatus nRetVal = xnOSReadFile(hFile, pHeader, &nRead);
+	XN_IS_STATUS_OK(nRetVal);
+
+	if (nRead != sizeof(*pHeader) ||
+		xnOSMemCmp(pHeader->cMagic, XN_USB_CAPTURE_MAGIC, sizeof(pHeader->cMagic)) != 0 ||
+		pHeader->nVersion != XN_USB_CAPTURE_VERSION)
+	{
+		return (XN_STATUS_USB_DEVICE_OPEN_FAILED);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+static XnStatus xnUSBReplayLoad(XN_FILE_HANDLE hFile, XnUSBReplayDevice* pDevice)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	nRetVal = xnUSBReplayReadHeader(hFile, &pDevice->header);
+	XN_IS_STATUS_OK(nRetVal);
+
+	for (;;)
+	{
+		XnUSBCaptureRecordHeader record;
+		XnUInt32 nRead = sizeof(record);
+		nRetVal = xnOSReadFile(hFile, &record, &nRead);
+		XN_IS_STATUS_OK(nRetVal);
+
+		if (nRead != sizeof(record))
+		{
+			// end of file (a capture that was cut short ends in the middle of a record)
+			break;
+		}
+
+		if (record.nType == XN_USB_CAPTURE_RECORD_SET_INTERFACE)
+		{
+			nRetVal = pDevice->interfaces.AddLast(record);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+		else if (record.nType == XN_USB_CAPTURE_RECORD_OPEN_END_POINT)
+		{
+			nRetVal = pDevice->endPoints.AddLast(record);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+		else if (xnUSBReplayIsTransfer(record.nType))
+		{
+			XnUSBReplayTransfer transfer;
+			transfer.record = record;
+			transfer.nDataOffset = pDevice->transfersData.GetSize();
+
+			nRetVal = pDevice->transfersData.SetSize(transfer.nDataOffset + record.nDataSize);
+			XN_IS_STATUS_OK(nRetVal);
+
+			nRead = record.nDataSize;
+			if (nRead != 0)
+			{
+				nRetVal = xnOSReadFile(hFile, pDevice->transfersData.GetData() + transfer.nDataOffset, &nRead);
+				XN_IS_STATUS_OK(nRetVal);
+			}
+
+			if (nRead != record.nDataSize)
+			{
+				break;
+			}
+
+			nRetVal = pDevice->transfers.AddLast(transfer);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+		else
+		{
+			// read thread data is read by the replay threads
+			nRetVal = xnOSSeekFile64(hFile, XN_OS_SEEK_CUR, record.nDataSize);
+			XN_IS_STATUS_OK(nRetVal);
+		}
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XN_C_API XnBool xnUSBIsCaptureFile(const XnChar* strFileName, XnUInt16* pnVendorID, XnUInt16* pnProductID)
+{
+	XN_FILE_HANDLE hFile;
+	if (strFileName == NULL || xnOSOpenFile(strFileName, XN_OS_FILE_READ, &hFile) != XN_STATUS_OK)
+	{
+		return FALSE;
+	}
+
+	XnUSBCaptureFileHeader header;
+	XnStatus nRetVal = xnUSBReplayReadHeader(hFile, &header);
+	xnOSCloseFile(&hFile);
+
+	if (nRetVal != XN_STATUS_OK)
+	{
+		return FALSE;
+	}
+
+	if (pnVendorID != NULL)
+	{
+		*pnVendorID = header.nVendorID;
+	}
+	if (pnProductID != NULL)
+	{
+		*pnProductID = header.nProductID;
+	}
+
+	return TRUE;
+}
+
+XN_C_API XnBool xnUSBIsReplayDevice(XN_USB_DEV_HANDLE pDevHandle)
+{
+	xnl::AutoCSLocker locker(g_replayLock);
+	return (g_replayDevices.Find(pDevHandle) != g_replayDevices.End());
+}
+
+XnBool xnUSBIsReplayEndPoint(XN_USB_EP_HANDLE pEPHandle)
+{
+	xnl::AutoCSLocker locker(g_replayLock);
+	return (g_replayEndPoints.Find(pEPHandle) != g_replayEndPoints.End());
+}
+
+XN_C_API XnStatus xnUSBSetReplaySpeed(XN_USB_DEV_HANDLE pDevHandle, XnDouble dSpeed)
+{
+	if (!xnUSBIsReplayDevice(pDevHandle))
+	{
+		return (XN_STATUS_USB_DEVICE_NOT_VALID);
+	}
+
+	if (dSpeed < 0)
+	{
+		return (XN_STATUS_BAD_PARAM);
+	}
+
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+	pDevice->dSpeed = dSpeed;
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayOpenDevice(const XnChar* strFileName, XN_USB_DEV_HANDLE* pDevHandlePtr)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_VALIDATE_OUTPUT_PTR(pDevHandlePtr);
+
+	XN_FILE_HANDLE hFile;
+	nRetVal = xnOSOpenFile(strFileName, XN_OS_FILE_READ, &hFile);
+	XN_IS_STATUS_OK(nRetVal);
+
+	XnUSBReplayDevice* pDevice = XN_NEW(XnUSBReplayDevice);
+	if (pDevice == NULL)
+	{
+		xnOSCloseFile(&hFile);
+		return (XN_STATUS_ALLOC_FAILED);
+	}
+
+	xnOSStrCopy(pDevice->strFileName, strFileName, sizeof(pDevice->strFileName));
+	pDevice->nNextTransfer = 0;
+	pDevice->dSpeed = 1.0;
+
+	nRetVal = xnUSBReplayLoad(hFile, pDevice);
+	xnOSCloseFile(&hFile);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		XN_DELETE(pDevice);
+		XN_LOG_WARNING_RETURN(nRetVal, XN_MASK_USB_CAPTURE, "Failed to read USB capture '%s': %s", strFileName, xnGetStatusString(nRetVal));
+	}
+
+	pDevice->nInterface = pDevice->header.nInterface;
+	pDevice->nAltInterface = pDevice->header.nAltInterface;
+
+	XN_USB_DEV_HANDLE pDevHandle = (XN_USB_DEV_HANDLE)pDevice;
+
+	{
+		xnl::AutoCSLocker locker(g_replayLock);
+		nRetVal = g_replayDevices.Set(pDevHandle, pDevice);
+	}
+	if (nRetVal != XN_STATUS_OK)
+	{
+		XN_DELETE(pDevice);
+		return (nRetVal);
+	}
+
+	xnLogInfo(XN_MASK_USB_CAPTURE, "Replaying USB capture '%s' of device %04x:%04x (%u transfers)", strFileName,
+		pDevice->header.nVendorID, pDevice->header.nProductID, pDevice->transfers.GetSize());
+
+	*pDevHandlePtr = pDevHandle;
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayCloseDevice(XN_USB_DEV_HANDLE pDevHandle)
+{
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+
+	{
+		xnl::AutoCSLocker locker(g_replayLock);
+		g_replayDevices.Remove(pDevHandle);
+	}
+
+	XN_DELETE(pDevice);
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayGetDeviceSpeed(XN_USB_DEV_HANDLE pDevHandle, XnUSBDeviceSpeed* pDevSpeed)
+{
+	XN_VALIDATE_OUTPUT_PTR(pDevSpeed);
+
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+	*pDevSpeed = (XnUSBDeviceSpeed)pDevice->header.nDeviceSpeed;
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplaySetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8 nInterface, XnUInt8 nAltInterface)
+{
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+
+	for (XnUInt32 i = 0; i < pDevice->interfaces.GetSize(); ++i)
+	{
+		const XnUSBCaptureRecordHeader& record = pDevice->interfaces[i];
+		if (record.nInterface == nInterface && record.nAltInterface == nAltInterface)
+		{
+			if (record.nStatus == XN_STATUS_OK)
+			{
+				pDevice->nInterface = nInterface;
+				pDevice->nAltInterface = nAltInterface;
+			}
+
+			return (record.nStatus);
+		}
+	}
+
+	xnLogWarning(XN_MASK_USB_CAPTURE, "Interface %d (alternative %d) wasn't set in the USB capture", nInterface, nAltInterface);
+	return (XN_STATUS_USB_SET_INTERFACE_FAILED);
+}
+
+XnStatus xnUSBReplayGetInterface(XN_USB_DEV_HANDLE pDevHandle, XnUInt8* pnInterface, XnUInt8* pnAltInterface)
+{
+	XN_VALIDATE_OUTPUT_PTR(pnInterface);
+	XN_VALIDATE_OUTPUT_PTR(pnAltInterface);
+
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+	*pnInterface = pDevice->nInterface;
+	*pnAltInterface = pDevice->nAltInterface;
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayOpenEndPoint(XN_USB_DEV_HANDLE pDevHandle, XnUInt16 nEndPointID, XnUSBEndPointType nEPType, XnUSBDirectionType nDirType, XN_USB_EP_HANDLE* pEPHandlePtr)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_VALIDATE_OUTPUT_PTR(pEPHandlePtr);
+
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+
+	const XnUSBCaptureRecordHeader* pRecord = NULL;
+	for (XnUInt32 i = 0; i < pDevice->endPoints.GetSize(); ++i)
+	{
+		const XnUSBCaptureRecordHeader& record = pDevice->endPoints[i];
+		if (record.nEndPointID == nEndPointID && record.nEndPointType == nEPType && record.nDirection == nDirType)
+		{
+			pRecord = &record;
+			break;
+		}
+	}
+
+	if (pRecord == NULL)
+	{
+		return (XN_STATUS_USB_ENDPOINT_NOT_FOUND);
+	}
+
+	if (pRecord->nStatus != XN_STATUS_OK)
+	{
+		return (pRecord->nStatus);
+	}
+
+	XnUSBReplayEndPoint* pEndPoint;
+	XN_VALIDATE_NEW(pEndPoint, XnUSBReplayEndPoint);
+	xnOSMemSet(pEndPoint, 0, sizeof(*pEndPoint));
+	pEndPoint->pDevice = pDevice;
+	pEndPoint->nEndPointID = nEndPointID;
+	pEndPoint->nMaxPacketSize = pRecord->nMaxPacketSize;
+
+	XN_USB_EP_HANDLE pEPHandle = (XN_USB_EP_HANDLE)pEndPoint;
+
+	{
+		xnl::AutoCSLocker locker(g_replayLock);
+		nRetVal = g_replayEndPoints.Set(pEPHandle, pEndPoint);
+	}
+	if (nRetVal != XN_STATUS_OK)
+	{
+		XN_DELETE(pEndPoint);
+		return (nRetVal);
+	}
+
+	*pEPHandlePtr = pEPHandle;
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayCloseEndPoint(XN_USB_EP_HANDLE pEPHandle)
+{
+	XnUSBReplayEndPoint* pEndPoint = (XnUSBReplayEndPoint*)pEPHandle;
+
+	if (pEndPoint->hThread != NULL)
+	{
+		xnUSBReplayShutdownReadThread(pEPHandle);
+	}
+
+	{
+		xnl::AutoCSLocker locker(g_replayLock);
+		g_replayEndPoints.Remove(pEPHandle);
+	}
+
+	XN_DELETE(pEndPoint);
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayGetEndPointMaxPacketSize(XN_USB_EP_HANDLE pEPHandle, XnUInt32* pnMaxPacketSize)
+{
+	XN_VALIDATE_OUTPUT_PTR(pnMaxPacketSize);
+
+	XnUSBReplayEndPoint* pEndPoint = (XnUSBReplayEndPoint*)pEPHandle;
+	*pnMaxPacketSize = pEndPoint->nMaxPacketSize;
+
+	return (XN_STATUS_OK);
+}
+
+// Returns the next transfer of this kind, skipping any other transfers captured before it (NULL once there are no
+// more).
+static const XnUSBReplayTransfer* xnUSBReplayNextTransfer(XnUSBReplayDevice* pDevice, XnUSBCaptureRecordType nType, XnUInt16 nEndPointID)
+{
+	xnl::AutoCSLocker locker(pDevice->transfersLock);
+
+	for (XnUInt32 i = pDevice->nNextTransfer; i < pDevice->transfers.GetSize(); ++i)
+	{
+		const XnUSBReplayTransfer& transfer = pDevice->transfers[i];
+		if (transfer.record.nType == (XnUInt32)nType && transfer.record.nEndPointID == nEndPointID)
+		{
+			pDevice->nNextTransfer = i + 1;
+			return &transfer;
+		}
+	}
+
+	xnLogWarning(XN_MASK_USB_CAPTURE, "USB capture '%s' has no more transfers to replay", pDevice->strFileName);
+	pDevice->nNextTransfer = pDevice->transfers.GetSize();
+
+	return NULL;
+}
+
+static XnStatus xnUSBReplayReceive(XnUSBReplayDevice* pDevice, const XnUSBReplayTransfer* pTransfer, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived)
+{
+	if (pTransfer == NULL)
+	{
+		return (XN_STATUS_USB_TRANSFER_TIMEOUT);
+	}
+
+	if (pTransfer->record.nStatus == XN_STATUS_OK)
+	{
+		XnUInt32 nBytes = XN_MIN(pTransfer->record.nDataSize, nBufferSize);
+		xnOSMemCopy(pBuffer, pDevice->transfersData.GetData() + pTransfer->nDataOffset, nBytes);
+		*pnBytesReceived = nBytes;
+	}
+
+	return (pTransfer->record.nStatus);
+}
+
+XnStatus xnUSBReplaySendControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType /*nType*/, XnUInt8 /*nRequest*/, XnUInt16 /*nValue*/, XnUInt16 /*nIndex*/, XnUChar* /*pBuffer*/, XnUInt32 /*nBufferSize*/)
+{
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+
+	const XnUSBReplayTransfer* pTransfer = xnUSBReplayNextTransfer(pDevice, XN_USB_CAPTURE_RECORD_SEND_CONTROL, 0);
+	return (pTransfer == NULL) ? XN_STATUS_USB_TRANSFER_TIMEOUT : pTransfer->record.nStatus;
+}
+
+XnStatus xnUSBReplayReceiveControl(XN_USB_DEV_HANDLE pDevHandle, XnUSBControlType /*nType*/, XnUInt8 /*nRequest*/, XnUInt16 /*nValue*/, XnUInt16 /*nIndex*/, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived)
+{
+	XN_VALIDATE_OUTPUT_PTR(pnBytesReceived);
+
+	XnUSBReplayDevice* pDevice = (XnUSBReplayDevice*)pDevHandle;
+
+	const XnUSBReplayTransfer* pTransfer = xnUSBReplayNextTransfer(pDevice, XN_USB_CAPTURE_RECORD_RECEIVE_CONTROL, 0);
+	return xnUSBReplayReceive(pDevice, pTransfer, pBuffer, nBufferSize, pnBytesReceived);
+}
+
+XnStatus xnUSBReplayReadEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* pBuffer, XnUInt32 nBufferSize, XnUInt32* pnBytesReceived)
+{
+	XN_VALIDATE_OUTPUT_PTR(pnBytesReceived);
+
+	XnUSBReplayEndPoint* pEndPoint = (XnUSBReplayEndPoint*)pEPHandle;
+
+	const XnUSBReplayTransfer* pTransfer = xnUSBReplayNextTransfer(pEndPoint->pDevice, XN_USB_CAPTURE_RECORD_READ_END_POINT, pEndPoint->nEndPointID);
+	return xnUSBReplayReceive(pEndPoint->pDevice, pTransfer, pBuffer, nBufferSize, pnBytesReceived);
+}
+
+XnStatus xnUSBReplayWriteEndPoint(XN_USB_EP_HANDLE pEPHandle, XnUChar* /*pBuffer*/, XnUInt32 /*nBufferSize*/)
+{
+	XnUSBReplayEndPoint* pEndPoint = (XnUSBReplayEndPoint*)pEPHandle;
+
+	const XnUSBReplayTransfer* pTransfer = xnUSBReplayNextTransfer(pEndPoint->pDevice, XN_USB_CAPTURE_RECORD_WRITE_END_POINT, pEndPoint->nEndPointID);
+	return (pTransfer == NULL) ? XN_STATUS_USB_TRANSFER_TIMEOUT : pTransfer->record.nStatus;
+}
+
+static void xnUSBReplayEndPointData(XnUSBReplayEndPoint* pEndPoint, XN_FILE_HANDLE hFile)
+{
+	XnUSBReplayDevice* pDevice = pEndPoint->pDevice;
+
+	// the number of transfers captured before the current record
+	XnUInt32 nTransfers = 0;
+
+	// pacing starts from a captured timestamp, and the time its data was replayed
+	XnDouble dSpeed = -1;
+	XnUInt64 nAnchorTimestamp = 0;
+	XnUInt64 nAnchorTime = 0;
+
+	while (!pEndPoint->bKillThread)
+	{
+		XnUSBCaptureRecordHeader record;
+		XnUInt32 nRead = sizeof(record);
+		if (xnOSReadFile(hFile, &record, &nRead) != XN_STATUS_OK || nRead != sizeof(record))
+		{
+			xnLogInfo(XN_MASK_USB_CAPTURE, "USB capture '%s' of end point 0x%x ended", pDevice->strFileName, pEndPoint->nEndPointID);
+			return;
+		}
+
+		if (record.nType != XN_USB_CAPTURE_RECORD_READ_THREAD_DATA || record.nEndPointID != pEndPoint->nEndPointID)
+		{
+			if (xnUSBReplayIsTransfer(record.nType))
+			{
+				++nTransfers;
+			}
+
+			if (xnOSSeekFile64(hFile, XN_OS_SEEK_CUR, record.nDataSize) != XN_STATUS_OK)
+			{
+				return;
+			}
+
+			continue;
+		}
+
+		// the data was received after these transfers (the commands that started the stream, for one), so it isn't
+		// replayed before them
+		XnBool bWaited = FALSE;
+		while (!pEndPoint->bKillThread && pDevice->nNextTransfer < nTransfers)
+		{
+			xnOSSleep(1);
+			bWaited = TRUE;
+		}
+
+		XnUInt64 nNow;
+		xnOSGetHighResTimeStamp(&nNow);
+
+		if (bWaited || pDevice->dSpeed != dSpeed)
+		{
+			dSpeed = pDevice->dSpeed;
+			nAnchorTimestamp = record.nTimestamp;
+			nAnchorTime = nNow;
+		}
+		else if (dSpeed > 0)
+		{
+			XnUInt64 nDueTime = nAnchorTime + (XnUInt64)((record.nTimestamp - nAnchorTimestamp) / dSpeed);
+			while (!pEndPoint->bKillThread && nNow < nDueTime)
+			{
+				xnOSSleep((XnUInt32)XN_MIN((nDueTime - nNow) / 1000, XN_USB_REPLAY_MAX_SLEEP));
+				xnOSGetHighResTimeStamp(&nNow);
+			}
+		}
+
+		// hand the data to the callback in buffers of the size the read thread was started with
+		XnUInt32 nLeft = record.nDataSize;
+		while (nLeft > 0 && !pEndPoint->bKillThread)
+		{
+			XnUInt32 nBytes = XN_MIN(nLeft, pEndPoint->nBufferSize);
+			nRead = nBytes;
+			if (xnOSReadFile(hFile, pEndPoint->pBuffer, &nRead) != XN_STATUS_OK || nRead != nBytes)
+			{
+				return;
+			}
+
+			pEndPoint->pCallbackFunction(pEndPoint->pBuffer, nBytes, pEndPoint->pCallbackData);
+			nLeft -= nBytes;
+		}
+	}
+}
+
+static XN_THREAD_PROC xnUSBReplayReadThreadMain(XN_THREAD_PARAM pThreadParam)
+{
+	XnUSBReplayEndPoint* pEndPoint = (XnUSBReplayEndPoint*)pThreadParam;
+
+	// each thread reads the file on its own, skipping the records of the others
+	XN_FILE_HANDLE hFile;
+	XnStatus nRetVal = xnOSOpenFile(pEndPoint->pDevice->strFileName, XN_OS_FILE_READ, &hFile);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnLogError(XN_MASK_USB_CAPTURE, "Failed to open USB capture '%s': %s", pEndPoint->pDevice->strFileName, xnGetStatusString(nRetVal));
+		XN_THREAD_PROC_RETURN(nRetVal);
+	}
+
+	nRetVal = xnOSSeekFile64(hFile, XN_OS_SEEK_SET, sizeof(XnUSBCaptureFileHeader));
+	if (nRetVal == XN_STATUS_OK)
+	{
+		xnUSBReplayEndPointData(pEndPoint, hFile);
+	}
+
+	xnOSCloseFile(&hFile);
+
+	XN_THREAD_PROC_RETURN(XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayInitReadThread(XN_USB_EP_HANDLE pEPHandle, XnUInt32 nBufferSize, XnUSBReadCallbackFunctionPtr pCallbackFunction, void* pCallbackData)
+{
+	XnStatus nRetVal = XN_STATUS_OK;
+
+	XN_VALIDATE_INPUT_PTR(pCallbackFunction);
+
+	XnUSBReplayEndPoint* pEndPoint = (XnUSBReplayEndPoint*)pEPHandle;
+
+	if (pEndPoint->hThread != NULL)
+	{
+		return (XN_STATUS_USB_READTHREAD_ALREADY_INIT);
+	}
+
+	if (nBufferSize == 0)
+	{
+		return (XN_STATUS_BAD_PARAM);
+	}
+
+	XN_VALIDATE_ALIGNED_CALLOC(pEndPoint->pBuffer, XnUChar, nBufferSize, XN_DEFAULT_MEM_ALIGN);
+	pEndPoint->nBufferSize = nBufferSize;
+	pEndPoint->pCallbackFunction = pCallbackFunction;
+	pEndPoint->pCallbackData = pCallbackData;
+	pEndPoint->bKillThread = FALSE;
+
+	nRetVal = xnOSCreateThread(xnUSBReplayReadThreadMain, pEndPoint, &pEndPoint->hThread);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		pEndPoint->hThread = NULL;
+		XN_ALIGNED_FREE_AND_NULL(pEndPoint->pBuffer);
+		return (nRetVal);
+	}
+
+	return (XN_STATUS_OK);
+}
+
+XnStatus xnUSBReplayShutdownReadThread(XN_USB_EP_HANDLE pEPHandle)
+{
+	XnUSBReplayEndPoint* pEndPoint = (XnUSBReplayEndPoint*)pEPHandle;
+
+	if (pEndPoint->hThread == NULL)
+	{
+		return (XN_STATUS_USB_READTHREAD_NOT_INIT);
+	}
+
+	pEndPoint->bKillThread = TRUE;
+
+	XnStatus nRetVal = xnOSWaitForThreadExit(pEndPoint->hThread, XN_USB_REPLAY_THREAD_KILL_TIMEOUT);
+	if (nRetVal != XN_STATUS_OK)
+	{
+		xnOSTerminateThread(&pEndPoint->hThread);
+	}
+	else
+	{
+		xnOSCloseThread(&pEndPoint->hThread);
+	}
+
+	pEndPoint->hThread = NULL;
+	XN_ALIGNED_FREE_AND_NULL(pEndPoint->pBuffer);
+
+	return (XN_STATUS_OK);
+}
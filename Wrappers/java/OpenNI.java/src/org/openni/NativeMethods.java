@@ -37,6 +37,7 @@ class NativeMethods {
   // Files
   static public final int DEVICE_PROPERTY_PLAYBACK_SPEED = 100; // float
   static public final int DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED = 101; // OniBool
+  static public final int DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED = 102; // OniBool
 
   static public final int DEVICE_COMMAND_SEEK = 1; // OniSeek
 
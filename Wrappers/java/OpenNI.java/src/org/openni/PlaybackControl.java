@@ -79,6 +79,33 @@ public class PlaybackControl {
         NativeMethods.DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED, repeat));
   }
 
+  /**
+   * Gets the current lockstep setting of the file device.
+   * 
+   * @return true if lockstep is enabled, false if not enabled.
+   */
+  public boolean getLockstepEnabled() {
+    OutArg<Boolean> val = new OutArg<Boolean>();
+    NativeMethods.checkReturnStatus(NativeMethods.oniDeviceGetBoolProperty(mDevice.getHandle(),
+        NativeMethods.DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED, val));
+    return val.mValue;
+  }
+
+  /**
+   * Changes the lockstep mode of the device. In lockstep mode, the recording is played back without
+   * regard to its timestamps: each stream gets its next frame as soon as all the frames it handed out
+   * before were released. Playback runs as fast as the consumers allow, and no frame is dropped. The
+   * playback speed is ignored while lockstep is enabled. Since the recording is read in order, the
+   * application must read every started stream, and release its frames before waiting for the next
+   * frame of any stream.
+   * 
+   * @param lockstep New value for lockstep -- true to enable, false to disable
+   */
+  public void setLockstepEnabled(boolean lockstep) {
+    NativeMethods.checkReturnStatus(NativeMethods.oniDeviceSetProperty(mDevice.getHandle(),
+        NativeMethods.DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED, lockstep));
+  }
+
   /**
    * Seeks within a VideoStream to a given FrameID. Note that when this function is called on one
    * stream, all other streams will also be changed to the corresponding place in the recording. The
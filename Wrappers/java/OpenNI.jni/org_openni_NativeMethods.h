@@ -59,6 +59,8 @@ extern "C" {
 #define org_openni_NativeMethods_DEVICE_PROPERTY_PLAYBACK_SPEED 100L
 #undef org_openni_NativeMethods_DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED
 #define org_openni_NativeMethods_DEVICE_PROPERTY_PLAYBACK_REPEAT_ENABLED 101L
+#undef org_openni_NativeMethods_DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED
+#define org_openni_NativeMethods_DEVICE_PROPERTY_PLAYBACK_LOCKSTEP_ENABLED 102L
 #undef org_openni_NativeMethods_DEVICE_COMMAND_SEEK
 #define org_openni_NativeMethods_DEVICE_COMMAND_SEEK 1L
 /*